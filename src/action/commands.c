@@ -33,8 +33,13 @@
 #include "action/processor_stack.h"
 #include "command/command.h"
 #include "command/statement.h"
+#include "objects/set.h"
 #include "util/arithmetical.h"
+#include "values/array.h"
+#include "values/bool.h"
 #include "values/int.h"
+#include "values/object_id.h"
+#include "values/set.h"
 #include "values/union.h"
 
 /*
@@ -67,6 +72,59 @@ cmd_pop(
     struct ws_command_args const* const args
 );
 
+int
+cmd_jump_if(
+    struct ws_processor* proc,
+    struct ws_command_args const* const args
+);
+
+int
+cmd_jump_unless(
+    struct ws_processor* proc,
+    struct ws_command_args const* const args
+);
+
+int
+cmd_foreach(
+    struct ws_processor* proc,
+    struct ws_command_args const* const args
+);
+
+/**
+ * Get the value of an argument
+ *
+ * @return the value or `NULL`, if the argument is invalid
+ */
+static struct ws_value*
+arg_value(
+    struct ws_processor* proc, //!< processor executing the command
+    struct ws_argument const* arg //!< argument to get the value of
+);
+
+/**
+ * Get the distance of a jump from a direct argument
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+static int
+arg_distance(
+    struct ws_argument const* arg, //!< argument holding the distance
+    size_t* distance //!< location to store the distance in
+);
+
+/**
+ * Jump if a condition has the value expected
+ *
+ * @return 0 or a positive value as returned by ws_processor_jump() on success,
+ *         a negative error number otherwise
+ */
+static int
+jump_cond(
+    struct ws_processor* proc, //!< processor executing the command
+    struct ws_command_args const* const args, //!< condition and distance
+    bool expected //!< value of the condition for which we jump
+);
+
 /*
  *
  * Interface implementation
@@ -80,6 +138,12 @@ ws_action_commands_init(void) {
         {.name = "store", .command_type = special, .func.special = cmd_store },
         {.name = "push",  .command_type = special, .func.special = cmd_push  },
         {.name = "pop",   .command_type = special, .func.special = cmd_pop   },
+        {.name = "jump_if",     .command_type = special,
+         .func.special = cmd_jump_if     },
+        {.name = "jump_unless", .command_type = special,
+         .func.special = cmd_jump_unless },
+        {.name = "foreach",     .command_type = special,
+         .func.special = cmd_foreach     },
     };
 
     return ws_command_add(cmds, ARYLEN(cmds));
@@ -271,3 +335,191 @@ cmd_push(
     return 0;
 }
 
+int
+cmd_jump_if(
+    struct ws_processor* proc,
+    struct ws_command_args const* const args
+) {
+    return jump_cond(proc, args, true);
+}
+
+int
+cmd_jump_unless(
+    struct ws_processor* proc,
+    struct ws_command_args const* const args
+) {
+    return jump_cond(proc, args, false);
+}
+
+int
+cmd_foreach(
+    struct ws_processor* proc,
+    struct ws_command_args const* const args
+) {
+    // We want 3 arguments: the collection, the counter and the loop's length
+    if ((args->num != 3) || !args->vals || (args->vals[1].type != indirect)) {
+        return -EINVAL;
+    }
+
+    size_t distance;
+    int res = arg_distance(args->vals + 2, &distance);
+    if (res < 0) {
+        return res;
+    }
+
+    struct ws_value* coll = arg_value(proc, args->vals);
+    struct ws_value* counter = arg_value(proc, args->vals + 1);
+    if (!coll || !counter ||
+            (ws_value_get_type(counter) != WS_VALUE_TYPE_INT)) {
+        return -EINVAL;
+    }
+
+    // the counter holds the position of the next element: an index for arrays,
+    // a cursor as used by ws_set_select_next() for sets
+    intmax_t pos = ws_value_int_get((struct ws_value_int*) counter);
+    if (pos < 0) {
+        return -EINVAL;
+    }
+
+    // fetch the element before pushing, which may move the stack
+    enum ws_value_type type = ws_value_get_type(coll);
+    intmax_t num = 0;
+    struct ws_object* found = NULL;
+    size_t next = pos + 1;
+    switch (type) {
+    case WS_VALUE_TYPE_ARRAY:
+        {
+            struct ws_value_array* array = (struct ws_value_array*) coll;
+            if ((size_t) pos >= ws_value_array_len(array)) {
+                // the loop is done
+                return ws_processor_jump(proc, distance);
+            }
+            num = ws_value_array_get(array, pos);
+            type = WS_VALUE_TYPE_INT;
+        }
+        break;
+
+    case WS_VALUE_TYPE_SET:
+        {
+            struct ws_set* set = ws_value_set_get((struct ws_value_set*) coll);
+            if (!set) {
+                return -EINVAL;
+            }
+
+            // sets are visited in the order of their slots
+            next = pos;
+            found = ws_set_select_next(set, &next);
+            ws_object_unref((struct ws_object*) set);
+            if (!found) {
+                // the loop is done
+                return ws_processor_jump(proc, distance);
+            }
+            type = WS_VALUE_TYPE_OBJECT_ID;
+        }
+        break;
+
+    default:
+        return -EINVAL;
+    }
+
+    ws_value_int_set((struct ws_value_int*) counter, next);
+
+    // pass the element to the loop's body
+    res = ws_processor_stack_push(proc->stack, 1);
+    if (res == 0) {
+        union ws_value_union* top = ws_processor_stack_top(proc->stack) - 1;
+        res = ws_value_union_reinit(top, type);
+        if (res == 0) {
+            if (type == WS_VALUE_TYPE_INT) {
+                ws_value_int_set(&top->int_, num);
+            } else {
+                ws_value_object_id_set(&top->object_id, found);
+            }
+        }
+    }
+
+    if (found) {
+        ws_object_unref(found);
+    }
+    return res;
+}
+
+static struct ws_value*
+arg_value(
+    struct ws_processor* proc,
+    struct ws_argument const* arg
+) {
+    switch (arg->type) {
+    case indirect: // the value must be extracted from the stack
+        return ws_processor_stack_value_at(proc->stack, arg->arg.pos, NULL);
+
+    case direct: // the value is passed directly
+        return arg->arg.val;
+
+    default:
+        return NULL;
+    }
+}
+
+static int
+arg_distance(
+    struct ws_argument const* arg,
+    size_t* distance
+) {
+    // the distance must be known when the transaction is registered
+    if ((arg->type != direct) ||
+            (ws_value_get_type(arg->arg.val) != WS_VALUE_TYPE_INT)) {
+        return -EINVAL;
+    }
+
+    *distance = ws_value_int_get((struct ws_value_int*) arg->arg.val);
+    return 0;
+}
+
+static int
+jump_cond(
+    struct ws_processor* proc,
+    struct ws_command_args const* const args,
+    bool expected
+) {
+    // We want 2 arguments: the condition and the distance
+    if ((args->num != 2) || !args->vals) {
+        return -EINVAL;
+    }
+
+    size_t distance;
+    int res = arg_distance(args->vals + 1, &distance);
+    if (res < 0) {
+        return res;
+    }
+
+    struct ws_value* cond = arg_value(proc, args->vals);
+    if (!cond) {
+        return -EINVAL;
+    }
+
+    // nil is false, integers are true unless zero
+    bool value;
+    switch (ws_value_get_type(cond)) {
+    case WS_VALUE_TYPE_NIL:
+        value = false;
+        break;
+
+    case WS_VALUE_TYPE_BOOL:
+        value = ws_value_bool_get((struct ws_value_bool*) cond);
+        break;
+
+    case WS_VALUE_TYPE_INT:
+        value = ws_value_int_get((struct ws_value_int*) cond) != 0;
+        break;
+
+    default:
+        return -EINVAL;
+    }
+
+    if (value != expected) {
+        return 0;
+    }
+
+    return ws_processor_jump(proc, distance);
+}
@@ -0,0 +1,303 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <malloc.h>
+#include <string.h>
+
+#include "action/dispatch.h"
+#include "objects/message/transaction.h"
+#include "objects/string.h"
+
+/**
+ * Initial capacity of a dispatch table
+ */
+#define DISPATCH_INITIAL_CAPACITY (16)
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Find the entry for a name
+ *
+ * @return the entry holding `name` or the empty entry where it would be
+ *         inserted
+ */
+static struct ws_dispatch_entry*
+find_entry(
+    struct ws_dispatch_table* self, //!< the table
+    struct ws_string* name, //!< name to look for
+    size_t hash //!< hash of the name
+);
+
+/**
+ * Double the capacity of a table
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+static int
+grow(
+    struct ws_dispatch_table* self //!< the table
+);
+
+/**
+ * Remove an entry, moving back entries displaced by it
+ */
+static void
+remove_entry(
+    struct ws_dispatch_table* self, //!< the table
+    struct ws_dispatch_entry* entry //!< entry to remove
+);
+
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_dispatch_table_init(
+    struct ws_dispatch_table* self
+) {
+    self->entries = calloc(DISPATCH_INITIAL_CAPACITY, sizeof(*self->entries));
+    if (!self->entries) {
+        return -ENOMEM;
+    }
+
+    self->capacity = DISPATCH_INITIAL_CAPACITY;
+    self->num = 0;
+    return 0;
+}
+
+void
+ws_dispatch_table_deinit(
+    struct ws_dispatch_table* self
+) {
+    struct ws_dispatch_entry* entry = self->entries + self->capacity;
+    while (entry-- > self->entries) {
+        if (!entry->name) {
+            continue;
+        }
+
+        ws_object_unref((struct ws_object*) entry->name);
+        if (entry->registered) {
+            ws_object_unref((struct ws_object*) entry->registered);
+        }
+        if (entry->named) {
+            ws_object_unref((struct ws_object*) entry->named);
+        }
+    }
+
+    free(self->entries);
+    self->entries = NULL;
+    self->capacity = 0;
+    self->num = 0;
+}
+
+int
+ws_dispatch_table_set(
+    struct ws_dispatch_table* self,
+    struct ws_string* name,
+    enum ws_dispatch_kind kind,
+    struct ws_transaction* transaction
+) {
+    size_t hash = ws_object_hash(&name->obj);
+    struct ws_dispatch_entry* entry = find_entry(self, name, hash);
+
+    if (!entry->name) {
+        if (!transaction) {
+            return -ENOENT;
+        }
+
+        // keep the load factor below 3/4
+        if ((self->num + 1) * 4 > self->capacity * 3) {
+            int res = grow(self);
+            if (res < 0) {
+                return res;
+            }
+            entry = find_entry(self, name, hash);
+        }
+
+        // names are copied, the caller may still modify the original
+        entry->name = ws_string_dupl(name);
+        if (!entry->name) {
+            return -ENOMEM;
+        }
+        entry->hash = hash;
+        entry->registered = NULL;
+        entry->named = NULL;
+        ++self->num;
+    }
+
+    struct ws_transaction** slot;
+    slot = (kind == WS_DISPATCH_REGISTERED) ? &entry->registered
+                                            : &entry->named;
+
+    if (transaction) {
+        if (*slot) {
+            return -EEXIST;
+        }
+
+        *slot = getref(transaction);
+        if (!*slot) {
+            goto cleanup_entry;
+        }
+        return 0;
+    }
+
+    if (!*slot) {
+        return -ENOENT;
+    }
+    ws_object_unref((struct ws_object*) *slot);
+    *slot = NULL;
+
+cleanup_entry:
+    if (!entry->registered && !entry->named) {
+        remove_entry(self, entry);
+    }
+    return transaction ? -EAGAIN : 0;
+}
+
+struct ws_transaction*
+ws_dispatch_table_get(
+    struct ws_dispatch_table* self,
+    struct ws_string* name
+) {
+    struct ws_dispatch_entry* entry;
+    entry = find_entry(self, name, ws_object_hash(&name->obj));
+    if (!entry->name) {
+        return NULL;
+    }
+
+    if (entry->registered) {
+        return getref(entry->registered);
+    }
+    return getref(entry->named);
+}
+
+struct ws_transaction*
+ws_dispatch_table_get_named(
+    struct ws_dispatch_table* self,
+    struct ws_string* name
+) {
+    struct ws_dispatch_entry* entry;
+    entry = find_entry(self, name, ws_object_hash(&name->obj));
+    if (!entry->name) {
+        return NULL;
+    }
+
+    return getref(entry->named);
+}
+
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static struct ws_dispatch_entry*
+find_entry(
+    struct ws_dispatch_table* self,
+    struct ws_string* name,
+    size_t hash
+) {
+    size_t mask = self->capacity - 1;
+    size_t pos = hash & mask;
+
+    // the table is never full, so we will hit an empty entry eventually
+    while (self->entries[pos].name) {
+        struct ws_dispatch_entry* entry = self->entries + pos;
+        if ((entry->hash == hash) && (ws_string_cmp(entry->name, name) == 0)) {
+            break;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    return self->entries + pos;
+}
+
+static int
+grow(
+    struct ws_dispatch_table* self
+) {
+    size_t capacity = self->capacity * 2;
+    struct ws_dispatch_entry* entries = calloc(capacity, sizeof(*entries));
+    if (!entries) {
+        return -ENOMEM;
+    }
+
+    size_t mask = capacity - 1;
+    struct ws_dispatch_entry* entry = self->entries + self->capacity;
+    while (entry-- > self->entries) {
+        if (!entry->name) {
+            continue;
+        }
+
+        size_t pos = entry->hash & mask;
+        while (entries[pos].name) {
+            pos = (pos + 1) & mask;
+        }
+        entries[pos] = *entry;
+    }
+
+    free(self->entries);
+    self->entries = entries;
+    self->capacity = capacity;
+    return 0;
+}
+
+static void
+remove_entry(
+    struct ws_dispatch_table* self,
+    struct ws_dispatch_entry* entry
+) {
+    size_t mask = self->capacity - 1;
+    size_t hole = entry - self->entries;
+
+    ws_object_unref((struct ws_object*) entry->name);
+    entry->name = NULL;
+    --self->num;
+
+    // move back entries which would not be found with the hole in between
+    size_t pos = (hole + 1) & mask;
+    while (self->entries[pos].name) {
+        size_t home = self->entries[pos].hash & mask;
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            self->entries[hole] = self->entries[pos];
+            self->entries[pos].name = NULL;
+            hole = pos;
+        }
+        pos = (pos + 1) & mask;
+    }
+}
+
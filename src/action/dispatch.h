@@ -0,0 +1,169 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup action "Action manager"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup action_dispatch "Action manager dispatch table"
+ *
+ * @{
+ *
+ * Table mapping event names to transactions
+ *
+ * An event runs the transaction registered for it or, if there is none, the
+ * transaction with the same name as the event.
+ * The dispatch table keeps both candidates in one entry per name, so an event
+ * is dispatched with a single lookup and without any temporary objects.
+ */
+
+#ifndef __WS_ACTION_DISPATCH_H__
+#define __WS_ACTION_DISPATCH_H__
+
+#include <stddef.h>
+
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_string;
+struct ws_transaction;
+
+/**
+ * Kind of a mapping in the dispatch table
+ */
+enum ws_dispatch_kind {
+    WS_DISPATCH_REGISTERED, //!< transaction registered for an event
+    WS_DISPATCH_NAMED, //!< transaction carrying the name itself
+};
+
+/**
+ * Entry of a dispatch table
+ */
+struct ws_dispatch_entry {
+    size_t hash; //!< @private hash of the name
+    struct ws_string* name; //!< @private name, `NULL` for empty entries
+    struct ws_transaction* registered; //!< @private registered transaction
+    struct ws_transaction* named; //!< @private transaction with the name
+};
+
+/**
+ * Dispatch table
+ *
+ * The table is an open addressing hash table with linear probing.
+ */
+struct ws_dispatch_table {
+    struct ws_dispatch_entry* entries; //!< @private entries
+    size_t capacity; //!< @private number of entries, a power of two
+    size_t num; //!< @private number of entries in use
+};
+
+/**
+ * Initialize a dispatch table
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+int
+ws_dispatch_table_init(
+    struct ws_dispatch_table* self //!< table to initialize
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Deinitialize a dispatch table
+ */
+void
+ws_dispatch_table_deinit(
+    struct ws_dispatch_table* self //!< table to deinitialize
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Set or clear a mapping
+ *
+ * Sets the transaction of the given kind for `name`.
+ * If `transaction` is `NULL`, the mapping is cleared.
+ *
+ * @return 0 on success, a negative error number otherwise:
+ *          -EEXIST - the name is already mapped to a transaction
+ *          -ENOENT - there is no mapping to clear
+ */
+int
+ws_dispatch_table_set(
+    struct ws_dispatch_table* self, //!< the table
+    struct ws_string* name, //!< name to map
+    enum ws_dispatch_kind kind, //!< kind of the mapping
+    struct ws_transaction* transaction //!< transaction to map the name to
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Get the transaction to run for an event
+ *
+ * @return a reference to the transaction registered for `name` or the one
+ *         with that name, `NULL` if there is none
+ */
+struct ws_transaction*
+ws_dispatch_table_get(
+    struct ws_dispatch_table* self, //!< the table
+    struct ws_string* name //!< name of the event
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Get the transaction carrying a name
+ *
+ * Unlike `ws_dispatch_table_get()`, this function ignores transactions
+ * registered for an event of that name.
+ *
+ * @return a reference to the transaction with the name `name`, `NULL` if there
+ *         is none
+ */
+struct ws_transaction*
+ws_dispatch_table_get_named(
+    struct ws_dispatch_table* self, //!< the table
+    struct ws_string* name //!< name of the transaction
+)
+__ws_nonnull__(1, 2)
+;
+
+#endif // __WS_ACTION_DISPATCH_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
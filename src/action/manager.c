@@ -26,17 +26,28 @@
  */
 
 #include <errno.h>
+#include <ev.h>
+#include <malloc.h>
 #include <stddef.h>
 
 #include "action/commands.h"
+#include "action/dispatch.h"
 #include "action/manager.h"
+#include "action/observer.h"
 #include "action/processor.h"
 #include "action/processor_stack.h"
+#include "action/profiler.h"
+#include "action/stack_pool.h"
+#include "action/timer.h"
+#include "action/worker.h"
+#include "command/bytecode.h"
+#include "objects/message/batch.h"
+#include "objects/message/batch_reply.h"
 #include "objects/message/error_reply.h"
 #include "objects/message/event.h"
+#include "objects/message/invocation.h"
 #include "objects/message/transaction.h"
 #include "objects/message/value_reply.h"
-#include "objects/named.h"
 #include "objects/set.h"
 #include "util/cleaner.h"
 
@@ -47,9 +58,72 @@
 struct {
     struct ws_object* obj; //!< @public object to feed to transactions
     struct ws_set transactions; //!< @public transactions registered
-    struct ws_set registrations; //!< @public registrations of transactions
+    struct ws_dispatch_table dispatch; //!< @public event dispatch table
+    ev_timer trimmer; //!< @public timer trimming the stack pool
+    size_t runs; //!< @public transactions run since the last trim check
+    ev_idle resumer; //!< @public watcher resuming suspended runs
+    struct run* suspended; //!< @public runs suspended
+    struct run** suspended_tail; //!< @public end of the suspended runs
+    bool shut_down; //!< @public whether the manager is being shut down
 } actman_ctx;
 
+/**
+ * A run of a transaction
+ *
+ * Runs which are either suspended or performed on the worker pool are
+ * allocated, all other runs live on the stack.
+ */
+struct run {
+    struct ws_action_job job; //!< job, if run by the worker pool
+    struct ws_transaction* transaction; //!< transaction to run
+    struct ws_processor_stack* stack; //!< stack of the run
+    struct ws_processor proc; //!< processor performing the run
+    ws_action_manager_reply_f done; //!< callback to pass the reply to
+    void* data; //!< data to pass to the callback
+    struct run* next; //!< next suspended run
+    uint64_t elapsed; //!< time spent executing, for the profiler
+    union ws_value_union const* args; //!< arguments to push, if any
+    size_t nargs; //!< number of arguments to push
+    struct ws_message* message; //!< message submitted, if not the transaction
+};
+
+/**
+ * A batch being processed
+ *
+ * The transactions of the batch are processed one after another, each one
+ * once the previous one completed.
+ */
+struct batch_run {
+    struct ws_batch* batch; //!< batch to process
+    struct ws_batch_reply* reply; //!< reply so far, `NULL` if an error occurred
+    size_t pos; //!< position of the transaction being processed
+    bool atomic; //!< whether the batch is atomic
+    bool aborted; //!< whether the remaining transactions are cancelled
+    bool running; //!< whether a transaction is being processed
+    bool advancing; //!< whether transactions are being started
+    bool preemptible; //!< whether transactions may run asynchronously
+    ws_action_manager_reply_f done; //!< callback to pass the reply to
+    void* data; //!< data to pass to the callback
+};
+
+/**
+ * Interval in which the stack pool is checked for trimming, in seconds
+ */
+#define STACK_TRIM_INTERVAL (30.)
+
+/**
+ * Number of instructions a run may perform at once
+ *
+ * Runs on the main loop are suspended and runs on the worker pool yield once
+ * they exceed the budget.
+ */
+#define RUN_BUDGET_INSNS (1 << 14)
+
+/**
+ * Time a run may take at once, in seconds
+ */
+#define RUN_BUDGET_TIME (0.002)
+
 
 /*
  *
@@ -74,6 +148,281 @@ run_transaction(
     struct ws_value* context //!< context to push on the stack
 );
 
+/**
+ * Process the transactions of a batch in order, right away
+ *
+ * @return reply to the batch or `NULL`, if an error occurred
+ */
+static struct ws_reply*
+run_batch(
+    struct ws_batch* batch //!< Batch to process
+);
+
+/**
+ * Process the transactions of a batch in order
+ *
+ * The replies of the transactions are collected in a single batch reply. A
+ * transaction which does not generate a reply, e.g. a registration, is
+ * represented by a nil value. If the batch is atomic, no transaction is
+ * processed unless all of them compile and the batch is aborted on the first
+ * error reply.
+ *
+ * If `preemptible` is set, the transactions are submitted via
+ * `submit_transaction()`, otherwise they are processed right away.
+ *
+ * @return 1 if the batch is processed asynchronously, 0 otherwise
+ */
+static int
+submit_batch(
+    struct ws_batch* batch, //!< Batch to process
+    bool preemptible, //!< whether transactions may run asynchronously
+    ws_action_manager_reply_f done, //!< callback to pass the reply to
+    void* data //!< data to pass to the callback
+);
+
+/**
+ * Process the remaining transactions of a batch
+ *
+ * Transactions are started until one of them runs asynchronously. Once all
+ * of them completed, the batch reply is passed on and the batch run is freed.
+ *
+ * @return 1 if the batch is still being processed, 0 otherwise
+ */
+static int
+batch_advance(
+    struct batch_run* run //!< batch run to advance
+);
+
+/**
+ * Reply callback: add the reply of a transaction to the batch reply
+ */
+static void
+batch_entry_done(
+    struct ws_reply* reply, //!< reply to the transaction
+    void* data //!< the batch run
+);
+
+/**
+ * Reply callback: store the reply in the `struct ws_reply*` passed as data
+ */
+static void
+store_reply(
+    struct ws_reply* reply, //!< reply to store
+    void* data //!< location to store the reply at
+);
+
+/**
+ * Run a registered transaction with the arguments of an invocation
+ *
+ * The reply carries the id of the invocation rather than the one of the
+ * transaction.
+ *
+ * @return reply generated by running the transaction
+ */
+static struct ws_reply*
+run_invocation(
+    struct ws_invocation* invocation //!< Invocation to process
+);
+
+/**
+ * Get the registered transaction an invocation refers to
+ *
+ * @return the transaction or `NULL`, if there is no such transaction
+ */
+static struct ws_transaction*
+invoked_transaction(
+    struct ws_invocation* invocation //!< Invocation to look up
+);
+
+/**
+ * Create the reply to an invocation of a transaction which doesn't exist
+ *
+ * @return the error reply or `NULL`, if it could not be created
+ */
+static struct ws_reply*
+no_such_transaction(
+    struct ws_invocation* invocation //!< Invocation which failed
+);
+
+/**
+ * Run a registered transaction without blocking the main loop
+ *
+ * The transaction is run via `submit_run()` with the arguments of the
+ * invocation, which is kept alive for as long as the run.
+ *
+ * @return 1 if the transaction is run asynchronously, 0 otherwise
+ */
+static int
+submit_invocation(
+    struct run* run //!< run with the invocation as its message
+);
+
+/**
+ * Register a transaction for later invocation
+ *
+ * The transaction is compiled right away. Events named like the transaction
+ * will run it.
+ *
+ * @return `NULL` on success, an error reply otherwise
+ */
+static struct ws_reply*
+register_transaction(
+    struct ws_transaction* transaction //!< Transaction to register
+);
+
+/**
+ * Process a transaction without blocking the main loop
+ *
+ * The transaction is registered right away, if requested. If it is to be
+ * executed, it is run via `submit_run()`.
+ *
+ * @return 1 if the transaction is run asynchronously, 0 otherwise
+ */
+static int
+submit_transaction(
+    struct run* run //!< run of the transaction, may live on the stack
+);
+
+/**
+ * Perform a run without blocking the main loop
+ *
+ * Transactions which leave the rest of the world alone are run on the worker
+ * pool, all others are run by `run_preemptible()`. Transactions which don't
+ * compile result in an error reply.
+ *
+ * @return 1 if the run is performed asynchronously, 0 otherwise
+ */
+static int
+submit_run(
+    struct run* run //!< run to perform, may live on the stack
+);
+
+/**
+ * Run a transaction on the main loop, suspending it if it takes too long
+ *
+ * If the run is suspended, it is moved off the stack.
+ *
+ * @return 1 if the run was suspended, 0 otherwise
+ */
+static int
+run_preemptible(
+    struct run* run, //!< run to perform, may live on the stack
+    struct ws_value* context //!< context to push on the stack
+);
+
+/**
+ * Prepare a run
+ *
+ * Sets up the stack and the processor of a run of `run->transaction`. The
+ * arguments of the run, if any, are pushed right after the environment.
+ *
+ * @return `NULL` on success, an error reply otherwise
+ */
+static struct ws_reply*
+run_start(
+    struct run* run, //!< run to prepare
+    struct ws_value* context //!< context to push on the stack
+);
+
+/**
+ * Continue a run
+ *
+ * If the run completes, the stack and the processor are released.
+ *
+ * @return the reply generated by the run or `NULL`, if it was suspended
+ */
+static struct ws_reply*
+run_continue(
+    struct run* run //!< run to continue
+);
+
+/**
+ * Copy a run to the heap
+ *
+ * The copy holds references to the transaction and the message of the run.
+ *
+ * @return the copy or `NULL`, if the run could not be copied
+ */
+static struct run*
+run_copy(
+    struct run const* run //!< run to copy
+);
+
+/**
+ * Pass the reply of a run to its callback
+ *
+ * If the run was submitted for a message other than its transaction, the
+ * reply carries the id of that message. If the run has no callback, the reply
+ * is dropped.
+ */
+static void
+run_reply(
+    struct run* run, //!< run which generated the reply
+    struct ws_reply* reply //!< reply generated by the run
+);
+
+/**
+ * Pass the reply of an allocated run on and free the run
+ */
+static void
+run_finish(
+    struct run* run, //!< run to finish
+    struct ws_reply* reply //!< reply generated by the run
+);
+
+/**
+ * Free a run created by `run_copy()`
+ */
+static void
+run_free(
+    struct run* run //!< run to free
+);
+
+/**
+ * Job callback: run a transaction on a worker thread
+ *
+ * The run yields if it exceeds its budget and is continued when the job is
+ * run again, possibly by another worker.
+ *
+ * @return the reply generated by the transaction or `NULL`, if it yielded
+ */
+static struct ws_reply*
+run_async(
+    struct ws_action_job* job
+);
+
+/**
+ * Job callback: pass the reply of an asynchronous run on
+ *
+ * If the worker pool was shut down before the run completed, the run is
+ * aborted.
+ */
+static void
+complete_async(
+    struct ws_action_job* job,
+    struct ws_reply* reply
+);
+
+/**
+ * Watcher callback: continue the suspended runs
+ */
+static void
+resume_runs(
+    struct ev_loop* loop,
+    ev_idle* watcher,
+    int revents
+);
+
+/**
+ * Timer callback: trim the stack pool if no transaction ran for a while
+ */
+static void
+trim_stacks(
+    struct ev_loop* loop,
+    ev_timer* watcher,
+    int revents
+);
+
 /**
  * Deinitialize the action manager
  */
@@ -110,23 +459,41 @@ ws_action_manager_init(
         return res;
     }
 
-    res = ws_set_init(&actman_ctx.registrations);
+    res = ws_dispatch_table_init(&actman_ctx.dispatch);
     if (res < 0) {
         goto cleanup_transactions;
     }
 
     res = ws_action_commands_init();
     if (res < 0) {
-        goto cleanup_registrations;
+        goto cleanup_dispatch;
     }
 
+    res = ws_action_observer_init();
+    if (res < 0) {
+        goto cleanup_dispatch;
+    }
+
+    // stacks are only trimmed while we're idle
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    if (loop) {
+        ev_timer_init(&actman_ctx.trimmer, trim_stacks, STACK_TRIM_INTERVAL,
+                      STACK_TRIM_INTERVAL);
+        ev_timer_start(loop, &actman_ctx.trimmer);
+    }
+
+    // suspended runs are continued whenever there's nothing else to do
+    actman_ctx.suspended = NULL;
+    actman_ctx.suspended_tail = &actman_ctx.suspended;
+    ev_idle_init(&actman_ctx.resumer, resume_runs);
+
     ws_cleaner_add(action_manager_deinit, NULL);
 
     is_init = true;
     return 0;
 
-cleanup_registrations:
-    ws_object_deinit((struct ws_object*) &actman_ctx.registrations);
+cleanup_dispatch:
+    ws_dispatch_table_deinit(&actman_ctx.dispatch);
 cleanup_transactions:
     ws_object_deinit((struct ws_object*) &actman_ctx.transactions);
     ws_object_unref(actman_ctx.obj);
@@ -146,15 +513,9 @@ ws_action_manager_process(
         enum ws_transaction_flags flags = ws_transaction_flags(transaction);
 
         if (flags & WS_TRANSACTION_FLAGS_REGISTER) {
-            // register the transaction for later invokation
-            int res = ws_set_insert(&actman_ctx.transactions,
-                                    (struct ws_object*) transaction);
-            if (res < 0) {
-                struct ws_error_reply* rep;
-                rep = ws_error_reply_new(transaction, -res,
-                                         "Could not register transaction",
-                                         NULL);
-                return (struct ws_reply*) rep;
+            struct ws_reply* reply = register_transaction(transaction);
+            if (reply) {
+                return reply;
             }
         }
 
@@ -166,6 +527,16 @@ ws_action_manager_process(
         return NULL;
     }
 
+    // check whether the message invokes a registered transaction
+    if (message->obj.id == &WS_OBJECT_TYPE_ID_INVOCATION) {
+        return run_invocation((struct ws_invocation*) message);
+    }
+
+    // check whether the message is a batch of transactions
+    if (message->obj.id == &WS_OBJECT_TYPE_ID_BATCH) {
+        return run_batch((struct ws_batch*) message);
+    }
+
     // check whether the message is an event
     if (message->obj.id == &WS_OBJECT_TYPE_ID_EVENT) {
         struct ws_event* event = (struct ws_event*) message;
@@ -177,45 +548,20 @@ ws_action_manager_process(
             return NULL;
         }
 
-        { // contain transaction retrieval in a scope to save stack
-            // get the named object containing the event
-            struct ws_named comparable;
-            ws_named_init(&comparable, name, NULL);
-
-            struct ws_named* named;
-            named = set_get(&actman_ctx.registrations, &comparable);
-
-            ws_object_deinit((struct ws_object*) &comparable);
-
-            // extract the transaction to run
-            if (named) {
-                transaction = (struct ws_transaction*) ws_named_get_obj(named);
-            }
-        }
-
-        if (!transaction) {
-            // get the transaction directly
-            struct ws_transaction comparable;
-            if (ws_transaction_init(&comparable, 0, name) < 0) {
-                goto cleanup_name;
-            }
-
-            transaction = set_get(&actman_ctx.transactions, &comparable);
-            ws_object_deinit((struct ws_object*) &comparable);
-        }
+        // get the transaction registered for the event or named like it
+        transaction = ws_dispatch_table_get(&actman_ctx.dispatch, name);
 
         // check whether we _have_ a transaction
         if (!transaction) {
             goto cleanup_name;
         }
 
-        // now, finally, run the transaction
-        struct ws_reply* reply;
-        reply = run_transaction(transaction,
-                                &ws_event_get_context(event)->value);
-        if (reply) {
-            ws_object_unref((struct ws_object*) reply);
-        }
+        // now, finally, run the transaction, nobody waits for the reply
+        struct run run = {
+            .transaction = transaction,
+        };
+        (void) run_preemptible(&run, &ws_event_get_context(event)->value);
+        ws_object_unref((struct ws_object*) transaction);
 
 cleanup_name:
         ws_object_unref((struct ws_object*) name);
@@ -225,6 +571,44 @@ cleanup_name:
     return NULL;
 }
 
+int
+ws_action_manager_submit(
+    struct ws_message* message,
+    ws_action_manager_reply_f done,
+    void* data
+) {
+    // completing aborted runs may cause further messages to be submitted
+    if (actman_ctx.shut_down) {
+        done(NULL, data);
+        return 0;
+    }
+
+    if (message->obj.id == &WS_OBJECT_TYPE_ID_TRANSACTION) {
+        struct run run = {
+            .transaction = (struct ws_transaction*) message,
+            .done = done,
+            .data = data,
+        };
+        return submit_transaction(&run);
+    }
+
+    if (message->obj.id == &WS_OBJECT_TYPE_ID_INVOCATION) {
+        struct run run = {
+            .message = message,
+            .done = done,
+            .data = data,
+        };
+        return submit_invocation(&run);
+    }
+
+    if (message->obj.id == &WS_OBJECT_TYPE_ID_BATCH) {
+        return submit_batch((struct ws_batch*) message, true, done, data);
+    }
+
+    done(ws_action_manager_process(message), data);
+    return 0;
+}
+
 int
 ws_action_manager_register(
     struct ws_string* event_name,
@@ -246,43 +630,21 @@ ws_action_manager_register(
         return -ENOENT;
     }
 
-    // construct a named object
-    struct ws_named* named = ws_named_new(event_name,
-                                          (struct ws_object*) transaction);
-    if (!named) {
-        return -ENOMEM;
-    }
+    // finally, map the event to the transaction
+    res = ws_dispatch_table_set(&actman_ctx.dispatch, event_name,
+                                WS_DISPATCH_REGISTERED, transaction);
+    ws_object_unref((struct ws_object*) transaction);
 
-    // finally, insert the new named object
-    res = ws_set_insert(&actman_ctx.registrations, (struct ws_object*) named);
-    if (res < 0) {
-        ws_object_unref((struct ws_object*) named);
-        return res;
-    }
-
-    return 0;
+    // an event keeps the transaction it was registered for first
+    return (res == -EEXIST) ? 0 : res;
 }
 
 int
 ws_action_manager_unregister_event(
     struct ws_string* event_name
 ) {
-    int res;
-
-    // construct a comparable for removal
-    struct ws_named comparable;
-    res = ws_named_init(&comparable, event_name, NULL);
-    if (res < 0) {
-        return res;
-    }
-
-    // perform the removal
-    res = ws_set_remove(&actman_ctx.registrations,
-                            (struct ws_object*) &comparable);
-
-    // get rid of the comparable before returning
-    ws_object_deinit((struct ws_object*) &comparable);
-    return res;
+    return ws_dispatch_table_set(&actman_ctx.dispatch, event_name,
+                                 WS_DISPATCH_REGISTERED, NULL);
 }
 
 int
@@ -304,7 +666,14 @@ ws_action_manager_unregister_transaction(
 
     // get rid of the comparable before returning
     ws_object_deinit((struct ws_object*) &comparable);
-    return res;
+    if (res < 0) {
+        return res;
+    }
+
+    // events are no longer dispatched by the transaction's name
+    (void) ws_dispatch_table_set(&actman_ctx.dispatch, transaction_name,
+                                 WS_DISPATCH_NAMED, NULL);
+    return 0;
 }
 
 
@@ -314,17 +683,414 @@ ws_action_manager_unregister_transaction(
  *
  */
 
+static struct ws_reply*
+register_transaction(
+    struct ws_transaction* transaction
+) {
+    // compile the transaction now rather than on its first invokation
+    if (!ws_transaction_bytecode(transaction)) {
+        struct ws_error_reply* rep;
+        rep = ws_error_reply_new(transaction, EINVAL,
+                                 "Could not compile transaction", NULL);
+        return (struct ws_reply*) rep;
+    }
+
+    // register the transaction for later invokation
+    int res = ws_set_insert(&actman_ctx.transactions,
+                            (struct ws_object*) transaction);
+    if (res < 0) {
+        struct ws_error_reply* rep;
+        rep = ws_error_reply_new(transaction, -res,
+                                 "Could not register transaction", NULL);
+        return (struct ws_reply*) rep;
+    }
+
+    // events named like the transaction will run it
+    struct ws_string* name = ws_transaction_name(transaction);
+    if (name) {
+        res = ws_dispatch_table_set(&actman_ctx.dispatch, name,
+                                    WS_DISPATCH_NAMED, transaction);
+        ws_object_unref((struct ws_object*) name);
+    }
+    if ((res < 0) && (res != -EEXIST)) {
+        ws_set_remove(&actman_ctx.transactions,
+                      (struct ws_object*) transaction);
+
+        struct ws_error_reply* rep;
+        rep = ws_error_reply_new(transaction, -res,
+                                 "Could not register transaction", NULL);
+        return (struct ws_reply*) rep;
+    }
+
+    return NULL;
+}
+
+static int
+submit_transaction(
+    struct run* run
+) {
+    enum ws_transaction_flags flags = ws_transaction_flags(run->transaction);
+
+    // registrations are handled right away
+    if (flags & WS_TRANSACTION_FLAGS_REGISTER) {
+        struct ws_reply* reply = register_transaction(run->transaction);
+        if (reply) {
+            run_reply(run, reply);
+            return 0;
+        }
+    }
+
+    if (!(flags & WS_TRANSACTION_FLAGS_EXEC)) {
+        run_reply(run, NULL);
+        return 0;
+    }
+
+    return submit_run(run);
+}
+
+static int
+submit_run(
+    struct run* run
+) {
+    // code which doesn't compile is not run at all
+    struct ws_bytecode const* code = ws_transaction_bytecode(run->transaction);
+    if (!code) {
+        run_reply(run, (struct ws_reply*)
+                       ws_error_reply_new(run->transaction, EINVAL,
+                                          "Could not compile transaction",
+                                          NULL));
+        return 0;
+    }
+
+    // transactions which leave the rest of the world alone may run
+    // concurrently to the main loop
+    if (code->pure) {
+        struct run* async = run_copy(run);
+        if (async) {
+            async->job.run = run_async;
+            async->job.done = complete_async;
+            if (ws_action_worker_submit(&async->job) == 0) {
+                return 1;
+            }
+            run_free(async);
+        }
+    }
+
+    return run_preemptible(run, NULL);
+}
+
+static struct ws_reply*
+run_batch(
+    struct ws_batch* batch
+) {
+    struct ws_reply* retval = NULL;
+    (void) submit_batch(batch, false, store_reply, &retval);
+    return retval;
+}
+
+static int
+submit_batch(
+    struct ws_batch* batch,
+    bool preemptible,
+    ws_action_manager_reply_f done,
+    void* data
+) {
+    struct batch_run* run = calloc(1, sizeof(*run));
+    if (!run) {
+        goto cleanup;
+    }
+
+    run->reply = ws_batch_reply_new(batch);
+    if (!run->reply) {
+        goto cleanup_run;
+    }
+
+    run->batch = getref(batch);
+    if (!run->batch) {
+        goto cleanup_reply;
+    }
+    run->atomic = ws_batch_is_atomic(batch);
+    run->preemptible = preemptible;
+    run->done = done;
+    run->data = data;
+
+    // a transaction which doesn't compile spoils an atomic batch right away
+    size_t pos;
+    for (pos = 0; run->atomic && (pos < ws_batch_len(batch)); ++pos) {
+        if (!ws_transaction_bytecode(ws_batch_get(batch, pos))) {
+            run->aborted = true;
+        }
+    }
+
+    return batch_advance(run);
+
+cleanup_reply:
+    ws_object_unref((struct ws_object*) run->reply);
+cleanup_run:
+    free(run);
+cleanup:
+    done(NULL, data);
+    return 0;
+}
+
+static int
+batch_advance(
+    struct batch_run* run
+) {
+    // transactions completing while we start them are handled by the loop
+    if (run->advancing) {
+        return 1;
+    }
+    run->advancing = true;
+
+    while (run->reply && !run->running &&
+            (run->pos < ws_batch_len(run->batch))) {
+        struct ws_transaction* transaction;
+        transaction = ws_batch_get(run->batch, run->pos);
+
+        run->running = true;
+        if (run->aborted) {
+            batch_entry_done((struct ws_reply*)
+                             ws_error_reply_new(transaction, ECANCELED,
+                                                "Batch aborted", NULL),
+                             run);
+        } else if (run->preemptible) {
+            struct run entry = {
+                .transaction = transaction,
+                .done = batch_entry_done,
+                .data = run,
+            };
+            (void) submit_transaction(&entry);
+        } else {
+            batch_entry_done(ws_action_manager_process(&transaction->m), run);
+        }
+    }
+
+    run->advancing = false;
+    if (run->running) {
+        return 1;
+    }
+
+    // the batch is either complete or failed
+    run->done((struct ws_reply*) run->reply, run->data);
+    ws_object_unref((struct ws_object*) run->batch);
+    free(run);
+    return 0;
+}
+
+static void
+batch_entry_done(
+    struct ws_reply* reply,
+    void* data
+) {
+    struct batch_run* run = (struct batch_run*) data;
+    struct ws_transaction* transaction = ws_batch_get(run->batch, run->pos);
+
+    run->running = false;
+    ++run->pos;
+
+    // a transaction which doesn't generate a reply is represented by nil, but
+    // a cancellation or a run aborted on shutdown should have generated one
+    if (!reply && !run->aborted && !actman_ctx.shut_down) {
+        reply = (struct ws_reply*) ws_value_reply_new(transaction, NULL);
+    }
+
+    if (!reply || !run->reply) {
+        ws_object_unref((struct ws_object*) reply);
+        ws_object_unref((struct ws_object*) run->reply);
+        run->reply = NULL;
+    } else {
+        if (run->atomic &&
+                (reply->m.obj.id == &WS_OBJECT_TYPE_ID_ERROR_REPLY)) {
+            run->aborted = true;
+        }
+
+        // the batch reply takes over our reference
+        if (ws_batch_reply_append(run->reply, reply) < 0) {
+            ws_object_unref((struct ws_object*) reply);
+            ws_object_unref((struct ws_object*) run->reply);
+            run->reply = NULL;
+        }
+    }
+
+    (void) batch_advance(run);
+}
+
+static void
+store_reply(
+    struct ws_reply* reply,
+    void* data
+) {
+    *((struct ws_reply**) data) = reply;
+}
+
+static struct ws_reply*
+run_invocation(
+    struct ws_invocation* invocation
+) {
+    struct ws_reply* retval;
+    struct ws_transaction* transaction = invoked_transaction(invocation);
+    if (!transaction) {
+        return no_such_transaction(invocation);
+    }
+
+    struct run run = {
+        .transaction = transaction,
+        .args = ws_invocation_args(invocation),
+        .nargs = ws_invocation_nargs(invocation),
+    };
+
+    // the transaction was compiled when it was registered
+    retval = run_start(&run, NULL);
+    if (!retval) {
+        retval = run_continue(&run);
+    }
+    ws_object_unref((struct ws_object*) transaction);
+
+    if (retval) {
+        ws_message_set_id(&retval->m, ws_message_get_id(&invocation->m));
+    }
+    return retval;
+}
+
+static struct ws_transaction*
+invoked_transaction(
+    struct ws_invocation* invocation
+) {
+    struct ws_string* name = ws_invocation_name(invocation);
+    if (!name) {
+        return NULL;
+    }
+
+    struct ws_transaction* retval;
+    retval = ws_dispatch_table_get_named(&actman_ctx.dispatch, name);
+    ws_object_unref((struct ws_object*) name);
+    return retval;
+}
+
+static struct ws_reply*
+no_such_transaction(
+    struct ws_invocation* invocation
+) {
+    // we need a transaction to create an error reply from
+    struct ws_transaction* dummy;
+    dummy = ws_transaction_new(ws_message_get_id(&invocation->m), NULL, 0,
+                               NULL);
+    if (!dummy) {
+        return NULL;
+    }
+
+    struct ws_reply* retval = (struct ws_reply*)
+                              ws_error_reply_new(dummy, ENOENT,
+                                                 "No such transaction", NULL);
+    ws_object_unref((struct ws_object*) dummy);
+    return retval;
+}
+
+static int
+submit_invocation(
+    struct run* run
+) {
+    struct ws_invocation* invocation = (struct ws_invocation*) run->message;
+
+    run->transaction = invoked_transaction(invocation);
+    if (!run->transaction) {
+        run_reply(run, no_such_transaction(invocation));
+        return 0;
+    }
+    run->args = ws_invocation_args(invocation);
+    run->nargs = ws_invocation_nargs(invocation);
+
+    // the transaction was compiled when it was registered
+    int retval = submit_run(run);
+    ws_object_unref((struct ws_object*) run->transaction);
+    return retval;
+}
+
 static struct ws_reply*
 run_transaction(
     struct ws_transaction* transaction,
     struct ws_value* context
 ) {
+    struct run run = {
+        .transaction = transaction,
+    };
+
+    // without a budget, the run will not be suspended
+    struct ws_reply* retval = run_start(&run, context);
+    if (!retval) {
+        retval = run_continue(&run);
+    }
+
+    return retval;
+}
+
+static int
+run_preemptible(
+    struct run* run,
+    struct ws_value* context
+) {
+    struct ws_reply* reply = run_start(run, context);
+    if (!reply) {
+        run->proc.budget = RUN_BUDGET_INSNS;
+        run->proc.time_budget = RUN_BUDGET_TIME;
+        reply = run_continue(run);
+    }
+
+    if (run->proc.suspended) {
+        // move the run off the stack, we continue it later
+        struct run* suspended = run_copy(run);
+        if (suspended) {
+            *actman_ctx.suspended_tail = suspended;
+            actman_ctx.suspended_tail = &suspended->next;
+
+            struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+            if (loop) {
+                ev_idle_start(loop, &actman_ctx.resumer);
+            }
+            return 1;
+        }
+
+        // we cannot suspend the run, so we complete it right away
+        run->proc.budget = 0;
+        run->proc.time_budget = 0;
+        reply = run_continue(run);
+    }
+
+    run_reply(run, reply);
+    return 0;
+}
+
+static struct ws_reply*
+run_start(
+    struct run* run,
+    struct ws_value* context
+) {
+    struct ws_transaction* transaction = run->transaction;
     struct ws_reply* retval = NULL;
     int res;
 
-    // prepare the stack
-    struct ws_processor_stack stack;
-    res = ws_processor_stack_init(&stack);
+    // take a stack from the pool
+    run->stack = ws_processor_stack_pool_get();
+    if (!run->stack) {
+        return (struct ws_reply*)
+               ws_error_reply_new(transaction, ENOMEM, "Could not init stack",
+                                  NULL);
+    }
+    __atomic_add_fetch(&actman_ctx.runs, 1, __ATOMIC_RELAXED);
+
+    // get the compiled commands from the transaction
+    struct ws_bytecode const* code = ws_transaction_bytecode(transaction);
+    if (!code) {
+        retval = (struct ws_reply*)
+                 ws_error_reply_new(transaction, EINVAL,
+                                    "Command list malformed", NULL);
+        goto cleanup_stack;
+    }
+
+    // allocate the stack for the environment and the whole transaction
+    size_t env = 2 + run->nargs;
+    res = ws_processor_stack_reserve(run->stack, env + code->stack_size);
     if (res < 0) {
         retval = (struct ws_reply*)
                  ws_error_reply_new(transaction, -res, "Could not init stack",
@@ -333,7 +1099,7 @@ run_transaction(
     }
 
     // push environment on the stack
-    res = ws_processor_stack_push(&stack, 2);
+    res = ws_processor_stack_push(run->stack, env);
     if (res < 0) {
         retval = (struct ws_reply*)
                  ws_error_reply_new(transaction, -res, "Could not init stack",
@@ -342,7 +1108,7 @@ run_transaction(
     }
 
     {
-        union ws_value_union* bottom = ws_processor_stack_bottom(&stack);
+        union ws_value_union* bottom = ws_processor_stack_bottom(run->stack);
 
         // initialize the global context
         ws_value_union_reinit(bottom, WS_VALUE_TYPE_OBJECT_ID);
@@ -356,24 +1122,21 @@ run_transaction(
         } else {
             ws_value_union_reinit(bottom, WS_VALUE_TYPE_NIL);
         }
+
+        // initialize the arguments
+        size_t i;
+        for (i = 0; i < run->nargs; ++i) {
+            ++bottom;
+            struct ws_value* arg = (struct ws_value*) &run->args[i].value;
+            ws_value_union_init_from_val(bottom, arg);
+        }
     }
 
     // we start a new frame, but we will never restore the default frame
-    (void) ws_processor_stack_start_frame(&stack);
-
-    // get the commands from the transaction
-    struct ws_transaction_command_list* commands;
-    commands = ws_transaction_commands(transaction);
-    if (!commands) {
-        retval = (struct ws_reply*)
-                 ws_error_reply_new(transaction, EINVAL,
-                                    "Command list malformed", NULL);
-        goto cleanup_stack;
-    }
+    (void) ws_processor_stack_start_frame(run->stack);
 
     // prepare the processor
-    struct ws_processor proc;
-    res = ws_processor_init(&proc, &stack, commands);
+    res = ws_processor_init(&run->proc, run->stack, code);
     if (res < 0) {
         retval = (struct ws_reply*)
                  ws_error_reply_new(transaction, -res,
@@ -381,36 +1144,242 @@ run_transaction(
         goto cleanup_stack;
     }
 
-    // run processor
-    res = ws_processor_exec(&proc);
+    return NULL;
+
+cleanup_stack:
+    ws_processor_stack_pool_put(run->stack);
+    run->stack = NULL;
+    return retval;
+}
+
+static struct ws_reply*
+run_continue(
+    struct run* run
+) {
+    struct ws_reply* retval;
+
+    // run processor, only measuring the time we actually execute
+    bool profile = ws_profiler_enabled();
+    uint64_t start = profile ? ws_profiler_now() : 0;
+    ssize_t res = ws_processor_exec(&run->proc);
+    if (profile) {
+        run->elapsed += ws_profiler_now() - start;
+    }
+    if (run->proc.suspended) {
+        return NULL;
+    }
+
+    if (profile) {
+        struct ws_string* name = ws_transaction_name(run->transaction);
+        if (name) {
+            ws_profiler_record_transaction(name, run->elapsed);
+            ws_object_unref(&name->obj);
+        }
+    }
+
     if (res < 0) {
         //!< @todo more elaborate error description
         retval = (struct ws_reply*)
-                 ws_error_reply_new(transaction, -res,
+                 ws_error_reply_new(run->transaction, -res,
                                     "Could not exec transaction", NULL);
-        goto cleanup_processor;
+    } else {
+        // create the return message from the transaction and the value
+        struct ws_value* value;
+        value = ws_processor_stack_value_at(run->stack, -1, NULL);
+        retval = (struct ws_reply*) ws_value_reply_new(run->transaction,
+                                                       value);
     }
 
-    // create the return message from the transaction and the value
-    struct ws_value* value = ws_processor_stack_value_at(&stack, -1, NULL);
-    retval = (struct ws_reply*) ws_value_reply_new(transaction, value);
-
     // cleanup
+    ws_processor_deinit(&run->proc);
+    ws_processor_stack_pool_put(run->stack);
+    run->stack = NULL;
+    return retval;
+}
 
-cleanup_processor:
-    ws_processor_deinit(&proc);
+static struct run*
+run_copy(
+    struct run const* run
+) {
+    struct run* retval = malloc(sizeof(*retval));
+    if (!retval) {
+        return NULL;
+    }
+
+    *retval = *run;
+    retval->next = NULL;
+    retval->transaction = getref(run->transaction);
+    retval->message = getref(run->message);
+    if (!retval->transaction || (run->message && !retval->message)) {
+        run_free(retval);
+        return NULL;
+    }
 
-cleanup_stack:
-    ws_processor_stack_deinit(&stack);
     return retval;
 }
 
+static void
+run_reply(
+    struct run* run,
+    struct ws_reply* reply
+) {
+    if (reply && run->message) {
+        ws_message_set_id(&reply->m, ws_message_get_id(run->message));
+    }
+
+    if (run->done) {
+        run->done(reply, run->data);
+    } else if (reply) {
+        ws_object_unref((struct ws_object*) reply);
+    }
+}
+
+static void
+run_finish(
+    struct run* run,
+    struct ws_reply* reply
+) {
+    run_reply(run, reply);
+    run_free(run);
+}
+
+static void
+run_free(
+    struct run* run
+) {
+    ws_object_unref((struct ws_object*) run->transaction);
+    ws_object_unref((struct ws_object*) run->message);
+    free(run);
+}
+
+static void
+trim_stacks(
+    struct ev_loop* loop,
+    ev_timer* watcher,
+    int revents
+) {
+    if (!__atomic_exchange_n(&actman_ctx.runs, 0, __ATOMIC_RELAXED)) {
+        ws_processor_stack_pool_trim();
+    }
+}
+
+static struct ws_reply*
+run_async(
+    struct ws_action_job* job
+) {
+    struct run* run = (struct run*) job;
+    struct ws_reply* retval;
+
+    // a run which yielded before already has a stack
+    if (!run->stack) {
+        retval = run_start(run, NULL);
+        if (retval) {
+            return retval;
+        }
+        run->proc.budget = RUN_BUDGET_INSNS;
+        run->proc.time_budget = RUN_BUDGET_TIME;
+    }
+
+    retval = run_continue(run);
+    if (!run->proc.suspended) {
+        return retval;
+    }
+
+    // the run may be continued by another worker, so it takes its stack along
+    struct ws_processor_stack* stack;
+    stack = ws_processor_stack_pool_detach(run->stack);
+    if (!stack) {
+        ws_processor_deinit(&run->proc);
+        ws_processor_stack_pool_put(run->stack);
+        run->stack = NULL;
+        return (struct ws_reply*)
+               ws_error_reply_new(run->transaction, ENOMEM,
+                                  "Could not suspend transaction", NULL);
+    }
+    run->stack = stack;
+    run->proc.stack = stack;
+
+    job->yield = true;
+    return NULL;
+}
+
+static void
+complete_async(
+    struct ws_action_job* job,
+    struct ws_reply* reply
+) {
+    struct run* run = (struct run*) job;
+
+    if (!reply && run->stack) {
+        ws_processor_deinit(&run->proc);
+        ws_processor_stack_pool_put(run->stack);
+        run->stack = NULL;
+    }
+
+    run_finish(run, reply);
+}
+
+static void
+resume_runs(
+    struct ev_loop* loop,
+    ev_idle* watcher,
+    int revents
+) {
+    // runs suspended again are put behind the ones we didn't continue yet
+    struct run* run = actman_ctx.suspended;
+    actman_ctx.suspended = NULL;
+    actman_ctx.suspended_tail = &actman_ctx.suspended;
+
+    while (run) {
+        struct run* next = run->next;
+
+        struct ws_reply* reply = run_continue(run);
+        if (run->proc.suspended) {
+            run->next = NULL;
+            *actman_ctx.suspended_tail = run;
+            actman_ctx.suspended_tail = &run->next;
+        } else {
+            run_finish(run, reply);
+        }
+
+        run = next;
+    }
+
+    if (!actman_ctx.suspended) {
+        ev_idle_stop(loop, &actman_ctx.resumer);
+    }
+}
+
 static void
 action_manager_deinit(
     void* dummy
 ) {
+    actman_ctx.shut_down = true;
+
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    if (loop) {
+        ev_timer_stop(loop, &actman_ctx.trimmer);
+        ev_idle_stop(loop, &actman_ctx.resumer);
+    }
+
+    // suspended runs are aborted
+    while (actman_ctx.suspended) {
+        struct run* run = actman_ctx.suspended;
+        actman_ctx.suspended = run->next;
+
+        ws_processor_deinit(&run->proc);
+        ws_processor_stack_pool_put(run->stack);
+        run_finish(run, NULL);
+    }
+    actman_ctx.suspended_tail = &actman_ctx.suspended;
+
+    ws_action_observer_deinit();
+    ws_action_timer_deinit();
+    ws_action_worker_deinit();
+    ws_processor_stack_pool_release();
+
     ws_object_deinit((struct ws_object*) &actman_ctx.transactions);
-    ws_object_deinit((struct ws_object*) &actman_ctx.registrations);
+    ws_dispatch_table_deinit(&actman_ctx.dispatch);
     ws_object_deinit((struct ws_object*) &actman_ctx);
 }
 
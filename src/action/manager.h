@@ -72,6 +72,43 @@ ws_action_manager_process(
 __ws_nonnull__(1)
 ;
 
+/**
+ * Callback receiving the reply to a message
+ *
+ * The reference to the reply, which may be `NULL`, is passed to the callback.
+ */
+typedef void (*ws_action_manager_reply_f)(
+    struct ws_reply* reply, //!< reply to the message
+    void* data //!< data passed along with the message
+);
+
+/**
+ * Submit a message for processing
+ *
+ * Transactions are registered right away, if requested. Transactions which
+ * only operate on the stack are executed on a pool of worker threads, all
+ * others on the main loop, where they are suspended if they take too long.
+ * Invocations run the registered transaction the same way and the
+ * transactions of a batch are processed like this one after another.
+ * Transactions which don't compile are not executed but answered with an error
+ * reply. All other messages are processed right away, as
+ * `ws_action_manager_process()` would do.
+ *
+ * Either way, `done` is invoked exactly once on the main loop, possibly
+ * before this function returns. Once the action manager is shut down, messages
+ * are not processed any more and `done` is passed `NULL` right away.
+ *
+ * @return 1 if the message is processed asynchronously, 0 otherwise
+ */
+int
+ws_action_manager_submit(
+    struct ws_message* message, //!< message to process
+    ws_action_manager_reply_f done, //!< callback to pass the reply to
+    void* data //!< data to pass to the callback
+)
+__ws_nonnull__(1, 2)
+;
+
 /**
  * Register a transaction to be run on an event
  *
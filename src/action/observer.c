@@ -0,0 +1,428 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <ev.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "action/manager.h"
+#include "action/observer.h"
+#include "logger/module.h"
+#include "objects/message/event.h"
+#include "objects/message/reply.h"
+#include "objects/object.h"
+#include "objects/string.h"
+#include "util/string.h"
+#include "values/object_id.h"
+
+/**
+ * Initial capacity of the list of pending changes
+ */
+#define PENDING_INITIAL_CAPACITY (16)
+
+/**
+ * An observer of an attribute
+ */
+struct observer {
+    struct ws_string* name; //!< name of the event emitted
+    uintmax_t target; //!< uuid of the object observed, `0` for a type
+    char* type; //!< name of the type observed, `NULL` for an object
+    char* attr; //!< name of the attribute observed
+    struct observer* next; //!< next observer in the list
+};
+
+/**
+ * A change not delivered yet
+ */
+struct change {
+    struct ws_object* obj; //!< object which changed
+    struct ws_string* name; //!< name of the event to emit
+};
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Check whether an object is of a type or one of its subtypes
+ *
+ * @note does not lock the object, since setters may hold its lock
+ *
+ * @return true if the object is of the type, false otherwise
+ */
+static bool
+is_of_type(
+    struct ws_object const* obj, //!< object to check
+    char const* type //!< name of the type
+);
+
+/**
+ * Queue an event for a change, unless it is already queued
+ *
+ * @warning must be called with the lock held
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+static int
+queue_change(
+    struct ws_object* obj, //!< object which changed
+    struct ws_string* name //!< name of the event to emit
+);
+
+/**
+ * Free an observer
+ */
+static void
+free_observer(
+    struct observer* observer //!< observer to free
+);
+
+/**
+ * Emit the events for all changes queued
+ */
+static void
+deliver_changes(
+    struct ev_loop* loop,
+    ev_async* watcher,
+    int revents
+);
+
+/*
+ *
+ * Internal constant
+ *
+ */
+
+/**
+ * Observers and the changes not delivered yet
+ */
+static struct {
+    struct observer* observers; //!< observers currently active
+    struct change* changes; //!< changes not delivered yet
+    size_t num; //!< number of changes not delivered yet
+    size_t capacity; //!< capacity of the list of changes
+    bool enabled; //!< whether changes are delivered at all
+    pthread_mutex_t lock; //!< lock protecting the observers and changes
+    ev_async deliverer; //!< watcher delivering the changes
+} observer_ctx = {
+    .observers = NULL,
+    .changes = NULL,
+    .num = 0,
+    .capacity = 0,
+    .enabled = false,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static struct ws_logger_context log_ctx = {
+    .prefix = "[Action observer] ",
+};
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_action_observer_init(void) {
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    if (!loop) {
+        return -ENOTSUP;
+    }
+
+    // changes are delivered once per loop iteration, however often the
+    // watcher was signalled
+    ev_async_init(&observer_ctx.deliverer, deliver_changes);
+    ev_async_start(loop, &observer_ctx.deliverer);
+
+    pthread_mutex_lock(&observer_ctx.lock);
+    observer_ctx.enabled = true;
+    pthread_mutex_unlock(&observer_ctx.lock);
+    return 0;
+}
+
+int
+ws_action_observer_add(
+    struct ws_string* name,
+    struct ws_object* target,
+    char const* type,
+    char const* attr
+) {
+    // exactly one of them must be given
+    if (!target == !type) {
+        return -EINVAL;
+    }
+
+    struct observer* observer = calloc(1, sizeof(*observer));
+    if (!observer) {
+        return -ENOMEM;
+    }
+
+    observer->name = ws_string_dupl(name);
+    observer->attr = strdup(attr);
+    if (type) {
+        observer->type = strdup(type);
+    } else {
+        observer->target = ws_object_uuid(target);
+    }
+
+    if (!observer->name || !observer->attr || (type && !observer->type)) {
+        free_observer(observer);
+        return -ENOMEM;
+    }
+
+    pthread_mutex_lock(&observer_ctx.lock);
+    observer->next = observer_ctx.observers;
+    observer_ctx.observers = observer;
+    pthread_mutex_unlock(&observer_ctx.lock);
+    return 0;
+}
+
+int
+ws_action_observer_remove(
+    struct ws_string* name
+) {
+    int res = -ENOENT;
+    pthread_mutex_lock(&observer_ctx.lock);
+
+    struct observer** link = &observer_ctx.observers;
+    while (*link) {
+        struct observer* observer = *link;
+        if (ws_string_cmp(observer->name, name) != 0) {
+            link = &observer->next;
+            continue;
+        }
+
+        *link = observer->next;
+        free_observer(observer);
+        res = 0;
+    }
+
+    pthread_mutex_unlock(&observer_ctx.lock);
+    return res;
+}
+
+void
+ws_action_observer_notify(
+    struct ws_object* obj,
+    char const* attr
+) {
+    pthread_mutex_lock(&observer_ctx.lock);
+    if (!observer_ctx.enabled) {
+        goto out;
+    }
+
+    uintmax_t uuid = 0;
+    struct observer* it;
+    for (it = observer_ctx.observers; it; it = it->next) {
+        if (!ws_streq(it->attr, attr)) {
+            continue;
+        }
+
+        if (it->type) {
+            if (!is_of_type(obj, it->type)) {
+                continue;
+            }
+        } else {
+            // the uuid is only looked up if someone observes the attribute
+            if (!uuid) {
+                uuid = ws_object_uuid(obj);
+            }
+            if (it->target != uuid) {
+                continue;
+            }
+        }
+
+        if (queue_change(obj, it->name) < 0) {
+            ws_log(&log_ctx, LOG_ERR, "Could not queue change of %s", attr);
+        }
+    }
+
+out:
+    pthread_mutex_unlock(&observer_ctx.lock);
+}
+
+void
+ws_action_observer_deinit(void) {
+    pthread_mutex_lock(&observer_ctx.lock);
+    bool enabled = observer_ctx.enabled;
+    observer_ctx.enabled = false;
+
+    while (observer_ctx.observers) {
+        struct observer* observer = observer_ctx.observers;
+        observer_ctx.observers = observer->next;
+        free_observer(observer);
+    }
+
+    struct change* changes = observer_ctx.changes;
+    size_t num = observer_ctx.num;
+    observer_ctx.changes = NULL;
+    observer_ctx.num = 0;
+    observer_ctx.capacity = 0;
+    pthread_mutex_unlock(&observer_ctx.lock);
+
+    // pending changes are dropped
+    while (num--) {
+        ws_object_unref(changes[num].obj);
+        ws_object_unref((struct ws_object*) changes[num].name);
+    }
+    free(changes);
+
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    if (enabled && loop) {
+        ev_async_stop(loop, &observer_ctx.deliverer);
+    }
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static bool
+is_of_type(
+    struct ws_object const* obj,
+    char const* type
+) {
+    ws_object_type_id* it = obj->id;
+    while (it) {
+        if (ws_streq(it->typestr, type)) {
+            return true;
+        }
+
+        // the root type is its own supertype
+        if (it->supertype == it) {
+            break;
+        }
+        it = it->supertype;
+    }
+
+    return false;
+}
+
+static int
+queue_change(
+    struct ws_object* obj,
+    struct ws_string* name
+) {
+    // changes of the same object and event are coalesced
+    size_t i;
+    for (i = 0; i < observer_ctx.num; ++i) {
+        struct change* change = observer_ctx.changes + i;
+        if ((change->obj == obj) && (ws_string_cmp(change->name, name) == 0)) {
+            return 0;
+        }
+    }
+
+    if (observer_ctx.num == observer_ctx.capacity) {
+        size_t capacity = observer_ctx.capacity * 2;
+        if (!capacity) {
+            capacity = PENDING_INITIAL_CAPACITY;
+        }
+
+        struct change* tmp;
+        tmp = realloc(observer_ctx.changes, capacity * sizeof(*tmp));
+        if (!tmp) {
+            return -ENOMEM;
+        }
+        observer_ctx.changes = tmp;
+        observer_ctx.capacity = capacity;
+    }
+
+    struct change* change = observer_ctx.changes + observer_ctx.num;
+    change->obj = getref(obj);
+    if (!change->obj) {
+        return -EAGAIN;
+    }
+    change->name = getref(name);
+
+    // the watcher only needs to be signalled for the first change
+    if (observer_ctx.num++ == 0) {
+        ev_async_send(ev_default_loop(EVFLAG_AUTO), &observer_ctx.deliverer);
+    }
+    return 0;
+}
+
+static void
+free_observer(
+    struct observer* observer
+) {
+    ws_object_unref((struct ws_object*) observer->name);
+    free(observer->type);
+    free(observer->attr);
+    free(observer);
+}
+
+static void
+deliver_changes(
+    struct ev_loop* loop,
+    ev_async* watcher,
+    int revents
+) {
+    // changes made by the transactions run are delivered in the next iteration
+    pthread_mutex_lock(&observer_ctx.lock);
+    struct change* changes = observer_ctx.changes;
+    size_t num = observer_ctx.num;
+    observer_ctx.changes = NULL;
+    observer_ctx.num = 0;
+    observer_ctx.capacity = 0;
+    pthread_mutex_unlock(&observer_ctx.lock);
+
+    size_t i;
+    for (i = 0; i < num; ++i) {
+        struct ws_value_object_id context;
+        ws_value_object_id_init(&context);
+        ws_value_object_id_set(&context, changes[i].obj);
+
+        struct ws_event* event = ws_event_new(changes[i].name, &context.val);
+        ws_value_deinit(&context.val);
+        ws_object_unref(changes[i].obj);
+        ws_object_unref((struct ws_object*) changes[i].name);
+
+        if (!event) {
+            ws_log(&log_ctx, LOG_ERR, "Could not emit change event");
+            continue;
+        }
+
+        struct ws_reply* reply;
+        reply = ws_action_manager_process((struct ws_message*) event);
+        if (reply) {
+            ws_object_unref((struct ws_object*) reply);
+        }
+        ws_object_unref((struct ws_object*) event);
+    }
+
+    free(changes);
+}
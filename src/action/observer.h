@@ -0,0 +1,129 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup action "Action manager"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup action_observer "Action manager attribute observers"
+ *
+ * @{
+ *
+ * Push notifications for attribute changes
+ *
+ * An observer emits an event when an attribute of either a specific object or
+ * any object of a type changes. The event is processed by the action manager,
+ * with the object which changed as its context, so scripts don't have to poll
+ * for changes.
+ *
+ * Setters mark the attributes they change via `ws_action_observer_notify()`.
+ * Changes are coalesced and delivered at most once per object, attribute and
+ * main loop iteration. Marking an attribute is safe from any thread and cheap
+ * if nobody observes it.
+ */
+
+#ifndef __WS_ACTION_OBSERVER_H__
+#define __WS_ACTION_OBSERVER_H__
+
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_object;
+struct ws_string;
+
+/**
+ * Initialize the delivery of attribute change events
+ *
+ * @warning must be called from the main loop
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+int
+ws_action_observer_init(void);
+
+/**
+ * Add an observer
+ *
+ * Either the object or the type name must be given. If a type name is given,
+ * the attribute is observed on all objects of the type, including subtypes.
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+int
+ws_action_observer_add(
+    struct ws_string* name, //!< name of the event emitted
+    struct ws_object* target, //!< object to observe or `NULL`
+    char const* type, //!< name of the type to observe or `NULL`
+    char const* attr //!< name of the attribute to observe
+)
+__ws_nonnull__(1, 4)
+;
+
+/**
+ * Remove all observers emitting an event
+ *
+ * @return 0 on success, -ENOENT if there is no observer with the name
+ */
+int
+ws_action_observer_remove(
+    struct ws_string* name //!< name of the event emitted
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Mark an attribute of an object as changed
+ *
+ * @note called by setters after the attribute was changed
+ */
+void
+ws_action_observer_notify(
+    struct ws_object* obj, //!< object which changed
+    char const* attr //!< name of the attribute which changed
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Remove all observers and drop pending changes
+ */
+void
+ws_action_observer_deinit(void);
+
+#endif // __WS_ACTION_OBSERVER_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -26,13 +26,17 @@
  */
 
 #include <errno.h>
+#include <stdint.h>
+#include <time.h>
 
 #include "action/processor.h"
 #include "action/processor_stack.h"
+#include "action/profiler.h"
+#include "command/bytecode.h"
 #include "command/command.h"
 #include "command/statement.h"
 #include "logger/module.h"
-#include "objects/message/transaction.h"
+#include "util/condition.h"
 #include "values/union.h"
 
 /*
@@ -45,6 +49,11 @@ static struct ws_logger_context log_ctx = {
     .prefix = "[Action processor] ",
 };
 
+/**
+ * Number of instructions after which the time budget is checked
+ */
+#define TIME_CHECK_INTERVAL (256)
+
 /*
  *
  * Forward declarations
@@ -52,32 +61,28 @@ static struct ws_logger_context log_ctx = {
  */
 
 /**
- * Prepare arguments for command execution
+ * Get the current time
  *
- * This function prepares the stack for command execution by copying everything
- * to the right position.
+ * @return the time, in seconds
  */
-static int
-ws_processor_prepare_args(
-    struct ws_processor_stack* stack,
-    struct ws_command_args const* const args
-)
-__ws_nonnull__(1, 2)
-;
+static double
+now(void);
 
 /**
- * Execute a regaular command function
+ * Get the value an operand refers to
  *
- * This function executes a regular command function.
- * This includes preparing and cleaning up the stack.
+ * Stack positions are resolved relative to `top`, which is the top of the
+ * stack before any operand of the current instruction was pushed.
+ *
+ * @return the value or `NULL`, if the position is not on the stack
  */
-static int
-exec_regular(
-    struct ws_processor_stack* stack,
-    ws_regular_command_func func,
-    struct ws_command_args const* const args
+static inline struct ws_value*
+operand_value(
+    struct ws_processor_stack const* stack, //!< stack to resolve positions on
+    size_t top, //!< top to resolve relative positions against
+    struct ws_bytecode_operand const* op //!< operand to resolve
 )
-__ws_nonnull__(1, 2, 3)
+__ws_nonnull__(1, 3)
 ;
 
 /*
@@ -90,12 +95,15 @@ int
 ws_processor_init(
     struct ws_processor* self,
     struct ws_processor_stack* stack,
-    struct ws_transaction_command_list* commands
+    struct ws_bytecode const* code
 ) {
     // initialize all the fields
     self->stack         = stack;
-    self->commands      = commands;
-    self->pc            = commands->statements;
+    self->code          = code;
+    self->budget        = 0;
+    self->time_budget   = 0;
+    self->suspended     = false;
+    self->pc            = 0;
     self->stack_frame   = ws_processor_stack_start_frame(stack);
 
     // nothing can go wrong here
@@ -114,43 +122,180 @@ ssize_t
 ws_processor_exec(
     struct ws_processor* self
 ) {
+    // dispatch table, indexed by operation
+    static void* const dispatch[] = {
+        [WS_BYTECODE_OP_REGULAR]    = __extension__ &&op_regular,
+        [WS_BYTECODE_OP_CONST]      = __extension__ &&op_const,
+        [WS_BYTECODE_OP_SPECIAL]    = __extension__ &&op_special,
+        [WS_BYTECODE_OP_JUMP]       = __extension__ &&op_jump,
+        [WS_BYTECODE_OP_EXIT]       = __extension__ &&op_exit,
+        [WS_BYTECODE_OP_FAIL]       = __extension__ &&op_fail,
+        [WS_BYTECODE_OP_END]        = __extension__ &&op_end,
+    };
+
+    // we count down the instructions left until we have to check the budget
+#define DISPATCH() __extension__ ({ \
+        if (!--left) { \
+            goto preempt; \
+        } \
+        goto *dispatch[ip->op]; \
+    })
+
+    // dispatch without charging the instruction
+#define RESUME() __extension__ ({ goto *dispatch[ip->op]; })
+
     ws_log(&log_ctx, LOG_DEBUG, "Starting processor %p", self);
-    // keep a sentinel around for faster comparisons
-    struct ws_statement const* aend;
-    aend = self->commands->statements + self->commands->num;
-
-    while (self->pc < aend) {
-        // get the current pc and increment it afterwards
-        struct ws_statement const* cur = self->pc++;
-
-        // execute command
-        int res;
-        switch(cur->command->command_type) {
-        case regular:
-            ws_log(&log_ctx, LOG_DEBUG, "Regular exec");
-            res = exec_regular(self->stack, cur->command->func.regular,
-                               &cur->args);
-            break;
-
-        case special:
-            ws_log(&log_ctx, LOG_DEBUG, "Special exec");
-            res = cur->command->func.special(self, &cur->args);
-            break;
-
-        default:
-            return -ENOTSUP;
+
+    struct ws_bytecode const* code = self->code;
+    struct ws_processor_stack* stack = self->stack;
+    struct ws_bytecode_insn const* ip = code->code + code->stmt_map[self->pc];
+    int res;
+
+    // determine the budget for this run
+    size_t insns = self->budget ? self->budget : SIZE_MAX;
+    double deadline = 0;
+    size_t chunk = insns;
+    if (self->time_budget > 0) {
+        deadline = now() + self->time_budget;
+        if (chunk > TIME_CHECK_INTERVAL) {
+            chunk = TIME_CHECK_INTERVAL;
+        }
+    }
+    size_t left = chunk;
+    self->suspended = false;
+
+    // the profiler is only consulted once per run
+    bool profile = ws_profiler_enabled();
+    uint64_t start = 0;
+
+    RESUME();
+
+op_regular:
+    if (ip->nops) {
+        // push the operands
+        size_t top = stack->top;
+        res = ws_processor_stack_push(stack, ip->nops);
+        if (res < 0) {
+            goto fail;
         }
 
+        union ws_value_union* dest = stack->data + top;
+        size_t i = ip->nops;
+        while (i--) {
+            struct ws_value* src = operand_value(stack, top, ip->ops + i);
+            if (!src) {
+                res = -EINVAL;
+                goto fail;
+            }
+
+            res = ws_value_union_init_from_val(dest + i, src);
+            if (res < 0) {
+                goto fail;
+            }
+        }
+    }
+
+    // we somehow ended up with a bad stack
+    if (ip->argc > stack->top) {
+        res = -EINVAL;
+        goto fail;
+    }
+
+    if (unlikely(profile)) {
+        start = ws_profiler_now();
+    }
+    res = ip->arg.regular(stack->data + stack->top - ip->argc);
+    if (unlikely(profile)) {
+        ws_profiler_record_command(ip->command, start);
+    }
+    if (res < 0) {
+        goto fail;
+    }
+
+    // pop the values, the result stays on the stack
+    res = ws_processor_stack_pop(stack, ip->argc - 1);
+    if (res != 0) {
+        goto fail;
+    }
+
+    ++ip;
+    DISPATCH();
+
+op_const:
+    res = ws_processor_stack_push(stack, 1);
+    if (res < 0) {
+        goto fail;
+    }
+
+    res = ws_value_union_init_from_val(stack->data + stack->top - 1,
+                                       ip->arg.value);
+    if (res < 0) {
+        goto fail;
+    }
+
+    ++ip;
+    DISPATCH();
+
+op_special:
+    {
+        struct ws_statement const* stmt = ip->arg.special;
+
+        // special commands may alter the pc
+        self->pc = ip->stmt + 1;
+        if (unlikely(profile)) {
+            start = ws_profiler_now();
+        }
+        res = stmt->command->func.special(self, &stmt->args);
+        if (unlikely(profile)) {
+            ws_profiler_record_command(stmt->command, start);
+        }
         if (res != 0) {
-            ws_log(&log_ctx, LOG_DEBUG, "... failed");
-            return res;
+            goto fail;
         }
+
+        ip = code->code + code->stmt_map[self->pc];
     }
+    DISPATCH();
+
+op_jump:
+    ip = code->code + ip->arg.target;
+    DISPATCH();
 
-    if (self->pc <= aend) {
+op_exit:
+    self->pc = ip->arg.target;
+    return ip->arg.target;
+
+op_fail:
+    res = ip->arg.error;
+    goto fail;
+
+op_end:
+    self->pc = code->num_statements;
+    return 0;
+
+preempt:
+    insns -= chunk;
+    if (!insns || ((deadline > 0) && (now() > deadline))) {
+        // we continue with this instruction when we're resumed
+        ws_log(&log_ctx, LOG_DEBUG, "Suspending processor %p", self);
+        self->pc = ip->stmt;
+        self->suspended = true;
         return 0;
     }
-    return self->pc - self->commands->statements;
+
+    chunk = insns;
+    if ((deadline > 0) && (chunk > TIME_CHECK_INTERVAL)) {
+        chunk = TIME_CHECK_INTERVAL;
+    }
+    left = chunk;
+    RESUME();
+
+fail:
+    ws_log(&log_ctx, LOG_DEBUG, "Statement %zu failed", ip->stmt);
+    return res;
+
+#undef RESUME
+#undef DISPATCH
 }
 
 size_t
@@ -158,14 +303,15 @@ ws_processor_jump(
     struct ws_processor* self,
     size_t value
 ) {
-    //calculate the current position
-    size_t target_pos = (self->pc - self->commands->statements) + value;
+    //calculate the target position
+    size_t target_pos = self->pc + value;
 
     // perform bound check
-    if (target_pos > self->commands->num) {
+    if (target_pos > self->code->num_statements) {
         return target_pos;
     }
 
+    self->pc = target_pos;
     return 0;
 }
 
@@ -176,87 +322,34 @@ ws_processor_jump(
  *
  */
 
-static int
-ws_processor_prepare_args(
-    struct ws_processor_stack* stack,
-    struct ws_command_args const* const args
+static inline struct ws_value*
+operand_value(
+    struct ws_processor_stack const* stack,
+    size_t top,
+    struct ws_bytecode_operand const* op
 ) {
-    size_t argc = args->num;
-
-    {
-        int res = ws_processor_stack_push(stack, argc);
-        if (res < 0) {
-            return res;
-        }
+    if (op->val) {
+        return op->val;
     }
 
-    union ws_value_union* top = ws_processor_stack_top(stack) - argc;
-
-    // iterate over all the arguments and assemble the stack
-    while (argc--) {
-        struct ws_argument* cur_arg = args->vals + argc;
-
-        // determine the source of the argument
-        struct ws_value* src = NULL;
-        switch (cur_arg->type) {
-        case direct:
-            src = cur_arg->arg.val;
-            break;
-
-        case indirect:
-            src = ws_processor_stack_value_at(stack, cur_arg->arg.pos,
-                                              &top->value);
-            break;
-        }
-
-        if (!src) {
-            return -EINVAL;
-        }
-        int res = ws_value_union_init_from_val(top + argc, src);
-        if (res < 0) {
-            return res;
-        }
-    }
-
-    return 0;
-}
-
-static int
-exec_regular(
-    struct ws_processor_stack* stack,
-    ws_regular_command_func func,
-    struct ws_command_args const* const args
-) {
-    union ws_value_union* top = NULL;
-    if (args->num <= 0) {
-        return -EINVAL;
-    }
-
-    int res;
-
-    // prepare the stack for command execution
-    if (args->vals) {
-        // the parameters are given explicitely
-        res = ws_processor_prepare_args(stack, args);
-        if (res < 0) {
-            return res;
+    // positive positions are counted from the bottom
+    if (op->pos >= 0) {
+        if ((size_t) op->pos >= top) {
+            return NULL;
         }
+        return &stack->data[op->pos].value;
     }
-    // extract the base pointer to pass to the function
-    top = (union ws_value_union*)
-          ws_processor_stack_value_at(stack, -(args->num), NULL);
 
-    // we somehow ended up with a bad stack
-    if (!top) {
-        return -EINVAL;
-    }
-
-    res = func(top);
-    if (res < 0) {
-        return res;
+    if ((size_t) (-op->pos) > top) {
+        return NULL;
     }
+    return &stack->data[top + op->pos].value;
+}
 
-    // pop the values
-    return ws_processor_stack_pop(stack, args->num - 1);
+static double
+now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
 }
 
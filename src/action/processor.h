@@ -41,14 +41,14 @@
 #define __WS_ACTION_PROCESSOR_H__
 
 #include <malloc.h>
+#include <stdbool.h>
 #include <stddef.h>
 
 #include "util/attributes.h"
 
 // forward declarations
+struct ws_bytecode;
 struct ws_processor_stack;
-struct ws_statement;
-struct ws_transaction_command_list;
 
 /**
  * Command processor context
@@ -57,8 +57,11 @@ struct ws_transaction_command_list;
  */
 struct ws_processor {
     struct ws_processor_stack* stack; //!< @public the stack buffer
-    struct ws_transaction_command_list* commands; //!< @public cmds to process
-    struct ws_statement* pc; //!< @private current statement
+    struct ws_bytecode const* code; //!< @public compiled cmds to process
+    size_t budget; //!< @public instructions per run, 0 for no limit
+    double time_budget; //!< @public seconds per run, 0 for no limit
+    bool suspended; //!< @public whether the last run exceeded the budget
+    size_t pc; //!< @private position of the next statement
     size_t stack_frame; //!< @private stack frame of the processor
 };
 
@@ -69,7 +72,7 @@ int
 ws_processor_init(
     struct ws_processor* self, //!< command processor to initialize
     struct ws_processor_stack* stack, //!< stack to use
-    struct ws_transaction_command_list* commands //!< commands to run
+    struct ws_bytecode const* code //!< compiled commands to run
 )
 __ws_nonnull__(1, 2, 3)
 ;
@@ -87,6 +90,12 @@ __ws_nonnull__(1)
 /**
  * Run a command processor with a context set up
  *
+ * If the processor exceeds its instruction or time budget, it is suspended:
+ * `suspended` is set and 0 is returned. Running the processor again resumes
+ * the execution where it stopped.
+ *
+ * The time budget is only checked every few instructions.
+ *
  * @return 0 on success, a negative error value on failure and a positive value
  *         if some command caused a jump outside the command list given by the
  *         transaction
@@ -104,6 +113,7 @@ __ws_nonnull__(1)
  * This method performs a forward-jump, performing bounding checks.
  * If the forward-jump results in a position within the current scope of
  * statements held by the context, it performs the jump by incrementing the pc.
+ * The jump is relative to the statement following the one currently executed.
  * If, however, the jump would result in a positoion _outside_ the scope, the
  * jump is not performed but the function returns the position the jump would
  * result in.
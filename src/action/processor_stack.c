@@ -48,8 +48,9 @@ ws_processor_stack_init(
         return -ENOMEM;
     }
 
-    self->size = INITIAL_STACK_SIZE;
-    self->top  = 0;
+    self->size  = INITIAL_STACK_SIZE;
+    self->top   = 0;
+    self->frame = 0;
 
     return 0;
 }
@@ -67,6 +68,32 @@ ws_processor_stack_deinit(
     free(self->data);
 }
 
+int
+ws_processor_stack_reserve(
+    struct ws_processor_stack* self,
+    size_t slots
+) {
+    size_t new_size = self->top + slots + 1;
+    if (new_size <= self->size) {
+        return 0;
+    }
+
+    // try to reallocate
+    union ws_value_union* new_data;
+    new_data = realloc(self->data, sizeof(*(self->data)) * new_size);
+    if (!new_data) {
+        return -ENOMEM;
+    }
+
+    // initialize all the things we have to initialize
+    self->data = new_data;
+    self->size = new_size;
+    memset(new_data + self->top, 0,
+           sizeof(*(self->data)) * (new_size - self->top));
+
+    return 0;
+}
+
 int
 ws_processor_stack_push(
     struct ws_processor_stack* self,
@@ -75,31 +102,22 @@ ws_processor_stack_push(
     // calculate the new `top` and, assuming a resize, calculate the new size
     size_t new_size = self->size;
     size_t new_top  = self->top + slots;
-    while ((new_top + 1) > new_size) {
-        new_size *= 2;
-    }
-
-    // check whether we have to resize
-    if (new_size != self->size) {
-        // try to reallocate
-        union ws_value_union* new_data;
-        new_data = realloc(self->data, sizeof(*(self->data)) * new_size);
-        if (!new_data) {
-            return -ENOMEM;
+    if ((new_top + 1) > new_size) {
+        while ((new_top + 1) > new_size) {
+            new_size *= 2;
         }
 
-        // initialize all the things we have to initialize
-        self->data = new_data;
-        self->size = new_size;
-        memset(new_data + self->top, 0,
-               sizeof(*(self->data)) * (new_size - self->top));
+        int res = ws_processor_stack_reserve(self, new_size - self->top - 1);
+        if (res < 0) {
+            return res;
+        }
     }
 
     // set the new top
+    size_t old_top = self->top;
     self->top = new_top;
 
     // initialize all the values pushed
-    size_t old_top = self->top;
     while (new_top > old_top) {
         --new_top;
         ws_value_nil_init(&self->data[new_top].nil);
@@ -118,12 +136,8 @@ ws_processor_stack_pop(
         return -EINVAL;
     }
 
-    // calculate the new `top` and, assuming a resize, calculate the new size
-    size_t new_size = self->size;
+    // the capacity is kept, stacks are only shrunk explicitly
     size_t new_top  = self->top - slots;
-    while (((new_top + 1) > new_size) && ((new_top + 1) > INITIAL_STACK_SIZE)) {
-        new_size /= 2;
-    }
 
     // deinitialize all the values on the way down
     size_t cur = self->top;
@@ -133,25 +147,44 @@ ws_processor_stack_pop(
         self->data[cur].value.type = WS_VALUE_TYPE_NONE;
     }
 
-    memset(self->data + new_top, 0, self->top - new_top);
-
     // set the top
     self->top = new_top;
 
-    // check whether we may resize
-    if (new_size != self->size) {
-        // try to reallocate
-        union ws_value_union* new_data;
-        new_data = realloc(self->data, sizeof(*(self->data)) * new_size);
-        if (!new_data) {
-            // noncritical error
-            return 0;
-        }
+    return 0;
+}
 
-        self->data = new_data;
-        self->size = new_size;
+void
+ws_processor_stack_clear(
+    struct ws_processor_stack* self
+) {
+    self->frame = 0;
+    (void) ws_processor_stack_pop(self, self->top);
+}
+
+int
+ws_processor_stack_shrink(
+    struct ws_processor_stack* self,
+    size_t size
+) {
+    // we never drop values still on the stack
+    if (size < self->top + 1) {
+        size = self->top + 1;
+    }
+    if (size < INITIAL_STACK_SIZE) {
+        size = INITIAL_STACK_SIZE;
+    }
+    if (size >= self->size) {
+        return 0;
+    }
+
+    union ws_value_union* new_data;
+    new_data = realloc(self->data, sizeof(*(self->data)) * size);
+    if (!new_data) {
+        return -ENOMEM;
     }
 
+    self->data = new_data;
+    self->size = size;
     return 0;
 }
 
@@ -95,6 +95,22 @@ ws_processor_stack_deinit(
 __ws_nonnull__(1)
 ;
 
+/**
+ * Reserve space on the stack
+ *
+ * This function makes sure that `slots` values may be pushed on the stack
+ * without further allocations.
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+int
+ws_processor_stack_reserve(
+    struct ws_processor_stack* self, //!< the stack
+    size_t slots //!< number of slots to reserve
+)
+__ws_nonnull__(1)
+;
+
 /**
  * Push values on the stack
  *
@@ -127,6 +143,36 @@ ws_processor_stack_pop(
 __ws_nonnull__(1)
 ;
 
+/**
+ * Clear the stack
+ *
+ * This function pops all values from the stack and resets the frame.
+ * The capacity of the stack is kept.
+ */
+void
+ws_processor_stack_clear(
+    struct ws_processor_stack* self //!< the stack
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Shrink the capacity of the stack
+ *
+ * Stacks never shrink on their own.
+ * This function reduces the capacity of the stack to `size` slots, but never
+ * below the values currently on the stack.
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+int
+ws_processor_stack_shrink(
+    struct ws_processor_stack* self, //!< the stack
+    size_t size //!< number of slots to keep
+)
+__ws_nonnull__(1)
+;
+
 /**
  * Get the top of the stack
  *
@@ -0,0 +1,340 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "action/profiler.h"
+#include "command/command.h"
+#include "objects/string.h"
+#include "util/condition.h"
+
+/**
+ * Maximum number of commands we keep counters for
+ */
+#define PROFILER_MAX_COMMANDS (256)
+
+/**
+ * Maximum number of transactions we keep histograms for
+ *
+ * @note Must be a power of two
+ */
+#define PROFILER_MAX_TRANSACTIONS (64)
+
+/**
+ * Number of buckets of a histogram
+ *
+ * Bucket `n` counts runs which took less than 2^n microseconds, the last
+ * bucket counts all the runs taking longer.
+ */
+#define PROFILER_BUCKETS (16)
+
+/**
+ * Counters for one command
+ */
+struct command_counters {
+    uint64_t calls; //!< number of invocations
+    uint64_t total; //!< cumulative time spent, in nanoseconds
+    uint64_t max; //!< longest invocation, in nanoseconds
+};
+
+/**
+ * Histogram for one transaction
+ */
+struct transaction_histogram {
+    struct ws_string* name; //!< name, `NULL` for unused slots
+    size_t hash; //!< hash of the name
+    uint64_t runs; //!< number of runs
+    uint64_t total; //!< cumulative time spent, in nanoseconds
+    uint64_t buckets[PROFILER_BUCKETS]; //!< runs by duration
+};
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Get the histogram for a transaction, creating it if necessary
+ *
+ * @return the histogram or `NULL`, if the table is full
+ */
+static struct transaction_histogram*
+get_histogram(
+    struct ws_string* name //!< name of the transaction
+);
+
+/**
+ * Zero a counter
+ */
+static void
+clear(
+    uint64_t* counter //!< counter to clear
+);
+
+/*
+ *
+ * Internal constant
+ *
+ */
+
+/**
+ * State of the profiler
+ *
+ * Histogram slots are never freed while running, so lookups need no lock: a
+ * slot's name is published atomically after the slot was set up.
+ */
+static struct {
+    bool enabled; //!< whether we record anything
+    struct command_counters commands[PROFILER_MAX_COMMANDS]; //!< commands
+    struct transaction_histogram
+        transactions[PROFILER_MAX_TRANSACTIONS]; //!< transactions
+    pthread_mutex_t lock; //!< lock for inserting new transactions
+} profiler = {
+    .enabled = false,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+void
+ws_profiler_enable(
+    bool enable
+) {
+    __atomic_store_n(&profiler.enabled, enable, __ATOMIC_RELAXED);
+}
+
+bool
+ws_profiler_enabled(void) {
+    return __atomic_load_n(&profiler.enabled, __ATOMIC_RELAXED);
+}
+
+void
+ws_profiler_reset(void) {
+    size_t i;
+    for (i = 0; i < PROFILER_MAX_COMMANDS; ++i) {
+        clear(&profiler.commands[i].calls);
+        clear(&profiler.commands[i].total);
+        clear(&profiler.commands[i].max);
+    }
+
+    // the names are kept, so the slots stay valid for concurrent lookups
+    for (i = 0; i < PROFILER_MAX_TRANSACTIONS; ++i) {
+        struct transaction_histogram* h = profiler.transactions + i;
+        clear(&h->runs);
+        clear(&h->total);
+
+        size_t b;
+        for (b = 0; b < PROFILER_BUCKETS; ++b) {
+            clear(h->buckets + b);
+        }
+    }
+}
+
+uint64_t
+ws_profiler_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void
+ws_profiler_record_command(
+    struct ws_command const* command,
+    uint64_t start
+) {
+    uint64_t nsecs = ws_profiler_now() - start;
+
+    size_t id = ws_command_id(command);
+    if (unlikely(id >= PROFILER_MAX_COMMANDS)) {
+        return;
+    }
+    struct command_counters* c = profiler.commands + id;
+
+    __atomic_add_fetch(&c->calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&c->total, nsecs, __ATOMIC_RELAXED);
+
+    uint64_t max = __atomic_load_n(&c->max, __ATOMIC_RELAXED);
+    while ((nsecs > max) &&
+            !__atomic_compare_exchange_n(&c->max, &max, nsecs, true,
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+void
+ws_profiler_record_transaction(
+    struct ws_string* name,
+    uint64_t nsecs
+) {
+    struct transaction_histogram* h = get_histogram(name);
+    if (unlikely(!h)) {
+        return;
+    }
+
+    size_t bucket = 0;
+    uint64_t usecs = nsecs / 1000;
+    while (usecs && (bucket < PROFILER_BUCKETS - 1)) {
+        usecs >>= 1;
+        ++bucket;
+    }
+
+    __atomic_add_fetch(&h->runs, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&h->total, nsecs, __ATOMIC_RELAXED);
+    __atomic_add_fetch(h->buckets + bucket, 1, __ATOMIC_RELAXED);
+}
+
+int
+ws_profiler_report(
+    FILE* out
+) {
+    size_t id;
+    for (id = 0; id < PROFILER_MAX_COMMANDS; ++id) {
+        struct command_counters* c = profiler.commands + id;
+        uint64_t calls = __atomic_load_n(&c->calls, __ATOMIC_RELAXED);
+        struct ws_command const* command = ws_command_get_by_id(id);
+        if (!calls || !command) {
+            continue;
+        }
+
+        fprintf(out, "command %s: calls=%llu total_ns=%llu max_ns=%llu\n",
+                command->name, (unsigned long long) calls,
+                (unsigned long long) __atomic_load_n(&c->total,
+                                                     __ATOMIC_RELAXED),
+                (unsigned long long) __atomic_load_n(&c->max,
+                                                     __ATOMIC_RELAXED));
+    }
+
+    size_t i;
+    for (i = 0; i < PROFILER_MAX_TRANSACTIONS; ++i) {
+        struct transaction_histogram* h = profiler.transactions + i;
+        struct ws_string* name = __atomic_load_n(&h->name, __ATOMIC_ACQUIRE);
+        uint64_t runs = __atomic_load_n(&h->runs, __ATOMIC_RELAXED);
+        if (!name || !runs) {
+            continue;
+        }
+
+        char* raw = ws_string_raw(name);
+        if (!raw) {
+            return -ENOMEM;
+        }
+
+        fprintf(out, "transaction %s: runs=%llu total_ns=%llu hist_us=",
+                raw, (unsigned long long) runs,
+                (unsigned long long) __atomic_load_n(&h->total,
+                                                     __ATOMIC_RELAXED));
+        free(raw);
+
+        // print the bucket counts, each bucket by its upper bound
+        size_t b;
+        for (b = 0; b < PROFILER_BUCKETS; ++b) {
+            uint64_t n = __atomic_load_n(h->buckets + b, __ATOMIC_RELAXED);
+            if (!n) {
+                continue;
+            }
+
+            if (b < PROFILER_BUCKETS - 1) {
+                fprintf(out, " <%llu:%llu", 1ULL << b, (unsigned long long) n);
+            } else {
+                fprintf(out, " >=%llu:%llu", 1ULL << (b - 1),
+                        (unsigned long long) n);
+            }
+        }
+        fputc('\n', out);
+    }
+
+    return 0;
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static struct transaction_histogram*
+get_histogram(
+    struct ws_string* name
+) {
+    size_t hash = ws_object_hash(&name->obj);
+    size_t mask = PROFILER_MAX_TRANSACTIONS - 1;
+    size_t start = hash & mask;
+
+    // first try without the lock
+    size_t i = start;
+    do {
+        struct transaction_histogram* h = profiler.transactions + i;
+        struct ws_string* cur = __atomic_load_n(&h->name, __ATOMIC_ACQUIRE);
+        if (!cur) {
+            break;
+        }
+        if ((h->hash == hash) && (ws_string_cmp(cur, name) == 0)) {
+            return h;
+        }
+        i = (i + 1) & mask;
+    } while (i != start);
+
+    // insert the transaction, someone else may have done so meanwhile
+    struct transaction_histogram* retval = NULL;
+    pthread_mutex_lock(&profiler.lock);
+
+    i = start;
+    do {
+        struct transaction_histogram* h = profiler.transactions + i;
+        if (!h->name) {
+            struct ws_string* copy = ws_string_dupl(name);
+            if (copy) {
+                h->hash = hash;
+                __atomic_store_n(&h->name, copy, __ATOMIC_RELEASE);
+                retval = h;
+            }
+            break;
+        }
+        if ((h->hash == hash) && (ws_string_cmp(h->name, name) == 0)) {
+            retval = h;
+            break;
+        }
+        i = (i + 1) & mask;
+    } while (i != start);
+
+    pthread_mutex_unlock(&profiler.lock);
+    return retval;
+}
+
+static void
+clear(
+    uint64_t* counter
+) {
+    __atomic_store_n(counter, 0, __ATOMIC_RELAXED);
+}
+
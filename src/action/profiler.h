@@ -0,0 +1,137 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup action "Action manager"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup action_profiler "Action manager profiler"
+ *
+ * @{
+ *
+ * Execution profiler for commands and transactions
+ *
+ * When enabled, the processor records the number of invocations and the time
+ * spent in each command, while the action manager records a histogram of the
+ * run times of each transaction, by name.
+ *
+ * All counters live in fixed tables and are updated atomically, so recording
+ * never allocates and never blocks.
+ * When the profiler is disabled, the processor only checks a flag once per
+ * run.
+ */
+
+#ifndef __WS_ACTION_PROFILER_H__
+#define __WS_ACTION_PROFILER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_command;
+struct ws_string;
+
+/**
+ * Enable or disable the profiler
+ */
+void
+ws_profiler_enable(
+    bool enable //!< whether to record anything
+);
+
+/**
+ * Check whether the profiler is enabled
+ *
+ * @return true if the profiler records, false otherwise
+ */
+bool
+ws_profiler_enabled(void);
+
+/**
+ * Reset all counters
+ */
+void
+ws_profiler_reset(void);
+
+/**
+ * Get a timestamp for profiling
+ *
+ * @return a monotonic timestamp, in nanoseconds
+ */
+uint64_t
+ws_profiler_now(void);
+
+/**
+ * Record an invocation of a command
+ */
+void
+ws_profiler_record_command(
+    struct ws_command const* command, //!< command invoked
+    uint64_t start //!< timestamp taken before the invocation
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Record a run of a transaction
+ */
+void
+ws_profiler_record_transaction(
+    struct ws_string* name, //!< name of the transaction
+    uint64_t nsecs //!< time the run took, in nanoseconds
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Write a report of all the counters
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+int
+ws_profiler_report(
+    FILE* out //!< stream to write the report to
+)
+__ws_nonnull__(1)
+;
+
+#endif // __WS_ACTION_PROFILER_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -0,0 +1,274 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <malloc.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "action/stack_pool.h"
+
+/**
+ * Number of stacks kept per thread
+ *
+ * Only a few transactions are nested or suspended at a time, stacks requested
+ * beyond this number are allocated and freed on demand.
+ */
+#define STACK_POOL_SIZE (4)
+
+/**
+ * Pool of stacks of one thread
+ */
+struct stack_pool {
+    struct ws_processor_stack stacks[STACK_POOL_SIZE]; //!< stacks
+    bool taken[STACK_POOL_SIZE]; //!< whether a stack is currently taken
+    size_t peak; //!< capacity required since the last trim
+};
+
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Get the pool of the current thread, create it if necessary
+ *
+ * @return the pool or `NULL`, if it could not be created
+ */
+static struct stack_pool*
+get_pool(void);
+
+/**
+ * Create the key for the pools
+ */
+static void
+create_key(void);
+
+/**
+ * Destroy a pool when its thread exits
+ */
+static void
+destroy_pool(
+    void* pool
+);
+
+
+/*
+ *
+ * Internal constant
+ *
+ */
+
+/**
+ * Key for the pool of the current thread
+ */
+static pthread_key_t pool_key;
+
+/**
+ * Guard for the creation of the key
+ */
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+struct ws_processor_stack*
+ws_processor_stack_pool_get(void) {
+    struct ws_processor_stack* stack;
+    struct stack_pool* pool = get_pool();
+
+    size_t i;
+    for (i = 0; pool && (i < STACK_POOL_SIZE); ++i) {
+        if (pool->taken[i]) {
+            continue;
+        }
+
+        stack = pool->stacks + i;
+        if (!stack->data && (ws_processor_stack_init(stack) < 0)) {
+            return NULL;
+        }
+
+        pool->taken[i] = true;
+        return stack;
+    }
+
+    // the pool is exhausted
+    stack = calloc(1, sizeof(*stack));
+    if (!stack) {
+        return NULL;
+    }
+
+    if (ws_processor_stack_init(stack) < 0) {
+        free(stack);
+        return NULL;
+    }
+
+    return stack;
+}
+
+void
+ws_processor_stack_pool_put(
+    struct ws_processor_stack* stack
+) {
+    struct stack_pool* pool = pthread_getspecific(pool_key);
+
+    if (!pool || (stack < pool->stacks) ||
+            (stack >= pool->stacks + STACK_POOL_SIZE)) {
+        ws_processor_stack_deinit(stack);
+        free(stack);
+        return;
+    }
+
+    ws_processor_stack_clear(stack);
+    if (pool->peak < stack->size) {
+        pool->peak = stack->size;
+    }
+    pool->taken[stack - pool->stacks] = false;
+}
+
+struct ws_processor_stack*
+ws_processor_stack_pool_detach(
+    struct ws_processor_stack* stack
+) {
+    struct stack_pool* pool = pthread_getspecific(pool_key);
+
+    if (!pool || (stack < pool->stacks) ||
+            (stack >= pool->stacks + STACK_POOL_SIZE)) {
+        // the stack was allocated on demand
+        return stack;
+    }
+
+    struct ws_processor_stack* detached = malloc(sizeof(*detached));
+    if (!detached) {
+        return NULL;
+    }
+
+    // the slot will get a fresh stack once it is taken again
+    *detached = *stack;
+    memset(stack, 0, sizeof(*stack));
+    pool->taken[stack - pool->stacks] = false;
+
+    return detached;
+}
+
+void
+ws_processor_stack_pool_release(void) {
+    if (pthread_once(&pool_once, create_key) != 0) {
+        return;
+    }
+
+    struct stack_pool* pool = pthread_getspecific(pool_key);
+    if (pool) {
+        (void) pthread_setspecific(pool_key, NULL);
+        destroy_pool(pool);
+    }
+}
+
+void
+ws_processor_stack_pool_trim(void) {
+    struct stack_pool* pool = get_pool();
+    if (!pool) {
+        return;
+    }
+
+    size_t i;
+    for (i = 0; i < STACK_POOL_SIZE; ++i) {
+        struct ws_processor_stack* stack = pool->stacks + i;
+        if (pool->taken[i] || !stack->data) {
+            continue;
+        }
+
+        if (pool->peak) {
+            (void) ws_processor_stack_shrink(stack, pool->peak);
+        } else {
+            ws_processor_stack_deinit(stack);
+            stack->data = NULL;
+        }
+    }
+
+    pool->peak = 0;
+}
+
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static struct stack_pool*
+get_pool(void) {
+    if (pthread_once(&pool_once, create_key) != 0) {
+        return NULL;
+    }
+
+    struct stack_pool* pool = pthread_getspecific(pool_key);
+    if (pool) {
+        return pool;
+    }
+
+    pool = calloc(1, sizeof(*pool));
+    if (!pool) {
+        return NULL;
+    }
+
+    if (pthread_setspecific(pool_key, pool) != 0) {
+        free(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+static void
+create_key(void) {
+    (void) pthread_key_create(&pool_key, destroy_pool);
+}
+
+static void
+destroy_pool(
+    void* pool
+) {
+    struct stack_pool* self = (struct stack_pool*) pool;
+
+    size_t i;
+    for (i = 0; i < STACK_POOL_SIZE; ++i) {
+        if (self->stacks[i].data) {
+            ws_processor_stack_deinit(self->stacks + i);
+        }
+    }
+
+    free(self);
+}
+
@@ -0,0 +1,125 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup action "Action manager"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup action_stack_pool "Action manager processor stack pool"
+ *
+ * @{
+ *
+ * Per-thread pool of processor stacks
+ *
+ * Running a transaction requires a processor stack.
+ * Rather than allocating a new stack for every run, stacks are taken from a
+ * pool local to the running thread and returned after the run.
+ * Returned stacks keep their capacity, so a transaction run repeatedly will
+ * not allocate any stack memory after its first run.
+ *
+ * Stacks are only shrunk by `ws_processor_stack_pool_trim()`, which is meant
+ * to be called while the thread is idle.
+ */
+
+#ifndef __WS_ACTION_STACK_POOL_H__
+#define __WS_ACTION_STACK_POOL_H__
+
+#include "action/processor_stack.h"
+#include "util/attributes.h"
+
+/**
+ * Take a stack from the pool of the current thread
+ *
+ * The stack returned is empty.
+ * Stacks may be returned in any order, but only on the thread they were taken
+ * from.
+ *
+ * @return a stack or `NULL`, if no stack could be provided
+ */
+struct ws_processor_stack*
+ws_processor_stack_pool_get(void);
+
+/**
+ * Return a stack to the pool of the current thread
+ *
+ * All values left on the stack are deinitialized.
+ */
+void
+ws_processor_stack_pool_put(
+    struct ws_processor_stack* stack //!< stack to return
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Detach a stack from the pool of the current thread
+ *
+ * The stack is moved out of the pool, so it may be returned to the pool of any
+ * thread afterwards, which will then simply free it.
+ * On success, the stack passed must not be used any more.
+ *
+ * @return the detached stack or `NULL`, if the stack could not be moved, in
+ *         which case it remains in the pool
+ */
+struct ws_processor_stack*
+ws_processor_stack_pool_detach(
+    struct ws_processor_stack* stack //!< stack to detach
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Trim the pool of the current thread
+ *
+ * Shrinks the stacks not in use to the capacity required since the last
+ * trim.
+ * Stacks which were not used at all since then are released.
+ */
+void
+ws_processor_stack_pool_trim(void);
+
+/**
+ * Release the pool of the current thread
+ *
+ * All stacks must have been returned to the pool.
+ */
+void
+ws_processor_stack_pool_release(void);
+
+#endif // __WS_ACTION_STACK_POOL_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -0,0 +1,231 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <ev.h>
+#include <malloc.h>
+#include <stddef.h>
+
+#include "action/manager.h"
+#include "action/timer.h"
+#include "logger/module.h"
+#include "objects/message/event.h"
+#include "objects/message/reply.h"
+#include "objects/string.h"
+
+/**
+ * A timer emitting an event
+ */
+struct timer {
+    ev_timer watcher; //!< libev timer, must be the first member
+    struct ws_string* name; //!< name of the timer and the event
+    struct timer* next; //!< next timer in the list
+};
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Find a timer by its name
+ *
+ * @return the link pointing to the timer or `NULL`, if there is none
+ */
+static struct timer**
+find_timer(
+    struct ws_string* name //!< name of the timer
+);
+
+/**
+ * Stop, unlink and free a timer
+ */
+static void
+remove_timer(
+    struct timer** link //!< link pointing to the timer
+);
+
+/**
+ * Emit the event of an expired timer
+ */
+static void
+fire_timer(
+    struct ev_loop* loop,
+    ev_timer* watcher,
+    int revents
+);
+
+/*
+ *
+ * Internal constant
+ *
+ */
+
+/**
+ * Timers currently active
+ */
+static struct timer* timers = NULL;
+
+static struct ws_logger_context log_ctx = {
+    .prefix = "[Action timer] ",
+};
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_action_timer_add(
+    struct ws_string* name,
+    double after,
+    double repeat
+) {
+    if ((after < 0) || (repeat < 0)) {
+        return -EINVAL;
+    }
+
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    if (!loop) {
+        return -ENOTSUP;
+    }
+
+    struct timer** link = find_timer(name);
+    if (link) {
+        remove_timer(link);
+    }
+
+    struct timer* timer = calloc(1, sizeof(*timer));
+    if (!timer) {
+        return -ENOMEM;
+    }
+
+    timer->name = ws_string_dupl(name);
+    if (!timer->name) {
+        free(timer);
+        return -ENOMEM;
+    }
+
+    ev_timer_init(&timer->watcher, fire_timer, after, repeat);
+    ev_timer_start(loop, &timer->watcher);
+
+    timer->next = timers;
+    timers = timer;
+    return 0;
+}
+
+int
+ws_action_timer_remove(
+    struct ws_string* name
+) {
+    struct timer** link = find_timer(name);
+    if (!link) {
+        return -ENOENT;
+    }
+
+    remove_timer(link);
+    return 0;
+}
+
+void
+ws_action_timer_deinit(void) {
+    while (timers) {
+        remove_timer(&timers);
+    }
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static struct timer**
+find_timer(
+    struct ws_string* name
+) {
+    struct timer** link = &timers;
+    while (*link) {
+        if (ws_string_cmp((*link)->name, name) == 0) {
+            return link;
+        }
+        link = &(*link)->next;
+    }
+
+    return NULL;
+}
+
+static void
+remove_timer(
+    struct timer** link
+) {
+    struct timer* timer = *link;
+    *link = timer->next;
+
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    if (loop) {
+        ev_timer_stop(loop, &timer->watcher);
+    }
+
+    ws_object_unref((struct ws_object*) timer->name);
+    free(timer);
+}
+
+static void
+fire_timer(
+    struct ev_loop* loop,
+    ev_timer* watcher,
+    int revents
+) {
+    struct timer* timer = (struct timer*) watcher;
+
+    struct ws_event* event = ws_event_new(timer->name, NULL);
+    if (!event) {
+        ws_log(&log_ctx, LOG_ERR, "Could not emit timer event");
+        return;
+    }
+
+    // one-shot timers are gone once expired
+    if (!watcher->repeat) {
+        struct timer** link = find_timer(timer->name);
+        if (link) {
+            remove_timer(link);
+        }
+    }
+
+    // the transactions run may modify the timers, including this one
+    struct ws_reply* reply;
+    reply = ws_action_manager_process((struct ws_message*) event);
+    if (reply) {
+        ws_object_unref((struct ws_object*) reply);
+    }
+    ws_object_unref((struct ws_object*) event);
+}
+
@@ -0,0 +1,101 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup action "Action manager"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup action_timer "Action manager timers"
+ *
+ * @{
+ *
+ * Timers emitting events
+ *
+ * A timer emits an event with its name when it expires, either once or
+ * periodically. The event is processed by the action manager directly, just
+ * like a hotkey event, hence it runs the transactions registered for the
+ * event or the transaction with the same name.
+ *
+ * Timers are identified by their name, there is at most one timer per name.
+ * They are backed by libev timers and must only be used from the main loop.
+ */
+
+#ifndef __WS_ACTION_TIMER_H__
+#define __WS_ACTION_TIMER_H__
+
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_string;
+
+/**
+ * Start a timer
+ *
+ * A timer with the same name is replaced.
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+int
+ws_action_timer_add(
+    struct ws_string* name, //!< name of the timer and the event emitted
+    double after, //!< time until the timer expires, in seconds
+    double repeat //!< interval for periodic timers, `0` for one-shot timers
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Stop and remove a timer
+ *
+ * @return 0 on success, -ENOENT if there is no timer with the name
+ */
+int
+ws_action_timer_remove(
+    struct ws_string* name //!< name of the timer
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Stop and remove all timers
+ */
+void
+ws_action_timer_deinit(void);
+
+#endif // __WS_ACTION_TIMER_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -0,0 +1,325 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <ev.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "action/stack_pool.h"
+#include "action/worker.h"
+
+/**
+ * Maximum number of worker threads
+ */
+#define WORKER_MAX_THREADS (4)
+
+/**
+ * Time a worker may be idle before trimming its stacks, in seconds
+ */
+#define WORKER_TRIM_INTERVAL (30)
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Start the worker threads
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+static int
+start_workers(void);
+
+/**
+ * Main function of a worker thread
+ */
+static void*
+worker_main(
+    void* dummy
+);
+
+/**
+ * Watcher callback: complete the jobs run
+ */
+static void
+complete_jobs(
+    struct ev_loop* loop,
+    ev_io* watcher,
+    int revents
+);
+
+/**
+ * Complete all the jobs in a list
+ */
+static void
+complete_list(
+    struct ws_action_job* job //!< first job of the list
+);
+
+
+/*
+ *
+ * Internal constant
+ *
+ */
+
+/**
+ * State of the worker pool
+ */
+static struct {
+    pthread_t threads[WORKER_MAX_THREADS]; //!< worker threads
+    size_t num_threads; //!< number of worker threads running
+    bool running; //!< whether the workers should keep running
+    pthread_mutex_t lock; //!< lock protecting the queues
+    pthread_cond_t wakeup; //!< condition signalling new jobs
+    struct ws_action_job* pending; //!< jobs to run
+    struct ws_action_job** pending_tail; //!< end of the pending jobs
+    struct ws_action_job* finished; //!< jobs to complete
+    struct ws_action_job** finished_tail; //!< end of the finished jobs
+    int efd; //!< eventfd signalling finished jobs
+    ev_io completer; //!< watcher completing the finished jobs
+} pool = {
+    .num_threads = 0,
+    .running = false,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wakeup = PTHREAD_COND_INITIALIZER,
+    .pending = NULL,
+    .pending_tail = &pool.pending,
+    .finished = NULL,
+    .finished_tail = &pool.finished,
+    .efd = -1,
+};
+
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_action_worker_submit(
+    struct ws_action_job* job
+) {
+    if (!pool.running) {
+        int res = start_workers();
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    job->next = NULL;
+    job->reply = NULL;
+
+    pthread_mutex_lock(&pool.lock);
+    *pool.pending_tail = job;
+    pool.pending_tail = &job->next;
+    pthread_cond_signal(&pool.wakeup);
+    pthread_mutex_unlock(&pool.lock);
+
+    return 0;
+}
+
+void
+ws_action_worker_deinit(void) {
+    if (!pool.running) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    pool.running = false;
+    pthread_cond_broadcast(&pool.wakeup);
+    pthread_mutex_unlock(&pool.lock);
+
+    while (pool.num_threads) {
+        pthread_join(pool.threads[--pool.num_threads], NULL);
+    }
+
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    if (loop) {
+        ev_io_stop(loop, &pool.completer);
+    }
+    close(pool.efd);
+    pool.efd = -1;
+
+    // complete everything, whether it was run or not
+    struct ws_action_job* finished = pool.finished;
+    struct ws_action_job* pending = pool.pending;
+    pool.finished = NULL;
+    pool.finished_tail = &pool.finished;
+    pool.pending = NULL;
+    pool.pending_tail = &pool.pending;
+
+    complete_list(finished);
+    complete_list(pending);
+}
+
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static int
+start_workers(void) {
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    if (!loop) {
+        return -ENOENT;
+    }
+
+    pool.efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (pool.efd < 0) {
+        return -errno;
+    }
+
+    ev_io_init(&pool.completer, complete_jobs, pool.efd, EV_READ);
+    ev_io_start(loop, &pool.completer);
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t num = (cpus > 1) ? (size_t) cpus : 1;
+    if (num > WORKER_MAX_THREADS) {
+        num = WORKER_MAX_THREADS;
+    }
+
+    pool.running = true;
+    while (pool.num_threads < num) {
+        pthread_t* thread = pool.threads + pool.num_threads;
+        if (pthread_create(thread, NULL, worker_main, NULL) != 0) {
+            break;
+        }
+        ++pool.num_threads;
+    }
+
+    if (!pool.num_threads) {
+        pool.running = false;
+        ev_io_stop(loop, &pool.completer);
+        close(pool.efd);
+        pool.efd = -1;
+        return -EAGAIN;
+    }
+
+    return 0;
+}
+
+static void*
+worker_main(
+    void* dummy
+) {
+    pthread_mutex_lock(&pool.lock);
+    while (pool.running) {
+        struct ws_action_job* job = pool.pending;
+        if (!job) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += WORKER_TRIM_INTERVAL;
+
+            int res = pthread_cond_timedwait(&pool.wakeup, &pool.lock,
+                                             &deadline);
+            if (res == ETIMEDOUT) {
+                // we were idle for a while
+                pthread_mutex_unlock(&pool.lock);
+                ws_processor_stack_pool_trim();
+                pthread_mutex_lock(&pool.lock);
+            }
+            continue;
+        }
+
+        // dequeue the job
+        pool.pending = job->next;
+        if (!pool.pending) {
+            pool.pending_tail = &pool.pending;
+        }
+        pthread_mutex_unlock(&pool.lock);
+
+        job->yield = false;
+        job->reply = job->run(job);
+        job->next = NULL;
+
+        pthread_mutex_lock(&pool.lock);
+        if (job->yield) {
+            // let the other jobs have their turn first
+            *pool.pending_tail = job;
+            pool.pending_tail = &job->next;
+            continue;
+        }
+
+        // hand the job back to the main loop
+        *pool.finished_tail = job;
+        pool.finished_tail = &job->next;
+
+        uint64_t one = 1;
+        if (write(pool.efd, &one, sizeof(one)) < 0) {
+            // the counter is already set, the loop will wake up anyway
+        }
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    ws_processor_stack_pool_release();
+    return NULL;
+}
+
+static void
+complete_jobs(
+    struct ev_loop* loop,
+    ev_io* watcher,
+    int revents
+) {
+    uint64_t count;
+    if (read(pool.efd, &count, sizeof(count)) < 0) {
+        // nothing to do, we'll check the list anyway
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    struct ws_action_job* finished = pool.finished;
+    pool.finished = NULL;
+    pool.finished_tail = &pool.finished;
+    pthread_mutex_unlock(&pool.lock);
+
+    complete_list(finished);
+}
+
+static void
+complete_list(
+    struct ws_action_job* job
+) {
+    while (job) {
+        // the callback may free the job
+        struct ws_action_job* next = job->next;
+        job->done(job, job->reply);
+        job = next;
+    }
+}
+
@@ -0,0 +1,120 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup action "Action manager"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup action_worker "Action manager worker pool"
+ *
+ * @{
+ *
+ * Pool of threads running jobs off the main loop
+ *
+ * Jobs are run on one of the worker threads.
+ * Once a job is run, its completion is handed back to the main loop through
+ * an eventfd, so the `done` callback of each job is always invoked on the
+ * thread running the main loop.
+ * The pool is started when the first job is submitted.
+ */
+
+#ifndef __WS_ACTION_WORKER_H__
+#define __WS_ACTION_WORKER_H__
+
+#include <stdbool.h>
+
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_reply;
+
+/**
+ * A job to run on the worker pool
+ *
+ * Users embed this struct into their own, to pass data to the callbacks.
+ */
+struct ws_action_job {
+    /**
+     * Run the job, called on a worker thread
+     *
+     * @return the reply generated by the job
+     */
+    struct ws_reply* (*run)(struct ws_action_job* job);
+    /**
+     * Complete the job, called on the main loop
+     *
+     * If the pool is shut down before the job was run, `reply` is `NULL`.
+     */
+    void (*done)(struct ws_action_job* job, struct ws_reply* reply);
+    /**
+     * Whether the job yielded, set by `run`
+     *
+     * A job which yielded is put back at the end of the queue, so the other
+     * jobs get their turn, and run again later. Its reply is ignored.
+     */
+    bool yield;
+    struct ws_action_job* next; //!< @private next job in the queue
+    struct ws_reply* reply; //!< @private reply generated by the job
+};
+
+/**
+ * Submit a job to the worker pool
+ *
+ * @warning must be called from the main loop
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+int
+ws_action_worker_submit(
+    struct ws_action_job* job //!< job to run
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Shut down the worker pool
+ *
+ * Waits for the jobs currently running.
+ * Afterwards, all jobs are completed, including the ones which were not run
+ * or which yielded.
+ */
+void
+ws_action_worker_deinit(void);
+
+#endif // __WS_ACTION_WORKER_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
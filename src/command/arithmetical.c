@@ -26,15 +26,55 @@
  */
 
 #include <errno.h>
+#include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "command/arithmetical.h"
 #include "command/util.h"
+#include "values/array.h"
 #include "values/int.h"
 #include "values/union.h"
 #include "values/value.h"
 #include "values/value_type.h"
 
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Arithmetical operations
+ */
+enum arith_op {
+    ARITH_ADD,
+    ARITH_SUB,
+    ARITH_MUL,
+    ARITH_DIV,
+};
+
+/**
+ * Perform an arithmetical operation on arrays, element by element
+ *
+ * The arguments may be arrays and ints. All the arrays must be of the same
+ * length. Ints are applied to each element. The operation is folded over the
+ * arguments from left to right, the result is an array.
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+static int
+arith_arrays(
+    union ws_value_union* args, //!< arguments passed to the command
+    enum arith_op op //!< operation to perform
+);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
 int
 ws_builtin_cmd_add(
     union ws_value_union* args
@@ -49,6 +89,10 @@ ws_builtin_cmd_add(
     }
 
     if (!AT_END(it)) {
+        if (ws_value_get_type(&it->value) == WS_VALUE_TYPE_ARRAY) {
+            return arith_arrays(args, ARITH_ADD);
+        }
+
         // Arrr! We must've hit something, captn!
         return -EINVAL;
     }
@@ -66,6 +110,10 @@ ws_builtin_cmd_sub(
     intmax_t val;
     union ws_value_union* it;
 
+    if (ws_value_get_type(&args->value) == WS_VALUE_TYPE_ARRAY) {
+        return arith_arrays(args, ARITH_SUB);
+    }
+
     if (ws_value_get_type(&args->value) != WS_VALUE_TYPE_INT) {
         return -EINVAL;
     }
@@ -78,6 +126,10 @@ ws_builtin_cmd_sub(
     }
 
     if (!AT_END(it)) {
+        if (ws_value_get_type(&it->value) == WS_VALUE_TYPE_ARRAY) {
+            return arith_arrays(args, ARITH_SUB);
+        }
+
         // Arrr! We must've hit something, captn!
         return -EINVAL;
     }
@@ -101,6 +153,10 @@ ws_builtin_cmd_mul(
     }
 
     if (!AT_END(it)) {
+        if (ws_value_get_type(&it->value) == WS_VALUE_TYPE_ARRAY) {
+            return arith_arrays(args, ARITH_MUL);
+        }
+
         // Arrr! We must've hit something, captn!
         return -EINVAL;
     }
@@ -114,15 +170,25 @@ int
 ws_builtin_cmd_div(
     union ws_value_union* args
 ) {
-    if (ws_value_get_type(&args->value) != WS_VALUE_TYPE_INT ||
-            ws_value_get_type(&args[1].value) != WS_VALUE_TYPE_INT) {
+    // we need exactly two operands, and may not look past the terminator
+    if (AT_END(args) || AT_END((args + 1))) {
         return -EINVAL;
     }
 
-    if (ws_value_get_type(&args[2].value) != WS_VALUE_TYPE_NONE) {
+    if (!AT_END((args + 2))) {
         return -E2BIG;
     }
 
+    if (ws_value_get_type(&args->value) == WS_VALUE_TYPE_ARRAY ||
+            ws_value_get_type(&args[1].value) == WS_VALUE_TYPE_ARRAY) {
+        return arith_arrays(args, ARITH_DIV);
+    }
+
+    if (ws_value_get_type(&args->value) != WS_VALUE_TYPE_INT ||
+            ws_value_get_type(&args[1].value) != WS_VALUE_TYPE_INT) {
+        return -EINVAL;
+    }
+
     intmax_t tmp_dividend = ws_value_int_get(&args->int_);
     intmax_t tmp_divisor = ws_value_int_get(&args[1].int_);
 
@@ -130,7 +196,136 @@ ws_builtin_cmd_div(
         return -EFAULT;
     }
 
+    // the quotient would not be representable
+    if ((tmp_divisor == -1) && (tmp_dividend == INTMAX_MIN)) {
+        return -ERANGE;
+    }
+
     ws_value_int_set(&args->int_, tmp_dividend / tmp_divisor);
 
     return 0;
 }
+
+/*
+ *
+ * Static function implementations
+ *
+ */
+
+static int
+arith_arrays(
+    union ws_value_union* args,
+    enum arith_op op
+) {
+    union ws_value_union* it;
+    size_t len = 0;
+    bool have_len = false;
+
+    // check the arguments and determine the length of the result
+    for (it = args; !AT_END(it); ++it) {
+        switch (ws_value_get_type(&it->value)) {
+        case WS_VALUE_TYPE_INT:
+            break;
+
+        case WS_VALUE_TYPE_ARRAY:
+            if (have_len && (ws_value_array_len(&it->array) != len)) {
+                return -EINVAL;
+            }
+            len = ws_value_array_len(&it->array);
+            have_len = true;
+            break;
+
+        default:
+            return -EINVAL;
+        }
+    }
+
+    struct ws_value_array res;
+    ws_value_array_init(&res);
+    if (ws_value_array_resize(&res, len) < 0) {
+        return -ENOMEM;
+    }
+
+    intmax_t* restrict acc = ws_value_array_elems_mut(&res);
+    size_t i;
+
+    // the first argument is the initial value
+    if (ws_value_get_type(&args->value) == WS_VALUE_TYPE_INT) {
+        intmax_t val = ws_value_int_get(&args->int_);
+        for (i = 0; i < len; ++i) {
+            acc[i] = val;
+        }
+    } else if (len) {
+        memcpy(acc, ws_value_array_elems(&args->array), len * sizeof(*acc));
+    }
+
+    int retval = 0;
+
+    // The operation is switched outside of the loops, so each loop is a plain
+    // elementwise operation the compiler may vectorize.
+    for (it = args + 1; !AT_END(it); ++it) {
+        if (ws_value_get_type(&it->value) == WS_VALUE_TYPE_INT) {
+            intmax_t val = ws_value_int_get(&it->int_);
+
+            switch (op) {
+            case ARITH_ADD:
+                for (i = 0; i < len; ++i) { acc[i] += val; }
+                break;
+            case ARITH_SUB:
+                for (i = 0; i < len; ++i) { acc[i] -= val; }
+                break;
+            case ARITH_MUL:
+                for (i = 0; i < len; ++i) { acc[i] *= val; }
+                break;
+            case ARITH_DIV:
+                if (val == 0) {
+                    retval = -EFAULT;
+                    goto out;
+                }
+                for (i = 0; i < len; ++i) {
+                    if ((val == -1) && (acc[i] == INTMAX_MIN)) {
+                        retval = -ERANGE;
+                        goto out;
+                    }
+                    acc[i] /= val;
+                }
+                break;
+            }
+            continue;
+        }
+
+        intmax_t const* restrict vals = ws_value_array_elems(&it->array);
+
+        switch (op) {
+        case ARITH_ADD:
+            for (i = 0; i < len; ++i) { acc[i] += vals[i]; }
+            break;
+        case ARITH_SUB:
+            for (i = 0; i < len; ++i) { acc[i] -= vals[i]; }
+            break;
+        case ARITH_MUL:
+            for (i = 0; i < len; ++i) { acc[i] *= vals[i]; }
+            break;
+        case ARITH_DIV:
+            for (i = 0; i < len; ++i) {
+                if (vals[i] == 0) {
+                    retval = -EFAULT;
+                    goto out;
+                }
+                if ((vals[i] == -1) && (acc[i] == INTMAX_MIN)) {
+                    retval = -ERANGE;
+                    goto out;
+                }
+                acc[i] /= vals[i];
+            }
+            break;
+        }
+    }
+
+    ws_value_union_reinit(args, WS_VALUE_TYPE_ARRAY);
+    ws_value_array_assign(&args->array, &res);
+
+out:
+    ws_value_deinit(&res.value);
+    return retval;
+}
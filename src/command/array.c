@@ -0,0 +1,189 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <stdint.h>
+
+#include "command/array.h"
+#include "command/util.h"
+#include "values/array.h"
+#include "values/int.h"
+#include "values/union.h"
+#include "values/value.h"
+#include "values/value_type.h"
+
+/*
+ *
+ * Internal constant
+ *
+ */
+
+/**
+ * Maximum number of elements of an array created by `range`
+ *
+ * The bounds are client-supplied, so we don't let them determine the size of
+ * an allocation without limits.
+ */
+#define RANGE_MAX_LEN (1 << 20)
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_builtin_cmd_array(
+    union ws_value_union* args
+) {
+    union ws_value_union* it;
+    intmax_t val;
+    size_t len = 0;
+
+    // iterate over all the arguments, checking whether they are ints
+    ITERATE_ARGS_TYPE(it, args, val, int) {
+        ++len;
+    }
+
+    if (!AT_END(it)) {
+        return -EINVAL;
+    }
+
+    struct ws_value_array res;
+    ws_value_array_init(&res);
+    if (ws_value_array_resize(&res, len) < 0) {
+        return -ENOMEM;
+    }
+
+    intmax_t* elems = ws_value_array_elems_mut(&res);
+    ITERATE_ARGS_TYPE(it, args, val, int) {
+        *elems++ = val;
+    }
+
+    ws_value_union_reinit(args, WS_VALUE_TYPE_ARRAY);
+    ws_value_array_assign(&args->array, &res);
+    ws_value_deinit(&res.value);
+    return 0;
+}
+
+int
+ws_builtin_cmd_at(
+    union ws_value_union* args
+) {
+    if ((ws_value_get_type(&args[0].value) != WS_VALUE_TYPE_ARRAY) ||
+            (ws_value_get_type(&args[1].value) != WS_VALUE_TYPE_INT)) {
+        return -EINVAL;
+    }
+
+    if (!AT_END((args + 2))) {
+        return -E2BIG;
+    }
+
+    intmax_t index = ws_value_int_get(&args[1].int_);
+    if ((index < 0) || ((size_t) index >= ws_value_array_len(&args->array))) {
+        return -ERANGE;
+    }
+
+    intmax_t val = ws_value_array_get(&args->array, index);
+    ws_value_union_reinit(args, WS_VALUE_TYPE_INT);
+    ws_value_int_set(&args->int_, val);
+    return 0;
+}
+
+int
+ws_builtin_cmd_length(
+    union ws_value_union* args
+) {
+    if (ws_value_get_type(&args->value) != WS_VALUE_TYPE_ARRAY) {
+        return -EINVAL;
+    }
+
+    if (!AT_END((args + 1))) {
+        return -E2BIG;
+    }
+
+    size_t len = ws_value_array_len(&args->array);
+    ws_value_union_reinit(args, WS_VALUE_TYPE_INT);
+    ws_value_int_set(&args->int_, len);
+    return 0;
+}
+
+int
+ws_builtin_cmd_range(
+    union ws_value_union* args
+) {
+    union ws_value_union* it;
+    intmax_t bounds[2] = {0, 0};
+    intmax_t val;
+    size_t num = 0;
+
+    ITERATE_ARGS_TYPE(it, args, val, int) {
+        if (num >= 2) {
+            return -E2BIG;
+        }
+        bounds[num++] = val;
+    }
+
+    if (!AT_END(it) || (num == 0)) {
+        return -EINVAL;
+    }
+
+    // with a single argument, the range starts at 0
+    if (num == 1) {
+        bounds[1] = bounds[0];
+        bounds[0] = 0;
+    }
+
+    // the difference of the bounds may not be representable as an intmax_t
+    uintmax_t len = 0;
+    if (bounds[1] > bounds[0]) {
+        len = (uintmax_t) bounds[1] - (uintmax_t) bounds[0];
+    }
+
+    if (len > RANGE_MAX_LEN) {
+        return -E2BIG;
+    }
+
+    struct ws_value_array res;
+    ws_value_array_init(&res);
+    if (ws_value_array_resize(&res, len) < 0) {
+        return -ENOMEM;
+    }
+
+    intmax_t* elems = ws_value_array_elems_mut(&res);
+    size_t i;
+    for (i = 0; i < len; ++i) {
+        elems[i] = bounds[0] + (intmax_t) i;
+    }
+
+    ws_value_union_reinit(args, WS_VALUE_TYPE_ARRAY);
+    ws_value_array_assign(&args->array, &res);
+    ws_value_deinit(&res.value);
+    return 0;
+}
+
@@ -0,0 +1,1013 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "command/bytecode.h"
+#include "command/statement.h"
+#include "util/string.h"
+#include "values/int.h"
+#include "values/union.h"
+#include "values/value.h"
+#include "values/value_type.h"
+
+/*
+ *
+ * Internal constant
+ *
+ */
+
+/**
+ * Depth of instructions which are not reached
+ */
+#define DEPTH_UNREACHED (SIZE_MAX)
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Compile a single statement
+ *
+ * Jump targets are compiled as statement positions and have to be translated
+ * to instruction indices once all the statements are compiled.
+ */
+static void
+compile_statement(
+    struct ws_bytecode_insn* insn, //!< instruction to compile to
+    struct ws_statement const* stmt, //!< statement to compile
+    size_t index, //!< index of the statement
+    struct ws_bytecode_operand** ops //!< next free operand slot
+);
+
+/**
+ * Determine the target of a jump with a constant distance
+ *
+ * Handles the unconditional `jump` as well as the conditional jumps `jump_if`,
+ * `jump_unless` and `foreach`. The distance of conditional jumps must always
+ * be a direct argument.
+ *
+ * @return 1 if the statement jumps to a constant target, 0 if it doesn't,
+ *         -EINVAL if the target lies before the first statement or the
+ *         statement is a malformed conditional jump
+ */
+static int
+static_target(
+    struct ws_statement const* stmt, //!< statement to check
+    size_t index, //!< index of the statement
+    size_t* target //!< statement position jumped to
+);
+
+/**
+ * Check whether a statement is a conditional jump
+ */
+static bool
+is_branch(
+    struct ws_statement const* stmt //!< statement to check
+);
+
+/**
+ * Determine the instruction a conditional jump may jump to
+ *
+ * @return true if the instruction is a conditional jump with a target inside
+ *         the code, false otherwise
+ */
+static bool
+branch_target(
+    struct ws_bytecode const* self, //!< code containing the instruction
+    struct ws_bytecode_insn const* insn, //!< instruction
+    size_t* target //!< instruction index jumped to
+);
+
+/**
+ * Record the stack depth for an instruction reached and queue it
+ *
+ * @return true if the depth is consistent with other paths, false otherwise
+ */
+static bool
+reach(
+    size_t* depth, //!< depth before each instruction
+    size_t* worklist, //!< instructions queued
+    size_t* pending, //!< number of instructions queued
+    size_t next, //!< instruction reached
+    size_t out //!< depth with which it is reached
+);
+
+/**
+ * Compile a jump with a constant distance
+ *
+ * @return true if the jump was compiled, false if the distance is not constant
+ */
+static bool
+compile_jump(
+    struct ws_bytecode_insn* insn, //!< instruction to compile to
+    struct ws_statement const* stmt, //!< statement to compile
+    size_t index //!< index of the statement
+);
+
+/**
+ * Optimize compiled code
+ *
+ * Optimizations are optional, failing to allocate memory for them leaves the
+ * code as it is.
+ */
+static void
+optimize(
+    struct ws_bytecode* self, //!< code to optimize
+    struct ws_statement const* statements //!< statements compiled
+);
+
+/**
+ * Determine the stack effect of an instruction
+ *
+ * @return true if the effect is known, false otherwise
+ */
+static bool
+stack_effect(
+    struct ws_bytecode_insn const* insn, //!< instruction
+    size_t depth, //!< stack depth before the instruction
+    size_t* peak, //!< maximum depth reached by the instruction
+    size_t* out //!< stack depth after the instruction
+);
+
+/**
+ * Determine the stack depth before each instruction
+ *
+ * Instructions which are not reached are assigned `DEPTH_UNREACHED`. The
+ * stack size of the code is updated.
+ *
+ * @return true if the control flow and the stack depths are known, false
+ *         otherwise
+ */
+static bool
+analyze_flow(
+    struct ws_bytecode* self, //!< code to analyze
+    size_t* depth //!< depth before each instruction, including the end
+);
+
+/**
+ * Replace stack operands by constants where possible and fold pure commands
+ */
+static void
+propagate_constants(
+    struct ws_bytecode* self, //!< code to optimize
+    struct ws_statement const* statements, //!< statements compiled
+    size_t const* depth //!< depth before each instruction
+);
+
+/**
+ * Evaluate a pure command with constant operands
+ *
+ * On success, the instruction is replaced by one pushing the result.
+ *
+ * @return true if the instruction was folded, false otherwise
+ */
+static bool
+fold(
+    struct ws_bytecode* self, //!< code containing the instruction
+    struct ws_statement const* statements, //!< statements compiled
+    struct ws_bytecode_insn* insn //!< instruction to fold
+);
+
+/**
+ * Remove instructions which are not reached
+ */
+static void
+remove_dead_code(
+    struct ws_bytecode* self, //!< code to optimize
+    size_t const* depth //!< depth before each instruction
+);
+
+/**
+ * Check whether an instruction invokes a special command of the given name
+ */
+static bool
+is_special(
+    struct ws_bytecode_insn const* insn, //!< instruction
+    char const* name //!< name of the command
+);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+struct ws_bytecode*
+ws_bytecode_compile(
+    struct ws_statement const* statements,
+    size_t num
+) {
+    size_t i;
+
+    // jump targets are checked before we even try to run the code
+    for (i = 0; i < num; ++i) {
+        size_t target;
+        if (static_target(statements + i, i, &target) < 0) {
+            return NULL;
+        }
+    }
+
+    struct ws_bytecode* self = calloc(1, sizeof(*self));
+    if (!self) {
+        return NULL;
+    }
+
+    // count the operands, so we can allocate them in one chunk
+    size_t num_ops = 0;
+    for (i = 0; i < num; ++i) {
+        if (statements[i].args.vals) {
+            num_ops += statements[i].args.num;
+        }
+    }
+
+    self->num = num;
+    self->num_statements = num;
+    self->code = calloc(num + 1, sizeof(*self->code));
+    self->stmt_map = calloc(num + 1, sizeof(*self->stmt_map));
+    self->operands = calloc(num_ops ? num_ops : 1, sizeof(*self->operands));
+    self->consts = calloc(num ? num : 1, sizeof(*self->consts));
+    if (!self->code || !self->stmt_map || !self->operands || !self->consts) {
+        ws_bytecode_free(self);
+        return NULL;
+    }
+
+    struct ws_bytecode_operand* ops = self->operands;
+    for (i = 0; i < num; ++i) {
+        compile_statement(self->code + i, statements + i, i, &ops);
+        self->stmt_map[i] = i;
+    }
+
+    self->code[num].op = WS_BYTECODE_OP_END;
+    self->code[num].stmt = num;
+    self->stmt_map[num] = num;
+
+    // translate jump targets from statements to instructions
+    for (i = 0; i < num; ++i) {
+        struct ws_bytecode_insn* insn = self->code + i;
+        if (insn->op != WS_BYTECODE_OP_JUMP) {
+            continue;
+        }
+
+        if (insn->arg.target > num) {
+            insn->op = WS_BYTECODE_OP_EXIT;
+        } else {
+            insn->arg.target = self->stmt_map[insn->arg.target];
+        }
+    }
+
+    optimize(self, statements);
+
+    // the processor's own special commands only operate on the stack
+    self->pure = true;
+    for (i = 0; i < self->num; ++i) {
+        struct ws_bytecode_insn const* insn = self->code + i;
+        if (insn->op == WS_BYTECODE_OP_REGULAR) {
+            self->pure = statements[insn->stmt].command->pure;
+        } else if (insn->op == WS_BYTECODE_OP_SPECIAL) {
+            self->pure = is_special(insn, "push") || is_special(insn, "pop") ||
+                         is_special(insn, "store") ||
+                         is_special(insn, "jump") ||
+                         is_special(insn, "jump_if") ||
+                         is_special(insn, "jump_unless");
+        }
+
+        if (!self->pure) {
+            break;
+        }
+    }
+
+    return self;
+}
+
+void
+ws_bytecode_free(
+    struct ws_bytecode* self
+) {
+    if (!self) {
+        return;
+    }
+
+    if (self->consts) {
+        while (self->num_consts--) {
+            ws_value_deinit(&self->consts[self->num_consts].value);
+        }
+    }
+
+    free(self->code);
+    free(self->operands);
+    free(self->consts);
+    free(self->stmt_map);
+    free(self);
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static void
+compile_statement(
+    struct ws_bytecode_insn* insn,
+    struct ws_statement const* stmt,
+    size_t index,
+    struct ws_bytecode_operand** ops
+) {
+    struct ws_command const* cmd = stmt->command;
+
+    insn->stmt = index;
+    insn->command = cmd;
+
+    switch (cmd->command_type) {
+    case regular:
+        break;
+
+    case special:
+        if (compile_jump(insn, stmt, index)) {
+            return;
+        }
+
+        insn->op = WS_BYTECODE_OP_SPECIAL;
+        insn->arg.special = stmt;
+        return;
+
+    default:
+        insn->op = WS_BYTECODE_OP_FAIL;
+        insn->arg.error = -ENOTSUP;
+        return;
+    }
+
+    if (!stmt->args.num) {
+        insn->op = WS_BYTECODE_OP_FAIL;
+        insn->arg.error = -EINVAL;
+        return;
+    }
+
+    insn->op = WS_BYTECODE_OP_REGULAR;
+    insn->arg.regular = cmd->func.regular;
+    insn->argc = stmt->args.num;
+    insn->nops = 0;
+    insn->ops = NULL;
+
+    if (!stmt->args.vals) {
+        // the arguments are already on the stack
+        return;
+    }
+
+    // embed the arguments in the code
+    insn->nops = stmt->args.num;
+    insn->ops = *ops;
+
+    size_t i;
+    for (i = 0; i < stmt->args.num; ++i) {
+        struct ws_argument const* arg = stmt->args.vals + i;
+        struct ws_bytecode_operand* op = (*ops)++;
+
+        if (arg->type == direct) {
+            op->val = arg->arg.val;
+            op->pos = 0;
+        } else {
+            op->val = NULL;
+            op->pos = arg->arg.pos;
+        }
+    }
+}
+
+static bool
+compile_jump(
+    struct ws_bytecode_insn* insn,
+    struct ws_statement const* stmt,
+    size_t index
+) {
+    size_t target;
+    if (!ws_streq(stmt->command->name, "jump") ||
+            (static_target(stmt, index, &target) <= 0)) {
+        return false;
+    }
+
+    insn->op = WS_BYTECODE_OP_JUMP;
+    insn->arg.target = target;
+    return true;
+}
+
+static int
+static_target(
+    struct ws_statement const* stmt,
+    size_t index,
+    size_t* target
+) {
+    struct ws_command_args const* args = &stmt->args;
+    struct ws_argument const* arg;
+
+    if (ws_streq(stmt->command->name, "jump")) {
+        if (!args->num) {
+            return 0;
+        }
+
+        // the distance is either the number of arguments or a direct argument
+        if (!args->vals) {
+            *target = index + 1 + args->num;
+            return 1;
+        }
+
+        arg = args->vals;
+        if ((args->num != 1) || (arg->type != direct) ||
+                (ws_value_get_type(arg->arg.val) != WS_VALUE_TYPE_INT)) {
+            return 0;
+        }
+    } else if (is_branch(stmt)) {
+        // the distance is the last argument, foreach needs a counter slot
+        bool loop = ws_streq(stmt->command->name, "foreach");
+        if ((args->num != (loop ? 3 : 2)) || !args->vals ||
+                (loop && (args->vals[1].type != indirect))) {
+            return -EINVAL;
+        }
+
+        arg = args->vals + args->num - 1;
+        if ((arg->type != direct) ||
+                (ws_value_get_type(arg->arg.val) != WS_VALUE_TYPE_INT)) {
+            return -EINVAL;
+        }
+    } else {
+        return 0;
+    }
+
+    // jumps are relative to the statement following the jump
+    intmax_t distance = ws_value_int_get((struct ws_value_int*) arg->arg.val);
+    if ((distance < 0) && ((uintmax_t) -distance > index + 1)) {
+        return -EINVAL;
+    }
+
+    *target = index + 1 + distance;
+    return 1;
+}
+
+static bool
+is_branch(
+    struct ws_statement const* stmt
+) {
+    char const* name = stmt->command->name;
+    return ws_streq(name, "jump_if") || ws_streq(name, "jump_unless") ||
+           ws_streq(name, "foreach");
+}
+
+static bool
+branch_target(
+    struct ws_bytecode const* self,
+    struct ws_bytecode_insn const* insn,
+    size_t* target
+) {
+    if ((insn->op != WS_BYTECODE_OP_SPECIAL) || !is_branch(insn->arg.special)) {
+        return false;
+    }
+
+    // the statement was checked when the code was compiled
+    size_t stmt;
+    (void) static_target(insn->arg.special, insn->stmt, &stmt);
+    if (stmt > self->num_statements) {
+        // the jump leaves the code
+        return false;
+    }
+
+    *target = self->stmt_map[stmt];
+    return true;
+}
+
+static bool
+reach(
+    size_t* depth,
+    size_t* worklist,
+    size_t* pending,
+    size_t next,
+    size_t out
+) {
+    if (depth[next] == DEPTH_UNREACHED) {
+        depth[next] = out;
+        worklist[(*pending)++] = next;
+        return true;
+    }
+
+    // the stack depth must not depend on the path taken
+    return depth[next] == out;
+}
+
+static void
+optimize(
+    struct ws_bytecode* self,
+    struct ws_statement const* statements
+) {
+    size_t* depth = calloc(self->num + 1, sizeof(*depth));
+    if (!depth) {
+        return;
+    }
+
+    if (analyze_flow(self, depth)) {
+        propagate_constants(self, statements, depth);
+        remove_dead_code(self, depth);
+
+        // folded commands may require less stack space
+        (void) analyze_flow(self, depth);
+    } else {
+        // we can only fold commands with direct arguments
+        size_t i;
+        for (i = 0; i < self->num; ++i) {
+            struct ws_bytecode_insn* insn = self->code + i;
+            if ((insn->op != WS_BYTECODE_OP_REGULAR) ||
+                    (insn->nops != insn->argc)) {
+                continue;
+            }
+
+            bool constant = true;
+            size_t j;
+            for (j = 0; j < insn->nops; ++j) {
+                constant = constant && insn->ops[j].val;
+            }
+
+            if (constant) {
+                fold(self, statements, insn);
+            }
+        }
+    }
+
+    free(depth);
+}
+
+static bool
+stack_effect(
+    struct ws_bytecode_insn const* insn,
+    size_t depth,
+    size_t* peak,
+    size_t* out
+) {
+    struct ws_statement const* stmt;
+    size_t num;
+
+    *peak = depth;
+    *out = depth;
+
+    switch (insn->op) {
+    case WS_BYTECODE_OP_REGULAR:
+        *peak = depth + insn->nops;
+        if (insn->argc > *peak) {
+            // the command operates on values below the frame
+            return false;
+        }
+        *out = *peak - (insn->argc - 1);
+        return true;
+
+    case WS_BYTECODE_OP_CONST:
+        *peak = *out = depth + 1;
+        return true;
+
+    case WS_BYTECODE_OP_SPECIAL:
+        break;
+
+    default:
+        return true;
+    }
+
+    stmt = insn->arg.special;
+    num = stmt->args.num;
+
+    if (is_special(insn, "push")) {
+        *peak = *out = depth + (num ? num : 1);
+        return true;
+    }
+
+    if (is_special(insn, "store")) {
+        return (num == 2) && stmt->args.vals &&
+               (stmt->args.vals[1].type == indirect);
+    }
+
+    if (is_special(insn, "jump_if") || is_special(insn, "jump_unless")) {
+        return true;
+    }
+
+    if (is_special(insn, "foreach")) {
+        // the element is only pushed if the loop continues
+        *peak = *out = depth + 1;
+        return true;
+    }
+
+    if (is_special(insn, "pop")) {
+        struct ws_argument const* arg = stmt->args.vals;
+        if (!num) {
+            num = 1;
+        }
+
+        if (arg) {
+            if ((arg->type != direct) ||
+                    (ws_value_get_type(arg->arg.val) != WS_VALUE_TYPE_INT)) {
+                return false;
+            }
+            num = ws_value_int_get((struct ws_value_int*) arg->arg.val);
+        }
+
+        if (num > depth) {
+            return false;
+        }
+
+        *out = depth - num;
+        return true;
+    }
+
+    // other special commands may do anything
+    return false;
+}
+
+static bool
+analyze_flow(
+    struct ws_bytecode* self,
+    size_t* depth
+) {
+    size_t num = self->num;
+    size_t* worklist = malloc((num + 1) * sizeof(*worklist));
+    if (!worklist) {
+        return false;
+    }
+
+    size_t i;
+    for (i = 0; i <= num; ++i) {
+        depth[i] = DEPTH_UNREACHED;
+    }
+
+    size_t pending = 0;
+    size_t stack_size = 0;
+    depth[0] = 0;
+    worklist[pending++] = 0;
+
+    while (pending) {
+        struct ws_bytecode_insn const* insn = self->code + worklist[--pending];
+        size_t in = depth[insn - self->code];
+        size_t peak;
+        size_t out;
+
+        if (!stack_effect(insn, in, &peak, &out)) {
+            goto fail;
+        }
+
+        if (peak > stack_size) {
+            stack_size = peak;
+        }
+
+        size_t next;
+        switch (insn->op) {
+        case WS_BYTECODE_OP_REGULAR:
+        case WS_BYTECODE_OP_CONST:
+        case WS_BYTECODE_OP_SPECIAL:
+            next = insn - self->code + 1;
+            break;
+
+        case WS_BYTECODE_OP_JUMP:
+            next = insn->arg.target;
+            break;
+
+        default:
+            continue;
+        }
+
+        if (!reach(depth, worklist, &pending, next, out)) {
+            goto fail;
+        }
+
+        // conditional jumps may also continue at their target, foreach
+        // leaves the loop without pushing an element
+        if (branch_target(self, insn, &next) &&
+                !reach(depth, worklist, &pending, next,
+                       is_special(insn, "foreach") ? in : out)) {
+            goto fail;
+        }
+    }
+
+    free(worklist);
+    self->stack_size = stack_size;
+    return true;
+
+fail:
+    free(worklist);
+    self->stack_size = 0;
+    return false;
+}
+
+static void
+propagate_constants(
+    struct ws_bytecode* self,
+    struct ws_statement const* statements,
+    size_t const* depth
+) {
+    size_t num = self->num;
+    struct ws_value** known = calloc(self->stack_size + 1, sizeof(*known));
+    size_t* preds = calloc(num + 1, sizeof(*preds));
+    if (!known || !preds) {
+        goto cleanup;
+    }
+
+    // count the predecessors of each instruction
+    size_t i;
+    for (i = 0; i < num; ++i) {
+        if (depth[i] == DEPTH_UNREACHED) {
+            continue;
+        }
+
+        switch (self->code[i].op) {
+        case WS_BYTECODE_OP_REGULAR:
+        case WS_BYTECODE_OP_CONST:
+        case WS_BYTECODE_OP_SPECIAL:
+            ++preds[i + 1];
+            {
+                size_t target;
+                if (branch_target(self, self->code + i, &target)) {
+                    ++preds[target];
+                }
+            }
+            break;
+
+        case WS_BYTECODE_OP_JUMP:
+            ++preds[self->code[i].arg.target];
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // the instruction the state is passed on to
+    size_t next = 0;
+    for (i = 0; i < num; ++i) {
+        struct ws_bytecode_insn* insn = self->code + i;
+        size_t d = depth[i];
+
+        if (d == DEPTH_UNREACHED) {
+            continue;
+        }
+
+        // we know nothing about values at the start of a block with several
+        // predecessors, since they may disagree
+        if ((next != i) || (preds[i] > 1)) {
+            memset(known, 0, (self->stack_size + 1) * sizeof(*known));
+        }
+
+        switch (insn->op) {
+        case WS_BYTECODE_OP_REGULAR:
+            {
+                struct ws_bytecode_operand* ops;
+                ops = self->operands + (insn->ops - self->operands);
+                bool constant = true;
+
+                size_t j;
+                for (j = 0; j < insn->nops; ++j) {
+                    if (!ops[j].val && (ops[j].pos < 0) &&
+                            ((size_t) -ops[j].pos <= d)) {
+                        ops[j].val = known[d + ops[j].pos];
+                    }
+                    constant = constant && ops[j].val;
+                }
+
+                if (constant && (insn->nops == insn->argc) &&
+                        fold(self, statements, insn)) {
+                    known[d] = insn->arg.value;
+                    break;
+                }
+
+                for (j = 0; j < insn->nops; ++j) {
+                    known[d + j] = ops[j].val;
+                }
+
+                // the command may alter all of its arguments
+                size_t base = d + insn->nops - insn->argc;
+                for (j = base; j < d + insn->nops; ++j) {
+                    known[j] = NULL;
+                }
+            }
+            break;
+
+        case WS_BYTECODE_OP_CONST:
+            known[d] = insn->arg.value;
+            break;
+
+        case WS_BYTECODE_OP_SPECIAL:
+            {
+                struct ws_command_args const* args = &insn->arg.special->args;
+
+                if (is_special(insn, "push")) {
+                    size_t n = args->num ? args->num : 1;
+                    size_t j;
+                    for (j = 0; j < n; ++j) {
+                        known[d + j] = NULL;
+                        if (args->vals && (args->vals[j].type == direct)) {
+                            known[d + j] = args->vals[j].arg.val;
+                        }
+                    }
+                    break;
+                }
+
+                if (is_special(insn, "foreach")) {
+                    // the counter is incremented and an element pushed
+                    ssize_t pos = args->vals[1].arg.pos;
+                    if (pos >= 0) {
+                        memset(known, 0,
+                               (self->stack_size + 1) * sizeof(*known));
+                    } else if ((size_t) -pos <= d) {
+                        known[d + pos] = NULL;
+                    }
+                    known[d] = NULL;
+                    break;
+                }
+
+                if (!is_special(insn, "store")) {
+                    break;
+                }
+
+                ssize_t pos = args->vals[1].arg.pos;
+                if (pos >= 0) {
+                    // the slot may be anywhere in the frame
+                    memset(known, 0,
+                           (self->stack_size + 1) * sizeof(*known));
+                    break;
+                }
+
+                if ((size_t) -pos > d) {
+                    break;
+                }
+
+                struct ws_value* val = NULL;
+                if (args->vals[0].type == direct) {
+                    val = args->vals[0].arg.val;
+                } else if ((args->vals[0].arg.pos < 0) &&
+                        ((size_t) -args->vals[0].arg.pos <= d)) {
+                    val = known[d + args->vals[0].arg.pos];
+                }
+                known[d + pos] = val;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        switch (insn->op) {
+        case WS_BYTECODE_OP_REGULAR:
+        case WS_BYTECODE_OP_CONST:
+        case WS_BYTECODE_OP_SPECIAL:
+            next = i + 1;
+            break;
+
+        case WS_BYTECODE_OP_JUMP:
+            // unless jumping backwards, the state is still valid at the target
+            next = insn->arg.target;
+            break;
+
+        default:
+            next = num;
+            break;
+        }
+    }
+
+cleanup:
+    free(known);
+    free(preds);
+}
+
+static bool
+fold(
+    struct ws_bytecode* self,
+    struct ws_statement const* statements,
+    struct ws_bytecode_insn* insn
+) {
+    if (!statements[insn->stmt].command->pure) {
+        return false;
+    }
+
+    // the number of arguments is up to the client, so they live on the heap
+    size_t argc = insn->argc;
+    union ws_value_union* args = calloc(argc + 1, sizeof(*args));
+    if (!args) {
+        return false;
+    }
+    union ws_value_union* result = self->consts + self->num_consts;
+    int res = 0;
+
+    size_t i;
+    for (i = 0; i < argc; ++i) {
+        ws_value_init(&args[i].value);
+        res = ws_value_union_init_from_val(args + i, insn->ops[i].val);
+        if (res < 0) {
+            ++i;
+            goto cleanup;
+        }
+    }
+    ws_value_init(&args[argc].value);
+    args[argc].value.type = WS_VALUE_TYPE_NONE;
+
+    // evaluate the command now, rather than each time the code is run
+    res = insn->arg.regular(args);
+
+    ws_value_init(&result->value);
+    if (res >= 0) {
+        res = ws_value_union_init_from_val(result, &args->value);
+    }
+
+cleanup:
+    while (i--) {
+        ws_value_deinit(&args[i].value);
+    }
+    free(args);
+
+    if (res < 0) {
+        return false;
+    }
+
+    ++self->num_consts;
+    insn->op = WS_BYTECODE_OP_CONST;
+    insn->arg.value = &result->value;
+    insn->argc = 0;
+    insn->nops = 0;
+    insn->ops = NULL;
+    return true;
+}
+
+static void
+remove_dead_code(
+    struct ws_bytecode* self,
+    size_t const* depth
+) {
+    size_t num = self->num;
+    size_t* index = malloc((num + 1) * sizeof(*index));
+    if (!index) {
+        return;
+    }
+
+    // compact the code, the end is always kept
+    size_t kept = 0;
+    size_t i;
+    for (i = 0; i <= num; ++i) {
+        if ((depth[i] != DEPTH_UNREACHED) || (i == num)) {
+            index[i] = kept;
+            self->code[kept++] = self->code[i];
+        }
+    }
+
+    // map removed instructions to the next instruction kept
+    size_t next = kept - 1;
+    i = num + 1;
+    while (i--) {
+        if ((depth[i] != DEPTH_UNREACHED) || (i == num)) {
+            next = index[i];
+        } else {
+            index[i] = next;
+        }
+    }
+
+    for (i = 0; i < kept; ++i) {
+        if (self->code[i].op == WS_BYTECODE_OP_JUMP) {
+            self->code[i].arg.target = index[self->code[i].arg.target];
+        }
+    }
+
+    for (i = 0; i <= self->num_statements; ++i) {
+        self->stmt_map[i] = index[self->stmt_map[i]];
+    }
+
+    self->num = kept - 1;
+    free(index);
+}
+
+static bool
+is_special(
+    struct ws_bytecode_insn const* insn,
+    char const* name
+) {
+    return (insn->op == WS_BYTECODE_OP_SPECIAL) &&
+           ws_streq(insn->arg.special->command->name, name);
+}
@@ -0,0 +1,168 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup command "Command"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup command_bytecode "Command bytecode"
+ *
+ * @{
+ */
+
+#ifndef __WS_COMMAND_BYTECODE_H__
+#define __WS_COMMAND_BYTECODE_H__
+
+#include <malloc.h>
+#include <sys/types.h>
+
+#include "command/command.h"
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_statement;
+struct ws_value;
+union ws_value_union;
+
+/**
+ * Bytecode operations
+ */
+enum ws_bytecode_op {
+    WS_BYTECODE_OP_REGULAR, //!< invoke a regular command
+    WS_BYTECODE_OP_CONST, //!< push a constant value
+    WS_BYTECODE_OP_SPECIAL, //!< invoke a special command
+    WS_BYTECODE_OP_JUMP, //!< jump to a constant target inside the code
+    WS_BYTECODE_OP_EXIT, //!< jump to a constant target outside the code
+    WS_BYTECODE_OP_FAIL, //!< fail with a constant error
+    WS_BYTECODE_OP_END, //!< end of the code
+};
+
+/**
+ * Bytecode operand
+ *
+ * An operand is an argument passed to a regular command. It is either a
+ * constant taken from the statement or a position on the stack, with the same
+ * semantics as an indirect `ws_argument`.
+ */
+struct ws_bytecode_operand {
+    struct ws_value* val; //!< @public constant value or `NULL`
+    ssize_t pos; //!< @public stack position, if `val` is `NULL`
+};
+
+/**
+ * Bytecode instruction
+ *
+ * Each instruction is compiled from a statement. In addition to the operation,
+ * instructions carry everything required to execute them without having to
+ * look at the statement.
+ */
+struct ws_bytecode_insn {
+    enum ws_bytecode_op op; //!< @public operation
+    size_t stmt; //!< @public index of the statement compiled from
+    struct ws_command const* command; //!< @public command invoked
+    size_t argc; //!< @public number of slots passed to a regular command
+    size_t nops; //!< @public number of operands to push before the call
+    struct ws_bytecode_operand const* ops; //!< @public operands
+    union {
+        ws_regular_command_func regular; //!< @public command to invoke
+        struct ws_statement const* special; //!< @public statement to invoke
+        struct ws_value* value; //!< @public constant to push
+        size_t target; //!< @public jump target, see the operation
+        int error; //!< @public error to fail with
+    } arg; //!< @public argument of the operation
+};
+
+/**
+ * Compiled statements
+ *
+ * The code is terminated by an instruction with the operation
+ * `WS_BYTECODE_OP_END`. The targets of `WS_BYTECODE_OP_JUMP` instructions are
+ * instruction indices, while the targets of `WS_BYTECODE_OP_EXIT` instructions
+ * are statement positions.
+ *
+ * Statements which were removed because they are unreachable are mapped to
+ * the instruction following them.
+ */
+struct ws_bytecode {
+    size_t num; //!< @public number of instructions, excluding the end
+    struct ws_bytecode_insn* code; //!< @public instructions
+    struct ws_bytecode_operand* operands; //!< @public operand storage
+    union ws_value_union* consts; //!< @public constants computed
+    size_t num_consts; //!< @public number of constants computed
+    size_t num_statements; //!< @public number of statements compiled
+    size_t* stmt_map; //!< @public instruction index for each statement
+    size_t stack_size; //!< @public slots required in the frame, 0 if unknown
+    bool pure; //!< @public whether the code only operates on the stack
+};
+
+/**
+ * Compile a list of statements
+ *
+ * The bytecode refers to the statements' arguments and commands, hence it is
+ * only valid as long as the statements are.
+ *
+ * The code is optimized during compilation:
+ *  - pure commands with constant arguments are evaluated,
+ *  - unreachable statements are removed,
+ *  - the number of stack slots required is computed, if the control flow and
+ *    the stack operations are known ahead of time.
+ *
+ * Code which only invokes pure commands and the processor's stack operations
+ * is marked as pure. Such code may be run on any thread.
+ *
+ * Jumps with constant distances must not lead to positions before the first
+ * statement, and the distances of conditional jumps must be constant.
+ *
+ * @return the compiled code or `NULL` on failure or if a jump is invalid
+ */
+struct ws_bytecode*
+ws_bytecode_compile(
+    struct ws_statement const* statements, //!< statements to compile
+    size_t num //!< number of statements
+);
+
+/**
+ * Free compiled statements
+ */
+void
+ws_bytecode_free(
+    struct ws_bytecode* self //!< code to free or `NULL`
+);
+
+#endif // __WS_COMMAND_BYTECODE_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
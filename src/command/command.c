@@ -169,6 +169,24 @@ ws_command_add(
     return 0;
 }
 
+size_t
+ws_command_id(
+    struct ws_command const* command
+) {
+    return command - cmd_ctx.commands;
+}
+
+struct ws_command const*
+ws_command_get_by_id(
+    size_t id
+) {
+    if (id >= cmd_ctx.num) {
+        return NULL;
+    }
+
+    return cmd_ctx.commands + id;
+}
+
 
 /*
  *
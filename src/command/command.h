@@ -116,6 +116,8 @@ struct ws_command {
         ws_regular_command_func regular; //!< @public regular commands' callback
         ws_special_command_func special; //!< @public special commands' callback
     } func; //!< @public function callback
+
+    bool pure; //!< @public regular command without side effects
 };
 
 /**
@@ -154,6 +156,31 @@ ws_command_add(
 __ws_nonnull__(1)
 ;
 
+/**
+ * Get the id of a command
+ *
+ * Ids are indices into the command list, hence they only change when
+ * commands are added.
+ *
+ * @return the id of the command
+ */
+size_t
+ws_command_id(
+    struct ws_command const* command //!< command to get the id of
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get a command by its id
+ *
+ * @return the command or `NULL`, if there's no command with the id
+ */
+struct ws_command const*
+ws_command_get_by_id(
+    size_t id //!< id of the command
+);
+
 #endif // __WS_COMMAND_COMMAND_H__
 
 /**
@@ -54,6 +54,16 @@
     union ws_value_union*\
 )
 
+/**
+ * Pure command declaration macro
+ *
+ * This macro expands to the declaration of a regular command function for the
+ * command `name_`. Pure commands only operate on their arguments.
+ *
+ * The macro is used in generated command function headers.
+ */
+#define DECLARE_CMD_pure(name_) DECLARE_CMD_regular(name_)
+
 /**
  * Special command declaration macro
  *
@@ -72,14 +82,41 @@
  *
  * This macro expands to a command list entry for a command which the name
  * `name_` and the type `type_`.
- * Valid types are `regular` and `special`.
+ * Valid types are `regular`, `pure` and `special`.
  *
  * The macro is intended for use in the (generated) command list.
  */
-#define COMMAND(name_, type_) {\
+#define COMMAND(name_, type_) COMMAND_##type_(name_)
+
+/**
+ * Command list entry for a regular command
+ */
+#define COMMAND_regular(name_) {\
+    .name = #name_,\
+    .command_type = regular,\
+    .func.regular = ws_builtin_cmd_##name_,\
+},
+
+/**
+ * Command list entry for a pure command
+ *
+ * Pure commands are regular commands which only operate on their arguments.
+ * They may be evaluated ahead of time if all their arguments are constant.
+ */
+#define COMMAND_pure(name_) {\
+    .name = #name_,\
+    .command_type = regular,\
+    .func.regular = ws_builtin_cmd_##name_,\
+    .pure = true,\
+},
+
+/**
+ * Command list entry for a special command
+ */
+#define COMMAND_special(name_) {\
     .name = #name_,\
-    .command_type = type_,\
-    .func.type_ = ws_builtin_cmd_##name_,\
+    .command_type = special,\
+    .func.special = ws_builtin_cmd_##name_,\
 },
 
 /**
@@ -26,16 +26,53 @@
 
 #include <errno.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
 
 #include "command/object.h"
+#include "command/util.h"
 
 #include "objects/object.h"
+#include "objects/set.h"
 #include "objects/string.h"
+#include "values/array.h"
 #include "values/object_id.h"
+#include "values/set.h"
 #include "values/string.h"
 #include "values/union.h"
 #include "values/value_type.h"
 
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * State of a bulk attribute read
+ */
+struct attr_table {
+    char const* const* idents; //!< names of the attributes to read
+    size_t num; //!< number of attributes to read
+    ws_object_type_id* type; //!< type the attributes are resolved for
+    struct ws_object_attribute const** attrs; //!< resolved attributes
+    intmax_t* row; //!< next row of the table to fill
+};
+
+/**
+ * Read the attributes of an object into the next row of a table
+ *
+ * The attributes are only resolved again if the type differs from the one of
+ * the previous object.
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+static int
+read_attr_row(
+    void* etc, //!< the table
+    void const* obj //!< the object to read the attributes of
+);
+
 /*
  *
  * Interface implementation
@@ -180,3 +217,141 @@ ws_builtin_cmd_is_instance_of(
 
     return 0;
 }
+
+int
+ws_builtin_cmd_read_attrs(
+    union ws_value_union* args
+) {
+    union ws_value_union* it;
+    size_t num = 0;
+
+    // the objects are followed by the names of the attributes
+    for (it = args + 1; ws_value_get_type(&it->value) == WS_VALUE_TYPE_STRING;
+            ++it) {
+        ++num;
+    }
+    if (!AT_END(it) || (num == 0)) {
+        return -EINVAL;
+    }
+
+    struct ws_set* set = NULL;
+    struct ws_object* obj = NULL;
+    size_t rows;
+    switch (ws_value_get_type(&args->value)) {
+    case WS_VALUE_TYPE_SET:
+        set = ws_value_set_get(&args->set);
+        if (!set) {
+            return -EINVAL;
+        }
+        rows = ws_set_cardinality(set);
+        break;
+
+    case WS_VALUE_TYPE_OBJECT_ID:
+        obj = ws_value_object_id_get(&args->object_id);
+        if (!obj) {
+            return -EINVAL;
+        }
+        rows = 1;
+        break;
+
+    default:
+        return -EINVAL;
+    }
+
+    // the number of attributes is only bounded by the message, so the
+    // per-attribute state goes to the heap rather than to the stack
+    int res = 0;
+    char** idents = calloc(num, sizeof(*idents));
+    struct ws_object_attribute const** attrs = calloc(num, sizeof(*attrs));
+    if (!idents || !attrs) {
+        res = -ENOMEM;
+        goto cleanup;
+    }
+
+    size_t i;
+    for (i = 0; i < num; ++i) {
+        struct ws_string* str = ws_value_string_get(&args[i + 1].string);
+        idents[i] = str ? ws_string_raw(str) : NULL; // idents are copies
+        ws_object_unref((struct ws_object*) str);
+        if (!idents[i]) {
+            res = -EINVAL;
+        }
+    }
+
+    // each row holds the uuid of an object followed by its attributes
+    struct ws_value_array table;
+    ws_value_array_init(&table);
+    if (res == 0) {
+        res = ws_value_array_resize(&table, rows * (num + 1));
+    }
+
+    if (res == 0) {
+        struct attr_table state = {
+            .idents = (char const* const*) idents,
+            .num = num,
+            .type = NULL,
+            .attrs = attrs,
+            .row = ws_value_array_elems_mut(&table),
+        };
+
+        if (set) {
+            res = ws_set_select(set, NULL, NULL, read_attr_row, &state);
+        } else {
+            res = read_attr_row(&state, obj);
+        }
+    }
+
+    if (res == 0) {
+        res = ws_value_union_reinit(args, WS_VALUE_TYPE_ARRAY);
+    }
+    if (res == 0) {
+        ws_value_array_assign(&args->array, &table);
+    }
+
+    ws_value_deinit(&table.value);
+    for (i = 0; i < num; ++i) {
+        free(idents[i]);
+    }
+
+cleanup:
+    free(idents);
+    free(attrs);
+    ws_object_unref((struct ws_object*) set);
+    ws_object_unref(obj);
+    return res;
+}
+
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static int
+read_attr_row(
+    void* etc,
+    void const* obj
+) {
+    struct attr_table* table = (struct attr_table*) etc;
+    struct ws_object* object = (struct ws_object*) obj;
+
+    if (object->id != table->type) {
+        int res = ws_object_type_resolve_attrs(object->id, table->idents,
+                                               table->num, table->attrs);
+        if (res < 0) {
+            table->type = NULL;
+            return res;
+        }
+        table->type = object->id;
+    }
+
+    // uuids are unsigned and start at a random seed, so about half of them
+    // exceed INTMAX_MAX. They are stored bit for bit, i.e. those show up as
+    // negative values and have to be read back as unsigned by the client.
+    table->row[0] = (intmax_t) ws_object_uuid(object);
+    int res = ws_object_attr_read_ints(object, table->attrs, table->num,
+                                       table->row + 1);
+    table->row += table->num + 1;
+    return res;
+}
@@ -0,0 +1,198 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <stdbool.h>
+
+#include "command/set.h"
+#include "command/util.h"
+#include "objects/set.h"
+#include "values/bool.h"
+#include "values/set.h"
+#include "values/union.h"
+#include "values/value.h"
+#include "values/value_type.h"
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Combine all the set arguments using a set operation
+ *
+ * The result replaces the first argument.
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+static int
+fold_sets(
+    union ws_value_union* args, //!< arguments passed to the command
+    int (*op)(struct ws_set*, struct ws_set const*, struct ws_set const*)
+    //!< set operation to apply
+);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_builtin_cmd_union(
+    union ws_value_union* args
+) {
+    return fold_sets(args, ws_set_union);
+}
+
+int
+ws_builtin_cmd_intersection(
+    union ws_value_union* args
+) {
+    return fold_sets(args, ws_set_intersection);
+}
+
+int
+ws_builtin_cmd_difference(
+    union ws_value_union* args
+) {
+    return fold_sets(args, ws_set_difference);
+}
+
+int
+ws_builtin_cmd_symdiff(
+    union ws_value_union* args
+) {
+    return fold_sets(args, ws_set_xor);
+}
+
+int
+ws_builtin_cmd_is_subset(
+    union ws_value_union* args
+) {
+    if (ws_value_get_type(&args->value) != WS_VALUE_TYPE_SET ||
+            ws_value_get_type(&args[1].value) != WS_VALUE_TYPE_SET) {
+        return -EINVAL;
+    }
+
+    if (ws_value_get_type(&args[2].value) != WS_VALUE_TYPE_NONE) {
+        return -E2BIG;
+    }
+
+    // the first argument is checked against the second one
+    bool is_subset = ws_set_is_subset(args[1].set.set, args->set.set);
+
+    ws_value_union_reinit(args, WS_VALUE_TYPE_BOOL);
+    ws_value_bool_set(&args->bool_, is_subset);
+
+    return 0;
+}
+
+int
+ws_builtin_cmd_sort(
+    union ws_value_union* args
+) {
+    if (ws_value_get_type(&args->value) != WS_VALUE_TYPE_SET) {
+        return -EINVAL;
+    }
+
+    if (ws_value_get_type(&args[1].value) != WS_VALUE_TYPE_NONE) {
+        return -E2BIG;
+    }
+
+    struct ws_set* res = ws_set_new();
+    if (!res) {
+        return -ENOMEM;
+    }
+
+    // ordered sets are processed, and hence serialized, in order
+    int retval = ws_set_enable_ordering(res);
+    if (retval < 0) {
+        goto out;
+    }
+
+    retval = ws_set_union(res, res, args->set.set);
+    if (retval < 0) {
+        goto out;
+    }
+
+    ws_value_set_set(&args->set, res);
+
+out:
+    ws_object_unref(&res->obj);
+    return retval;
+}
+
+/*
+ *
+ * Static function implementations
+ *
+ */
+
+static int
+fold_sets(
+    union ws_value_union* args,
+    int (*op)(struct ws_set*, struct ws_set const*, struct ws_set const*)
+) {
+    struct ws_set* res = ws_set_new();
+    if (!res) {
+        return -ENOMEM;
+    }
+
+    int retval = 0;
+    union ws_value_union* it;
+    struct ws_set* set;
+
+    // iterate over all arguments, checking whether they are sets
+    ITERATE_ARGS_TYPE(it, args, set, set) {
+        // the first set is the initial value of the fold
+        if (it == args) {
+            retval = ws_set_union(res, res, set);
+        } else {
+            retval = op(res, res, set);
+        }
+
+        ws_object_unref(&set->obj);
+        if (retval < 0) {
+            goto out;
+        }
+    }
+
+    if (!AT_END(it) || (it == args)) {
+        retval = -EINVAL;
+        goto out;
+    }
+
+    ws_value_union_reinit(args, WS_VALUE_TYPE_SET);
+    ws_value_set_set(&args->set, res);
+
+out:
+    ws_object_unref(&res->obj);
+    return retval;
+}
@@ -62,12 +62,22 @@ ws_builtin_cmd_strcat(
 ) {
     union ws_value_union* it;
     struct ws_string* val;
-    struct ws_string* res = args->string.str;
+
+    if (ws_value_get_type(&args->value) != WS_VALUE_TYPE_STRING) {
+        return -EINVAL;
+    }
+
+    // the first argument may share its string with other values
+    struct ws_string* res = ws_value_string_get_mut(&args->string);
+    if (!res) {
+        return -ENOMEM;
+    }
 
     //iterate over all arguments, checking whether they are ws_value_strings
-    ITERATE_ARGS_TYPE(it, args, val, string) {
-        res = ws_string_cat(res, val);
-        if (!res) {
+    ITERATE_ARGS_TYPE(it, args + 1, val, string) {
+        struct ws_string* cat = ws_string_cat(res, val);
+        ws_object_unref(&val->obj);
+        if (!cat) {
             return -ENOMEM;
         }
     }
@@ -76,9 +86,6 @@ ws_builtin_cmd_strcat(
         return -EINVAL;
     }
 
-    ws_value_union_reinit(args, WS_VALUE_TYPE_STRING);
-    ws_value_string_set_str(&args->string, res);
-
     return 0;
 }
 
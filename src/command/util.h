@@ -73,6 +73,7 @@
 #define WS_VALUE_TYPE_string    WS_VALUE_TYPE_STRING
 #define WS_VALUE_TYPE_object_id WS_VALUE_TYPE_OBJECT_ID
 #define WS_VALUE_TYPE_set       WS_VALUE_TYPE_SET
+#define WS_VALUE_TYPE_array     WS_VALUE_TYPE_ARRAY
 
 
 /**
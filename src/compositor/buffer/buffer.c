@@ -64,7 +64,7 @@ ws_buffer_init(
     }
 
     ws_object_init(&self->obj);
-    self->obj.id = &WS_OBJECT_TYPE_ID_BUFFER.type;
+    ws_object_set_type(&self->obj, &WS_OBJECT_TYPE_ID_BUFFER.type);
 
     return 0;
 }
@@ -107,7 +107,8 @@ ws_egl_buffer_init(
     if (res < 0) {
         return res;
     }
-    self->buf.obj.id = (ws_object_type_id *) &WS_OBJECT_TYPE_ID_EGL_BUFFER;
+    ws_object_set_type(&self->buf.obj,
+                       (ws_object_type_id *) &WS_OBJECT_TYPE_ID_EGL_BUFFER);
 
     self->dev = getref(dev);
     if (!dev) {
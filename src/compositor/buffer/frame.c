@@ -97,7 +97,8 @@ ws_frame_buffer_new(
     struct ws_frame_buffer* tmp = calloc(1, sizeof(*tmp));
     ws_buffer_init(&tmp->obj.obj);
     tmp->obj.obj.obj.settings |= WS_OBJECT_HEAPALLOCED;
-    tmp->obj.obj.obj.id = (ws_object_type_id *) &WS_OBJECT_TYPE_ID_FRAME_BUFFER;
+    ws_object_set_type(&tmp->obj.obj.obj,
+                       (ws_object_type_id *) &WS_OBJECT_TYPE_ID_FRAME_BUFFER);
     tmp->fb_dev = fb_dev;
 
     struct drm_mode_create_dumb creq; //Create Request
@@ -134,7 +134,8 @@ ws_image_buffer_new(void)
     struct ws_image_buffer* tmp = calloc(1, sizeof(*tmp));
     ws_buffer_init(&tmp->raw.obj);
     tmp->raw.obj.obj.settings |= WS_OBJECT_HEAPALLOCED;
-    tmp->raw.obj.obj.id = (ws_object_type_id *)&WS_OBJECT_TYPE_ID_IMAGE_BUFFER;
+    ws_object_set_type(&tmp->raw.obj.obj,
+                       (ws_object_type_id *)&WS_OBJECT_TYPE_ID_IMAGE_BUFFER);
     return tmp;
 }
 
@@ -33,12 +33,14 @@
 #include "objects/object.h"
 #include "util/arithmetical.h"
 
+#include "action/observer.h"
 #include "compositor/buffer/frame.h"
 #include "compositor/cursor.h"
 #include "compositor/framebuffer_device.h"
 #include "compositor/keyboard.h"
 #include "compositor/internal_context.h"
 #include "compositor/monitor.h"
+#include "compositor/snapshot.h"
 #include "compositor/wayland/client.h"
 #include "compositor/wayland/pointer.h"
 #include "compositor/wayland/surface.h"
@@ -81,7 +83,7 @@ ws_cursor_new(
 ) {
     struct ws_cursor* self = calloc(1, sizeof(*self));
     ws_object_init((struct ws_object*) self);
-    self->obj.id = &WS_OBJECT_TYPE_ID_CURSOR;
+    ws_object_set_type(&self->obj, &WS_OBJECT_TYPE_ID_CURSOR);
     self->cur_fb_dev = dev;
     self->cursor_fb = ws_frame_buffer_new(dev, CURSOR_SIZE, CURSOR_SIZE);
     // We set the cursor to sane values
@@ -143,6 +145,8 @@ ws_cursor_set_active_surface(
 
     struct ws_surface* old_surface = self->active_surface;
     self->active_surface = nxt_surface;
+    ws_action_observer_notify(&self->obj, "active_surface");
+    ws_snapshot_invalidate();
 
     struct wl_display* display = ws_wayland_acquire_display();
     if (!display) {
@@ -38,10 +38,12 @@
 #include <wayland-server-protocol.h>
 #include <xkbcommon/xkbcommon.h>
 
+#include "action/observer.h"
 #include "objects/object.h"
 #include "objects/wayland_obj.h"
 #include "compositor/keyboard.h"
 #include "compositor/internal_context.h"
+#include "compositor/snapshot.h"
 #include "compositor/wayland/client.h"
 #include "compositor/wayland/keyboard.h"
 #include "util/wayland.h"
@@ -118,7 +120,7 @@ ws_keyboard_new(void)
 
     ws_object_init(&k->obj);
 
-    k->obj.id = &WS_OBJECT_TYPE_ID_KEYBOARD;
+    ws_object_set_type(&k->obj, &WS_OBJECT_TYPE_ID_KEYBOARD);
     k->obj.settings |= WS_OBJECT_HEAPALLOCED;
     k->active_surface = NULL;
 
@@ -452,6 +454,8 @@ ws_keyboard_set_active_surface(
     }
 
     self->active_surface = nxt_surface;
+    ws_action_observer_notify(&self->obj, "active_surface");
+    ws_snapshot_invalidate();
 
     if (self->active_surface) {
         ws_keyboard_send_keymap(self);
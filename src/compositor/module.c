@@ -43,6 +43,7 @@
 #include "compositor/keyboard.h"
 #include "compositor/monitor.h"
 #include "compositor/monitor_mode.h"
+#include "compositor/snapshot.h"
 #include "compositor/wayland/compositor.h"
 #include "compositor/wayland/seat.h"
 #include "compositor/wayland/shell.h"
@@ -240,6 +241,12 @@ ws_compositor_init(void) {
 
     ws_comp_ctx.keyboard = ws_keyboard_new();
 
+    // clients may still query the state via IPC if this fails
+    retval = ws_snapshot_init();
+    if (retval < 0) {
+        ws_log(&log_ctx, LOG_WARNING, "Could not publish state snapshot");
+    }
+
     is_init = true;
     return 0;
 
@@ -41,6 +41,7 @@
 #include "compositor/framebuffer_device.h"
 #include "compositor/internal_context.h"
 #include "compositor/monitor.h"
+#include "compositor/snapshot.h"
 #include "logger/module.h"
 #include "objects/object.h"
 #include "util/wayland.h"
@@ -110,7 +111,7 @@ ws_monitor_new(
 ) {
     struct ws_monitor* tmp = calloc(1, sizeof(*tmp));
     ws_object_init((struct ws_object*) tmp);
-    tmp->obj.id = &WS_OBJECT_TYPE_ID_MONITOR;
+    ws_object_set_type(&tmp->obj, &WS_OBJECT_TYPE_ID_MONITOR);
     tmp->obj.settings |= WS_OBJECT_HEAPALLOCED;
 
     // initialize members
@@ -206,6 +207,7 @@ ws_monitor_set_mode_with_id(
     if (!self->current_mode) {
         return;
     }
+    ws_snapshot_invalidate();
 
     if (!self->resource) {
         ws_log(&log_ctx, LOG_DEBUG, "Did not publish mode.");
@@ -75,7 +75,7 @@ ws_monitor_mode_new(
 ) {
     struct ws_monitor_mode* tmp = calloc(1, sizeof(*tmp));
     ws_object_init((struct ws_object*) tmp);
-    tmp->obj.id = &WS_OBJECT_TYPE_ID_MONITOR_MODE;
+    ws_object_set_type(&tmp->obj, &WS_OBJECT_TYPE_ID_MONITOR_MODE);
     tmp->obj.settings |= WS_OBJECT_HEAPALLOCED;
 
     return tmp;
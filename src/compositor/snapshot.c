@@ -0,0 +1,394 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <ev.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "compositor/cursor.h"
+#include "compositor/internal_context.h"
+#include "compositor/keyboard.h"
+#include "compositor/monitor.h"
+#include "compositor/monitor_mode.h"
+#include "compositor/snapshot.h"
+#include "compositor/wayland/surface.h"
+#include "logger/module.h"
+#include "objects/object.h"
+#include "objects/set.h"
+#include "util/cleaner.h"
+#include "util/socket.h"
+
+#define SNAPSHOT_SOCK_NAME "waysome-snapshot.sock"
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Create, map and seal the memfd holding the snapshot
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+static int
+create_shared_memory(void);
+
+/**
+ * Write the current state into the snapshot
+ */
+static void
+write_snapshot(void);
+
+/**
+ * Fill in the geometry of a surface
+ */
+static void
+fill_surface(
+    struct ws_snapshot_surface* dest, //!< destination
+    struct ws_surface* surface //!< surface, may be `NULL`
+);
+
+/**
+ * Append a monitor to a state, if it is connected
+ *
+ * @return 0
+ */
+static int
+append_monitor(
+    void* etc, //!< the state
+    void const* mon //!< the monitor
+);
+
+/**
+ * Watcher callback: update the snapshot if it was marked as outdated
+ */
+static void
+update_snapshot(
+    struct ev_loop* loop,
+    ev_async* watcher,
+    int revents
+);
+
+/**
+ * Callback for the socket: send the snapshot to a client
+ *
+ * @return zero on success, else negative errno.h number
+ */
+static int
+send_snapshot(
+    int fd //!< connection to the client
+);
+
+/**
+ * Deinit function
+ */
+static void
+snapshot_deinit(
+    void* dummy
+);
+
+/*
+ *
+ * Internal variables
+ *
+ */
+
+static struct {
+    struct ws_snapshot* shared; //!< writable mapping of the memfd
+    int fd; //!< the memfd
+    bool dirty; //!< whether an update is pending
+    ev_async updater; //!< watcher updating the snapshot
+    struct ws_socket sock; //!< socket handing out the memfd
+} snapshot_ctx = {
+    .shared = NULL,
+    .fd = -1,
+    .dirty = false,
+};
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_snapshot_init(void) {
+    static bool is_init = false;
+    if (is_init) {
+        return 0;
+    }
+
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    if (!loop) {
+        return -ENOTSUP;
+    }
+
+    int res = create_shared_memory();
+    if (res < 0) {
+        return res;
+    }
+    write_snapshot();
+
+    ev_async_init(&snapshot_ctx.updater, update_snapshot);
+    ev_async_start(loop, &snapshot_ctx.updater);
+
+    // `20` is the hardcoded backlog by now
+    res = ws_socket_init(&snapshot_ctx.sock, send_snapshot, SNAPSHOT_SOCK_NAME,
+                         20);
+    if (res < 0) {
+        ev_async_stop(loop, &snapshot_ctx.updater);
+        munmap(snapshot_ctx.shared, sizeof(*snapshot_ctx.shared));
+        close(snapshot_ctx.fd);
+        snapshot_ctx.shared = NULL;
+        snapshot_ctx.fd = -1;
+        return res;
+    }
+
+    ws_cleaner_add(snapshot_deinit, NULL);
+
+    is_init = true;
+    return 0;
+}
+
+void
+ws_snapshot_invalidate(void) {
+    if (!__atomic_load_n(&snapshot_ctx.shared, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    // the watcher only needs to be signalled once per update
+    if (!__atomic_exchange_n(&snapshot_ctx.dirty, true, __ATOMIC_ACQ_REL)) {
+        ev_async_send(ev_default_loop(EVFLAG_AUTO), &snapshot_ctx.updater);
+    }
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static int
+create_shared_memory(void) {
+    int fd = memfd_create("waysome-snapshot", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    int res;
+    if (ftruncate(fd, sizeof(*snapshot_ctx.shared)) < 0) {
+        res = -errno;
+        goto cleanup_fd;
+    }
+
+    struct ws_snapshot* shared = mmap(NULL, sizeof(*shared),
+                                      PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                                      0);
+    if (shared == MAP_FAILED) {
+        res = -errno;
+        goto cleanup_fd;
+    }
+
+    memset(shared, 0, sizeof(*shared));
+    shared->magic = WS_SNAPSHOT_MAGIC;
+    shared->version = WS_SNAPSHOT_VERSION;
+
+    // Our own mapping stays writable, but clients can't resize the memfd or
+    // map it writable. Older kernels don't know about the latter.
+    int seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL;
+#ifdef F_SEAL_FUTURE_WRITE
+    if (fcntl(fd, F_ADD_SEALS, seals | F_SEAL_FUTURE_WRITE) == 0) {
+        goto sealed;
+    }
+    ws_log(&log_ctx, LOG_WARNING, "Snapshot can't be sealed against writes");
+#endif
+    if (fcntl(fd, F_ADD_SEALS, seals) < 0) {
+        res = -errno;
+        munmap(shared, sizeof(*shared));
+        goto cleanup_fd;
+    }
+
+#ifdef F_SEAL_FUTURE_WRITE
+sealed:
+#endif
+    snapshot_ctx.fd = fd;
+    __atomic_store_n(&snapshot_ctx.shared, shared, __ATOMIC_RELEASE);
+    return 0;
+
+cleanup_fd:
+    close(fd);
+    return res;
+}
+
+static void
+write_snapshot(void) {
+    struct ws_snapshot_state state;
+    memset(&state, 0, sizeof(state));
+
+    if (ws_comp_ctx.keyboard) {
+        fill_surface(&state.keyboard_focus,
+                     ws_comp_ctx.keyboard->active_surface);
+    }
+    if (ws_comp_ctx.cursor) {
+        fill_surface(&state.pointer_focus, ws_comp_ctx.cursor->active_surface);
+    }
+    ws_set_select(&ws_comp_ctx.monitors, NULL, NULL, append_monitor, &state);
+
+    // Readers tell changes by the sequence number, so it's only bumped if
+    // the state actually changed.
+    struct ws_snapshot* shared = snapshot_ctx.shared;
+    if (memcmp(&shared->state, &state, sizeof(state)) == 0) {
+        return;
+    }
+
+    // Readers retry while the sequence number is odd or changed while they
+    // copied the state.
+    uint32_t seq = shared->seq;
+    __atomic_store_n(&shared->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&shared->state, &state, sizeof(state));
+    __atomic_store_n(&shared->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+static void
+fill_surface(
+    struct ws_snapshot_surface* dest,
+    struct ws_surface* surface
+) {
+    if (!surface) {
+        return;
+    }
+
+    dest->uuid = ws_object_uuid((struct ws_object*) surface);
+    dest->x = surface->x;
+    dest->y = surface->y;
+    dest->width = surface->width;
+    dest->height = surface->height;
+}
+
+static int
+append_monitor(
+    void* etc,
+    void const* mon
+) {
+    struct ws_snapshot_state* state = (struct ws_snapshot_state*) etc;
+    struct ws_monitor const* monitor = (struct ws_monitor const*) mon;
+
+    if (!monitor->connected || !monitor->current_mode ||
+            (state->num_monitors >= WS_SNAPSHOT_MAX_MONITORS)) {
+        return 0;
+    }
+
+    struct ws_snapshot_monitor* dest = state->monitors + state->num_monitors++;
+    dest->id = monitor->id;
+    dest->width = monitor->current_mode->mode.hdisplay;
+    dest->height = monitor->current_mode->mode.vdisplay;
+    dest->refresh = monitor->current_mode->mode.vrefresh;
+    dest->phys_width = monitor->phys_width;
+    dest->phys_height = monitor->phys_height;
+    return 0;
+}
+
+static void
+update_snapshot(
+    struct ev_loop* loop,
+    ev_async* watcher,
+    int revents
+) {
+    if (__atomic_exchange_n(&snapshot_ctx.dirty, false, __ATOMIC_ACQ_REL)) {
+        write_snapshot();
+    }
+}
+
+static int
+send_snapshot(
+    int fd
+) {
+    struct ws_snapshot_handshake handshake = {
+        .magic = WS_SNAPSHOT_MAGIC,
+        .version = WS_SNAPSHOT_VERSION,
+        .size = sizeof(*snapshot_ctx.shared),
+    };
+    struct iovec iov = {
+        .iov_base = &handshake,
+        .iov_len = sizeof(handshake),
+    };
+
+    // the memfd is passed as ancillary data
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    struct msghdr msg = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control.buf,
+        .msg_controllen = sizeof(control.buf),
+    };
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &snapshot_ctx.fd, sizeof(int));
+
+    if (sendmsg(fd, &msg, MSG_NOSIGNAL) < 0) {
+        return -errno;
+    }
+
+    // the client doesn't need the connection any more
+    close(fd);
+    return 0;
+}
+
+static void
+snapshot_deinit(
+    void* dummy
+) {
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    if (loop) {
+        ev_async_stop(loop, &snapshot_ctx.updater);
+    }
+    ws_socket_deinit(&snapshot_ctx.sock);
+
+    struct ws_snapshot* shared = snapshot_ctx.shared;
+    __atomic_store_n(&snapshot_ctx.shared, NULL, __ATOMIC_RELEASE);
+    munmap(shared, sizeof(*shared));
+    close(snapshot_ctx.fd);
+    snapshot_ctx.fd = -1;
+}
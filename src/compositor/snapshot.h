@@ -0,0 +1,191 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup compositor "Compositor"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup compositor_snapshot "Compositor state snapshot"
+ *
+ * @{
+ *
+ * Read-only snapshot of the compositor state shared with clients
+ *
+ * Many clients only read the state of the compositor, e.g. the focused
+ * surfaces or the modes of the monitors. The compositor publishes this state
+ * in a memfd, which clients map read-only.
+ *
+ * Clients connect to the socket `waysome-snapshot.sock`, which sends them a
+ * `struct ws_snapshot_handshake` along with the file descriptor of the memfd
+ * and closes the connection. The memfd is sealed against resizing and, where
+ * supported, against new writable mappings.
+ *
+ * The snapshot is protected by a sequence lock: its sequence number is odd
+ * while the compositor updates it. Clients copy the state using
+ * `ws_snapshot_read()`, which retries until it got a consistent copy, without
+ * a single syscall.
+ *
+ * After `ws_snapshot_invalidate()` was called, the snapshot is updated once,
+ * in the next main loop iteration, if the state changed at all.
+ */
+
+#ifndef __WS_COMPOSITOR_SNAPSHOT_H__
+#define __WS_COMPOSITOR_SNAPSHOT_H__
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Magic number identifying a snapshot
+ */
+#define WS_SNAPSHOT_MAGIC (0x57534e50)
+
+/**
+ * Version of the layout of the snapshot
+ */
+#define WS_SNAPSHOT_VERSION (1)
+
+/**
+ * Maximum number of monitors in a snapshot
+ */
+#define WS_SNAPSHOT_MAX_MONITORS (16)
+
+/**
+ * Geometry of a surface in a snapshot
+ */
+struct ws_snapshot_surface {
+    uint64_t uuid; //!< uuid of the surface, `0` if there is no surface
+    int32_t x; //!< x position of the surface
+    int32_t y; //!< y position of the surface
+    int32_t width; //!< width of the surface
+    int32_t height; //!< height of the surface
+};
+
+/**
+ * Monitor in a snapshot
+ */
+struct ws_snapshot_monitor {
+    uint32_t id; //!< id of the monitor relative to the framebuffer device
+    int32_t width; //!< horizontal resolution of the current mode
+    int32_t height; //!< vertical resolution of the current mode
+    uint32_t refresh; //!< refresh rate of the current mode, in Hz
+    int32_t phys_width; //!< physical width, in mm
+    int32_t phys_height; //!< physical height, in mm
+};
+
+/**
+ * State of the compositor in a snapshot
+ */
+struct ws_snapshot_state {
+    struct ws_snapshot_surface keyboard_focus; //!< surface with keyboard focus
+    struct ws_snapshot_surface pointer_focus; //!< surface under the cursor
+    uint32_t num_monitors; //!< number of connected monitors
+    uint32_t reserved; //!< reserved, always `0`
+    /** connected monitors, the first `num_monitors` are valid */
+    struct ws_snapshot_monitor monitors[WS_SNAPSHOT_MAX_MONITORS];
+};
+
+/**
+ * Layout of the shared memory
+ */
+struct ws_snapshot {
+    uint32_t magic; //!< `WS_SNAPSHOT_MAGIC`
+    uint32_t version; //!< `WS_SNAPSHOT_VERSION`
+    uint32_t seq; //!< sequence number, odd while the state is updated
+    uint32_t reserved; //!< reserved, always `0`
+    struct ws_snapshot_state state; //!< the state, guarded by `seq`
+};
+
+/**
+ * Message sent along with the file descriptor of the snapshot
+ */
+struct ws_snapshot_handshake {
+    uint32_t magic; //!< `WS_SNAPSHOT_MAGIC`
+    uint32_t version; //!< `WS_SNAPSHOT_VERSION`
+    uint64_t size; //!< size of the memory to map
+};
+
+/**
+ * Initialize the snapshot and the socket handing it out
+ *
+ * @warning must be called from the main loop, after the compositor was
+ *          initialized
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+int
+ws_snapshot_init(void);
+
+/**
+ * Mark the snapshot as outdated
+ *
+ * @note called whenever a part of the state in the snapshot changed. This
+ *       function is safe to call from any thread.
+ */
+void
+ws_snapshot_invalidate(void);
+
+/**
+ * Read a consistent copy of the state from a snapshot
+ *
+ * This function is meant to be used by clients on their read-only mapping.
+ *
+ * @return the sequence number of the copy, which only changes if the state
+ *         changed
+ */
+static inline uint32_t
+ws_snapshot_read(
+    struct ws_snapshot const* shared, //!< the snapshot mapped
+    struct ws_snapshot_state* dest //!< destination of the copy
+) {
+    while (1) {
+        uint32_t seq = __atomic_load_n(&shared->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            continue;
+        }
+
+        memcpy(dest, &shared->state, sizeof(*dest));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&shared->seq, __ATOMIC_RELAXED) == seq) {
+            return seq;
+        }
+    }
+}
+
+#endif // __WS_COMPOSITOR_SNAPSHOT_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -29,6 +29,8 @@
 #include <wayland-server.h>
 #include <wayland-server-protocol.h>
 
+#include "action/observer.h"
+#include "compositor/snapshot.h"
 #include "compositor/wayland/abstract_shell_surface.h"
 #include "compositor/wayland/surface.h"
 #include "values/union.h"
@@ -143,7 +145,8 @@ ws_abstract_shell_surface_init(
     if (retval < 0) {
         return retval;
     }
-    self->wl_obj.obj.id = &WS_OBJECT_TYPE_ID_ABSTRACT_SHELL_SURFACE;
+    ws_object_set_type(&self->wl_obj.obj,
+                       &WS_OBJECT_TYPE_ID_ABSTRACT_SHELL_SURFACE);
 
     // initialize the remaining members
     self->surface = getref(surface);
@@ -184,7 +187,12 @@ ws_abstract_shell_surface_set_width(
         return -EINVAL;
     }
 
-    s->width = width;
+    // observers are only interested in actual changes
+    if (s->width != width) {
+        s->width = width;
+        ws_action_observer_notify((struct ws_object*) s, "width");
+        ws_snapshot_invalidate();
+    }
 
     struct wl_resource* r = ws_wayland_obj_get_wl_resource(&s->wl_obj);
     if (!r) {
@@ -206,7 +214,12 @@ ws_abstract_shell_surface_set_height(
         return -EINVAL;
     }
 
-    s->height = height;
+    // observers are only interested in actual changes
+    if (s->height != height) {
+        s->height = height;
+        ws_action_observer_notify((struct ws_object*) s, "height");
+        ws_snapshot_invalidate();
+    }
 
     struct wl_resource* r = ws_wayland_obj_get_wl_resource(&s->wl_obj);
     if (!r) {
@@ -229,8 +242,21 @@ ws_abstract_shell_surface_set_width_and_height(
         return -EINVAL;
     }
 
-    s->width = width;
-    s->height = height;
+    // observers are only interested in actual changes
+    bool changed = false;
+    if (s->width != width) {
+        s->width = width;
+        ws_action_observer_notify((struct ws_object*) s, "width");
+        changed = true;
+    }
+    if (s->height != height) {
+        s->height = height;
+        ws_action_observer_notify((struct ws_object*) s, "height");
+        changed = true;
+    }
+    if (changed) {
+        ws_snapshot_invalidate();
+    }
 
     struct wl_resource* r = ws_wayland_obj_get_wl_resource(&s->wl_obj);
     if (!r) {
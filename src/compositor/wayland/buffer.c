@@ -177,14 +177,14 @@ ws_wayland_buffer_init(
     }
 
     ws_wayland_obj_init(&self->wl_obj, r);
-    self->wl_obj.obj.id = &WS_OBJECT_TYPE_ID_WAYLAND_BUFFER;
+    ws_object_set_type(&self->wl_obj.obj, &WS_OBJECT_TYPE_ID_WAYLAND_BUFFER);
 
     // initialize members
     int retval = ws_buffer_init(&self->buf);
     if (retval < 0) {
         return retval;
     }
-    self->buf.obj.id = &buffer_type.type;
+    ws_object_set_type(&self->buf.obj, &buffer_type.type);
 
     return 0;
 }
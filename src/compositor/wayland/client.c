@@ -90,7 +90,7 @@ ws_wayland_client_get(
     struct ws_wayland_client dum;
     memset(&dum, 0, sizeof(dum));
     ws_object_init((struct ws_object*) &dum);
-    dum.obj.id = &WS_OBJECT_TYPE_ID_WAYLAND_CLIENT;
+    ws_object_set_type(&dum.obj, &WS_OBJECT_TYPE_ID_WAYLAND_CLIENT);
     dum.client = c;
 
     struct ws_wayland_client* found = (struct ws_wayland_client*) ws_set_get(
@@ -108,7 +108,7 @@ ws_wayland_client_get(
         return NULL;
     }
     ws_object_init(&self->obj);
-    self->obj.id = &WS_OBJECT_TYPE_ID_WAYLAND_CLIENT;
+    ws_object_set_type(&self->obj, &WS_OBJECT_TYPE_ID_WAYLAND_CLIENT);
 
     // initialize members
 
@@ -105,7 +105,7 @@ ws_wayland_keyboard_new(
                                    resource_destroy);
 
     ws_wayland_obj_init(&k->wl_obj, resource);
-    k->wl_obj.obj.id = &WS_OBJECT_TYPE_ID_WAYLAND_KEYBOARD;
+    ws_object_set_type(&k->wl_obj.obj, &WS_OBJECT_TYPE_ID_WAYLAND_KEYBOARD);
 
     if (version >= 4) {
         wl_keyboard_send_repeat_info(resource, 500, 20);
@@ -151,7 +151,7 @@ ws_wayland_pointer_new(
                                    resource_destroy);
 
     ws_wayland_obj_init(&self->wl_obj, resource);
-    self->wl_obj.obj.id = &WS_OBJECT_TYPE_ID_WAYLAND_POINTER;
+    ws_object_set_type(&self->wl_obj.obj, &WS_OBJECT_TYPE_ID_WAYLAND_POINTER);
 
     return self;
 
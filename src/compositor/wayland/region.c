@@ -150,7 +150,7 @@ ws_region_new(
 
     // finish the initialisation
     ws_wayland_obj_init(&self->wl_obj, resource);
-    self->wl_obj.obj.id = &WS_OBJECT_TYPE_ID_REGION;
+    ws_object_set_type(&self->wl_obj.obj, &WS_OBJECT_TYPE_ID_REGION);
 
     // set the implementation
     wl_resource_set_implementation(resource, &interface,
@@ -273,7 +273,8 @@ ws_shell_surface_new(
     if (retval < 0) {
         goto cleanup_resource;
     }
-    self->shell.wl_obj.obj.id = &WS_OBJECT_TYPE_ID_SHELL_SURFACE;
+    ws_object_set_type(&self->shell.wl_obj.obj,
+                       &WS_OBJECT_TYPE_ID_SHELL_SURFACE);
 
     return self;
 
@@ -34,6 +34,7 @@
 
 #include "compositor/internal_context.h"
 #include "compositor/monitor.h"
+#include "compositor/snapshot.h"
 #include "compositor/wayland/client.h"
 #include "compositor/wayland/region.h"
 #include "compositor/wayland/surface.h"
@@ -257,7 +258,7 @@ ws_surface_new(
 
     // finish the initialisation
     ws_wayland_obj_init(&self->wl_obj, resource);
-    self->wl_obj.obj.id = &WS_OBJECT_TYPE_ID_SURFACE;
+    ws_object_set_type(&self->wl_obj.obj, &WS_OBJECT_TYPE_ID_SURFACE);
 
     // initialize the members
     ws_wayland_buffer_init(&self->img_buf, NULL);
@@ -320,6 +321,7 @@ surface_attach_cb(
 
     self->x = x;
     self->y = y;
+    ws_snapshot_invalidate();
 }
 
 static void
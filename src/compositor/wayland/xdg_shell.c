@@ -163,7 +163,7 @@ ws_wayland_xdg_shell_new(
         return NULL;
     }
 
-    self->wl_obj.obj.id = &WS_OBJECT_TYPE_ID_WAYLAND_XDG_SHELL;
+    ws_object_set_type(&self->wl_obj.obj, &WS_OBJECT_TYPE_ID_WAYLAND_XDG_SHELL);
 
     return self;
 }
@@ -130,6 +130,11 @@ ws_connector_flush(
     size_t used_mem = self->outbuf.data;
     int res;
 
+    if (!used_mem) {
+        // nothing to flush
+        return 0;
+    }
+
     res = write(self->fd, self->outbuf.buffer, used_mem);
     if (res < 0 ) {
         return -errno;
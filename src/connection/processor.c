@@ -38,6 +38,14 @@
 #include "serialize/deserializer.h"
 #include "serialize/serializer.h"
 
+/**
+ * Maximum number of messages queued per connection
+ *
+ * Messages are queued until their reply was sent. Once this many messages are
+ * queued, we stop reading from the connection.
+ */
+#define CONNECTION_MAX_PENDING (64)
+
 /*
  *
  * Forward declarations
@@ -81,6 +89,67 @@ connection_processor_flush_msg(
     struct ws_message* message
 );
 
+/**
+ * Deserialize and queue the messages received
+ *
+ * The messages are queued until too many messages are pending. Reading from
+ * the connection is stopped or resumed accordingly.
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+static int
+connection_processor_consume(
+    struct ws_connection_processor* proc
+);
+
+/**
+ * Queue a slot for the reply to a message
+ *
+ * @return the slot or `NULL`, if no slot could be allocated
+ */
+static struct ws_connection_reply*
+connection_processor_queue_reply(
+    struct ws_connection_processor* proc
+);
+
+/**
+ * Submit the messages queued, one at a time
+ *
+ * A message is only submitted once the previous one was processed.
+ */
+static void
+connection_processor_advance(
+    struct ws_connection_processor* proc
+);
+
+/**
+ * Reply callback: fill a reply slot
+ */
+static void
+connection_processor_reply_done(
+    struct ws_reply* reply, //!< reply to the message
+    void* data //!< the slot for the reply
+);
+
+/**
+ * Send the replies available, in order
+ *
+ * @return 0 if all the replies available were flushed, a negative error
+ *         code on failure, especially `-EAGAIN` if we have to try again later
+ */
+static int
+connection_processor_flush_replies(
+    struct ws_connection_processor* proc
+);
+
+/**
+ * Close the connection and stop all the watchers
+ */
+static void
+connection_processor_close(
+    struct ws_connection_processor* proc
+);
+
 /**
  * Deinitialize a command processor
  */
@@ -139,7 +208,7 @@ ws_connection_processor_new(
     if (!ws_object_init(&retval->obj)) {
         goto cleanup_mem;
     }
-    retval->obj.id = &WS_OBJECT_TYPE_ID_COMMAND_PROCESSOR;
+    ws_object_set_type(&retval->obj, &WS_OBJECT_TYPE_ID_COMMAND_PROCESSOR);
     retval->obj.settings |= WS_OBJECT_HEAPALLOCED;
 
     int res;
@@ -160,6 +229,15 @@ ws_connection_processor_new(
     retval->deserializer    = deserializer;
     retval->serializer      = serializer;
 
+    // no replies are pending
+    retval->replies         = NULL;
+    retval->replies_tail    = &retval->replies;
+    retval->submit          = NULL;
+    retval->num_queued      = 0;
+    retval->running         = false;
+    retval->advancing       = false;
+    retval->eof             = false;
+
     // now get the libev loop
     struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
     if (!loop) {
@@ -175,11 +253,10 @@ ws_connection_processor_new(
     retval->dispatcher.data = retval;
     ev_io_start(loop, &retval->dispatcher);
 
-    if (serializer) {
-        ev_prepare_init(&retval->flusher, connection_processor_flush);
-        retval->flusher.data    = retval;
-        ev_prepare_start(loop, &retval->flusher);
-    }
+    // even without a serializer, the replies have to be dropped in order
+    ev_prepare_init(&retval->flusher, connection_processor_flush);
+    retval->flusher.data    = retval;
+    ev_prepare_start(loop, &retval->flusher);
 
     // mark the object as initialized
     retval->is_init = true;
@@ -219,7 +296,7 @@ connection_processor_dispatch(
 
     // if we intend to reply to the messages, we should first check this
     if (proc->serializer) {
-        res = connection_processor_flush_msg(proc, NULL);
+        res = connection_processor_flush_replies(proc);
         if ((res < 0) && (res != -EAGAIN) && (res != -EINTR)) {
             goto deinit;
         }
@@ -231,67 +308,37 @@ connection_processor_dispatch(
         goto error_handling;
     }
 
-    struct ws_message* msg = NULL;
-    while (1) {
-        // deserialize a message
-        //!< @todo use getters as soon as they are available
-        res =  ws_deserialize(proc->deserializer, &msg,
-                              proc->conn.inbuf.buffer, proc->conn.inbuf.data);
-        if (res < 0) {
-            break;
-        }
-        res = ws_connbuf_discard(&proc->conn.inbuf, res);
-        if (res < 0) {
-            break;
-        }
-
-        // handle the message
-        if (!msg) {
-            // nothing to do!
-            ws_object_unlock(&proc->obj);
-            return;
-        }
-
-        // pass the message to the transaction manager
-        struct ws_reply* reply = ws_action_manager_process(msg);
-        ws_object_unref((struct ws_object*) msg);
-        if (!reply) {
-            // reply being `NULL` can have a number of reasons
-            continue;
-        }
-
-        // check whether we _can_ send a reply
-        if (!proc->serializer) {
-            // nope, we can't
-            ws_object_unref((struct ws_object*) reply);
-            continue;
-        }
-
-        // flush the buffer
-        res = connection_processor_flush_msg(proc, (struct ws_message*) reply);
-        if (res < 0) {
-            break;
-        }
+    res = connection_processor_consume(proc);
+    if (res == 0) {
+        ws_object_unlock(&proc->obj);
+        return;
     }
 
 error_handling:
-    switch(-res) {
+    switch(res) {
     case -EAGAIN:
     case -EINTR:
         // we have to come back later
         ws_object_unlock(&proc->obj);
         return;
 
+    case EOF:
+        // we reached the end of file, but the replies pending are still sent
+        if (proc->replies) {
+            proc->eof = true;
+            ev_io_stop(loop, watcher);
+            ws_object_unlock(&proc->obj);
+            return;
+        }
+        break;
+
     default:
         //!< @todo report an error
-
-    case EOF:
-        // we reached the end of file
         ;
     }
 
 deinit:
-    connection_processor_deinit(&proc->obj);
+    connection_processor_close(proc);
     ws_object_unlock(&proc->obj);
     ws_object_unref(&proc->obj);
 }
@@ -307,17 +354,35 @@ connection_processor_flush(
 
     // try to lock the object
     if (ws_object_lock_try_write(&proc->obj) != 0) {
-        goto unlock;
+        return;
     }
 
     // flush the buffer
-    int res = connection_processor_flush_msg(proc, NULL);
-    if ((res == 0) || (res == -EAGAIN) || (res == -EINTR)) {
+    int res = connection_processor_flush_replies(proc);
+    if ((res < 0) && (res != -EAGAIN) && (res != -EINTR)) {
+        goto close_connection;
+    }
+
+    // once the peer stopped sending, we only wait for the replies to be sent
+    if (proc->eof) {
+        if ((res == 0) && !proc->replies) {
+            goto close_connection;
+        }
+        goto unlock;
+    }
+
+    // messages may have been held back because too many were queued
+    if (!proc->is_init || ev_is_active(&proc->dispatcher)) {
+        goto unlock;
+    }
+    res = connection_processor_consume(proc);
+    if (res == 0) {
         goto unlock;
     }
 
+close_connection:
     //!< @todo: error handling
-    connection_processor_deinit(&proc->obj);
+    connection_processor_close(proc);
     ws_object_unlock(&proc->obj);
     ws_object_unref(&proc->obj);
     return;
@@ -347,6 +412,9 @@ connection_processor_flush_msg(
             break;
         }
 
+        // the serializer holds the message until it's written completely
+        message = NULL;
+
         // communicate the changes to the buffer
         res = ws_connbuf_append(&proc->conn.outbuf, res);
         if (res < 0) {
@@ -355,22 +423,194 @@ connection_processor_flush_msg(
 
         // flush
         res = ws_connector_flush(&proc->conn);
-    } while (res == 0);
+    } while ((res == 0) && proc->serializer->buffer);
     return res;
 }
 
-bool
-connection_processor_deinit(
-    struct ws_object * obj
+static int
+connection_processor_consume(
+    struct ws_connection_processor* proc
 ) {
-    struct ws_connection_processor* proc = (struct ws_connection_processor*) obj;
+    int res;
+
+    while (proc->num_queued < CONNECTION_MAX_PENDING) {
+        // deserialize a message
+        //!< @todo use getters as soon as they are available
+        struct ws_message* msg = NULL;
+        res =  ws_deserialize(proc->deserializer, &msg,
+                              proc->conn.inbuf.buffer, proc->conn.inbuf.data);
+        if (res < 0) {
+            return res;
+        }
+        if (res > 0) {
+            res = ws_connbuf_discard(&proc->conn.inbuf, res);
+            if (res < 0) {
+                return res;
+            }
+        }
+
+        if (!msg) {
+            // we need more input
+            break;
+        }
+
+        // reserve a place in the line, the slot takes over the message
+        struct ws_connection_reply* slot;
+        slot = connection_processor_queue_reply(proc);
+        if (!slot) {
+            ws_object_unref((struct ws_object*) msg);
+            return -ENOMEM;
+        }
+        slot->msg = msg;
+        if (!proc->submit) {
+            proc->submit = slot;
+        }
+
+        // the reply may arrive later
+        connection_processor_advance(proc);
+
+        // flush the buffer
+        res = connection_processor_flush_replies(proc);
+        if ((res < 0) && (res != -EAGAIN) && (res != -EINTR)) {
+            return res;
+        }
+    }
 
+    // only read more input if we are able to queue it
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    if (loop) {
+        if (proc->num_queued < CONNECTION_MAX_PENDING) {
+            ev_io_start(loop, &proc->dispatcher);
+        } else {
+            ev_io_stop(loop, &proc->dispatcher);
+        }
+    }
+
+    return 0;
+}
+
+static struct ws_connection_reply*
+connection_processor_queue_reply(
+    struct ws_connection_processor* proc
+) {
+    struct ws_connection_reply* slot = calloc(1, sizeof(*slot));
+    if (!slot) {
+        return NULL;
+    }
+
+    // the slot keeps the processor alive until it's filled
+    slot->proc = getref(proc);
+    if (!slot->proc) {
+        free(slot);
+        return NULL;
+    }
+
+    *proc->replies_tail = slot;
+    proc->replies_tail = &slot->next;
+    ++proc->num_queued;
+    return slot;
+}
+
+static void
+connection_processor_advance(
+    struct ws_connection_processor* proc
+) {
+    // replies passed while we submit are handled by the loop below
+    if (proc->advancing) {
+        return;
+    }
+    proc->advancing = true;
+
+    // a closed connection does not submit anything
+    while (proc->is_init && !proc->running && proc->submit) {
+        struct ws_connection_reply* slot = proc->submit;
+        proc->submit = slot->next;
+
+        struct ws_message* msg = slot->msg;
+        slot->msg = NULL;
+
+        proc->running = true;
+        (void) ws_action_manager_submit(msg, connection_processor_reply_done,
+                                        slot);
+        ws_object_unref((struct ws_object*) msg);
+    }
+
+    proc->advancing = false;
+}
+
+static void
+connection_processor_reply_done(
+    struct ws_reply* reply,
+    void* data
+) {
+    struct ws_connection_reply* slot = (struct ws_connection_reply*) data;
+    struct ws_connection_processor* proc = slot->proc;
+
+    slot->reply = reply;
+    slot->done = true;
+
+    // the next message may be processed now
+    proc->running = false;
+    connection_processor_advance(proc);
+
+    // the slot may be freed together with the processor
+    ws_object_unref(&proc->obj);
+}
+
+static int
+connection_processor_flush_replies(
+    struct ws_connection_processor* proc
+) {
+    int res = 0;
+    if (proc->serializer) {
+        res = connection_processor_flush_msg(proc, NULL);
+    }
+
+    // we stop at the first message which was not processed yet
+    while ((res == 0) && proc->replies && proc->replies->done) {
+        struct ws_connection_reply* slot = proc->replies;
+        proc->replies = slot->next;
+        if (!proc->replies) {
+            proc->replies_tail = &proc->replies;
+        }
+        --proc->num_queued;
+
+        if (slot->reply) {
+            // the serializer is idle, so it will take the reply, replies on a
+            // read-only connection are dropped
+            if (proc->serializer) {
+                res = connection_processor_flush_msg(proc,
+                                                     (struct ws_message*)
+                                                     slot->reply);
+            }
+            ws_object_unref((struct ws_object*) slot->reply);
+        }
+        free(slot);
+    }
+
+    return res;
+}
+
+static void
+connection_processor_close(
+    struct ws_connection_processor* proc
+) {
     if (!proc->is_init) {
-        return true;
+        return;
     }
 
     proc->is_init = false;
 
+    // the messages not submitted yet are at the end of the queue, drop them
+    struct ws_connection_reply* dropped = proc->submit;
+    proc->submit = NULL;
+    struct ws_connection_reply** link = &proc->replies;
+    while (*link != dropped) {
+        link = &(*link)->next;
+    }
+    *link = NULL;
+    proc->replies_tail = link;
+
     ws_connector_deinit(&proc->conn);
 
     ws_deserializer_deinit(proc->deserializer);
@@ -380,14 +620,43 @@ connection_processor_deinit(
 
     // now get the libev loop
     struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
-    if (!loop) {
-        return true;
+    if (loop) {
+        ev_io_stop(loop, &proc->dispatcher);
+        ev_prepare_stop(loop, &proc->flusher);
     }
 
-    ev_io_stop(loop, &proc->dispatcher);
-    if (proc->serializer) {
-        ev_prepare_start(loop, &proc->flusher);
+    // each of the dropped slots holds a reference, the caller holds one, too
+    while (dropped) {
+        struct ws_connection_reply* slot = dropped;
+        dropped = slot->next;
+        --proc->num_queued;
+
+        ws_object_unref((struct ws_object*) slot->msg);
+        free(slot);
+        ws_object_unref(&proc->obj);
+    }
+}
+
+bool
+connection_processor_deinit(
+    struct ws_object * obj
+) {
+    struct ws_connection_processor* proc = (struct ws_connection_processor*) obj;
+
+    connection_processor_close(proc);
+
+    // all the slots are filled, the pending ones would keep us alive
+    while (proc->replies) {
+        struct ws_connection_reply* slot = proc->replies;
+        proc->replies = slot->next;
+
+        if (slot->reply) {
+            ws_object_unref((struct ws_object*) slot->reply);
+        }
+        free(slot);
     }
+    proc->replies_tail = &proc->replies;
+    proc->num_queued = 0;
 
     return true;
 }
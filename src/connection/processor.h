@@ -42,8 +42,25 @@
 
 // forward declarations
 struct ws_deserializer;
+struct ws_reply;
 struct ws_serializer;
 
+/**
+ * Slot for a message and the reply to it
+ *
+ * Messages are processed one at a time, in the order they were received: a
+ * message is only submitted once the previous one was processed, even if the
+ * latter was suspended or run asynchronously. Hence, replies are sent in the
+ * order the messages were received.
+ */
+struct ws_connection_reply {
+    struct ws_connection_reply* next; //!< @private next slot in the queue
+    struct ws_connection_processor* proc; //!< @private connection processor
+    struct ws_message* msg; //!< @private the message, until it's submitted
+    struct ws_reply* reply; //!< @private the reply, if any
+    bool done; //!< @private whether the message was processed
+};
+
 /**
  * @extends ws_object
  */
@@ -54,6 +71,13 @@ struct ws_connection_processor {
     struct ws_serializer* serializer; //!< @protected serializer to use
     ev_io dispatcher; //!< @protected dispatching watcher
     ev_prepare flusher; //!< @protected flushing watcher
+    struct ws_connection_reply* replies; //!< @protected replies to send
+    struct ws_connection_reply** replies_tail; //!< @protected end of queue
+    struct ws_connection_reply* submit; //!< @protected next msg to submit
+    size_t num_queued; //!< @protected number of slots queued
+    bool running; //!< @protected whether a message is being processed
+    bool advancing; //!< @protected whether messages are being submitted
+    bool eof; //!< @protected whether the peer stopped sending
     bool is_init; //!< @protected flag indicating whether it's initialized
 };
 
@@ -70,6 +94,10 @@ extern ws_object_type_id WS_OBJECT_TYPE_ID_CONNECTION_PROCESSOR;
  * However, the `serializer` is completely optional.
  * If _no_ serializer is passed, the connection will be a read-only connection.
  *
+ * The connection processor stops reading from the connection while too many
+ * messages are waiting to be processed or for their replies to be sent. If the
+ * peer stops sending, the connection is closed once all the replies are sent.
+ *
  * @return a new connection processor or `NULL`, if an error occured
  */
 struct ws_connection_processor*
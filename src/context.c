@@ -28,9 +28,13 @@
 #include <errno.h>
 #include <ev.h>
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "action/observer.h"
+#include "action/profiler.h"
+#include "action/timer.h"
 #include "command/util.h"
 #include "compositor/cursor.h"
 #include "compositor/keyboard.h"
@@ -38,10 +42,14 @@
 #include "context.h"
 #include "input/hotkeys.h"
 #include "objects/object.h"
+#include "objects/stats.h"
 #include "objects/string.h"
 #include "util/arithmetical.h"
 #include "util/exec.h"
 #include "util/string.h"
+#include "values/array.h"
+#include "values/bool.h"
+#include "values/object_id.h"
 #include "values/string.h"
 #include "values/union.h"
 
@@ -85,6 +93,44 @@ remove_hotkey_event(
     union ws_value_union* stack
 );
 
+/**
+ * Start a timer emitting an event
+ *
+ * Takes the name of the event, the time until it is emitted and, optionally,
+ * the interval in which it is repeated, both in milliseconds.
+ */
+static int
+func_add_timer(
+    union ws_value_union* stack
+);
+
+/**
+ * Stop a timer
+ */
+static int
+func_remove_timer(
+    union ws_value_union* stack
+);
+
+/**
+ * Observe an attribute
+ *
+ * Takes the name of the event emitted when the attribute changes, either the
+ * object or the name of the type to observe and the name of the attribute.
+ */
+static int
+func_observe(
+    union ws_value_union* stack
+);
+
+/**
+ * Remove all observers emitting an event
+ */
+static int
+func_unobserve(
+    union ws_value_union* stack
+);
+
 /**
  *  Get cursor under surface, regardless if it is in focus
  */
@@ -125,17 +171,85 @@ func_set_kb_focus(
     union ws_value_union* stack
 );
 
+/**
+ * Get a snapshot of the per-type object counters
+ *
+ * If a type name is passed, the counters of that type are returned as an array
+ * `[live, allocs, deinits]` (see `struct ws_object_type_stats`), or -ENOENT is
+ * returned if no object of that type was ever created.
+ *
+ * Without arguments, a report covering all the types is returned as a string.
+ * The report holds one line per type, formatted as
+ * `<typestr>: live=<n> allocs=<n> deinits=<n>`.
+ */
+static int
+func_stats(
+    union ws_value_union* stack
+);
+
+/**
+ * Get a report of the execution profiler
+ *
+ * Optionally, a boolean may be passed to enable or disable the profiler.
+ */
+static int
+func_profile(
+    union ws_value_union* stack
+);
+
+/**
+ * Reset the counters of the execution profiler
+ */
+static int
+func_profile_reset(
+    union ws_value_union* stack
+);
+
+/**
+ * Set a string value from a raw buffer
+ *
+ * The buffer is freed, regardless of the outcome.
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+static int
+set_string_result(
+    union ws_value_union* dest, //!< value to set
+    char* buf //!< buffer holding the string
+);
+
+/**
+ * Set an array value from the counters of an object type
+ *
+ * The array holds the number of live objects, the number of allocations and
+ * the number of deinitializations, in that order.
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+static int
+set_stats_result(
+    union ws_value_union* dest, //!< value to set
+    struct ws_object_type_stats const* stats //!< counters to set it from
+);
+
 static const struct ws_object_function functions[] = {
     { .name = "exit", .func = func_exit },
     { .name = "log", .func = func_log },
     { .name = "exec", .func = func_exec },
     { .name = "add_hotkey_event", .func = add_hotkey_event },
     { .name = "remove_hotkey_event", .func = remove_hotkey_event },
+    { .name = "add_timer", .func = func_add_timer },
+    { .name = "remove_timer", .func = func_remove_timer },
+    { .name = "observe", .func = func_observe },
+    { .name = "unobserve", .func = func_unobserve },
     { .name = "surface_under_cursor", .func = func_get_surface_under_cursor },
     { .name = "get_mouse_focus", .func = func_get_ms_focus },
     { .name = "get_keyboard_focus", .func = func_get_kb_focus },
     { .name = "set_ms_focus", .func = func_set_ms_focus },
     { .name = "set_kb_focus", .func = func_set_kb_focus },
+    { .name = "stats", .func = func_stats },
+    { .name = "profile", .func = func_profile },
+    { .name = "profile_reset", .func = func_profile_reset },
     { .name = NULL, .func = NULL }
 };
 
@@ -346,6 +460,138 @@ remove_hotkey_event(
     return res;
 }
 
+static int
+func_add_timer(
+    union ws_value_union* stack
+) {
+    union ws_value_union* retval = stack;
+    stack += 2; // We don't care about object itself and command name
+
+    if ((ws_value_get_type(&stack[0].value) != WS_VALUE_TYPE_STRING) ||
+            (ws_value_get_type(&stack[1].value) != WS_VALUE_TYPE_INT)) {
+        return -EINVAL;
+    }
+
+    intmax_t after = ws_value_int_get(&stack[1].int_);
+    intmax_t repeat = 0;
+    if (ws_value_get_type(&stack[2].value) == WS_VALUE_TYPE_INT) {
+        repeat = ws_value_int_get(&stack[2].int_);
+    }
+
+    struct ws_string* name = ws_value_string_get(&stack[0].string);
+    if (!name) {
+        return -ENOENT;
+    }
+
+    int res = ws_action_timer_add(name, after / 1000., repeat / 1000.);
+    ws_object_unref((struct ws_object*) name);
+    ws_value_union_reinit(retval, WS_VALUE_TYPE_BOOL);
+    ws_value_bool_set(&retval->bool_, res == 0);
+
+    return res;
+}
+
+static int
+func_remove_timer(
+    union ws_value_union* stack
+) {
+    union ws_value_union* retval = stack;
+    stack += 2; // We don't care about object itself and command name
+
+    if (ws_value_get_type(&stack->value) != WS_VALUE_TYPE_STRING) {
+        return -EINVAL;
+    }
+
+    struct ws_string* name = ws_value_string_get(&stack->string);
+    if (!name) {
+        return -ENOENT;
+    }
+
+    int res = ws_action_timer_remove(name);
+    ws_object_unref((struct ws_object*) name);
+    ws_value_union_reinit(retval, WS_VALUE_TYPE_BOOL);
+    ws_value_bool_set(&retval->bool_, res == 0);
+
+    return res;
+}
+
+static int
+func_observe(
+    union ws_value_union* stack
+) {
+    union ws_value_union* retval = stack;
+    stack += 2; // We don't care about object itself and command name
+
+    if ((ws_value_get_type(&stack[0].value) != WS_VALUE_TYPE_STRING) ||
+            (ws_value_get_type(&stack[2].value) != WS_VALUE_TYPE_STRING)) {
+        return -EINVAL;
+    }
+
+    struct ws_object* target = NULL;
+    char* type = NULL;
+    switch (ws_value_get_type(&stack[1].value)) {
+    case WS_VALUE_TYPE_OBJECT_ID:
+        target = ws_value_object_id_get(&stack[1].object_id);
+        break;
+
+    case WS_VALUE_TYPE_STRING:
+        {
+            struct ws_string* str = ws_value_string_get(&stack[1].string);
+            if (str) {
+                type = ws_string_raw(str);
+                ws_object_unref((struct ws_object*) str);
+            }
+        }
+        break;
+
+    default:
+        return -EINVAL;
+    }
+
+    struct ws_string* name = ws_value_string_get(&stack[0].string);
+    struct ws_string* attr_str = ws_value_string_get(&stack[2].string);
+    char* attr = attr_str ? ws_string_raw(attr_str) : NULL;
+
+    int res = -ENOENT;
+    if (name && attr && (target || type)) {
+        res = ws_action_observer_add(name, target, type, attr);
+    }
+
+    free(attr);
+    free(type);
+    ws_object_unref((struct ws_object*) attr_str);
+    ws_object_unref((struct ws_object*) name);
+    ws_object_unref(target);
+    ws_value_union_reinit(retval, WS_VALUE_TYPE_BOOL);
+    ws_value_bool_set(&retval->bool_, res == 0);
+
+    return res;
+}
+
+static int
+func_unobserve(
+    union ws_value_union* stack
+) {
+    union ws_value_union* retval = stack;
+    stack += 2; // We don't care about object itself and command name
+
+    if (ws_value_get_type(&stack->value) != WS_VALUE_TYPE_STRING) {
+        return -EINVAL;
+    }
+
+    struct ws_string* name = ws_value_string_get(&stack->string);
+    if (!name) {
+        return -ENOENT;
+    }
+
+    int res = ws_action_observer_remove(name);
+    ws_object_unref((struct ws_object*) name);
+    ws_value_union_reinit(retval, WS_VALUE_TYPE_BOOL);
+    ws_value_bool_set(&retval->bool_, res == 0);
+
+    return res;
+}
+
 static int
 func_get_surface_under_cursor(
     union ws_value_union* stack
@@ -428,3 +674,153 @@ func_set_kb_focus(
     return 0;
 }
 
+static int
+func_stats(
+    union ws_value_union* stack
+) {
+    union ws_value_union* retval = stack;
+    stack += 2; // We don't care about object itself and command name
+
+    char* filter = NULL;
+    if (ws_value_get_type(&stack->value) == WS_VALUE_TYPE_STRING) {
+        struct ws_string* str = ws_value_string_get(&stack->string);
+        if (!str) {
+            return -ENOENT;
+        }
+        filter = ws_string_raw(str);
+        ws_object_unref((struct ws_object*) str);
+        if (!filter) {
+            return -ENOMEM;
+        }
+    }
+
+    // types may be added between the two calls, we simply ignore those
+    size_t num = ws_object_stats_snapshot(NULL, 0);
+    struct ws_object_type_stats* stats = calloc(num + 1, sizeof(*stats));
+    if (!stats) {
+        free(filter);
+        return -ENOMEM;
+    }
+    num = MIN(num, ws_object_stats_snapshot(stats, num));
+
+    int res;
+    if (filter) {
+        res = -ENOENT;
+
+        size_t i;
+        for (i = 0; i < num; ++i) {
+            if (ws_streq(filter, stats[i].type->typestr)) {
+                res = set_stats_result(retval, stats + i);
+                break;
+            }
+        }
+        goto cleanup;
+    }
+
+    char* buf = NULL;
+    size_t len = 0;
+    FILE* out = open_memstream(&buf, &len);
+    if (!out) {
+        res = -ENOMEM;
+        goto cleanup;
+    }
+
+    size_t i;
+    for (i = 0; i < num; ++i) {
+        fprintf(out, "%s: live=%zu allocs=%zu deinits=%zu\n",
+                stats[i].type->typestr, stats[i].live, stats[i].allocs,
+                stats[i].deinits);
+    }
+    fclose(out);
+
+    res = set_string_result(retval, buf);
+
+cleanup:
+    free(stats);
+    free(filter);
+    return res;
+}
+
+static int
+func_profile(
+    union ws_value_union* stack
+) {
+    union ws_value_union* retval = stack;
+    stack += 2; // We don't care about object itself and command name
+
+    if (ws_value_get_type(&stack->value) == WS_VALUE_TYPE_BOOL) {
+        ws_profiler_enable(ws_value_bool_get(&stack->bool_));
+    }
+
+    char* buf = NULL;
+    size_t len = 0;
+    FILE* out = open_memstream(&buf, &len);
+    if (!out) {
+        return -ENOMEM;
+    }
+
+    int res = ws_profiler_report(out);
+    fclose(out);
+    if (res < 0) {
+        free(buf);
+        return res;
+    }
+
+    return set_string_result(retval, buf);
+}
+
+static int
+func_profile_reset(
+    union ws_value_union* stack
+) {
+    ws_profiler_reset();
+    return 0;
+}
+
+static int
+set_string_result(
+    union ws_value_union* dest,
+    char* buf
+) {
+    int res = ws_value_union_reinit(dest, WS_VALUE_TYPE_STRING);
+    if (res < 0) {
+        free(buf);
+        return res;
+    }
+
+    struct ws_string* str = ws_value_string_get(&dest->string);
+    if (!str) {
+        free(buf);
+        return -ENOMEM;
+    }
+
+    res = ws_string_set_from_raw(str, buf);
+    ws_object_unref((struct ws_object*) str);
+    free(buf);
+
+    return res;
+}
+
+static int
+set_stats_result(
+    union ws_value_union* dest,
+    struct ws_object_type_stats const* stats
+) {
+    struct ws_value_array res;
+    ws_value_array_init(&res);
+    if (ws_value_array_resize(&res, 3) < 0) {
+        return -ENOMEM;
+    }
+
+    intmax_t* elems = ws_value_array_elems_mut(&res);
+    elems[0] = stats->live;
+    elems[1] = stats->allocs;
+    elems[2] = stats->deinits;
+
+    int retval = ws_value_union_reinit(dest, WS_VALUE_TYPE_ARRAY);
+    if (retval == 0) {
+        ws_value_array_assign(&dest->array, &res);
+    }
+    ws_value_deinit(&res.value);
+    return retval;
+}
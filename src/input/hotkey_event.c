@@ -103,7 +103,7 @@ ws_hotkey_event_init(
     if (!ws_object_init(&self->obj)) {
         return -1;
     }
-    self->obj.id = &WS_OBJECT_TYPE_ID_HOTKEY_EVENT;
+    ws_object_set_type(&self->obj, &WS_OBJECT_TYPE_ID_HOTKEY_EVENT);
 
     if (!ws_string_init(&self->name)) {
         goto cleanup_object;
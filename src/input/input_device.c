@@ -98,7 +98,7 @@ ws_input_device_new(
 ) {
     struct ws_input_device* self = calloc(1, sizeof(*self));
     ws_object_init(&self->obj);
-    self->obj.id = &WS_OBJECT_TYPE_ID_INPUT_DEVICE;
+    ws_object_set_type(&self->obj, &WS_OBJECT_TYPE_ID_INPUT_DEVICE);
     self->obj.settings |= WS_OBJECT_HEAPALLOCED;
 
     libevdev_new_from_fd(fd, &self->dev);
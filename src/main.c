@@ -37,6 +37,7 @@
 #include "context.h"
 #include "input/module.h"
 #include "logger/module.h"
+#include "objects/deferred.h"
 #include "objects/object.h"
 #include "util/cleaner.h"
 #include "util/wayland.h"
@@ -98,6 +99,12 @@ main(
 
     ws_log(&log_main, LOG_DEBUG, "Logger initalized.");
 
+    retval = ws_object_deferred_init();
+    if (retval != 0) {
+        ws_log(&log_main, LOG_EMERG, "Failed to init deferred destruction.");
+        goto cleanup;
+    }
+
     retval = ws_connection_manager_init();
     if (retval != 0) {
         ws_log(&log_main, LOG_EMERG, "Failed to init Connection manager.");
@@ -140,7 +147,7 @@ main(
     // now create a context and initialize the action manager
     struct ws_object context;
     ws_object_init(&context);
-    context.id = &WS_OBJECT_TYPE_ID_CONTEXT;
+    ws_object_set_type(&context, &WS_OBJECT_TYPE_ID_CONTEXT);
 
     retval = ws_action_manager_init(&context);
     if (retval != 0) {
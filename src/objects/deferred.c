@@ -0,0 +1,308 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <ev.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger/module.h"
+#include "objects/deferred.h"
+#include "objects/object.h"
+#include "util/cleaner.h"
+#include "util/condition.h"
+
+/**
+ * Time budget per loop iteration, in seconds
+ */
+#define DEFERRED_BUDGET (0.002)
+
+/**
+ * Number of objects to destroy between two checks of the time budget
+ */
+#define DEFERRED_BATCH (32)
+
+/**
+ * Initial capacity of the queue
+ */
+#define DEFERRED_INITIAL_CAPACITY (64)
+
+static struct ws_logger_context log_ctx = {
+    .prefix = "[Object/Deferred] ",
+};
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Pop the next object from the queue
+ *
+ * @return the next object or `NULL`, if the queue is empty
+ */
+static struct ws_object*
+pop_object(void);
+
+/**
+ * Watcher callback: drain the queue at the end of a loop iteration
+ */
+static void
+drain_queue(
+    struct ev_loop* loop,
+    ev_check* watcher,
+    int revents
+);
+
+/**
+ * Watcher callback: keep the loop from blocking while objects are queued
+ */
+static void
+keep_alive(
+    struct ev_loop* loop,
+    ev_idle* watcher,
+    int revents
+);
+
+/**
+ * Destroy all queued objects and disable deferred destruction
+ */
+static void
+deferred_deinit(
+    void* dummy
+);
+
+/*
+ *
+ * Internal constant
+ *
+ */
+
+/**
+ * The queue of objects to destroy
+ */
+static struct {
+    struct ws_object** objs; //!< queued objects
+    size_t head; //!< index of the next object to destroy
+    size_t num; //!< index past the last object queued
+    size_t capacity; //!< capacity of the queue
+    bool enabled; //!< whether objects are queued at all
+    pthread_mutex_t lock; //!< lock protecting the queue
+    ev_check drainer; //!< watcher draining the queue
+    ev_idle keeper; //!< watcher keeping the loop alive while draining
+} queue = {
+    .objs = NULL,
+    .head = 0,
+    .num = 0,
+    .capacity = 0,
+    .enabled = false,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_object_deferred_init(void) {
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    if (!loop) {
+        return -ENOENT;
+    }
+
+    pthread_mutex_lock(&queue.lock);
+    if (queue.enabled) {
+        pthread_mutex_unlock(&queue.lock);
+        return 0;
+    }
+
+    queue.objs = calloc(DEFERRED_INITIAL_CAPACITY, sizeof(*queue.objs));
+    if (!queue.objs) {
+        pthread_mutex_unlock(&queue.lock);
+        return -ENOMEM;
+    }
+    queue.capacity = DEFERRED_INITIAL_CAPACITY;
+    queue.enabled = true;
+    pthread_mutex_unlock(&queue.lock);
+
+    ev_check_init(&queue.drainer, drain_queue);
+    ev_idle_init(&queue.keeper, keep_alive);
+    ev_check_start(loop, &queue.drainer);
+
+    return ws_cleaner_add(deferred_deinit, NULL);
+}
+
+bool
+ws_object_deferred_push(
+    struct ws_object* obj
+) {
+    bool retval = false;
+    pthread_mutex_lock(&queue.lock);
+
+    if (unlikely(!queue.enabled)) {
+        goto out;
+    }
+
+    if (queue.num == queue.capacity) {
+        // move the remaining objects to the front before growing
+        if (queue.head > 0) {
+            memmove(queue.objs, queue.objs + queue.head,
+                    (queue.num - queue.head) * sizeof(*queue.objs));
+            queue.num -= queue.head;
+            queue.head = 0;
+        }
+
+        if (queue.num == queue.capacity) {
+            size_t capacity = queue.capacity * 2;
+            struct ws_object** tmp;
+            tmp = realloc(queue.objs, capacity * sizeof(*queue.objs));
+            if (!tmp) {
+                // we cannot queue the object, so the caller destroys it now
+                goto out;
+            }
+            queue.objs = tmp;
+            queue.capacity = capacity;
+        }
+    }
+
+    queue.objs[queue.num++] = obj;
+    retval = true;
+
+out:
+    pthread_mutex_unlock(&queue.lock);
+    return retval;
+}
+
+size_t
+ws_object_deferred_run(
+    double budget
+) {
+    ev_tstamp deadline = ev_time() + budget;
+    size_t count = 0;
+
+    struct ws_object* obj;
+    while ((obj = pop_object())) {
+        ws_object_deinit(obj);
+        free(obj);
+
+        if ((++count % DEFERRED_BATCH == 0) && (budget >= 0) &&
+                (ev_time() > deadline)) {
+            break;
+        }
+    }
+
+    return count;
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static struct ws_object*
+pop_object(void) {
+    struct ws_object* retval = NULL;
+    pthread_mutex_lock(&queue.lock);
+
+    if (queue.head < queue.num) {
+        retval = queue.objs[queue.head++];
+    }
+
+    if (queue.head == queue.num) {
+        queue.head = 0;
+        queue.num = 0;
+    }
+
+    pthread_mutex_unlock(&queue.lock);
+    return retval;
+}
+
+static void
+drain_queue(
+    struct ev_loop* loop,
+    ev_check* watcher,
+    int revents
+) {
+    size_t count = ws_object_deferred_run(DEFERRED_BUDGET);
+    if (count) {
+        ws_log(&log_ctx, LOG_DEBUG, "Destroyed %zu objects", count);
+    }
+
+    pthread_mutex_lock(&queue.lock);
+    bool pending = queue.head < queue.num;
+    pthread_mutex_unlock(&queue.lock);
+
+    // If objects remain, we must not block in the next iteration. An active
+    // idle watcher makes the loop poll without blocking.
+    if (pending) {
+        ev_idle_start(loop, &queue.keeper);
+    } else {
+        ev_idle_stop(loop, &queue.keeper);
+    }
+}
+
+static void
+keep_alive(
+    struct ev_loop* loop,
+    ev_idle* watcher,
+    int revents
+) {
+    // nothing to do, the queue is drained by the check watcher
+}
+
+static void
+deferred_deinit(
+    void* dummy
+) {
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    ev_check_stop(loop, &queue.drainer);
+    ev_idle_stop(loop, &queue.keeper);
+
+    // destroy everything which is left, objects are destroyed right away from
+    // now on
+    ws_object_deferred_run(-1);
+
+    pthread_mutex_lock(&queue.lock);
+    queue.enabled = false;
+    pthread_mutex_unlock(&queue.lock);
+
+    // objects destroyed by other objects might have been queued meanwhile
+    ws_object_deferred_run(-1);
+
+    pthread_mutex_lock(&queue.lock);
+    free(queue.objs);
+    queue.objs = NULL;
+    queue.capacity = 0;
+    pthread_mutex_unlock(&queue.lock);
+}
+
@@ -0,0 +1,109 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup objects "Classes"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup objects_deferred "Deferred object destruction"
+ *
+ * Queue for objects which lost their last reference
+ *
+ * Once initialized, objects are not destroyed immediately when their last
+ * reference is dropped. Instead, they are queued and destroyed in batches at
+ * the end of a main loop iteration, with a time budget per iteration. This
+ * avoids long deinitialization cascades in the middle of a callback, e.g. when
+ * a client with many resources disconnects.
+ *
+ * @{
+ */
+
+#ifndef __WS_OBJECTS_DEFERRED_H__
+#define __WS_OBJECTS_DEFERRED_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_object;
+
+/**
+ * Initialize deferred object destruction
+ *
+ * Starts the watcher draining the queue at the end of each loop iteration.
+ * Before this function was called, objects are destroyed immediately.
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+int
+ws_object_deferred_init(void);
+
+/**
+ * Queue an object for destruction
+ *
+ * @note This function is called by `ws_object_unref()` and should not be
+ *       called elsewhere.
+ *
+ * @return true if the object was queued, false if the caller has to destroy
+ *         the object itself
+ */
+bool
+ws_object_deferred_push(
+    struct ws_object* obj //!< object which lost its last reference
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Destroy queued objects
+ *
+ * Destroys objects until either the queue is empty or the budget is exceeded.
+ * Objects queued by the destruction of other objects are destroyed in the
+ * same run.
+ *
+ * @return the number of objects destroyed
+ */
+size_t
+ws_object_deferred_run(
+    double budget //!< time budget in seconds, a negative value for no limit
+);
+
+#endif // __WS_OBJECTS_DEFERRED_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
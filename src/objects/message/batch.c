@@ -0,0 +1,173 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <malloc.h>
+
+#include "objects/message/batch.h"
+#include "objects/message/transaction.h"
+
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Deinitialize a batch message
+ *
+ * @return true
+ */
+static bool
+batch_deinit(
+    struct ws_object* obj
+);
+
+
+/*
+ *
+ * Internal constants
+ *
+ */
+
+/**
+ * Type id of the `ws_batch` type.
+ */
+ws_object_type_id WS_OBJECT_TYPE_ID_BATCH = {
+    .supertype  = &WS_OBJECT_TYPE_ID_MESSAGE,
+    .typestr    = "ws_batch",
+
+    .hash_callback = NULL,
+    .deinit_callback = batch_deinit,
+    .cmp_callback = NULL,
+    .uuid_callback = NULL,
+
+    .function_table = NULL,
+};
+
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+struct ws_batch*
+ws_batch_new(
+    size_t id
+) {
+    struct ws_batch* retval = calloc(1, sizeof(*retval));
+    if (!retval) {
+        return NULL;
+    }
+
+    if (ws_message_init(&retval->m, id) < 0) {
+        free(retval);
+        return NULL;
+    }
+    ws_object_set_type(&retval->m.obj, &WS_OBJECT_TYPE_ID_BATCH);
+    retval->m.obj.settings = WS_OBJECT_HEAPALLOCED;
+
+    return retval;
+}
+
+int
+ws_batch_append(
+    struct ws_batch* self,
+    struct ws_transaction* transaction
+) {
+    if (self->num >= self->len) {
+        size_t len = self->len ? self->len * 2 : 4;
+        struct ws_transaction** buf;
+        buf = realloc(self->transactions, len * sizeof(*buf));
+        if (!buf) {
+            return -ENOMEM;
+        }
+        self->transactions = buf;
+        self->len = len;
+    }
+
+    self->transactions[self->num++] = getref(transaction);
+    return 0;
+}
+
+size_t
+ws_batch_len(
+    struct ws_batch* self
+) {
+    return self->num;
+}
+
+struct ws_transaction*
+ws_batch_get(
+    struct ws_batch* self,
+    size_t pos
+) {
+    if (pos >= self->num) {
+        return NULL;
+    }
+    return self->transactions[pos];
+}
+
+void
+ws_batch_set_atomic(
+    struct ws_batch* self,
+    bool atomic
+) {
+    self->atomic = atomic;
+}
+
+bool
+ws_batch_is_atomic(
+    struct ws_batch* self
+) {
+    return self->atomic;
+}
+
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static bool
+batch_deinit(
+    struct ws_object* obj
+) {
+    struct ws_batch* self = (struct ws_batch*) obj;
+
+    while (self->num) {
+        ws_object_unref(&self->transactions[--self->num]->m.obj);
+    }
+    free(self->transactions);
+
+    return true;
+}
+
@@ -0,0 +1,172 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup objects "Classes"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup objects_messages "Message classes"
+ *
+ * @{
+ */
+
+#ifndef __WS_OBJECTS_BATCH_H__
+#define __WS_OBJECTS_BATCH_H__
+
+#include <stdbool.h>
+
+#include "objects/message/message.h"
+
+
+// Forward declarations
+struct ws_transaction;
+
+
+/**
+ * Batch message type
+ *
+ * A batch bundles several transactions which are executed in order. The
+ * results are sent back to the source in one single reply.
+ *
+ * @extends ws_message
+ */
+struct ws_batch {
+    struct ws_message m; //!< @protected Base class.
+    struct ws_transaction** transactions; //!< @protected transactions
+    size_t num; //!< @protected number of transactions
+    size_t len; //!< @protected capacity of the transaction array
+    bool atomic; //!< @protected whether to abort on the first error
+};
+
+/**
+ * Variable which holds the type information about the ws_batch type
+ */
+extern ws_object_type_id WS_OBJECT_TYPE_ID_BATCH;
+
+/**
+ * Create a new, empty batch
+ *
+ * @memberof ws_batch
+ *
+ * @return a new batch or `NULL`, if an error occurred
+ */
+struct ws_batch*
+ws_batch_new(
+    size_t id //!< id of the batch message
+);
+
+/**
+ * Append a transaction to a batch
+ *
+ * @memberof ws_batch
+ *
+ * @note Gets a reference on the transaction
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+int
+ws_batch_append(
+    struct ws_batch* self, //!< the batch
+    struct ws_transaction* transaction //!< transaction to append
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Get the number of transactions in a batch
+ *
+ * @memberof ws_batch
+ *
+ * @return the number of transactions in the batch
+ */
+size_t
+ws_batch_len(
+    struct ws_batch* self //!< the batch
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get a transaction from a batch
+ *
+ * @memberof ws_batch
+ *
+ * @return the transaction at position `pos` (not ref'd) or `NULL`, if `pos` is
+ *         out of bounds
+ */
+struct ws_transaction*
+ws_batch_get(
+    struct ws_batch* self, //!< the batch
+    size_t pos //!< position of the transaction
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Set whether the batch is all-or-nothing
+ *
+ * An atomic batch is only executed if all of its transactions compile and is
+ * aborted on the first transaction which results in an error.
+ *
+ * @memberof ws_batch
+ */
+void
+ws_batch_set_atomic(
+    struct ws_batch* self, //!< the batch
+    bool atomic //!< whether the batch is all-or-nothing
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Check whether the batch is all-or-nothing
+ *
+ * @memberof ws_batch
+ *
+ * @return true if the batch is atomic, false otherwise
+ */
+bool
+ws_batch_is_atomic(
+    struct ws_batch* self //!< the batch
+)
+__ws_nonnull__(1)
+;
+
+#endif // __WS_OBJECTS_BATCH_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
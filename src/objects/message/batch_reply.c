@@ -0,0 +1,158 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <malloc.h>
+
+#include "objects/message/batch.h"
+#include "objects/message/batch_reply.h"
+
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Deinitialize a batch reply message
+ *
+ * @return true
+ */
+static bool
+batch_reply_deinit(
+    struct ws_object* obj
+);
+
+
+/*
+ *
+ * Internal constants
+ *
+ */
+
+/**
+ * Type id of the `ws_batch_reply` type.
+ */
+ws_object_type_id WS_OBJECT_TYPE_ID_BATCH_REPLY = {
+    .supertype  = &WS_OBJECT_TYPE_ID_REPLY,
+    .typestr    = "ws_reply",
+
+    .hash_callback = NULL,
+    .deinit_callback = batch_reply_deinit,
+    .cmp_callback = NULL,
+    .uuid_callback = NULL,
+
+    .function_table = NULL,
+};
+
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+struct ws_batch_reply*
+ws_batch_reply_new(
+    struct ws_batch* src
+) {
+    struct ws_batch_reply* retval = calloc(1, sizeof(*retval));
+    if (!retval) {
+        return NULL;
+    }
+
+    if (ws_message_init((struct ws_message*) retval, src->m.id) < 0) {
+        free(retval);
+        return NULL;
+    }
+    ws_object_set_type((struct ws_object*) retval,
+                       &WS_OBJECT_TYPE_ID_BATCH_REPLY);
+    ((struct ws_object*) retval)->settings = WS_OBJECT_HEAPALLOCED;
+
+    return retval;
+}
+
+int
+ws_batch_reply_append(
+    struct ws_batch_reply* self,
+    struct ws_reply* reply
+) {
+    if (self->num >= self->len) {
+        size_t len = self->len ? self->len * 2 : 4;
+        struct ws_reply** buf = realloc(self->replies, len * sizeof(*buf));
+        if (!buf) {
+            return -ENOMEM;
+        }
+        self->replies = buf;
+        self->len = len;
+    }
+
+    self->replies[self->num++] = reply;
+    return 0;
+}
+
+size_t
+ws_batch_reply_len(
+    struct ws_batch_reply* self
+) {
+    return self->num;
+}
+
+struct ws_reply*
+ws_batch_reply_get(
+    struct ws_batch_reply* self,
+    size_t pos
+) {
+    if (pos >= self->num) {
+        return NULL;
+    }
+    return self->replies[pos];
+}
+
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static bool
+batch_reply_deinit(
+    struct ws_object* obj
+) {
+    struct ws_batch_reply* self = (struct ws_batch_reply*) obj;
+
+    while (self->num) {
+        ws_object_unref(&self->replies[--self->num]->m.obj);
+    }
+    free(self->replies);
+
+    return true;
+}
+
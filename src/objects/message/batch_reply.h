@@ -0,0 +1,133 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup objects "Classes"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup objects_messages "Message classes"
+ *
+ * @{
+ */
+
+#ifndef __WS_OBJECTS_BATCH_REPLY_H__
+#define __WS_OBJECTS_BATCH_REPLY_H__
+
+#include "objects/message/reply.h"
+
+
+// Forward declarations
+struct ws_batch;
+
+
+/**
+ * Batch reply message type
+ *
+ * This reply type combines the replies to all the transactions of a batch, in
+ * the order in which the transactions appeared in the batch.
+ *
+ * @extends ws_reply
+ */
+struct ws_batch_reply {
+    struct ws_reply reply; //!< @protected base class
+    struct ws_reply** replies; //!< @protected replies of the transactions
+    size_t num; //!< @protected number of replies
+    size_t len; //!< @protected capacity of the reply array
+};
+
+/**
+ * Variable which holds the type information about the ws_batch_reply type
+ */
+extern ws_object_type_id WS_OBJECT_TYPE_ID_BATCH_REPLY;
+
+/**
+ * Create a batch reply
+ *
+ * @return a new, empty reply or `NULL`, if an error occurred
+ */
+struct ws_batch_reply*
+ws_batch_reply_new(
+    struct ws_batch* src //!< batch for which this is the reply
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Append the reply to a transaction of the batch
+ *
+ * @note The batch reply takes over the reference passed in
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+int
+ws_batch_reply_append(
+    struct ws_batch_reply* self, //!< the batch reply
+    struct ws_reply* reply //!< reply to append
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Get the number of replies in a batch reply
+ *
+ * @return the number of replies
+ */
+size_t
+ws_batch_reply_len(
+    struct ws_batch_reply* self //!< the batch reply
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get a reply from a batch reply
+ *
+ * @return the reply at position `pos` (not ref'd) or `NULL`, if `pos` is out
+ *         of bounds
+ */
+struct ws_reply*
+ws_batch_reply_get(
+    struct ws_batch_reply* self, //!< the batch reply
+    size_t pos //!< position of the reply
+)
+__ws_nonnull__(1)
+;
+
+#endif // __WS_OBJECTS_BATCH_REPLY_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
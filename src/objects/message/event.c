@@ -94,7 +94,7 @@ ws_event_init(
         }
     }
 
-    self->m.obj.id = &WS_OBJECT_TYPE_ID_EVENT;
+    ws_object_set_type(&self->m.obj, &WS_OBJECT_TYPE_ID_EVENT);
 
     return 0;
 
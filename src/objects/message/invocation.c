@@ -0,0 +1,178 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <malloc.h>
+
+#include "objects/message/invocation.h"
+
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Deinitialize an invocation message
+ *
+ * @return true
+ */
+static bool
+invocation_deinit(
+    struct ws_object* obj
+);
+
+
+/*
+ *
+ * Internal constants
+ *
+ */
+
+/**
+ * Type id of the `ws_invocation` type.
+ */
+ws_object_type_id WS_OBJECT_TYPE_ID_INVOCATION = {
+    .supertype  = &WS_OBJECT_TYPE_ID_MESSAGE,
+    .typestr    = "ws_invocation",
+
+    .hash_callback = NULL,
+    .deinit_callback = invocation_deinit,
+    .cmp_callback = NULL,
+    .uuid_callback = NULL,
+
+    .function_table = NULL,
+};
+
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+struct ws_invocation*
+ws_invocation_new(
+    size_t id,
+    struct ws_string* name
+) {
+    struct ws_invocation* retval = calloc(1, sizeof(*retval));
+    if (!retval) {
+        return NULL;
+    }
+
+    if (ws_message_init(&retval->m, id) < 0) {
+        free(retval);
+        return NULL;
+    }
+    ws_object_set_type(&retval->m.obj, &WS_OBJECT_TYPE_ID_INVOCATION);
+    retval->m.obj.settings = WS_OBJECT_HEAPALLOCED;
+
+    if (name) {
+        retval->name = getref(name);
+    }
+
+    return retval;
+}
+
+void
+ws_invocation_set_name(
+    struct ws_invocation* self,
+    struct ws_string* name
+) {
+    ws_object_unref((struct ws_object*) self->name);
+    self->name = getref(name);
+}
+
+struct ws_string*
+ws_invocation_name(
+    struct ws_invocation* self
+) {
+    return getref(self->name);
+}
+
+int
+ws_invocation_append_arg(
+    struct ws_invocation* self,
+    struct ws_value* val
+) {
+    if (self->num >= self->len) {
+        size_t len = self->len ? self->len * 2 : 4;
+        union ws_value_union* buf = realloc(self->args, len * sizeof(*buf));
+        if (!buf) {
+            return -ENOMEM;
+        }
+        self->args = buf;
+        self->len = len;
+    }
+
+    int res = ws_value_union_init_from_val(self->args + self->num, val);
+    if (res < 0) {
+        return res;
+    }
+    ++self->num;
+    return 0;
+}
+
+union ws_value_union const*
+ws_invocation_args(
+    struct ws_invocation* self
+) {
+    return self->args;
+}
+
+size_t
+ws_invocation_nargs(
+    struct ws_invocation* self
+) {
+    return self->num;
+}
+
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static bool
+invocation_deinit(
+    struct ws_object* obj
+) {
+    struct ws_invocation* self = (struct ws_invocation*) obj;
+
+    while (self->num) {
+        ws_value_deinit(&self->args[--self->num].value);
+    }
+    free(self->args);
+    ws_object_unref((struct ws_object*) self->name);
+
+    return true;
+}
+
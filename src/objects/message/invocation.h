@@ -0,0 +1,169 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup objects "Classes"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup objects_messages "Message classes"
+ *
+ * @{
+ */
+
+#ifndef __WS_OBJECTS_INVOCATION_H__
+#define __WS_OBJECTS_INVOCATION_H__
+
+#include "objects/message/message.h"
+#include "objects/string.h"
+#include "values/union.h"
+
+
+/**
+ * Invocation message type
+ *
+ * An invocation runs a registered transaction, identified by its name, with a
+ * vector of arguments. The arguments are pushed onto the stack right after the
+ * environment, e.g. the first argument is found at position 2.
+ *
+ * @extends ws_message
+ */
+struct ws_invocation {
+    struct ws_message m; //!< @protected Base class.
+    struct ws_string* name; //!< @protected name of the transaction to run
+    union ws_value_union* args; //!< @protected arguments
+    size_t num; //!< @protected number of arguments
+    size_t len; //!< @protected capacity of the argument array
+};
+
+/**
+ * Variable which holds the type information about the ws_invocation type
+ */
+extern ws_object_type_id WS_OBJECT_TYPE_ID_INVOCATION;
+
+/**
+ * Create a new invocation without any arguments
+ *
+ * @memberof ws_invocation
+ *
+ * @note Gets a ref on the name object for you
+ *
+ * @return a new invocation or `NULL`, if an error occurred
+ */
+struct ws_invocation*
+ws_invocation_new(
+    size_t id, //!< id of the message
+    struct ws_string* name //!< name of the transaction, may be `NULL`
+);
+
+/**
+ * Set the name of the transaction to invoke
+ *
+ * @memberof ws_invocation
+ *
+ * @note Gets a ref on the name object for you
+ */
+void
+ws_invocation_set_name(
+    struct ws_invocation* self, //!< the invocation
+    struct ws_string* name //!< name of the transaction
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Get the name of the transaction to invoke
+ *
+ * @memberof ws_invocation
+ *
+ * @return a reference to the name or `NULL`, if no name was set
+ */
+struct ws_string*
+ws_invocation_name(
+    struct ws_invocation* self //!< the invocation
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Append an argument to an invocation
+ *
+ * @memberof ws_invocation
+ *
+ * @note The value is copied
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+int
+ws_invocation_append_arg(
+    struct ws_invocation* self, //!< the invocation
+    struct ws_value* val //!< value to append
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Get the arguments of an invocation
+ *
+ * @memberof ws_invocation
+ *
+ * @return the arguments, `NULL` if there are none
+ */
+union ws_value_union const*
+ws_invocation_args(
+    struct ws_invocation* self //!< the invocation
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get the number of arguments of an invocation
+ *
+ * @memberof ws_invocation
+ *
+ * @return the number of arguments
+ */
+size_t
+ws_invocation_nargs(
+    struct ws_invocation* self //!< the invocation
+)
+__ws_nonnull__(1)
+;
+
+#endif // __WS_OBJECTS_INVOCATION_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
@@ -61,7 +61,7 @@ ws_message_init(
     size_t id
 ) {
     ws_object_init(&self->obj);
-    self->obj.id = &WS_OBJECT_TYPE_ID_MESSAGE;
+    ws_object_set_type(&self->obj, &WS_OBJECT_TYPE_ID_MESSAGE);
     self->id = id;
 
     // what could possibly go wrong?
@@ -74,3 +74,11 @@ ws_message_get_id(
 ) {
     return self->id;
 }
+
+void
+ws_message_set_id(
+    struct ws_message* self,
+    size_t id
+) {
+    self->id = id;
+}
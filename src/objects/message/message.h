@@ -91,6 +91,22 @@ ws_message_get_id(
 __ws_nonnull__(1)
 ;
 
+/**
+ * Set the id of a message object
+ *
+ * @memberof ws_message
+ *
+ * @note for replies which answer a message other than the one they were
+ *       created from
+ */
+void
+ws_message_set_id(
+    struct ws_message* self, //!< message to set the id of
+    size_t id //!< new id of the message
+)
+__ws_nonnull__(1)
+;
+
 #endif //__WS_OBJECTS_MESSAGE_H__
 
 /**
@@ -27,7 +27,9 @@
 
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "command/bytecode.h"
 #include "command/command.h"
 #include "command/statement.h"
 #include "objects/message/message.h"
@@ -47,6 +49,16 @@ deinit_transaction(
     struct ws_object* self
 );
 
+/**
+ * Hash a transaction
+ *
+ * Transactions are compared by name, so they are hashed by name, too.
+ */
+static size_t
+hash_transaction(
+    struct ws_object* const self
+);
+
 /**
  * Compare two transactions
  *
@@ -69,7 +81,7 @@ ws_object_type_id WS_OBJECT_TYPE_ID_TRANSACTION = {
     .typestr    = "ws_transaction",
 
     .deinit_callback = deinit_transaction,
-    .hash_callback = NULL,
+    .hash_callback = hash_transaction,
     .cmp_callback = cmp_transactions,
     .uuid_callback = NULL,
 
@@ -92,11 +104,14 @@ ws_transaction_init(
     if (res < 0) {
         return res;
     }
-    self->m.obj.id = &WS_OBJECT_TYPE_ID_TRANSACTION;
+    ws_object_set_type(&self->m.obj, &WS_OBJECT_TYPE_ID_TRANSACTION);
 
     self->name = getref(name);
     self->cmds = NULL;
     self->flags = 0;
+    self->expand = false;
+    self->expand_attrs = NULL;
+    self->num_expand_attrs = 0;
     return 0;
 }
 
@@ -178,6 +193,50 @@ ws_transaction_set_name(
     t->name = getref(name);
 }
 
+int
+ws_transaction_expand(
+    struct ws_transaction* t,
+    char const* attr
+) {
+    ws_object_lock_write(&t->m.obj);
+    t->expand = true;
+
+    int res = 0;
+    if (!attr) {
+        goto out;
+    }
+
+    char* copy = strdup(attr);
+    char** tmp = realloc(t->expand_attrs,
+                         (t->num_expand_attrs + 1) * sizeof(*tmp));
+    if (!copy || !tmp) {
+        free(copy);
+        res = -ENOMEM;
+        goto out;
+    }
+    t->expand_attrs = tmp;
+    t->expand_attrs[t->num_expand_attrs++] = copy;
+
+out:
+    ws_object_unlock(&t->m.obj);
+    return res;
+}
+
+bool
+ws_transaction_expansion(
+    struct ws_transaction* t,
+    char const* const** attrs,
+    size_t* num
+) {
+    ws_object_lock_read(&t->m.obj);
+    bool retval = t->expand;
+    *attrs = (char const* const*) t->expand_attrs;
+    *num = t->num_expand_attrs;
+    ws_object_unlock(&t->m.obj);
+
+    return retval;
+}
+
 struct ws_transaction_command_list*
 ws_transaction_commands(
     struct ws_transaction* t
@@ -185,6 +244,25 @@ ws_transaction_commands(
     return t->cmds;
 }
 
+struct ws_bytecode const*
+ws_transaction_bytecode(
+    struct ws_transaction* t
+) {
+    ws_object_lock_write(&t->m.obj);
+
+    struct ws_bytecode* code = NULL;
+    if (t->cmds) {
+        if (!t->cmds->code) {
+            t->cmds->code = ws_bytecode_compile(t->cmds->statements,
+                                                t->cmds->num);
+        }
+        code = t->cmds->code;
+    }
+
+    ws_object_unlock(&t->m.obj);
+    return code;
+}
+
 int
 ws_transaction_push_statement(
     struct ws_transaction* t,
@@ -201,8 +279,13 @@ ws_transaction_push_statement(
         t->cmds->statements = NULL;
         t->cmds->len          = 1;
         t->cmds->num        = 0;
+        t->cmds->code       = NULL;
     }
 
+    // the compiled commands are outdated now
+    ws_bytecode_free(t->cmds->code);
+    t->cmds->code = NULL;
+
     if (t->cmds->len + 1 >= t->cmds->num) {
         struct ws_statement* tmp;
         size_t newsize = (t->cmds->len * 2) * sizeof(*t->cmds->statements);
@@ -242,10 +325,21 @@ deinit_transaction(
 
     ws_object_unref((struct ws_object*) t->name);
 
+    size_t attr = t->num_expand_attrs;
+    while (attr--) {
+        free(t->expand_attrs[attr]);
+    }
+    free(t->expand_attrs);
+    t->expand_attrs = NULL;
+    t->num_expand_attrs = 0;
+
     if (!t->cmds) {
         goto out;
     }
 
+    ws_bytecode_free(t->cmds->code);
+    t->cmds->code = NULL;
+
     if (!t->cmds->statements) {
         goto out;
     }
@@ -261,6 +355,15 @@ out:
     return true;
 }
 
+static size_t
+hash_transaction(
+    struct ws_object* const self
+) {
+    struct ws_transaction* t = (struct ws_transaction*) self;
+
+    return ws_object_hash((struct ws_object*) t->name);
+}
+
 static int
 cmp_transactions(
     struct ws_object const* o1,
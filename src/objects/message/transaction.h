@@ -47,6 +47,9 @@
 #include "objects/message/message.h"
 #include "objects/string.h"
 
+// forward declarations
+struct ws_bytecode;
+
 /**
  * Transaction action type
  *
@@ -64,6 +67,7 @@ struct ws_transaction_command_list {
     size_t len; //!< @protected length of the command array
     size_t num; //!< @protected next free position/number of statements
     struct ws_statement* statements; //!< @protected Transaction statements
+    struct ws_bytecode* code; //!< @protected compiled statements or `NULL`
 };
 
 /**
@@ -80,6 +84,10 @@ struct ws_transaction {
     enum ws_transaction_flags flags; //!< @protected What should be done?
 
     struct ws_transaction_command_list* cmds; //!< @protected Commands
+
+    bool expand; //!< @protected Expand objects in the reply?
+    char** expand_attrs; //!< @protected Attributes inlined for objects
+    size_t num_expand_attrs; //!< @protected Number of attributes inlined
 };
 
 extern ws_object_type_id WS_OBJECT_TYPE_ID_TRANSACTION;
@@ -179,6 +187,36 @@ ws_transaction_set_name(
     struct ws_string* name //!< The name
 );
 
+/**
+ * Request the expansion of objects in the reply of the transaction
+ *
+ * Objects referenced by the value reply are serialized with their type and
+ * the attributes requested rather than their uuid only. Each call enables the
+ * expansion and, if `attr` is not `NULL`, appends it to the attributes
+ * inlined.
+ *
+ * @return zero on success, else negative errno.h number
+ */
+int
+ws_transaction_expand(
+    struct ws_transaction* t, //!< The transaction
+    char const* attr //!< Attribute to inline or `NULL`
+);
+
+/**
+ * Get the expansion requested for objects in the reply
+ *
+ * @note The attributes remain owned by the transaction
+ *
+ * @return true if objects are expanded, false otherwise
+ */
+bool
+ws_transaction_expansion(
+    struct ws_transaction* t, //!< The transaction
+    char const* const** attrs, //!< Destination for the attributes inlined
+    size_t* num //!< Destination for the number of attributes
+);
+
 /**
  * Get the command list of the transaction
  *
@@ -189,6 +227,19 @@ ws_transaction_commands(
     struct ws_transaction* t //!< The transaction
 );
 
+/**
+ * Get the compiled command list of the transaction
+ *
+ * The commands are compiled on the first call, the result is kept until the
+ * command list is altered.
+ *
+ * @return compiled commands of the transaction or `NULL` on failure
+ */
+struct ws_bytecode const*
+ws_transaction_bytecode(
+    struct ws_transaction* t //!< The transaction
+);
+
 /**
  * Append a statement to the transaction
  *
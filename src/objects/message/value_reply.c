@@ -83,7 +83,8 @@ ws_value_reply_new(
     if (res < 0) {
         goto cleanup;
     }
-    ((struct ws_object*) retval)->id = &WS_OBJECT_TYPE_ID_VALUE_REPLY;
+    ws_object_set_type((struct ws_object*) retval,
+                       &WS_OBJECT_TYPE_ID_VALUE_REPLY);
     ((struct ws_object*) retval)->settings = WS_OBJECT_HEAPALLOCED;
 
     if (value) {
@@ -95,6 +96,13 @@ ws_value_reply_new(
         ws_value_nil_init(&retval->value.nil);
     }
 
+    // the transaction holds the expansion until the reply is serialized
+    char const* const* attrs;
+    size_t num;
+    if (ws_transaction_expansion(src, &attrs, &num)) {
+        retval->expand = getref(src);
+    }
+
     return retval;
 
 cleanup:
@@ -110,6 +118,21 @@ ws_value_reply_get_value(
     return &self->value.value;
 }
 
+bool
+ws_value_reply_expansion(
+    struct ws_value_reply* self,
+    char const* const** attrs,
+    size_t* num
+) {
+    if (!self->expand) {
+        *attrs = NULL;
+        *num = 0;
+        return false;
+    }
+
+    return ws_transaction_expansion(self->expand, attrs, num);
+}
+
 
 /*
  *
@@ -123,6 +146,7 @@ value_reply_deinit(
 ) {
     struct ws_value_reply* reply = (struct ws_value_reply*) obj;
     ws_value_deinit(&reply->value.value);
+    ws_object_unref((struct ws_object*) reply->expand);
     return true;
 }
 
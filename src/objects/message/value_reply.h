@@ -59,6 +59,7 @@ struct ws_transaction;
 struct ws_value_reply {
     struct ws_reply reply; //!< @protected base class
     union ws_value_union value; //!< @protected value type
+    struct ws_transaction* expand; //!< @protected source of expansion or NULL
 };
 
 /**
@@ -94,6 +95,22 @@ ws_value_reply_get_value(
 __ws_nonnull__(1)
 ;
 
+/**
+ * Get the expansion requested for objects in the value
+ *
+ * @note The attributes remain owned by the reply
+ *
+ * @return true if objects are expanded, false otherwise
+ */
+bool
+ws_value_reply_expansion(
+    struct ws_value_reply* self, //!< The reply
+    char const* const** attrs, //!< Destination for the attributes inlined
+    size_t* num //!< Destination for the number of attributes
+)
+__ws_nonnull__(1, 2, 3)
+;
+
 #endif // __WS_OBJECTS_VALUE_REPLY_H__
 
 /**
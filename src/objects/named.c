@@ -77,7 +77,7 @@ ws_named_init(
         return res;
 
     }
-    self->str.obj.id = &WS_OBJECT_TYPE_ID_NAMED;
+    ws_object_set_type(&self->str.obj, &WS_OBJECT_TYPE_ID_NAMED);
     self->str.obj.settings |= WS_OBJECT_HEAPALLOCED;
 
     if (!ws_string_set_from_str(&self->str, name)) {
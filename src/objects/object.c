@@ -33,7 +33,10 @@
 #include <uuid/uuid.h>
 
 #include "logger/module.h"
+#include "objects/deferred.h"
 #include "objects/object.h"
+#include "objects/registry.h"
+#include "objects/stats.h"
 #include "util/condition.h"
 #include "util/string.h"
 #include "values/bool.h"
@@ -53,6 +56,61 @@ static struct ws_logger_context log_ctx = {
  *
  */
 
+/**
+ * Generate a new, session-unique uuid
+ *
+ * The uuid is composed of a per-process random seed and a counter which is
+ * incremented atomically. Hence, no two calls within one session will return
+ * the same uuid.
+ *
+ * @return a new uuid, never `0`
+ */
+static uintmax_t
+generate_uuid(void);
+
+/**
+ * Initialize the seed for uuid generation
+ */
+static void
+init_uuid_seed(void);
+
+/**
+ * Lock a single object, unless it is a constant object and only read
+ *
+ * @return true if the lock was aquired or not needed, false on error
+ */
+static bool
+lock_one(
+    struct ws_object* self, //!< The object to lock
+    bool write //!< Whether to write-lock the object
+);
+
+/**
+ * Unlock an object locked with `lock_one()`
+ *
+ * @return true if the lock was unlocked or not held, false on error
+ */
+static bool
+unlock_one(
+    struct ws_object* self, //!< The object to unlock
+    bool write //!< Whether the object was write-locked
+);
+
+/**
+ * Seed for uuid generation
+ */
+static uintmax_t uuid_seed = 0;
+
+/**
+ * Counter for uuid generation
+ */
+static uintmax_t uuid_counter = 0;
+
+/**
+ * Once-guard for the initialization of the uuid seed
+ */
+static pthread_once_t uuid_seed_once = PTHREAD_ONCE_INIT;
+
 /*
  * Attribute information about the type
  */
@@ -204,6 +262,7 @@ ws_object_init(
         self->uuid = 0;
 
         self->id = &WS_OBJECT_TYPE_ID_OBJECT;
+        ws_object_stats_alloc(self->id);
 
         return true;
     }
@@ -228,6 +287,23 @@ ws_object_getref(
     return self;
 }
 
+bool
+ws_object_is_shared(
+    struct ws_object* self
+) {
+    if (!(self->settings & WS_OBJECT_HEAPALLOCED)) {
+        return true;
+    }
+
+    if (pthread_mutex_lock(&self->ref_counting.lock) != 0) {
+        return true;
+    }
+    bool shared = self->ref_counting.refcnt > 1;
+    pthread_mutex_unlock(&self->ref_counting.lock);
+
+    return shared;
+}
+
 void
 ws_object_unref(
     struct ws_object* self
@@ -247,6 +323,11 @@ ws_object_unref(
     }
     pthread_mutex_unlock(&self->ref_counting.lock);
 
+    // destroy the object at the end of the loop iteration, if possible
+    if (ws_object_deferred_push(self)) {
+        return;
+    }
+
     ws_object_deinit(self);
     free(self);
 }
@@ -259,8 +340,6 @@ ws_object_hash(
         return -EINVAL;
     }
 
-    ws_log(&log_ctx, LOG_DEBUG, "Hashing: %p (%s)", self, self->id->typestr);
-
     ws_object_type_id* type = self->id;
     while (!type->hash_callback) {
         // we hit the basic object type, which is totally abstract
@@ -313,12 +392,79 @@ ws_object_unlock(
     return 0 == pthread_rwlock_unlock(&self->rw_lock);
 }
 
+void
+ws_object_set_type(
+    struct ws_object* self,
+    ws_object_type_id* type
+) {
+    if (self->id == type) {
+        return;
+    }
+
+    ws_object_stats_retype(self->id, type);
+    self->id = type;
+}
+
+bool
+ws_object_lock_pair(
+    struct ws_object* o1,
+    bool write1,
+    struct ws_object* o2,
+    bool write2
+) {
+    if (o1 == o2) {
+        return lock_one(o1, write1 || write2);
+    }
+
+    // always lock the object with the lower address first
+    if ((uintptr_t) o1 > (uintptr_t) o2) {
+        struct ws_object* tmp_obj = o1;
+        o1 = o2;
+        o2 = tmp_obj;
+
+        bool tmp_write = write1;
+        write1 = write2;
+        write2 = tmp_write;
+    }
+
+    if (!lock_one(o1, write1)) {
+        return false;
+    }
+
+    if (!lock_one(o2, write2)) {
+        unlock_one(o1, write1);
+        return false;
+    }
+
+    return true;
+}
+
+bool
+ws_object_unlock_pair(
+    struct ws_object* o1,
+    bool write1,
+    struct ws_object* o2,
+    bool write2
+) {
+    if (o1 == o2) {
+        return unlock_one(o1, write1 || write2);
+    }
+
+    bool res = unlock_one(o2, write2);
+    return unlock_one(o1, write1) && res;
+}
+
 void
 ws_object_deinit(
     struct ws_object* self
 ) {
+    // make sure the object can not be resolved by its uuid any more
+    ws_object_registry_remove(self);
+
     ws_object_lock_write(self);
 
+    ws_object_stats_deinit(self->id);
+
     // traverse towards the root, deinitializing
     ws_object_type_id* type = self->id;
     while (type != &WS_OBJECT_TYPE_ID_OBJECT) {
@@ -491,13 +637,94 @@ err:
     return WS_OBJ_ATTR_NO_TYPE;
 }
 
+int
+ws_object_type_resolve_attrs(
+    ws_object_type_id* type,
+    char const* const* idents,
+    size_t num,
+    struct ws_object_attribute const** dest
+) {
+    size_t i;
+    for (i = 0; i < num; ++i) {
+        dest[i] = NULL;
+
+        // the attribute may be defined by any of the supertypes
+        ws_object_type_id* cur = type;
+        while (!dest[i]) {
+            struct ws_object_attribute const* iter = cur->attribute_table;
+            for (; iter && iter->name; ++iter) {
+                if (ws_streq(iter->name, idents[i])) {
+                    dest[i] = iter;
+                    break;
+                }
+            }
+
+            if (!cur->supertype || (cur->supertype == cur)) {
+                break;
+            }
+            cur = cur->supertype;
+        }
+
+        if (!dest[i]) {
+            return -ECANCELED;
+        }
+    }
+
+    return 0;
+}
+
+int
+ws_object_attr_read_ints(
+    struct ws_object* self,
+    struct ws_object_attribute const* const* attrs,
+    size_t num,
+    intmax_t* dest
+) {
+    int retval = 0;
+
+    ws_object_lock_read(self);
+
+    size_t i;
+    for (i = 0; (i < num) && (retval == 0); ++i) {
+        void* member_pos = (void *) (((char *) self) +
+                                     attrs[i]->offset_in_struct);
+
+        switch (attrs[i]->type) {
+        case WS_OBJ_ATTR_TYPE_CHAR:
+            dest[i] = *((char*) member_pos);
+            break;
+
+        case WS_OBJ_ATTR_TYPE_INT32:
+            dest[i] = *((int32_t*) member_pos);
+            break;
+
+        case WS_OBJ_ATTR_TYPE_INT64:
+            dest[i] = *((int64_t*) member_pos);
+            break;
+
+        case WS_OBJ_ATTR_TYPE_UINT32:
+            dest[i] = *((uint32_t*) member_pos);
+            break;
+
+        case WS_OBJ_ATTR_TYPE_UINT64:
+            dest[i] = (intmax_t) *((uint64_t*) member_pos);
+            break;
+
+        default:
+            retval = -EINVAL;
+            break;
+        }
+    }
+
+    ws_object_unlock(self);
+    return retval;
+}
+
 int
 ws_object_cmp(
     struct ws_object const* o1,
     struct ws_object const* o2
 ) {
-    ws_log(&log_ctx, LOG_DEBUG, "Comparing: %p <=> %p", o1, o2);
-
     if ((o1 == NULL) ^ (o2 == NULL)) {
         return (o1 != NULL) ? -1 : 1;
     }
@@ -506,24 +733,10 @@ ws_object_cmp(
         return 0;
     }
 
-    while (1) {
-        int try = ws_object_lock_try_read((struct ws_object*) o1);
-        if (try != 0) {
-            if (try == -EAGAIN || try == -EWOULDBLOCK) {
-                continue;
-            }
-            return try;
-        }
-
-        try = ws_object_lock_try_read((struct ws_object*) o2);
-        if (try != 0) {
-            ws_object_unlock((struct ws_object*) o1);
-            if (try == -EAGAIN || try == -EWOULDBLOCK) {
-                continue;
-            }
-            return try;
-        }
-        break;
+    // unlocked at the end, removing `const`
+    if (!ws_object_lock_pair((struct ws_object*) o1, false,
+                             (struct ws_object*) o2, false)) {
+        return -EAGAIN;
     }
 
     int res;
@@ -547,8 +760,8 @@ ws_object_cmp(
     res = type->cmp_callback(o1, o2);
 
 out:
-    ws_object_unlock((struct ws_object*) o2); // unlock, remove `const`
-    ws_object_unlock((struct ws_object*) o1); // unlock, remove `const`
+    ws_object_unlock_pair((struct ws_object*) o1, false,
+                          (struct ws_object*) o2, false);
     return res;
 }
 
@@ -556,35 +769,35 @@ uintmax_t
 ws_object_uuid(
     struct ws_object const* self //!< The object
 ) {
-    while (self->uuid == 0) {
-        // This case is rare, so we must cast here
-        struct ws_object* _self = (struct ws_object*) self;
-        if (!ws_object_lock_try_write(_self)) {
-            // check again if uuid is set
-            continue;
-        }
-
-        ws_object_type_id* type = self->id;
-
-        while (!type->uuid_callback) {
-            if (type == &WS_OBJECT_TYPE_ID_OBJECT) {
-                uintmax_t buff[(sizeof(uuid_t) / sizeof(uintmax_t)) + 1];
-                uuid_generate((unsigned char*) buff);
-                _self->uuid = buff[0];
+    uintmax_t uuid = __atomic_load_n(&self->uuid, __ATOMIC_ACQUIRE);
+    if (likely(uuid != 0)) {
+        return uuid;
+    }
 
-                goto iter_next;
-            }
+    ws_object_type_id* type = self->id;
+    while (!type->uuid_callback && (type != &WS_OBJECT_TYPE_ID_OBJECT)) {
+        type = type->supertype;
+    }
 
-            type = type->supertype;
-        }
+    uintmax_t new_uuid;
+    if (type->uuid_callback) {
+        new_uuid = type->uuid_callback((struct ws_object*) self);
+    } else {
+        new_uuid = generate_uuid();
+    }
 
-        _self->uuid = type->uuid_callback(_self);
+    // This case is rare, so we must cast here
+    struct ws_object* _self = (struct ws_object*) self;
 
-iter_next:
-        ws_object_unlock(_self);
+    // Another thread may have assigned an uuid in the meantime. In this case,
+    // the uuid assigned first wins and we just use that one.
+    if (!__atomic_compare_exchange_n(&_self->uuid, &uuid, new_uuid, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return uuid;
     }
 
-    return self->uuid;
+    ws_object_registry_add(_self);
+    return new_uuid;
 }
 
 bool
@@ -696,3 +909,52 @@ ws_object_has_cmd(
  * static function implementations
  *
  */
+
+static uintmax_t
+generate_uuid(void) {
+    pthread_once(&uuid_seed_once, init_uuid_seed);
+
+    uintmax_t uuid;
+    do {
+        uuid = uuid_seed + __atomic_add_fetch(&uuid_counter, 1,
+                                              __ATOMIC_RELAXED);
+    } while (unlikely(uuid == 0)); // zero means "no uuid"
+
+    return uuid;
+}
+
+static void
+init_uuid_seed(void) {
+    uintmax_t buff[(sizeof(uuid_t) / sizeof(uintmax_t)) + 1];
+    uuid_generate((unsigned char*) buff);
+    uuid_seed = buff[0];
+}
+
+static bool
+lock_one(
+    struct ws_object* self,
+    bool write
+) {
+    if (write) {
+        return ws_object_lock_write(self);
+    }
+
+    // constant objects do not change, so there is no need for read-locking
+    if (self->settings & WS_OBJ_CONST) {
+        return true;
+    }
+
+    return ws_object_lock_read(self);
+}
+
+static bool
+unlock_one(
+    struct ws_object* self,
+    bool write
+) {
+    if (!write && (self->settings & WS_OBJ_CONST)) {
+        return true;
+    }
+
+    return ws_object_unlock(self);
+}
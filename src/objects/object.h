@@ -300,6 +300,21 @@ ws_object_getref(
     struct ws_object* self //!< The object
 );
 
+/**
+ * Check whether an object may be referenced by others
+ *
+ * @memberof ws_object
+ *
+ * Objects which are not ref counted are always considered shared, since
+ * references to them can not be tracked.
+ *
+ * @return true if the object has more than one reference, false otherwise
+ */
+bool
+ws_object_is_shared(
+    struct ws_object* self //!< The object
+);
+
 /**
  * Unreference an object
  *
@@ -312,6 +327,9 @@ ws_object_getref(
  * @warning It is not save to use the object after this operation _in any kind_.
  * The object might be unavailable after this operation, as it was freed from
  * the heap.
+ *
+ * @note If deferred destruction is initialized, an object losing its last
+ * reference is destroyed at the end of the current loop iteration.
  */
 void
 ws_object_unref(
@@ -404,6 +422,68 @@ ws_object_unlock(
     struct ws_object* self //!< The object
 );
 
+/**
+ * Set the type of an object
+ *
+ * Used by the initialization functions of subtypes, after initializing the
+ * base type.
+ *
+ * @memberof ws_object
+ *
+ * @note Always use this function instead of assigning the type directly, as
+ *       the per-type object counters are updated here.
+ */
+void
+ws_object_set_type(
+    struct ws_object* self, //!< The object
+    ws_object_type_id* type //!< The new type of the object
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Lock two objects
+ *
+ * The objects are locked in the order of their addresses, hence two threads
+ * locking the same pair of objects will not deadlock, regardless of the order
+ * in which the objects are passed. If both objects are the same, the object is
+ * locked only once, with a write-lock if any of the two locks requested is a
+ * write-lock. Objects marked as `WS_OBJ_CONST` are not read-locked at all.
+ *
+ * @memberof ws_object
+ *
+ * @note The objects must be unlocked using `ws_object_unlock_pair()`, passing
+ *       the very same arguments.
+ *
+ * @return true if both locks were aquired, false on error (no lock is held)
+ */
+bool
+ws_object_lock_pair(
+    struct ws_object* o1, //!< The first object
+    bool write1, //!< Whether to write-lock the first object
+    struct ws_object* o2, //!< The second object
+    bool write2 //!< Whether to write-lock the second object
+)
+__ws_nonnull__(1, 3)
+;
+
+/**
+ * Unlock two objects locked via `ws_object_lock_pair()`
+ *
+ * @memberof ws_object
+ *
+ * @return true if the locks were unlocked, else false
+ */
+bool
+ws_object_unlock_pair(
+    struct ws_object* o1, //!< The first object
+    bool write1, //!< Whether the first object was write-locked
+    struct ws_object* o2, //!< The second object
+    bool write2 //!< Whether the second object was write-locked
+)
+__ws_nonnull__(1, 3)
+;
+
 /**
  * Uninitialize a ws_object
  *
@@ -494,6 +574,47 @@ ws_object_attr_type(
 __ws_nonnull__(1, 2)
 ;
 
+/**
+ * Resolve attributes of a type by their names
+ *
+ * Looks the attributes up in the attribute tables of `type` and its
+ * supertypes, so that they can be read from any number of objects of that type
+ * using `ws_object_attr_read_ints()` without matching their names again.
+ *
+ * @return zero on success, else negative error code from errno.h
+ *      -ECANCELED - if one of the attributes does not exist
+ */
+int
+ws_object_type_resolve_attrs(
+    ws_object_type_id* type, //!< The type to resolve the attributes for
+    char const* const* idents, //!< The identifiers of the attributes
+    size_t num, //!< Number of attributes to resolve
+    struct ws_object_attribute const** dest //!< Destination, `num` elements
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Read integral attributes of an object
+ *
+ * @memberof ws_object
+ *
+ * Reads the attributes previously resolved for the type of the object into
+ * `dest`, taking the read lock of the object only once.
+ *
+ * @return zero on success, else negative error code from errno.h
+ *      -EINVAL - if one of the attributes is not an integral one
+ */
+int
+ws_object_attr_read_ints(
+    struct ws_object* self, //!< The object
+    struct ws_object_attribute const* const* attrs, //!< Resolved attributes
+    size_t num, //!< Number of attributes to read
+    intmax_t* dest //!< Destination, `num` elements
+)
+__ws_nonnull__(1)
+;
+
 /**
  * Compare two ws_object instances
  *
@@ -521,7 +642,8 @@ ws_object_cmp(
  * Get an UUID for an object
  *
  * This method creates the UUID for the object if there is no uuid available for
- * it.
+ * it. Objects are added to the object registry when their UUID is created, so
+ * they may be resolved via `ws_object_registry_get()` afterwards.
  *
  * @memberof ws_object
  *
@@ -0,0 +1,324 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "objects/object.h"
+#include "objects/registry.h"
+#include "util/cleaner.h"
+#include "util/condition.h"
+
+/**
+ * Initial number of slots in the registry
+ *
+ * @note Must be a power of two
+ */
+#define REGISTRY_INITIAL_SIZE (64)
+
+/**
+ * Registry entry
+ *
+ * A slot with an uuid of `0` is free, a slot with an uuid but no object is a
+ * tombstone left behind by a removed object.
+ */
+struct registry_entry {
+    uintmax_t uuid; //!< uuid of the object registered
+    struct ws_object* obj; //!< the object (weak reference)
+};
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Mix the bits of an uuid into a hash value
+ *
+ * @return hash value for the uuid
+ */
+static size_t
+hash_uuid(
+    uintmax_t uuid //!< uuid to hash
+);
+
+/**
+ * Find the slot for an uuid
+ *
+ * @warning the registry must be locked and the table must be allocated
+ *
+ * @return the slot holding the uuid or the first free slot in the probe
+ *         sequence, if the uuid is not registered
+ */
+static struct registry_entry*
+find_slot(
+    uintmax_t uuid //!< uuid to look for
+);
+
+/**
+ * Rehash the registry into a table of a new size
+ *
+ * @warning the registry must be write-locked
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+static int
+rehash(
+    size_t size //!< new number of slots, must be a power of two
+);
+
+/**
+ * Free the registry
+ */
+static void
+registry_deinit(
+    void* dummy
+);
+
+/*
+ *
+ * Internal constant
+ *
+ */
+
+/**
+ * The registry
+ */
+static struct {
+    struct registry_entry* entries; //!< table of entries
+    size_t size; //!< number of slots in the table
+    size_t used; //!< number of slots used, including tombstones
+    size_t num; //!< number of objects registered
+    pthread_rwlock_t lock; //!< lock protecting the registry
+} registry = {
+    .entries = NULL,
+    .size = 0,
+    .used = 0,
+    .num = 0,
+    .lock = PTHREAD_RWLOCK_INITIALIZER,
+};
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_object_registry_add(
+    struct ws_object* obj
+) {
+    if (unlikely(obj->uuid == 0)) {
+        return -EINVAL;
+    }
+
+    int res = 0;
+    pthread_rwlock_wrlock(&registry.lock);
+
+    if (unlikely(!registry.entries)) {
+        res = rehash(REGISTRY_INITIAL_SIZE);
+        if (res < 0) {
+            goto out;
+        }
+        ws_cleaner_add(registry_deinit, NULL);
+    }
+
+    // keep the load below 3/4, including tombstones
+    if ((registry.used + 1) * 4 > registry.size * 3) {
+        // only grow if the table is actually filled with objects
+        size_t size = registry.size;
+        if ((registry.num + 1) * 2 > size) {
+            size *= 2;
+        }
+
+        res = rehash(size);
+        if (res < 0) {
+            goto out;
+        }
+    }
+
+    struct registry_entry* entry = find_slot(obj->uuid);
+    if (entry->obj) {
+        // already registered
+        res = (entry->obj == obj) ? 0 : -EEXIST;
+        goto out;
+    }
+
+    if (entry->uuid == 0) {
+        ++registry.used;
+    }
+    entry->uuid = obj->uuid;
+    entry->obj = obj;
+    ++registry.num;
+
+out:
+    pthread_rwlock_unlock(&registry.lock);
+    return res;
+}
+
+void
+ws_object_registry_remove(
+    struct ws_object const* obj
+) {
+    if (obj->uuid == 0) {
+        return;
+    }
+
+    pthread_rwlock_wrlock(&registry.lock);
+
+    if (registry.entries) {
+        struct registry_entry* entry = find_slot(obj->uuid);
+        if (entry->obj == obj) {
+            // leave a tombstone, the uuid stays in the slot
+            entry->obj = NULL;
+            --registry.num;
+        }
+    }
+
+    pthread_rwlock_unlock(&registry.lock);
+}
+
+struct ws_object*
+ws_object_registry_get(
+    uintmax_t uuid
+) {
+    if (uuid == 0) {
+        return NULL;
+    }
+
+    struct ws_object* retval = NULL;
+    pthread_rwlock_rdlock(&registry.lock);
+
+    if (unlikely(!registry.entries)) {
+        goto out;
+    }
+
+    struct ws_object* obj = find_slot(uuid)->obj;
+    // uuids are never reused, an entry with a mismatching uuid is stale
+    if (!obj || obj->uuid != uuid) {
+        goto out;
+    }
+
+    if (!(obj->settings & WS_OBJECT_HEAPALLOCED)) {
+        retval = obj;
+        goto out;
+    }
+
+    // We may not use `ws_object_getref()` here: an object which lost its last
+    // reference is still registered until it is deinitialized, and it must not
+    // be revived.
+    if (pthread_mutex_lock(&obj->ref_counting.lock) != 0) {
+        goto out;
+    }
+    if (obj->ref_counting.refcnt > 0) {
+        obj->ref_counting.refcnt++;
+        retval = obj;
+    }
+    pthread_mutex_unlock(&obj->ref_counting.lock);
+
+out:
+    pthread_rwlock_unlock(&registry.lock);
+    return retval;
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static size_t
+hash_uuid(
+    uintmax_t uuid
+) {
+    // finalizer of splitmix64, spreads sequential uuids over the table
+    uint64_t h = (uint64_t) uuid;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return (size_t) (h ^ (h >> 31));
+}
+
+static struct registry_entry*
+find_slot(
+    uintmax_t uuid
+) {
+    size_t mask = registry.size - 1;
+    size_t pos = hash_uuid(uuid) & mask;
+
+    // linear probing, the table is never full
+    while (registry.entries[pos].uuid != 0 &&
+            registry.entries[pos].uuid != uuid) {
+        pos = (pos + 1) & mask;
+    }
+
+    return registry.entries + pos;
+}
+
+static int
+rehash(
+    size_t size
+) {
+    struct registry_entry* old = registry.entries;
+    size_t old_size = registry.size;
+
+    registry.entries = calloc(size, sizeof(*registry.entries));
+    if (!registry.entries) {
+        registry.entries = old;
+        return -ENOMEM;
+    }
+    registry.size = size;
+    registry.used = registry.num;
+
+    // re-insert all the live entries, dropping the tombstones
+    size_t i;
+    for (i = 0; i < old_size; ++i) {
+        if (old[i].obj) {
+            *find_slot(old[i].uuid) = old[i];
+        }
+    }
+
+    free(old);
+    return 0;
+}
+
+static void
+registry_deinit(
+    void* dummy
+) {
+    pthread_rwlock_wrlock(&registry.lock);
+    free(registry.entries);
+    registry.entries = NULL;
+    registry.size = 0;
+    registry.used = 0;
+    registry.num = 0;
+    pthread_rwlock_unlock(&registry.lock);
+}
+
@@ -0,0 +1,110 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup objects "Classes"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup objects_registry "Object registry"
+ *
+ * Registry for resolving UUIDs to live objects
+ *
+ * Objects are registered lazily, the first time their UUID is requested via
+ * `ws_object_uuid()`, and are removed from the registry when they are
+ * deinitialized.
+ * The registry does not hold references on the objects it contains: entries
+ * are weak.
+ *
+ * @{
+ */
+
+#ifndef __WS_OBJECTS_REGISTRY_H__
+#define __WS_OBJECTS_REGISTRY_H__
+
+#include <stdint.h>
+
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_object;
+
+/**
+ * Register an object by its UUID
+ *
+ * @note This function is called by `ws_object_uuid()` and should not be called
+ *       elsewhere.
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+int
+ws_object_registry_add(
+    struct ws_object* obj //!< object to register, must have an uuid set
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Remove an object from the registry
+ *
+ * @note This function is called by `ws_object_deinit()` and should not be
+ *       called elsewhere.
+ */
+void
+ws_object_registry_remove(
+    struct ws_object const* obj //!< object to remove
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Resolve an UUID to a live object
+ *
+ * Objects which are about to be destroyed, e.g. objects which lost their last
+ * reference but are not yet deinitialized, are not returned.
+ *
+ * @note Returns a reference on the object
+ *
+ * @return the object with the UUID given or `NULL`, if no such object exists
+ */
+struct ws_object*
+ws_object_registry_get(
+    uintmax_t uuid //!< UUID of the object to look up
+);
+
+#endif // __WS_OBJECTS_REGISTRY_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
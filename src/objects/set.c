@@ -25,11 +25,13 @@
  * along with waysome. If not, see <http://www.gnu.org/licenses/>.
  */
 
+
+#include <assert.h>
+#include <endian.h>
 #include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
-
-#include <libreset/hash.h>
-#include <libreset/set.h>
+#include <string.h>
 
 #include "objects/object.h"
 
@@ -37,20 +39,85 @@
 
 /*
  *
- * Forward declarations
+ * Internal constants
  *
  */
 
 /**
- * Compare two objects
+ * Number of control bytes probed at once
+ */
+#define GROUP_WIDTH 8
+
+/**
+ * Control byte marking an empty slot
+ */
+#define CTRL_EMPTY ((uint8_t) 0x80)
+
+/**
+ * Control byte marking a slot of a removed element
+ */
+#define CTRL_DELETED ((uint8_t) 0xFE)
+
+/**
+ * Lowest bit of each control byte in a group
+ */
+#define GROUP_LSBS UINT64_C(0x0101010101010101)
+
+/**
+ * Highest bit of each control byte in a group
+ */
+#define GROUP_MSBS UINT64_C(0x8080808080808080)
+
+/**
+ * Number of slots allocated for the first element
+ */
+#define MIN_CAPACITY 16
+
+/**
+ * Slot index denoting "no such slot"
+ */
+#define NOT_FOUND SIZE_MAX
+
+/**
+ * Maximum number of levels of the ordered index
+ *
+ * With a branching factor of 4, this is plenty for any set fitting in memory.
+ */
+#define ORDER_MAX_LEVEL 16
+
+/**
+ * Set operations
+ */
+enum set_operation {
+    SET_UNION,
+    SET_INTERSECTION,
+    SET_DIFFERENCE,
+    SET_XOR,
+};
+
+/**
+ * Node of the ordered index
+ */
+struct order_node {
+    struct ws_object* obj; //!< The element
+    size_t height; //!< Number of levels the node is linked into
+    struct order_node* next[]; //!< Successors, one per level
+};
+
+/**
+ * Ordered index, a skip list
+ */
+struct ws_set_order {
+    struct order_node* head[ORDER_MAX_LEVEL]; //!< First node on each level
+    size_t level; //!< Number of levels in use
+    uint64_t rand; //!< State of the random number generator for node heights
+};
+
+/*
+ *
+ * Forward declarations
  *
- * @return 1 if both parameters point to the same objects, 0 otherwise
  */
-static int
-cmp_objects(
-    void const* a, //!< object a
-    void const* b //!< object b
-);
 
 /**
  * Deinit callback for ws_set type
@@ -78,21 +145,224 @@ get_greatest(
     void const* src //!< source
 );
 
-/*
+/**
+ * Callback for ws_set_select_any()
+ */
+static int
+get_reference(
+    void* dest, //!< destination
+    void const* src //!< source
+);
+
+/**
+ * Find the slot holding an object
  *
- * Internal structs
+ * @return the index of the slot or `NOT_FOUND`
+ */
+static size_t
+find_slot(
+    struct ws_set const* self, //!< The set
+    struct ws_object const* cmp, //!< Object to compare to
+    size_t hash //!< Hash of `cmp`
+);
+
+/**
+ * Find the first empty or deleted slot for a hash
+ *
+ * @warning the set must have at least one free slot
  *
+ * @return the index of the slot
  */
+static size_t
+find_free(
+    struct ws_set const* self, //!< The set
+    size_t mixed //!< Mixed hash, as returned by `mix_hash()`
+);
 
 /**
- * Set configuration for libreset. Not meant to be public.
+ * Find the next slot holding an element, starting at `slot`
+ *
+ * @return the index of the slot or the capacity of the set, if there is none
+ */
+static size_t
+next_full(
+    struct ws_set const* self, //!< The set
+    size_t slot //!< Slot to start from
+);
+
+/**
+ * Insert an object with a known hash
+ *
+ * @return zero on success, else negative error value from errno.h
+ */
+static int
+insert_hashed(
+    struct ws_set* self, //!< The set
+    struct ws_object* obj, //!< The object to insert
+    size_t hash //!< Hash of the object
+);
+
+/**
+ * Remove the element in a slot
+ */
+static void
+erase_slot(
+    struct ws_set* self, //!< The set
+    size_t slot //!< The slot to clear
+);
+
+/**
+ * Move all the elements to a table with the given capacity
+ *
+ * This also gets rid of all the slots marked as deleted.
+ *
+ * @return zero on success, else negative error value from errno.h
+ */
+static int
+rehash(
+    struct ws_set* self, //!< The set
+    size_t capacity //!< The new capacity, a power of two
+);
+
+/**
+ * Remove all the elements and release the table
+ */
+static void
+clear_table(
+    struct ws_set* self //!< The set
+);
+
+/**
+ * Perform a set operation
+ *
+ * The result is computed into a temporary set, which is swapped into `dest`
+ * on success. Hence, `dest` may be one of the sources.
+ *
+ * @return zero on success, else negative error value from errno.h
+ */
+static int
+set_operation(
+    struct ws_set* dest, //!< The destination set
+    struct ws_set const* src_a, //!< The first source set
+    struct ws_set const* src_b, //!< The second source set
+    enum set_operation op //!< Operation to perform
+);
+
+/**
+ * Insert all the elements of `src` which are (not) in `other`
+ *
+ * If `other` is `NULL`, all the elements of `src` are inserted.
+ *
+ * @return zero on success, else negative error value from errno.h
+ */
+static int
+insert_filtered(
+    struct ws_set* dest, //!< The destination set
+    struct ws_set const* src, //!< The set to take elements from
+    struct ws_set const* other, //!< The set to check elements against
+    bool contained //!< Whether to insert elements which are in `other`
+);
+
+/**
+ * Check whether `other` is a subset of (or equal to) `self`
+ *
+ * Both sets are read-locked for the comparison.
+ *
+ * @return true if the check holds, false otherwise or on error
+ */
+static bool
+compare_sets(
+    struct ws_set const* self, //!< The superset
+    struct ws_set const* other, //!< The set to check
+    bool equal //!< Whether the sets have to be equal
+);
+
+/**
+ * Compare two elements for the ordered index
+ *
+ * Other than ws_object_cmp(), this function defines a total order, even for
+ * elements of different types or types without a compare callback.
+ *
+ * @return a negative value if `a` is lower, zero if they are equal, a positive
+ *         value if `a` is greater than `b`
+ */
+static int
+order_cmp(
+    struct ws_object const* a, //!< First element
+    struct ws_object const* b //!< Second element
+);
+
+/**
+ * Find the predecessors of an element on each level of the ordered index
+ *
+ * `update[l][l]` is the link to the first node not lower than `obj` on level
+ * `l`.
+ */
+static void
+order_find(
+    struct ws_set_order* order, //!< The ordered index
+    struct ws_object const* obj, //!< Element to look for
+    struct order_node** update[ORDER_MAX_LEVEL] //!< Predecessors
+);
+
+/**
+ * Insert an element into the ordered index
+ *
+ * @return zero on success, else negative error value from errno.h
+ */
+static int
+order_insert(
+    struct ws_set_order* order, //!< The ordered index
+    struct ws_object* obj //!< Element to insert
+);
+
+/**
+ * Remove an element from the ordered index
+ */
+static void
+order_remove(
+    struct ws_set_order* order, //!< The ordered index
+    struct ws_object const* obj //!< Element to remove
+);
+
+/**
+ * Remove all the nodes from the ordered index
+ */
+static void
+order_clear(
+    struct ws_set_order* order //!< The ordered index
+);
+
+/**
+ * Get the greatest element of the ordered index
+ *
+ * @return the greatest element or `NULL`, if the index is empty
+ */
+static struct ws_object*
+order_last(
+    struct ws_set_order const* order //!< The ordered index
+);
+
+/**
+ * Process the nodes of the ordered index, starting at `node`
+ *
+ * @return zero or the first non-zero value returned by `proc`
+ */
+static int
+order_select(
+    struct order_node const* node, //!< First node to process
+    struct ws_object const* upper, //!< Upper bound or `NULL`
+    ws_set_predf pred, //!< Predicate function
+    void* pred_etc, //!< Additional parameter for the predicate function
+    ws_set_procf proc, //!< Processor function
+    void* proc_etc //!< Additional parameter for the processor function
+);
+
+/*
+ *
+ * Internal structs
+ *
  */
-static const struct r_set_cfg WS_SET_CONFIGURATION= {
-    .cmpf = cmp_objects,
-    .copyf = (void* (*)(void*)) ws_object_getref,
-    .freef = (void (*)(void*)) ws_object_unref,
-    .hashf = (r_hash (*)(void const*)) ws_object_hash,
-};
 
 /**
  * Type information for ws_set type
@@ -126,13 +396,15 @@ ws_set_init(
     }
     ws_object_init(&self->obj);
 
-    self->obj.id = &WS_OBJECT_TYPE_ID_SET;
-
-    self->set = r_set_new(&WS_SET_CONFIGURATION);
+    ws_object_set_type(&self->obj, &WS_OBJECT_TYPE_ID_SET);
 
-    if (!self->set) {
-        return -ENOMEM;
-    }
+    // the table is allocated on the first insertion
+    self->entries = NULL;
+    self->ctrl = NULL;
+    self->capacity = 0;
+    self->num = 0;
+    self->growth_left = 0;
+    self->order = NULL;
 
     return 0;
 }
@@ -150,6 +422,57 @@ ws_set_new(void)
     return set;
 }
 
+int
+ws_set_enable_ordering(
+    struct ws_set* self
+) {
+    if (!self) {
+        return -EINVAL;
+    }
+
+    if (self->order) {
+        return 0;
+    }
+
+    struct ws_set_order* order = calloc(1, sizeof(*order));
+    if (!order) {
+        return -ENOMEM;
+    }
+    // any non-zero seed will do
+    order->rand = (uintptr_t) self | 1;
+
+    size_t slot;
+    for (slot = next_full(self, 0); slot < self->capacity;
+            slot = next_full(self, slot + 1)) {
+        if (order_insert(order, self->entries[slot].obj) < 0) {
+            order_clear(order);
+            free(order);
+            return -ENOMEM;
+        }
+    }
+
+    self->order = order;
+    return 0;
+}
+
+void
+ws_set_disable_ordering(
+    struct ws_set* self
+) {
+    if (self && self->order) {
+        order_clear(self->order);
+        free(self->order);
+        self->order = NULL;
+    }
+}
+
+bool
+ws_set_is_ordered(
+    struct ws_set const* self
+) {
+    return self && self->order;
+}
+
 int
 ws_set_insert(
     struct ws_set* self,
@@ -158,13 +481,8 @@ ws_set_insert(
     if (!self || !obj) {
         return -EINVAL;
     }
-    int res = r_set_insert(self->set, obj);
-
-    if (res == 0 || res == -EEXIST) {
-        return 0;
-    }
 
-    return res;
+    return insert_hashed(self, obj, ws_object_hash(obj));
 }
 
 int
@@ -176,13 +494,13 @@ ws_set_remove(
         return -EINVAL;
     }
 
-    int r = r_set_remove(self->set, cmp);
-
-    if (r == 0 || r == -EEXIST) {
-        return 0;
+    size_t slot = find_slot(self, cmp, ws_object_hash((struct ws_object*) cmp));
+    if (slot == NOT_FOUND) {
+        return -ENOENT;
     }
 
-    return r;
+    erase_slot(self, slot);
+    return 0;
 }
 
 struct ws_object*
@@ -194,72 +512,80 @@ ws_set_get(
         return NULL;
     }
 
-    struct ws_object* o = r_set_contains(self->set, cmp);
-    ws_object_getref(o);
-    return o;
-}
-
-// int
-// ws_set_union(
-//     struct ws_set* dest,
-//     struct ws_set const* src_a,
-//     struct ws_set const* src_b
-// ) {
-//     if (dest && src_a && src_b) {
-//         return r_set_union(dest->set, src_a->set, src_b->set);
-//     }
-//
-//     return -EINVAL;
-// }
-
-// int
-// ws_set_intersection(
-//     struct ws_set* dest,
-//     struct ws_set const* src_a,
-//     struct ws_set const* src_b
-// ) {
-//     if (dest && src_a && src_b) {
-//         return r_set_intersection(dest->set, src_a->set, src_b->set);
-//     }
-//
-//     return -EINVAL;
-// }
-
-// int
-// ws_set_xor(
-//     struct ws_set* dest,
-//     struct ws_set const* src_a,
-//     struct ws_set const* src_b
-// ) {
-//     if (dest && src_a && src_b) {
-//         return r_set_xor(dest->set, src_a->set, src_b->set);
-//     }
-//
-//     return -EINVAL;
-// }
-
-// bool
-// ws_set_is_subset(
-//     struct ws_set const* self,
-//     struct ws_set const* other
-// ) {
-//     if (self && other) {
-//         return r_set_is_subset(self->set, other->set);
-//     }
-//
-//     return false;
-// }
+    size_t slot = find_slot(self, cmp, ws_object_hash((struct ws_object*) cmp));
+    if (slot == NOT_FOUND) {
+        return NULL;
+    }
+
+    return ws_object_getref(self->entries[slot].obj);
+}
+
+int
+ws_set_union(
+    struct ws_set* dest,
+    struct ws_set const* src_a,
+    struct ws_set const* src_b
+) {
+    if (dest && src_a && src_b) {
+        return set_operation(dest, src_a, src_b, SET_UNION);
+    }
+
+    return -EINVAL;
+}
+
+int
+ws_set_intersection(
+    struct ws_set* dest,
+    struct ws_set const* src_a,
+    struct ws_set const* src_b
+) {
+    if (dest && src_a && src_b) {
+        return set_operation(dest, src_a, src_b, SET_INTERSECTION);
+    }
+
+    return -EINVAL;
+}
+
+int
+ws_set_difference(
+    struct ws_set* dest,
+    struct ws_set const* src_a,
+    struct ws_set const* src_b
+) {
+    if (dest && src_a && src_b) {
+        return set_operation(dest, src_a, src_b, SET_DIFFERENCE);
+    }
+
+    return -EINVAL;
+}
+
+int
+ws_set_xor(
+    struct ws_set* dest,
+    struct ws_set const* src_a,
+    struct ws_set const* src_b
+) {
+    if (dest && src_a && src_b) {
+        return set_operation(dest, src_a, src_b, SET_XOR);
+    }
+
+    return -EINVAL;
+}
 
 bool
-ws_set_equal(
+ws_set_is_subset(
     struct ws_set const* self,
     struct ws_set const* other
 ) {
-    if (self && other) {
-        return r_set_equal(self->set, other->set);
-    }
+    return self && other && compare_sets(self, other, false);
+}
 
-    return false;
+bool
+ws_set_equal(
+    struct ws_set const* self,
+    struct ws_set const* other
+) {
+    return self && other && compare_sets(self, other, true);
 }
 
 size_t
@@ -267,7 +593,7 @@ ws_set_cardinality(
     struct ws_set const* self
 ) {
     if (self) {
-        return r_set_cardinality(self->set);
+        return self->num;
     }
 
     return 0;
@@ -281,36 +607,79 @@ ws_set_select(
     ws_set_procf proc,
     void* proc_etc
 ) {
-    if (self) {
-        return r_set_select(self->set, pred, pred_etc, proc, proc_etc);
+    if (!self || !proc) {
+        return -EINVAL;
     }
 
-    return -EINVAL;
-}
+    if (self->order) {
+        return order_select(self->order->head[0], NULL, pred, pred_etc,
+                            proc, proc_etc);
+    }
 
+    size_t slot;
+    for (slot = next_full(self, 0); slot < self->capacity;
+            slot = next_full(self, slot + 1)) {
+        struct ws_object* obj = self->entries[slot].obj;
 
-static int
-get_reference(
-    void* dest,
-    void const* src
-) {
-    *(struct ws_object**) dest = (void*) src;
-    return 1;
-}
+        if (pred && !pred(obj, pred_etc)) {
+            continue;
+        }
 
-struct ws_object*
-ws_set_select_any(
-    struct ws_set const* self
-) {
-    void* tmp = NULL;
-    ws_set_select(self, NULL, NULL, get_reference, &tmp);
-    return tmp;
+        int res = proc(proc_etc, obj);
+        if (res != 0) {
+            return res;
+        }
+    }
+
+    return 0;
 }
 
-struct ws_object*
-ws_set_select_lowest(
+int
+ws_set_select_range(
+    struct ws_set const* self,
+    struct ws_object const* lower,
+    struct ws_object const* upper,
+    ws_set_predf pred,
+    void* pred_etc,
+    ws_set_procf proc,
+    void* proc_etc
+) {
+    if (!self || !proc) {
+        return -EINVAL;
+    }
+
+    if (!self->order) {
+        return -ENOTSUP;
+    }
+
+    struct order_node const* first = self->order->head[0];
+    if (lower) {
+        struct order_node** update[ORDER_MAX_LEVEL];
+        order_find(self->order, lower, update);
+        first = update[0][0];
+    }
+
+    return order_select(first, upper, pred, pred_etc, proc, proc_etc);
+}
+
+struct ws_object*
+ws_set_select_any(
     struct ws_set const* self
 ) {
+    void* tmp = NULL;
+    ws_set_select(self, NULL, NULL, get_reference, &tmp);
+    return tmp;
+}
+
+struct ws_object*
+ws_set_select_lowest(
+    struct ws_set const* self
+) {
+    if (self && self->order) {
+        struct order_node const* first = self->order->head[0];
+        return first ? first->obj : NULL;
+    }
+
     void* tmp = NULL;
     ws_set_select(self, NULL, NULL, get_lowest, &tmp);
     return tmp;
@@ -320,26 +689,513 @@ struct ws_object*
 ws_set_select_greatest(
     struct ws_set const* self
 ) {
+    if (self && self->order) {
+        return order_last(self->order);
+    }
+
     void* tmp = NULL;
     ws_set_select(self, NULL, NULL, get_greatest, &tmp);
     return tmp;
 }
 
+struct ws_object*
+ws_set_select_next(
+    struct ws_set const* self,
+    size_t* cursor
+) {
+    if (!self || !cursor || (*cursor >= self->capacity)) {
+        return NULL;
+    }
+
+    size_t slot = next_full(self, *cursor);
+    if (slot >= self->capacity) {
+        *cursor = self->capacity;
+        return NULL;
+    }
+
+    *cursor = slot + 1;
+    return ws_object_getref(self->entries[slot].obj);
+}
+
 /*
  *
  * Internal implementation
  *
  */
 
+/**
+ * Spread the bits of a hash
+ *
+ * Many hash callbacks return values with only a few significant bits. Both the
+ * control byte and the position of an element are derived from the mixed hash.
+ *
+ * @return the mixed hash
+ */
+static inline size_t
+mix_hash(
+    size_t hash //!< Hash as returned by ws_object_hash()
+) {
+    uint64_t mixed = (uint64_t) hash * UINT64_C(0x9E3779B97F4A7C15);
+    return (size_t) (mixed ^ (mixed >> 32));
+}
+
+/**
+ * Load a group of control bytes
+ *
+ * The control byte of the first slot ends up in the lowest byte of the group.
+ *
+ * @return the group
+ */
+static inline uint64_t
+group_load(
+    uint8_t const* ctrl //!< First control byte of the group
+) {
+    uint64_t group;
+    memcpy(&group, ctrl, sizeof(group));
+    return le64toh(group);
+}
+
+/**
+ * Get the slots of a group whose control byte equals `h2`
+ *
+ * May report false positives, which are filtered by the caller comparing the
+ * cached hashes, but no false negatives.
+ *
+ * @return a mask with the highest bit of each matching control byte set
+ */
+static inline uint64_t
+group_match(
+    uint64_t group, //!< Group of control bytes
+    uint8_t h2 //!< 7 bit hash fragment to look for
+) {
+    uint64_t x = group ^ (GROUP_LSBS * h2);
+    return (x - GROUP_LSBS) & ~x & GROUP_MSBS;
+}
+
+/**
+ * Get the empty slots of a group
+ *
+ * @return a mask with the highest bit of each empty control byte set
+ */
+static inline uint64_t
+group_match_empty(
+    uint64_t group //!< Group of control bytes
+) {
+    return group & ~(group << 6) & GROUP_MSBS;
+}
+
+/**
+ * Get the empty or deleted slots of a group
+ *
+ * @return a mask with the highest bit of each free control byte set
+ */
+static inline uint64_t
+group_match_free(
+    uint64_t group //!< Group of control bytes
+) {
+    return group & ~(group << 7) & GROUP_MSBS;
+}
+
+/**
+ * Get the first slot of a match mask
+ *
+ * @return the index of the slot within the group
+ */
+static inline size_t
+mask_first(
+    uint64_t mask //!< Non-zero mask, as returned by the `group_match*()`s
+) {
+    return __builtin_ctzll(mask) / 8;
+}
+
+/**
+ * Maximum number of elements for a capacity, before we need to grow
+ *
+ * @return the maximum load
+ */
+static inline size_t
+max_load(
+    size_t capacity //!< Capacity of the table
+) {
+    return capacity - capacity / 8;
+}
+
+static size_t
+find_slot(
+    struct ws_set const* self,
+    struct ws_object const* cmp,
+    size_t hash
+) {
+    if (!self->capacity) {
+        return NOT_FOUND;
+    }
+
+    size_t mixed = mix_hash(hash);
+    size_t mask = self->capacity / GROUP_WIDTH - 1;
+    size_t group = (mixed >> 7) & mask;
+
+    // triangular probing visits each group exactly once
+    size_t probe;
+    for (probe = 1; probe <= mask + 1; ++probe) {
+        size_t base = group * GROUP_WIDTH;
+        uint64_t ctrl = group_load(self->ctrl + base);
+
+        uint64_t match;
+        for (match = group_match(ctrl, mixed & 0x7F); match;
+                match &= match - 1) {
+            size_t slot = base + mask_first(match);
+            struct ws_set_entry const* entry = self->entries + slot;
+
+            if ((entry->hash == hash) &&
+                    (ws_object_cmp(entry->obj, cmp) == 0)) {
+                return slot;
+            }
+        }
+
+        // the element would have been inserted here
+        if (group_match_empty(ctrl)) {
+            break;
+        }
+
+        group = (group + probe) & mask;
+    }
+
+    return NOT_FOUND;
+}
+
+static size_t
+find_free(
+    struct ws_set const* self,
+    size_t mixed
+) {
+    size_t mask = self->capacity / GROUP_WIDTH - 1;
+    size_t group = (mixed >> 7) & mask;
+
+    size_t probe = 1;
+    while (1) {
+        size_t base = group * GROUP_WIDTH;
+        uint64_t match = group_match_free(group_load(self->ctrl + base));
+        if (match) {
+            return base + mask_first(match);
+        }
+
+        group = (group + probe++) & mask;
+    }
+}
+
+static size_t
+next_full(
+    struct ws_set const* self,
+    size_t slot
+) {
+    while (slot < self->capacity) {
+        size_t base = slot & ~((size_t) GROUP_WIDTH - 1);
+
+        // full slots have the highest bit cleared
+        uint64_t match = ~group_load(self->ctrl + base) & GROUP_MSBS;
+        match &= ~UINT64_C(0) << (8 * (slot - base));
+        if (match) {
+            return base + mask_first(match);
+        }
+
+        slot = base + GROUP_WIDTH;
+    }
+
+    return self->capacity;
+}
+
+static int
+insert_hashed(
+    struct ws_set* self,
+    struct ws_object* obj,
+    size_t hash
+) {
+    if (find_slot(self, obj, hash) != NOT_FOUND) {
+        return 0;
+    }
+
+    if (!self->growth_left) {
+        size_t capacity = self->capacity;
+        if (!capacity) {
+            capacity = MIN_CAPACITY;
+        } else if (self->num >= max_load(capacity) / 2) {
+            capacity *= 2;
+        } // else: enough slots are marked as deleted, rehash in place
+
+        int res = rehash(self, capacity);
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    struct ws_object* ref = ws_object_getref(obj);
+    if (!ref) {
+        return -EAGAIN;
+    }
+
+    if (self->order) {
+        int res = order_insert(self->order, ref);
+        if (res < 0) {
+            ws_object_unref(ref);
+            return res;
+        }
+    }
+
+    size_t mixed = mix_hash(hash);
+    size_t slot = find_free(self, mixed);
+
+    if (self->ctrl[slot] == CTRL_EMPTY) {
+        --self->growth_left;
+    }
+    self->ctrl[slot] = mixed & 0x7F;
+    self->entries[slot].hash = hash;
+    self->entries[slot].obj = ref;
+    ++self->num;
+
+    return 0;
+}
+
+static void
+erase_slot(
+    struct ws_set* self,
+    size_t slot
+) {
+    size_t base = slot & ~((size_t) GROUP_WIDTH - 1);
+
+    // If the group has an empty slot, no probe sequence ever continued past
+    // it, so we may mark the slot empty rather than deleted.
+    if (group_match_empty(group_load(self->ctrl + base))) {
+        self->ctrl[slot] = CTRL_EMPTY;
+        ++self->growth_left;
+    } else {
+        self->ctrl[slot] = CTRL_DELETED;
+    }
+
+    struct ws_object* obj = self->entries[slot].obj;
+    self->entries[slot].obj = NULL;
+    --self->num;
+
+    if (self->order) {
+        order_remove(self->order, obj);
+    }
+
+    ws_object_unref(obj);
+}
+
+static int
+rehash(
+    struct ws_set* self,
+    size_t capacity
+) {
+    struct ws_set_entry* entries = calloc(capacity, sizeof(*entries));
+    uint8_t* ctrl = malloc(capacity);
+    if (!entries || !ctrl) {
+        free(entries);
+        free(ctrl);
+        return -ENOMEM;
+    }
+    memset(ctrl, CTRL_EMPTY, capacity);
+
+    struct ws_set_entry* old_entries = self->entries;
+    uint8_t* old_ctrl = self->ctrl;
+    size_t old_capacity = self->capacity;
+
+    self->entries = entries;
+    self->ctrl = ctrl;
+    self->capacity = capacity;
+    self->growth_left = max_load(capacity) - self->num;
+
+    size_t slot;
+    for (slot = 0; slot < old_capacity; ++slot) {
+        if (old_ctrl[slot] & CTRL_EMPTY) {
+            // empty or deleted
+            continue;
+        }
+
+        size_t mixed = mix_hash(old_entries[slot].hash);
+        size_t new_slot = find_free(self, mixed);
+
+        ctrl[new_slot] = mixed & 0x7F;
+        entries[new_slot] = old_entries[slot];
+    }
+
+    free(old_entries);
+    free(old_ctrl);
+
+    return 0;
+}
+
+static void
+clear_table(
+    struct ws_set* self
+) {
+    if (self->order) {
+        order_clear(self->order);
+    }
+
+    size_t slot;
+    for (slot = next_full(self, 0); slot < self->capacity;
+            slot = next_full(self, slot + 1)) {
+        ws_object_unref(self->entries[slot].obj);
+    }
+
+    free(self->entries);
+    free(self->ctrl);
+
+    self->entries = NULL;
+    self->ctrl = NULL;
+    self->capacity = 0;
+    self->num = 0;
+    self->growth_left = 0;
+}
+
 static int
-cmp_objects(
-    void const* a,
-    void const* b
+set_operation(
+    struct ws_set* dest,
+    struct ws_set const* src_a,
+    struct ws_set const* src_b,
+    enum set_operation op
 ) {
-    struct ws_object* o1 = (struct ws_object*) a;
-    struct ws_object* o2 = (struct ws_object*) b;
+    struct ws_set result;
+    int res = ws_set_init(&result);
+    if (res < 0) {
+        return res;
+    }
+
+    // the sources are only read, `dest` is locked for the swap only
+    struct ws_object* obj_a = (struct ws_object*) &src_a->obj;
+    struct ws_object* obj_b = (struct ws_object*) &src_b->obj;
+    if (!ws_object_lock_pair(obj_a, false, obj_b, false)) {
+        res = -EAGAIN;
+        goto out;
+    }
+
+    switch (op) {
+    case SET_UNION:
+        res = insert_filtered(&result, src_a, NULL, false);
+        if (res == 0) {
+            res = insert_filtered(&result, src_b, NULL, false);
+        }
+        break;
+
+    case SET_INTERSECTION:
+        // iterate over the smaller set, look up in the bigger one
+        if (src_a->num <= src_b->num) {
+            res = insert_filtered(&result, src_a, src_b, true);
+        } else {
+            res = insert_filtered(&result, src_b, src_a, true);
+        }
+        break;
+
+    case SET_DIFFERENCE:
+        res = insert_filtered(&result, src_a, src_b, false);
+        break;
+
+    case SET_XOR:
+        res = insert_filtered(&result, src_a, src_b, false);
+        if (res == 0) {
+            res = insert_filtered(&result, src_b, src_a, false);
+        }
+        break;
+    }
+
+    ws_object_unlock_pair(obj_a, false, obj_b, false);
+    if (res < 0) {
+        goto out;
+    }
+
+    if (!ws_object_lock_write(&dest->obj)) {
+        res = -EAGAIN;
+        goto out;
+    }
 
-    return !ws_object_cmp(o1, o2);
+    // the result replaces the content of `dest`, including the index
+    if (dest->order) {
+        res = ws_set_enable_ordering(&result);
+    }
+
+    if (res == 0) {
+        // swap the tables, the old content of `dest` is released with `result`
+        struct ws_set_entry* entries = dest->entries;
+        uint8_t* ctrl = dest->ctrl;
+        size_t capacity = dest->capacity;
+        size_t num = dest->num;
+        size_t growth_left = dest->growth_left;
+        struct ws_set_order* order = dest->order;
+
+        dest->entries = result.entries;
+        dest->ctrl = result.ctrl;
+        dest->capacity = result.capacity;
+        dest->num = result.num;
+        dest->growth_left = result.growth_left;
+        dest->order = result.order;
+
+        result.entries = entries;
+        result.ctrl = ctrl;
+        result.capacity = capacity;
+        result.num = num;
+        result.growth_left = growth_left;
+        result.order = order;
+    }
+
+    ws_object_unlock(&dest->obj);
+
+out:
+    ws_object_deinit(&result.obj);
+    return res;
+}
+
+static int
+insert_filtered(
+    struct ws_set* dest,
+    struct ws_set const* src,
+    struct ws_set const* other,
+    bool contained
+) {
+    size_t slot;
+    for (slot = next_full(src, 0); slot < src->capacity;
+            slot = next_full(src, slot + 1)) {
+        struct ws_set_entry const* entry = src->entries + slot;
+
+        if (other) {
+            bool found = find_slot(other, entry->obj, entry->hash) != NOT_FOUND;
+            if (found != contained) {
+                continue;
+            }
+        }
+
+        int res = insert_hashed(dest, entry->obj, entry->hash);
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    return 0;
+}
+
+static bool
+compare_sets(
+    struct ws_set const* self,
+    struct ws_set const* other,
+    bool equal
+) {
+    struct ws_object* obj_s = (struct ws_object*) &self->obj;
+    struct ws_object* obj_o = (struct ws_object*) &other->obj;
+    if (!ws_object_lock_pair(obj_s, false, obj_o, false)) {
+        return false;
+    }
+
+    bool retval = equal ? (other->num == self->num) : (other->num <= self->num);
+
+    size_t slot;
+    for (slot = next_full(other, 0); retval && (slot < other->capacity);
+            slot = next_full(other, slot + 1)) {
+        struct ws_set_entry const* entry = other->entries + slot;
+        retval = find_slot(self, entry->obj, entry->hash) != NOT_FOUND;
+    }
+
+    ws_object_unlock_pair(obj_s, false, obj_o, false);
+    return retval;
 }
 
 static bool
@@ -347,25 +1203,33 @@ deinit_set(
     struct ws_object* const self
 ) {
     if (self) {
-        return (0 == r_set_destroy(((struct ws_set*) self)->set));
+        clear_table((struct ws_set*) self);
+        ws_set_disable_ordering((struct ws_set*) self);
+        return true;
     }
 
     return false;
 }
 
+static int
+get_reference(
+    void* dest,
+    void const* src
+) {
+    *(struct ws_object**) dest = (void*) src;
+    return 1;
+}
+
 static int
 get_lowest(
     void* dest,
     void const* src
 ) {
-    if ((*(void**) dest) == NULL) {
-        (*(void**) dest) = (void*) src;
-    } else {
-        int cmp;
-        cmp = ws_object_cmp((struct ws_object*) dest, (struct ws_object*) src);
-        if (cmp == -1) {
-            (*(void**) dest) = (void*) src;
-        }
+    struct ws_object** lowest = (struct ws_object**) dest;
+
+    // ws_object_cmp() returns -1 if its first argument is the bigger one
+    if (!*lowest || (ws_object_cmp(*lowest, (struct ws_object*) src) < 0)) {
+        *lowest = (struct ws_object*) src;
     }
     return 0;
 }
@@ -375,15 +1239,186 @@ get_greatest(
     void* dest,
     void const* src
 ) {
-    if ((*(void**) dest) == NULL) {
-        (*(void**) dest) = (void*) src;
-    } else {
-        int cmp;
-        cmp = ws_object_cmp((struct ws_object*) dest, (struct ws_object*) src);
-        if (cmp == 1) {
-            (*(void**) dest) = (void*) src;
+    struct ws_object** greatest = (struct ws_object**) dest;
+
+    if (!*greatest || (ws_object_cmp(*greatest, (struct ws_object*) src) > 0)) {
+        *greatest = (struct ws_object*) src;
+    }
+    return 0;
+}
+
+static int
+order_cmp(
+    struct ws_object const* a,
+    struct ws_object const* b
+) {
+    if (a->id != b->id) {
+        return ((uintptr_t) a->id < (uintptr_t) b->id) ? -1 : 1;
+    }
+
+    ws_object_type_id* type = a->id;
+    while (!type->cmp_callback) {
+        if (type == &WS_OBJECT_TYPE_ID_OBJECT) {
+            // no order defined by the type, but we need a consistent one
+            return ((uintptr_t) a < (uintptr_t) b) ? -1 : (a != b);
+        }
+
+        type = type->supertype;
+    }
+
+    // ws_object_cmp() returns 1 if its second argument is the bigger one
+    int res = ws_object_cmp(a, b);
+    return (res > 0) ? -1 : (res < 0);
+}
+
+static void
+order_find(
+    struct ws_set_order* order,
+    struct ws_object const* obj,
+    struct order_node** update[ORDER_MAX_LEVEL]
+) {
+    struct order_node** next = order->head;
+
+    size_t level = ORDER_MAX_LEVEL;
+    while (level--) {
+        while (next[level] && (order_cmp(next[level]->obj, obj) < 0)) {
+            next = next[level]->next;
         }
+        update[level] = next;
+    }
+}
+
+static int
+order_insert(
+    struct ws_set_order* order,
+    struct ws_object* obj
+) {
+    // xorshift, each additional level with a probability of 1/4
+    uint64_t rand = order->rand;
+    rand ^= rand << 13;
+    rand ^= rand >> 7;
+    rand ^= rand << 17;
+    order->rand = rand;
+
+    size_t height = 1;
+    while (((rand & 3) == 0) && (height < ORDER_MAX_LEVEL)) {
+        rand >>= 2;
+        ++height;
     }
+
+    struct order_node* node;
+    node = malloc(sizeof(*node) + height * sizeof(*node->next));
+    if (!node) {
+        return -ENOMEM;
+    }
+    node->obj = obj;
+    node->height = height;
+
+    struct order_node** update[ORDER_MAX_LEVEL];
+    order_find(order, obj, update);
+
+    size_t level;
+    for (level = 0; level < height; ++level) {
+        node->next[level] = update[level][level];
+        update[level][level] = node;
+    }
+
+    if (height > order->level) {
+        order->level = height;
+    }
+
     return 0;
 }
 
+static void
+order_remove(
+    struct ws_set_order* order,
+    struct ws_object const* obj
+) {
+    struct order_node** update[ORDER_MAX_LEVEL];
+    order_find(order, obj, update);
+
+    // distinct elements may compare equal, so we have to skip those
+    struct order_node* node = update[0][0];
+    while (node && (node->obj != obj) && (order_cmp(node->obj, obj) == 0)) {
+        size_t level;
+        for (level = 0; level < node->height; ++level) {
+            update[level] = node->next;
+        }
+        node = node->next[0];
+    }
+
+    // the element is in the set, hence it must be in the index, too
+    assert(node && (node->obj == obj));
+
+    size_t level;
+    for (level = 0; level < node->height; ++level) {
+        update[level][level] = node->next[level];
+    }
+
+    while (order->level && !order->head[order->level - 1]) {
+        --order->level;
+    }
+
+    free(node);
+}
+
+static void
+order_clear(
+    struct ws_set_order* order
+) {
+    struct order_node* node = order->head[0];
+    while (node) {
+        struct order_node* next = node->next[0];
+        free(node);
+        node = next;
+    }
+
+    memset(order->head, 0, sizeof(order->head));
+    order->level = 0;
+}
+
+static struct ws_object*
+order_last(
+    struct ws_set_order const* order
+) {
+    struct order_node* const* next = order->head;
+    struct order_node const* node = NULL;
+
+    size_t level = order->level;
+    while (level--) {
+        while (next[level]) {
+            node = next[level];
+            next = node->next;
+        }
+    }
+
+    return node ? node->obj : NULL;
+}
+
+static int
+order_select(
+    struct order_node const* node,
+    struct ws_object const* upper,
+    ws_set_predf pred,
+    void* pred_etc,
+    ws_set_procf proc,
+    void* proc_etc
+) {
+    for (; node; node = node->next[0]) {
+        if (upper && (order_cmp(node->obj, upper) > 0)) {
+            break;
+        }
+
+        if (pred && !pred(node->obj, pred_etc)) {
+            continue;
+        }
+
+        int res = proc(proc_etc, node->obj);
+        if (res != 0) {
+            return res;
+        }
+    }
+
+    return 0;
+}
@@ -42,25 +42,52 @@
 #ifndef __WS_OBJECTS_SET_H__
 #define __WS_OBJECTS_SET_H__
 
+#include <stdint.h>
+
 #include "objects/object.h"
 
 #define set_get(self_, obj_) \
     ((__typeof__(obj_)) ws_set_get(self_, (struct ws_object*) obj_))
 
+/**
+ * Slot of a ws_set
+ *
+ * The hash of the object is cached in the slot, so it has to be computed only
+ * once per object and insertion.
+ */
+struct ws_set_entry {
+    size_t hash; //!< @protected Cached hash of the object
+    struct ws_object* obj; //!< @protected The object
+};
+
+/**
+ * Ordered index of a ws_set
+ */
+struct ws_set_order;
+
 /**
  * ws_set type definition
  *
  * @extends ws_object
  *
- * The ws_set type implementation operates on libreset internally.
- * The `struct ws_set` type is only used for `ws_object` objects, so nobody has
- * to care about the set configuration. Therefor, this is hold internally to the
- * set interface.
+ * The ws_set type is an open addressing hash set.
+ * For each slot, one control byte holds either a marker for an empty or
+ * deleted slot or 7 bits of the hash of the object stored in it. Lookups probe
+ * groups of 8 control bytes at a time, comparing all of them in a single
+ * operation. Only slots with a matching control byte are looked at.
+ *
+ * Optionally, a set maintains an ordered index of its elements, a skip list
+ * ordered by ws_object_cmp(). It is enabled via ws_set_enable_ordering().
  */
 struct ws_set {
     struct ws_object obj; //!< @protected Base class.
 
-    struct r_set* set; //!< @protected Actual set implementation
+    struct ws_set_entry* entries; //!< @protected Slots
+    uint8_t* ctrl; //!< @protected Control bytes, one per slot
+    size_t capacity; //!< @protected Number of slots, a power of two
+    size_t num; //!< @protected Number of elements
+    size_t growth_left; //!< @protected Empty slots left before rehashing
+    struct ws_set_order* order; //!< @protected Ordered index or `NULL`
 };
 
 /**
@@ -102,6 +129,51 @@ ws_set_init(
 struct ws_set*
 ws_set_new(void);
 
+/**
+ * Enable the ordered index of a set
+ *
+ * @memberof ws_set
+ *
+ * Once enabled, the index is maintained on every modification of the set.
+ * It orders the elements using ws_object_cmp(). Elements of different types
+ * are ordered by type first, elements of types without a compare callback by
+ * address.
+ * With the index, ws_set_select() processes the elements in ascending order,
+ * ws_set_select_lowest() and ws_set_select_greatest() take O(log n) time and
+ * ws_set_select_range() becomes available.
+ *
+ * @warning elements must not be modified in a way that changes their order
+ * while they are in an ordered set.
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+int
+ws_set_enable_ordering(
+    struct ws_set* self //!< The set
+);
+
+/**
+ * Disable the ordered index of a set
+ *
+ * @memberof ws_set
+ */
+void
+ws_set_disable_ordering(
+    struct ws_set* self //!< The set
+);
+
+/**
+ * Check whether a set maintains an ordered index
+ *
+ * @memberof ws_set
+ *
+ * @return true if the ordered index is enabled, else false
+ */
+bool
+ws_set_is_ordered(
+    struct ws_set const* self //!< The set
+);
+
 /**
  * Insert an object into the ste
  *
@@ -120,7 +192,9 @@ ws_set_insert(
  *
  * @memberof ws_set
  *
- * @return zero on success else negative error value from errno.h
+ * @return zero on success else negative error value from errno.h:
+ *          -EINVAL - NULL passed
+ *          -ENOENT - no such element in the set
  */
 int
 ws_set_remove(
@@ -148,6 +222,13 @@ ws_set_get(
  *
  * @memberof ws_set
  *
+ * The previous content of `dest` is replaced by the result. `dest` may be one
+ * of the source sets.
+ *
+ * The source sets are read-locked while the result is computed, `dest` is
+ * write-locked only while its content is replaced. The same holds for the
+ * other set operations.
+ *
  * @return zero on success, else negative error number from errno.h
  */
 int
@@ -162,6 +243,9 @@ ws_set_union(
  *
  * @memberof ws_set
  *
+ * The previous content of `dest` is replaced by the result. `dest` may be one
+ * of the source sets.
+ *
  * @return zero on success, else negative error number from errno.h
  */
 int
@@ -171,11 +255,32 @@ ws_set_intersection(
     struct ws_set const* src_b //!< The second source set
 );
 
+/**
+ * Create the difference of two sets
+ *
+ * @memberof ws_set
+ *
+ * `dest` will contain all the elements of `src_a` which are not in `src_b`.
+ * The previous content of `dest` is replaced by the result. `dest` may be one
+ * of the source sets.
+ *
+ * @return zero on success, else negative error number from errno.h
+ */
+int
+ws_set_difference(
+    struct ws_set* dest, //!< The destination set
+    struct ws_set const* src_a, //!< The set to subtract from
+    struct ws_set const* src_b //!< The set to subtract
+);
+
 /**
  * Create the symmetric difference between two sets
  *
  * @memberof ws_set
  *
+ * The previous content of `dest` is replaced by the result. `dest` may be one
+ * of the source sets.
+ *
  * @return zero on success, else negative error number from errno.h
  */
 int
@@ -232,6 +337,14 @@ ws_set_cardinality(
  * set, selecting elements for another set or doing other crazy things for
  * elements of a set.
  *
+ * @warning the set must not be modified from within the processor function
+ *
+ * If the ordered index of the set is enabled, the elements are processed in
+ * ascending order.
+ *
+ * If the processor function returns a non-zero value, the iteration is stopped
+ * and the value is returned.
+ *
  * @return zero on success, else negative error code from errno.h
  */
 int
@@ -243,6 +356,31 @@ ws_set_select(
     void* proc_etc //!< Additional parameter for the processor function
 );
 
+/**
+ * Execute a processor function for each element in a range, in order
+ *
+ * @memberof ws_set
+ *
+ * Processes all elements `e` with `lower <= e <= upper` in ascending order.
+ * A bound of `NULL` does not restrict the range.
+ *
+ * @note requires the ordered index, see ws_set_enable_ordering()
+ *
+ * @return zero on success, else negative error code from errno.h:
+ *          -EINVAL - NULL passed
+ *          -ENOTSUP - the ordered index is not enabled
+ */
+int
+ws_set_select_range(
+    struct ws_set const* self, //!< The set
+    struct ws_object const* lower, //!< Lower bound or `NULL`
+    struct ws_object const* upper, //!< Upper bound or `NULL`
+    ws_set_predf pred, //!< Predicate function
+    void* pred_etc, //!< Additional parameter for the predicate function
+    ws_set_procf proc, //!< Processor function
+    void* proc_etc //!< Additional parameter for the processor function
+);
+
 /**
  * Select first possible element
  *
@@ -260,6 +398,8 @@ ws_set_select_any(
  *
  * @memberof ws_set
  *
+ * @note takes O(log n) if the ordered index is enabled, O(n) otherwise
+ *
  * @return the lowest element of the set, NULL on failure
  */
 struct ws_object*
@@ -272,6 +412,8 @@ ws_set_select_lowest(
  *
  * @memberof ws_set
  *
+ * @note takes O(log n) if the ordered index is enabled, O(n) otherwise
+ *
  * @return greatest element from set or NULL on failure
  */
 struct ws_object*
@@ -279,6 +421,27 @@ ws_set_select_greatest(
     struct ws_set const* self
 );
 
+/**
+ * Get the next element of the set, starting at a cursor
+ *
+ * @memberof ws_set
+ *
+ * Allows iterating over a set step by step, without processing the elements
+ * skipped again on every step. `cursor` has to be zero for the first call and
+ * is advanced past the element returned by each call.
+ * The elements are returned in the order in which they are stored, which is
+ * not affected by the ordered index. The order remains stable as long as the
+ * set is not modified.
+ *
+ * @return the next element with a new reference or NULL, if there are no
+ *         elements left
+ */
+struct ws_object*
+ws_set_select_next(
+    struct ws_set const* self,
+    size_t* cursor //!< Position to continue at
+);
+
 #endif // __WS_OBJECTS_SET_H__
 
 /**
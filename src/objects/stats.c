@@ -0,0 +1,206 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "objects/stats.h"
+#include "util/condition.h"
+
+/**
+ * Maximum number of types we keep counters for
+ *
+ * @note Must be a power of two
+ */
+#define STATS_TABLE_SIZE (256)
+
+/**
+ * Counters for one type
+ */
+struct type_counters {
+    ws_object_type_id* type; //!< the type, `NULL` for unused slots
+    size_t live; //!< number of objects currently of the type
+    size_t allocs; //!< number of objects which were of the type
+    size_t deinits; //!< number of objects deinitialized
+};
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Get the counters for a type, creating them if necessary
+ *
+ * @return the counters for the type or `NULL`, if the table is full
+ */
+static struct type_counters*
+get_counters(
+    ws_object_type_id* type //!< type to get the counters for
+);
+
+/*
+ *
+ * Internal constant
+ *
+ */
+
+/**
+ * Table of counters
+ *
+ * Slots are never freed, so lookups need no lock: a slot's type is published
+ * atomically after the slot was set up.
+ */
+static struct {
+    struct type_counters slots[STATS_TABLE_SIZE]; //!< the counters
+    pthread_mutex_t lock; //!< lock for inserting new types
+} table = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+void
+ws_object_stats_alloc(
+    ws_object_type_id* type
+) {
+    struct type_counters* c = get_counters(type);
+    if (likely(c)) {
+        __atomic_add_fetch(&c->allocs, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&c->live, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void
+ws_object_stats_retype(
+    ws_object_type_id* from,
+    ws_object_type_id* to
+) {
+    struct type_counters* c = get_counters(from);
+    if (likely(c)) {
+        __atomic_sub_fetch(&c->live, 1, __ATOMIC_RELAXED);
+    }
+
+    ws_object_stats_alloc(to);
+}
+
+void
+ws_object_stats_deinit(
+    ws_object_type_id* type
+) {
+    struct type_counters* c = get_counters(type);
+    if (likely(c)) {
+        __atomic_add_fetch(&c->deinits, 1, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&c->live, 1, __ATOMIC_RELAXED);
+    }
+}
+
+size_t
+ws_object_stats_snapshot(
+    struct ws_object_type_stats* buf,
+    size_t num
+) {
+    size_t found = 0;
+
+    size_t i;
+    for (i = 0; i < STATS_TABLE_SIZE; ++i) {
+        struct type_counters* c = table.slots + i;
+        ws_object_type_id* type = __atomic_load_n(&c->type, __ATOMIC_ACQUIRE);
+        if (!type) {
+            continue;
+        }
+
+        if (buf && (found < num)) {
+            buf[found].type = type;
+            buf[found].live = __atomic_load_n(&c->live, __ATOMIC_RELAXED);
+            buf[found].allocs = __atomic_load_n(&c->allocs, __ATOMIC_RELAXED);
+            buf[found].deinits = __atomic_load_n(&c->deinits,
+                                                 __ATOMIC_RELAXED);
+        }
+        ++found;
+    }
+
+    return found;
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static struct type_counters*
+get_counters(
+    ws_object_type_id* type
+) {
+    size_t mask = STATS_TABLE_SIZE - 1;
+    size_t start = (((uintptr_t) type) >> 4) & mask;
+
+    // fast path: the type is in the table already
+    size_t pos = start;
+    do {
+        struct type_counters* c = table.slots + pos;
+        ws_object_type_id* t = __atomic_load_n(&c->type, __ATOMIC_ACQUIRE);
+        if (t == type) {
+            return c;
+        }
+        if (!t) {
+            break;
+        }
+        pos = (pos + 1) & mask;
+    } while (pos != start);
+
+    // slow path: insert the type
+    struct type_counters* retval = NULL;
+    pthread_mutex_lock(&table.lock);
+
+    pos = start;
+    do {
+        struct type_counters* c = table.slots + pos;
+        if (c->type == type) {
+            // someone else inserted it meanwhile
+            retval = c;
+            break;
+        }
+        if (!c->type) {
+            __atomic_store_n(&c->type, type, __ATOMIC_RELEASE);
+            retval = c;
+            break;
+        }
+        pos = (pos + 1) & mask;
+    } while (pos != start);
+
+    pthread_mutex_unlock(&table.lock);
+    return retval;
+}
+
@@ -0,0 +1,130 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup objects "Classes"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup objects_stats "Object statistics"
+ *
+ * Per-type object counters
+ *
+ * For each object type, the number of objects initialized and deinitialized is
+ * counted, along with the number of objects currently being of that type. The
+ * counters are updated by `ws_object_init()`, `ws_object_set_type()` and
+ * `ws_object_deinit()`.
+ *
+ * @note The type information itself is constant, hence the counters are kept
+ *       in a separate table.
+ *
+ * @{
+ */
+
+#ifndef __WS_OBJECTS_STATS_H__
+#define __WS_OBJECTS_STATS_H__
+
+#include <stddef.h>
+
+#include "objects/object.h"
+#include "util/attributes.h"
+
+/**
+ * Snapshot of the counters of one object type
+ *
+ * `allocs` and `deinits` only ever grow. An object turned into an object of a
+ * subtype is counted in `allocs` of each type it passed through, but in `live`
+ * of its current type only. Hence, `live` is not `allocs - deinits` in
+ * general.
+ */
+struct ws_object_type_stats {
+    ws_object_type_id* type; //!< the type the counters belong to
+    size_t live; //!< number of objects currently of this type
+    size_t allocs; //!< number of objects which were of this type
+    size_t deinits; //!< number of objects deinitialized as this type
+};
+
+/**
+ * Count an object initialized as a type
+ */
+void
+ws_object_stats_alloc(
+    ws_object_type_id* type //!< type of the object
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Count an object turned into an object of another type
+ *
+ * The object is accounted as an allocation of the new type, and as live for
+ * the new type only.
+ */
+void
+ws_object_stats_retype(
+    ws_object_type_id* from, //!< previous type of the object
+    ws_object_type_id* to //!< new type of the object
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Count an object deinitialized as a type
+ */
+void
+ws_object_stats_deinit(
+    ws_object_type_id* type //!< type of the object
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Take a snapshot of the counters
+ *
+ * Fills at most `num` entries of `buf` with the counters of the types seen so
+ * far.
+ *
+ * @return the total number of types seen so far
+ */
+size_t
+ws_object_stats_snapshot(
+    struct ws_object_type_stats* buf, //!< buffer to fill
+    size_t num //!< number of entries in the buffer
+);
+
+#endif // __WS_OBJECTS_STATS_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
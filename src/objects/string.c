@@ -27,6 +27,7 @@
 
 #include <errno.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unicode/ustring.h>
@@ -48,6 +49,18 @@ deinit_callback(
     struct ws_object* const
 );
 
+/**
+ * Hash callback for ws_string
+ *
+ * @note Guaranteed to be read-locked when called from ws_object_hash().
+ *
+ * @return FNV-1a hash of the characters of the string
+ */
+static size_t
+hash_callback(
+    struct ws_object* const
+);
+
 /*
  *
  *
@@ -61,7 +74,7 @@ ws_object_type_id WS_OBJECT_TYPE_ID_STRING = {
     .typestr = "ws_string",
 
     .deinit_callback = deinit_callback,
-    .hash_callback = NULL,
+    .hash_callback = hash_callback,
     .cmp_callback = (int (*) (struct ws_object const*, struct ws_object const*))
                     ws_string_cmp,
     .uuid_callback = NULL,
@@ -84,7 +97,7 @@ ws_string_init(
     }
 
     ws_object_init(&self->obj);
-    self->obj.id = &WS_OBJECT_TYPE_ID_STRING;
+    ws_object_set_type(&self->obj, &WS_OBJECT_TYPE_ID_STRING);
 
     return true;
 }
@@ -98,23 +111,26 @@ ws_string_set_from_str(
         return false;
     }
 
-    ws_object_lock_write(&self->obj);
-    ws_object_lock_read(&other->obj);
+    if (self == other) {
+        return true;
+    }
+
+    if (!ws_object_lock_pair(&self->obj, true, &other->obj, false)) {
+        return false;
+    }
 
     size_t charcount = u_strlen(other->str);
 
     UChar* temp = realloc(self->str, (charcount + 1) * sizeof(*self->str));
     if (unlikely(!temp)) {
-        ws_object_unlock(&other->obj);
-        ws_object_unlock(&self->obj);
+        ws_object_unlock_pair(&self->obj, true, &other->obj, false);
         return false;
     }
     self->str = temp;
 
     u_strcpy(self->str, other->str);
 
-    ws_object_unlock(&other->obj);
-    ws_object_unlock(&self->obj);
+    ws_object_unlock_pair(&self->obj, true, &other->obj, false);
 
     return true;
 }
@@ -152,22 +168,25 @@ ws_string_cat(
     struct ws_string* self,
     struct ws_string* other
 ){
-    ws_object_lock_write(&self->obj);
-    ws_object_lock_read(&other->obj); //!< @todo Thread-safeness!
+    if (!ws_object_lock_pair(&self->obj, true, &other->obj, false)) {
+        return NULL;
+    }
 
-    size_t new_len = u_strlen(self->str) + u_strlen(other->str) + 1;
-    UChar* temp = realloc(self->str, new_len * sizeof(*self->str));
+    size_t self_len = u_strlen(self->str);
+    size_t other_len = u_strlen(other->str);
+    UChar* temp = realloc(self->str,
+                          (self_len + other_len + 1) * sizeof(*self->str));
     if (unlikely(!temp)) {
-        ws_object_unlock(&other->obj);
-        ws_object_unlock(&self->obj);
+        ws_object_unlock_pair(&self->obj, true, &other->obj, false);
         return NULL;
     }
     self->str = temp;
 
-    u_strcat(self->str, other->str);
+    // `other` may be `self`, so we must not use `u_strcat()` here
+    u_memcpy(self->str + self_len, other->str, other_len);
+    self->str[self_len + other_len] = 0;
 
-    ws_object_unlock(&other->obj);
-    ws_object_unlock(&self->obj);
+    ws_object_unlock_pair(&self->obj, true, &other->obj, false);
 
     return self;
 }
@@ -189,13 +208,13 @@ ws_string_cmp(
     struct ws_string* self,
     struct ws_string* other
 ){
-    ws_object_lock_read(&self->obj);
-    ws_object_lock_read(&other->obj); //!< @todo Thread-safeness!
+    if (!ws_object_lock_pair(&self->obj, false, &other->obj, false)) {
+        return -EAGAIN;
+    }
 
     int res = u_strcmp(self->str, other->str);
 
-    ws_object_unlock(&other->obj);
-    ws_object_unlock(&self->obj);
+    ws_object_unlock_pair(&self->obj, false, &other->obj, false);
 
     return res;
 }
@@ -207,13 +226,13 @@ ws_string_ncmp(
     size_t offset,
     size_t n
 ){
-    ws_object_lock_read(&self->obj);
-    ws_object_lock_read(&other->obj); //!< @todo Thread-safeness!
+    if (!ws_object_lock_pair(&self->obj, false, &other->obj, false)) {
+        return -EAGAIN;
+    }
 
     int res = u_strncmp(self->str + offset, other->str, n);
 
-    ws_object_unlock(&self->obj);
-    ws_object_unlock(&other->obj);
+    ws_object_unlock_pair(&self->obj, false, &other->obj, false);
 
     return res;
 }
@@ -223,13 +242,13 @@ ws_string_substr(
     struct ws_string* self,
     struct ws_string* other
 ){
-    ws_object_lock_read(&self->obj);
-    ws_object_lock_read(&other->obj); //!< @todo Thread-safeness!
+    if (!ws_object_lock_pair(&self->obj, false, &other->obj, false)) {
+        return false;
+    }
 
     UChar* res = u_strstr(self->str, other->str);
 
-    ws_object_unlock(&self->obj);
-    ws_object_unlock(&other->obj);
+    ws_object_unlock_pair(&self->obj, false, &other->obj, false);
 
     return !!res;
 }
@@ -325,3 +344,18 @@ deinit_callback(
     }
     return false;
 }
+
+static size_t
+hash_callback(
+    struct ws_object* const self
+) {
+    UChar const* c = ((struct ws_string*) self)->str;
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+
+    while (c && *c) {
+        hash ^= *c++;
+        hash *= UINT64_C(0x100000001b3);
+    }
+
+    return (size_t) hash;
+}
@@ -102,7 +102,7 @@ ws_wayland_obj_init(
 
     ws_object_init(&self->obj);
 
-    self->obj.id = &WS_OBJECT_TYPE_ID_WAYLAND_OBJ;
+    ws_object_set_type(&self->obj, &WS_OBJECT_TYPE_ID_WAYLAND_OBJ);
     self->resource = r;
 
     return 0;
@@ -26,6 +26,7 @@
  */
 
 #include <errno.h>
+#include <inttypes.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
@@ -33,8 +34,11 @@
 #include <yajl/yajl_parse.h>
 
 #include "command/command.h"
+#include "objects/message/batch.h"
 #include "objects/message/event.h"
+#include "objects/message/invocation.h"
 #include "objects/message/transaction.h"
+#include "objects/registry.h"
 #include "objects/string.h"
 #include "serialize/deserializer.h"
 #include "serialize/json/deserializer_callbacks.h"
@@ -44,6 +48,7 @@
 #include "values/bool.h"
 #include "values/int.h"
 #include "values/nil.h"
+#include "values/object_id.h"
 #include "values/string.h"
 #include "wayland-util.h"
 
@@ -79,6 +84,11 @@ static const struct {
         .next = STATE_EVENT_VALUE,
         .str = EVENT_VALUE,
     },
+    { .current = STATE_MSG, .next = STATE_BATCH,    .str = BATCH        },
+    { .current = STATE_MSG, .next = STATE_BATCH_ATOMIC, .str = ATOMIC   },
+    { .current = STATE_MSG, .next = STATE_INVOKE,   .str = INVOKE       },
+    { .current = STATE_MSG, .next = STATE_INVOKE_ARGS, .str = ARGS      },
+    { .current = STATE_MSG, .next = STATE_EXPAND,   .str = EXPAND       },
 
     { .str = NULL },
 };
@@ -104,6 +114,49 @@ setup_transaction(
     struct ws_deserializer* s // The current state object
 );
 
+/**
+ * Setup the deserializer_state object to hold a batch
+ *
+ * @return zero on success, else negative errno.h number
+ */
+static int
+setup_batch(
+    struct ws_deserializer* d //!< The deserializer obj, containing everything
+);
+
+/**
+ * Setup the deserializer_state object to hold an invocation
+ *
+ * @return zero on success, else negative errno.h number
+ */
+static int
+setup_invocation(
+    struct ws_deserializer* d //!< The deserializer obj, containing everything
+);
+
+/**
+ * Append an argument to the invocation being parsed
+ *
+ * The value is copied, the caller keeps ownership of `val`.
+ *
+ * @return 1 on success, 0 on error, in order to be returned by a callback
+ */
+static int
+append_invocation_arg(
+    struct ws_deserializer* d, //!< The deserializer obj, containing everything
+    struct ws_value* val //!< The argument to append
+);
+
+/**
+ * Append the transaction parsed last to the batch
+ *
+ * @return zero on success, else negative errno.h number
+ */
+static int
+finalize_batch_transaction(
+    struct ws_deserializer* d //!< The deserializer obj, containing everything
+);
+
 /**
  * Finalize the message and clear the buffers we still have lying around
  */
@@ -135,6 +188,20 @@ buff_to_string(
     size_t len //!< The length of the string
 );
 
+/**
+ * Helper for appending an object, referenced by its uuid, as direct argument
+ *
+ * If no object with the uuid exists, `nil` is appended instead.
+ *
+ * @return zero on success, else negative errno.h number
+ */
+static int
+append_object_arg(
+    struct ws_statement* statement, //!< The statement to append the arg to
+    const unsigned char* str, //!< The string containing the uuid (hex)
+    size_t len //!< The length of the string
+);
+
 /*
  *
  * Interface implementation
@@ -179,6 +246,14 @@ yajl_null_cb(
         }
         break;
 
+    case STATE_INVOKE_ARGS_ARY:
+        {
+            ws_log(&log_ctx, LOG_DEBUG, "Appending as invocation argument");
+            struct ws_value_nil nil;
+            ws_value_nil_init(&nil);
+            return append_invocation_arg(d, (struct ws_value*) &nil);
+        }
+
     case STATE_EVENT_VALUE:
         // event value is NULL
         {
@@ -255,6 +330,25 @@ yajl_boolean_cb(
         state->current_state = STATE_FLAGS_MAP;
         break;
 
+    case STATE_BATCH_ATOMIC:
+        ws_log(&log_ctx, LOG_DEBUG, "Using as batch atomic-flag");
+        if (state->in_batch || (setup_batch(d) < 0)) {
+            state->current_state = STATE_INVALID;
+            break;
+        }
+        ws_batch_set_atomic(state->batch, b);
+        state->current_state = STATE_MSG;
+        break;
+
+    case STATE_INVOKE_ARGS_ARY:
+        {
+            ws_log(&log_ctx, LOG_DEBUG, "Appending as invocation argument");
+            struct ws_value_bool boo;
+            ws_value_bool_init(&boo);
+            ws_value_bool_set(&boo, b);
+            return append_invocation_arg(d, (struct ws_value*) &boo);
+        }
+
     case STATE_EVENT_VALUE:
         // event value is a boolean
         {
@@ -302,6 +396,9 @@ yajl_integer_cb(
         if (d->buffer) {
             // Hey, we have a message object, set the ID directly
             d->buffer->id = i; //!< @todo visibility violation here
+        } else if (state->batch && !state->in_batch) {
+            // This is the ID of the batch itself
+            state->batch->m.id = i; //!< @todo visibility violation here
         } else {
             // cache the ID
             state->id = i;
@@ -350,6 +447,15 @@ yajl_integer_cb(
         state->current_state = STATE_COMMAND_ARY_NEW_COMMAND;
         break;
 
+    case STATE_INVOKE_ARGS_ARY:
+        {
+            ws_log(&log_ctx, LOG_DEBUG, "Appending as invocation argument");
+            struct ws_value_int n;
+            ws_value_int_init(&n);
+            ws_value_int_set(&n, i);
+            return append_invocation_arg(d, (struct ws_value*) &n);
+        }
+
     case STATE_EVENT_VALUE:
         // event value is an integer
         {
@@ -408,14 +514,19 @@ yajl_string_cb(
 
     case STATE_TYPE:
         ws_log(&log_ctx, LOG_DEBUG, "Using as type identifier");
+        state->current_state = STATE_MSG;
         if (ws_strneq(TYPE_TRANSACTION, (char*) str,
                     strlen(TYPE_TRANSACTION))) {
-            setup_transaction(d);
+            if (setup_transaction(d) < 0) {
+                state->current_state = STATE_INVALID;
+            }
         } else if (ws_strneq(TYPE_EVENT, (char*) str, strlen(TYPE_EVENT))) {
             state->has_event = true;
+        } else if (ws_strneq(TYPE_BATCH, (char*) str, strlen(TYPE_BATCH))) {
+            if (state->in_batch || (setup_batch(d) < 0)) {
+                state->current_state = STATE_INVALID;
+            }
         }
-
-        state->current_state = STATE_MSG;
         break;
 
     case STATE_COMMAND_ARY_COMMAND_ARGS:
@@ -446,6 +557,21 @@ yajl_string_cb(
         }
         break;
 
+    case STATE_COMMAND_ARY_COMMAND_ARG_OBJECT_ID:
+        {
+            ws_log(&log_ctx, LOG_DEBUG, "Using as object id argument");
+            int res = append_object_arg(state->tmp_statement, str, len);
+            if (res != 0) {
+                state->error.parser_error = false;
+                state->error.error_num = res;
+                return 0;
+            }
+
+            // Keep the state for now.
+            state->current_state = STATE_COMMAND_ARY_COMMAND_ARG_OBJECT_ID;
+        }
+        break;
+
     case STATE_FLAGS_REGISTER:
         {
             state->register_name = ws_string_new();
@@ -492,6 +618,75 @@ yajl_string_cb(
         }
         break;
 
+    case STATE_INVOKE:
+        {
+            struct ws_string* name = ws_string_new();
+            if (!name) {
+                state->error.parser_error = false;
+                state->error.error_num = -ENOMEM;
+                return 0;
+            }
+
+            int res = buff_to_string("Using as invoked transaction (%s)",
+                                     name, str, len);
+            if ((res != 0) || (setup_invocation(d) < 0)) {
+                ws_object_unref((struct ws_object*) name);
+                state->current_state = STATE_INVALID;
+                break;
+            }
+
+            // gets a ref on name
+            ws_invocation_set_name((struct ws_invocation*) d->buffer, name);
+            ws_object_unref((struct ws_object*) name);
+            state->current_state = STATE_MSG;
+        }
+        break;
+
+    case STATE_INVOKE_ARGS_ARY:
+        {
+            struct ws_value_string s;
+            memset(&s, 0, sizeof(s));
+            ws_value_string_init(&s);
+            struct ws_string* sstr = ws_value_string_get(&s);
+            if (!sstr) {
+                state->error.parser_error = false;
+                state->error.error_num = -ENOMEM;
+                return 0;
+            }
+
+            int res = buff_to_string("Using as invocation argument (%s)",
+                                     sstr, str, len);
+            ws_object_unref((struct ws_object*) sstr);
+            if (res != 0) {
+                ws_value_deinit((struct ws_value*) &s);
+                state->error.parser_error = false;
+                state->error.error_num = res;
+                return 0;
+            }
+
+            res = append_invocation_arg(d, (struct ws_value*) &s);
+            ws_value_deinit((struct ws_value*) &s);
+            return res;
+        }
+
+    case STATE_EXPAND_ARY:
+        {
+            char buff[len + 1];
+            memcpy(buff, str, len);
+            buff[len] = 0;
+            ws_log(&log_ctx, LOG_DEBUG, "Using as attribute to expand (%s)",
+                   buff);
+
+            int res = ws_transaction_expand((struct ws_transaction*) d->buffer,
+                                            buff);
+            if (res != 0) {
+                state->error.parser_error = false;
+                state->error.error_num = res;
+                return 0;
+            }
+        }
+        break;
+
     case STATE_EVENT_VALUE:
         // event value is a string
         {
@@ -565,6 +760,11 @@ yajl_start_map_cb(
         state->current_state = STATE_FLAGS_MAP;
         break;
 
+    case STATE_BATCH_ARY:
+        ws_log(&log_ctx, LOG_DEBUG, "Starting transaction of batch");
+        state->current_state = STATE_MSG;
+        break;
+
     default:
         ws_log(&log_ctx, LOG_DEBUG, "INVALID");
         state->current_state = STATE_INVALID;
@@ -626,13 +826,24 @@ yajl_map_key_cb(
 
     case STATE_COMMAND_ARY_COMMAND_ARG_DIRECT:
         // If the key is a "pos" key, for a stack position, we continue here
-        if (!ws_strneq((char*) key, POS, len)) {
-            ws_log(&log_ctx, LOG_DEBUG, "Invalid, expected position key");
-            state->current_state = STATE_INVALID;
+        if ((len == strlen(POS)) && ws_strneq((char*) key, POS, len)) {
+            ws_log(&log_ctx, LOG_DEBUG,
+                   "Using as key for stack position argument");
+            state->current_state =
+                STATE_COMMAND_ARY_COMMAND_ARG_INDIRECT_STACKPOS;
             break;
         }
-        ws_log(&log_ctx, LOG_DEBUG, "Using as key for stack position argument");
-        state->current_state = STATE_COMMAND_ARY_COMMAND_ARG_INDIRECT_STACKPOS;
+
+        // If the key is an "object" key, an object is passed by its uuid
+        if ((len == strlen(OBJECT_ID)) &&
+                ws_strneq((char*) key, OBJECT_ID, len)) {
+            ws_log(&log_ctx, LOG_DEBUG, "Using as key for object argument");
+            state->current_state = STATE_COMMAND_ARY_COMMAND_ARG_OBJECT_ID;
+            break;
+        }
+
+        ws_log(&log_ctx, LOG_DEBUG, "Invalid, expected position or object key");
+        state->current_state = STATE_INVALID;
         break;
 
     default:
@@ -682,6 +893,11 @@ yajl_end_map_cb(
         state->current_state = STATE_COMMAND_ARY_COMMAND_ARGS;
         break;
 
+    case STATE_COMMAND_ARY_COMMAND_ARG_OBJECT_ID:
+        ws_log(&log_ctx, LOG_DEBUG, "Finished command arg: Object id");
+        state->current_state = STATE_COMMAND_ARY_COMMAND_ARGS;
+        break;
+
     case STATE_COMMAND_ARY_COMMAND_ARGS:
         ws_log(&log_ctx, LOG_DEBUG, "Finished command arguments");
         state->current_state = STATE_COMMAND_ARY_NEW_COMMAND;
@@ -693,6 +909,16 @@ yajl_end_map_cb(
         break;
 
     case STATE_MSG:
+        if (state->in_batch) {
+            ws_log(&log_ctx, LOG_DEBUG, "Finished transaction of batch");
+            if (finalize_batch_transaction(d) < 0) {
+                state->current_state = STATE_INVALID;
+                break;
+            }
+            state->current_state = STATE_BATCH_ARY;
+            break;
+        }
+
         ws_log(&log_ctx, LOG_DEBUG, "Finished message");
         state->current_state = STATE_INIT;
         break;
@@ -729,10 +955,44 @@ yajl_start_array_cb(
 
     case STATE_COMMANDS:
         ws_log(&log_ctx, LOG_DEBUG, "Start command array");
-        setup_transaction(d);
+        if (setup_transaction(d) < 0) {
+            state->current_state = STATE_INVALID;
+            break;
+        }
         state->current_state = STATE_COMMAND_ARY;
         break;
 
+    case STATE_INVOKE_ARGS:
+        ws_log(&log_ctx, LOG_DEBUG, "Start invocation arguments");
+        if (setup_invocation(d) < 0) {
+            state->current_state = STATE_INVALID;
+            break;
+        }
+        state->current_state = STATE_INVOKE_ARGS_ARY;
+        break;
+
+    case STATE_EXPAND:
+        ws_log(&log_ctx, LOG_DEBUG, "Start expansion attributes");
+        if ((setup_transaction(d) < 0) ||
+                (ws_transaction_expand((struct ws_transaction*) d->buffer,
+                                       NULL) < 0)) {
+            state->current_state = STATE_INVALID;
+            break;
+        }
+        state->current_state = STATE_EXPAND_ARY;
+        break;
+
+    case STATE_BATCH:
+        ws_log(&log_ctx, LOG_DEBUG, "Start batch");
+        if (state->in_batch || (setup_batch(d) < 0)) {
+            // batches may not be nested
+            state->current_state = STATE_INVALID;
+            break;
+        }
+        state->in_batch = true;
+        state->current_state = STATE_BATCH_ARY;
+        break;
+
     case STATE_COMMAND_ARY_COMMAND_NAME:
         ws_log(&log_ctx, LOG_DEBUG, "Start command arguments");
         // We are in the command name state and the next thing is an array, so
@@ -780,6 +1040,22 @@ yajl_end_array_cb(
         state->current_state = STATE_COMMAND_ARY_NEW_COMMAND;
         break;
 
+    case STATE_INVOKE_ARGS_ARY:
+        ws_log(&log_ctx, LOG_DEBUG, "Finish invocation arguments");
+        state->current_state = STATE_MSG;
+        break;
+
+    case STATE_EXPAND_ARY:
+        ws_log(&log_ctx, LOG_DEBUG, "Finish expansion attributes");
+        state->current_state = STATE_MSG;
+        break;
+
+    case STATE_BATCH_ARY:
+        ws_log(&log_ctx, LOG_DEBUG, "Finish batch");
+        state->in_batch = false;
+        state->current_state = STATE_MSG;
+        break;
+
     default:
         ws_log(&log_ctx, LOG_DEBUG, "INVALID");
         state->current_state = STATE_INVALID;
@@ -804,13 +1080,27 @@ setup_transaction(
     }
 
     if (self->buffer != NULL) {
+        if (!ws_object_is_instance_of((struct ws_object*) self->buffer,
+                                      &WS_OBJECT_TYPE_ID_TRANSACTION)) {
+            // the message is something else already
+            return -EINVAL;
+        }
         return 0;
     }
 
+    struct deserializer_state* state = (struct deserializer_state*) self->state;
+    if (state->batch && !state->in_batch) {
+        // A batch only holds transactions in its batch array
+        return -EINVAL;
+    }
+
     //!< @todo assign real name, flags
     enum ws_transaction_flags flags = 0;
-    self->buffer = (struct ws_message*) ws_transaction_new(0, NULL,
+    self->buffer = (struct ws_message*) ws_transaction_new(state->id, NULL,
                                                            flags, NULL);
+    if (!self->buffer) {
+        return -ENOMEM;
+    }
 
     ws_log(&log_ctx, LOG_DEBUG, "Transaction setup finished");
     return 0;
@@ -823,6 +1113,16 @@ finalize_message(
     ws_log(&log_ctx, LOG_DEBUG, "Finalizing message");
     struct deserializer_state* state = (struct deserializer_state*) d->state;
 
+    if (state->batch) {
+        if (d->buffer) {
+            // left over from an incomplete transaction of the batch
+            ws_object_unref((struct ws_object*) d->buffer);
+        }
+        d->buffer = (struct ws_message*) state->batch;
+        state->batch = NULL;
+        return;
+    }
+
     if (d->buffer == NULL && !state->has_event) {
         // Do runtime check whether buffer object exists here, because _someone_
         // decided against runtime checks in the utility functions
@@ -852,6 +1152,114 @@ finalize_message(
     }
 }
 
+static int
+setup_batch(
+    struct ws_deserializer* d
+) {
+    struct deserializer_state* state = (struct deserializer_state*) d->state;
+
+    if (state->batch) {
+        return 0;
+    }
+
+    if (d->buffer || state->has_event) {
+        // the message is not a batch
+        return -EINVAL;
+    }
+
+    state->batch = ws_batch_new(state->id);
+    if (!state->batch) {
+        return -ENOMEM;
+    }
+    state->id = 0;
+
+    ws_log(&log_ctx, LOG_DEBUG, "Batch setup finished");
+    return 0;
+}
+
+static int
+setup_invocation(
+    struct ws_deserializer* d
+) {
+    struct deserializer_state* state = (struct deserializer_state*) d->state;
+
+    if (d->buffer) {
+        if (d->buffer->obj.id != &WS_OBJECT_TYPE_ID_INVOCATION) {
+            // the message is something else already
+            return -EINVAL;
+        }
+        return 0;
+    }
+
+    if (state->batch || state->has_event) {
+        // the message is not an invocation
+        return -EINVAL;
+    }
+
+    struct ws_invocation* invocation = ws_invocation_new(state->id, NULL);
+    if (!invocation) {
+        return -ENOMEM;
+    }
+    d->buffer = (struct ws_message*) invocation;
+
+    ws_log(&log_ctx, LOG_DEBUG, "Invocation setup finished");
+    return 0;
+}
+
+static int
+append_invocation_arg(
+    struct ws_deserializer* d,
+    struct ws_value* val
+) {
+    struct deserializer_state* state = (struct deserializer_state*) d->state;
+
+    struct ws_invocation* invocation = (struct ws_invocation*) d->buffer;
+    int res = ws_invocation_append_arg(invocation, val);
+    if (res != 0) {
+        state->error.parser_error = false;
+        state->error.error_num = res;
+        return 0;
+    }
+
+    state->current_state = STATE_INVOKE_ARGS_ARY;
+    return 1;
+}
+
+static int
+finalize_batch_transaction(
+    struct ws_deserializer* d
+) {
+    struct deserializer_state* state = (struct deserializer_state*) d->state;
+
+    // Every element of the batch has to be a transaction
+    if (!d->buffer) {
+        return -EINVAL;
+    }
+    if (!ws_object_is_instance_of((struct ws_object*) d->buffer,
+                                  &WS_OBJECT_TYPE_ID_TRANSACTION)) {
+        return -EINVAL;
+    }
+
+    struct ws_transaction* t = (struct ws_transaction*) d->buffer;
+
+    ws_transaction_set_flags(t, state->flags);
+
+    // gets a ref on name
+    ws_transaction_set_name(t, state->register_name);
+    ws_object_unref((struct ws_object*) state->register_name);
+
+    int res = ws_batch_append(state->batch, t);
+    ws_object_unref((struct ws_object*) t);
+
+    // reset the caches for the next transaction
+    d->buffer = NULL;
+    state->flags = 0;
+    state->register_name = NULL;
+    state->id = 0;
+
+    return res;
+}
+
 static enum json_backend_state
 get_next_state_for_string(
     enum json_backend_state current,
@@ -881,3 +1289,44 @@ buff_to_string(
     ws_log(&log_ctx, LOG_DEBUG, logfmt, buff);
     return ws_string_set_from_raw(dst, buff);
 }
+
+static int
+append_object_arg(
+    struct ws_statement* statement,
+    const unsigned char* str,
+    size_t len
+) {
+    char buff[len + 1];
+    strncpy(buff, (char*) str, len);
+    buff[len] = 0;
+
+    char* end;
+    uintmax_t uuid = strtoumax(buff, &end, 16);
+    if ((len == 0) || (*end != 0)) {
+        return -EINVAL;
+    }
+
+    // O(1) lookup, we get a reference on the object, if any
+    struct ws_object* obj = ws_object_registry_get(uuid);
+    if (!obj) {
+        ws_log(&log_ctx, LOG_DEBUG, "No object with uuid %s, using nil", buff);
+        struct ws_value_nil* nil = calloc(1, sizeof(*nil));
+        if (!nil) {
+            return -ENOMEM;
+        }
+        ws_value_nil_init(nil);
+
+        return ws_statement_append_direct(statement, (struct ws_value*) nil);
+    }
+
+    struct ws_value_object_id* id = calloc(1, sizeof(*id));
+    if (!id) {
+        ws_object_unref(obj);
+        return -ENOMEM;
+    }
+    ws_value_object_id_init(id);
+    ws_value_object_id_set(id, obj); // gets its own reference
+    ws_object_unref(obj);
+
+    return ws_statement_append_direct(statement, (struct ws_value*) id);
+}
@@ -55,6 +55,7 @@
 
 #include "serialize/json/states.h"
 
+#include "objects/message/batch.h"
 #include "objects/message/transaction.h"
 
 #include "values/union.h"
@@ -83,6 +84,9 @@ struct deserializer_state {
 
     bool has_event;
 
+    struct ws_batch* batch; //!< @public batch, if a batch is parsed
+    bool in_batch; //!< @public whether we parse a transaction of the batch
+
     struct {
         bool parser_error;
         int error_num;
@@ -51,14 +51,21 @@
 #define UID         "UID"
 #define TYPE        "TYPE"
 #define FLAGS       "FLAGS"
+#define BATCH       "BATCH"
+#define ATOMIC      "ATOMIC"
+#define INVOKE      "INVOKE"
+#define ARGS        "ARGS"
+#define EXPAND      "EXPAND"
 
 #define FLAG_EXEC   "EXEC"
 #define FLAG_REGISTER "REGISTER"
 
 #define TYPE_TRANSACTION "transaction"
 #define TYPE_EVENT "event"
+#define TYPE_BATCH "batch"
 
 #define POS         "pos" // key for argument: stack position
+#define OBJECT_ID   "object" // key for argument: object, referenced by uuid
 
 #define EVENT_NAME  "name" // key for event name
 #define EVENT_VALUE "value" // key for event value
@@ -73,6 +80,11 @@
 #define VALUE       "value" // key for value reply
 #define TRANSACTION_ID "transaction-id" // key for value reply: transaction id
 
+#define REPLIES     "replies" // key for batch reply: transaction replies
+
+#define EXPANDED_ID "id" // key for expanded objects: uuid
+#define EXPANDED_TYPE "type" // key for expanded objects: type name
+
 #define ERROR_CODE  "errorcode" // key for error reply - code
 #define ERROR_DESC  "errordesc" // key for error reply - description
 #define ERROR_CAUSE "errorcause" // key for error reply - cause
@@ -42,16 +42,19 @@
 #include <yajl/yajl_common.h>
 #include <yajl/yajl_gen.h>
 
+#include "objects/message/batch_reply.h"
 #include "objects/message/error_reply.h"
 #include "objects/message/event.h"
 #include "objects/message/message.h"
 #include "objects/message/value_reply.h"
+#include "objects/object.h"
 #include "objects/string.h"
 #include "serialize/json/keys.h"
 #include "serialize/json/serializer.h"
 #include "serialize/json/serializer_state.h"
 #include "serialize/serializer.h"
 #include "util/arithmetical.h"
+#include "values/array.h"
 #include "values/object_id.h"
 #include "values/value.h"
 
@@ -73,6 +76,17 @@ serialize(
     size_t nbuf
 );
 
+/**
+ * Serialize the members of a message, picking the function for its type
+ *
+ * @return zero on success, else negative errno.h number
+ */
+static int
+serialize_message(
+    struct serializer_context* ctx,
+    struct ws_message* msg
+);
+
 /**
  * Serialize an error reply type
  *
@@ -80,7 +94,8 @@ serialize(
  */
 static int
 serialize_reply_error_reply(
-    struct ws_serializer* self
+    struct serializer_context* ctx,
+    struct ws_message* msg
 );
 
 /**
@@ -90,7 +105,19 @@ serialize_reply_error_reply(
  */
 static int
 serialize_reply_value_reply(
-    struct ws_serializer* self
+    struct serializer_context* ctx,
+    struct ws_message* msg
+);
+
+/**
+ * Serialize a batch reply type
+ *
+ * @return zero on success, else negative errno.h number
+ */
+static int
+serialize_reply_batch_reply(
+    struct serializer_context* ctx,
+    struct ws_message* msg
 );
 
 /**
@@ -100,7 +127,8 @@ serialize_reply_value_reply(
  */
 static int
 serialize_event(
-    struct ws_serializer* self
+    struct serializer_context* ctx,
+    struct ws_message* msg
 );
 
 /**
@@ -112,6 +140,24 @@ serialize_value(
     struct ws_value* val
 );
 
+/**
+ * Serialize an object, either as its uuid or expanded
+ *
+ * If the context requests the expansion of objects, the object is serialized
+ * as a map holding its uuid, its type and the attributes requested. Integral
+ * attributes are inlined, other or missing attributes are serialized as null.
+ *
+ * @note must be casted to (int (*)(void*, void const*)) to be able to pass to
+ * ws_set_select()
+ *
+ * @return zero on success, else negative errno.h number
+ */
+static int
+serialize_object(
+    struct serializer_context* ctx,
+    struct ws_object* obj
+);
+
 /**
  * Serialize callback for ws_value_set_select()
  *
@@ -201,44 +247,10 @@ serialize(
     }
 
     {
-        bool serialized = false;
-        /*
-         * Map from type -> serializing function
-         */
-        static const struct {
-            ws_object_type_id* type;
-            int (*serf)(struct ws_serializer*);
-        } FUNC_TAB[] = {
-            {
-                .type = &WS_OBJECT_TYPE_ID_EVENT,
-                .serf = serialize_event
-            },
-            {
-                .type = &WS_OBJECT_TYPE_ID_ERROR_REPLY,
-                .serf = serialize_reply_error_reply,
-            },
-            {
-                .type = &WS_OBJECT_TYPE_ID_VALUE_REPLY,
-                .serf = serialize_reply_value_reply,
-            }
-        };
-
-        for (size_t i = 0; i < ARYLEN(FUNC_TAB); ++i) {
-            if (FUNC_TAB[i].type != self->buffer->obj.id) {
-                continue;
-            }
-
-            int retval = FUNC_TAB[i].serf(self);
-            if (retval < 0) {
-                //!< @todo something went wrong serializing the event. Error?
-                return retval;
-            }
-            serialized = true;
-            break;
-        }
-
-        if (!serialized) {
-            return -EINVAL;
+        int retval = serialize_message(ctx, self->buffer);
+        if (retval < 0) {
+            //!< @todo something went wrong serializing the event. Error?
+            return retval;
         }
     }
 
@@ -277,12 +289,51 @@ write_buffer:
     return write;
 }
 
+static int
+serialize_message(
+    struct serializer_context* ctx,
+    struct ws_message* msg
+) {
+    /*
+     * Map from type -> serializing function
+     */
+    static const struct {
+        ws_object_type_id* type;
+        int (*serf)(struct serializer_context*, struct ws_message*);
+    } FUNC_TAB[] = {
+        {
+            .type = &WS_OBJECT_TYPE_ID_EVENT,
+            .serf = serialize_event
+        },
+        {
+            .type = &WS_OBJECT_TYPE_ID_ERROR_REPLY,
+            .serf = serialize_reply_error_reply,
+        },
+        {
+            .type = &WS_OBJECT_TYPE_ID_VALUE_REPLY,
+            .serf = serialize_reply_value_reply,
+        },
+        {
+            .type = &WS_OBJECT_TYPE_ID_BATCH_REPLY,
+            .serf = serialize_reply_batch_reply,
+        }
+    };
+
+    for (size_t i = 0; i < ARYLEN(FUNC_TAB); ++i) {
+        if (FUNC_TAB[i].type == msg->obj.id) {
+            return FUNC_TAB[i].serf(ctx, msg);
+        }
+    }
+
+    return -EINVAL;
+}
+
 static int
 serialize_reply_error_reply(
-    struct ws_serializer* self
+    struct serializer_context* ctx,
+    struct ws_message* msg
 ) {
-    struct ws_error_reply* r = (struct ws_error_reply*) self->buffer;
-    struct serializer_context* ctx = (struct serializer_context*) self->state;
+    struct ws_error_reply* r = (struct ws_error_reply*) msg;
 
     if (gen_key(ctx, ERROR_CODE)) {
         //!< @todo error?
@@ -325,10 +376,9 @@ serialize_reply_error_reply(
 
 static int
 serialize_reply_value_reply(
-    struct ws_serializer* self
+    struct serializer_context* ctx,
+    struct ws_message* msg
 ) {
-    struct serializer_context* ctx = (struct serializer_context*) self->state;
-
     // We haven't serialized anything
     // generate the key for the value reply
     if (gen_key(ctx, VALUE)) {
@@ -336,8 +386,13 @@ serialize_reply_value_reply(
         return -1;
     }
 
-    struct ws_value* v = &((struct ws_value_reply*) self->buffer)->value.value;
-    if (serialize_value(ctx, v)) {
+    struct ws_value_reply* r = (struct ws_value_reply*) msg;
+    ctx->expand = ws_value_reply_expansion(r, &ctx->expand_attrs,
+                                           &ctx->num_expand_attrs);
+
+    int res = serialize_value(ctx, ws_value_reply_get_value(r));
+    ctx->expand = false;
+    if (res) {
         //!< @todo error?
         return -1;
     }
@@ -347,7 +402,7 @@ serialize_reply_value_reply(
         return -1;
     }
 
-    size_t id = ws_message_get_id(self->buffer);
+    size_t id = ws_message_get_id(msg);
     yajl_gen_status stat = yajl_gen_integer(ctx->yajlgen, id);
     if (stat != yajl_gen_status_ok) {
         //!< @todo error?
@@ -357,11 +412,71 @@ serialize_reply_value_reply(
     return 0;
 }
 
+static int
+serialize_reply_batch_reply(
+    struct serializer_context* ctx,
+    struct ws_message* msg
+) {
+    struct ws_batch_reply* r = (struct ws_batch_reply*) msg;
+
+    if (gen_key(ctx, REPLIES)) {
+        //!< @todo error?
+        return -1;
+    }
+
+    yajl_gen_status stat = yajl_gen_array_open(ctx->yajlgen);
+    if (stat != yajl_gen_status_ok) {
+        //!< @todo error?
+        return -1;
+    }
+
+    // each reply is serialized as if it was a message on its own
+    size_t len = ws_batch_reply_len(r);
+    for (size_t i = 0; i < len; ++i) {
+        stat = yajl_gen_map_open(ctx->yajlgen);
+        if (stat != yajl_gen_status_ok) {
+            //!< @todo error?
+            return -1;
+        }
+
+        struct ws_reply* reply = ws_batch_reply_get(r, i);
+        int res = serialize_message(ctx, &reply->m);
+        if (res < 0) {
+            return res;
+        }
+
+        stat = yajl_gen_map_close(ctx->yajlgen);
+        if (stat != yajl_gen_status_ok) {
+            //!< @todo error?
+            return -1;
+        }
+    }
+
+    stat = yajl_gen_array_close(ctx->yajlgen);
+    if (stat != yajl_gen_status_ok) {
+        //!< @todo error?
+        return -1;
+    }
+
+    if (gen_key(ctx, TRANSACTION_ID)) {
+        //!< @todo error?
+        return -1;
+    }
+
+    stat = yajl_gen_integer(ctx->yajlgen, ws_message_get_id(msg));
+    if (stat != yajl_gen_status_ok) {
+        //!< @todo error?
+        return -1;
+    }
+
+    return 0;
+}
+
 static int
 serialize_event(
-    struct ws_serializer* self
+    struct serializer_context* ctx,
+    struct ws_message* msg
 ) {
-    struct serializer_context* ctx = (struct serializer_context*) self->state;
 
     // We haven't serialized anything
     // generate the key for the event message
@@ -384,7 +499,7 @@ serialize_event(
         return -1;
     }
 
-    struct ws_event* ev = (struct ws_event*) self->buffer;
+    struct ws_event* ev = (struct ws_event*) msg;
 
     // We have a '{ "event" : { "context" : ' in the buffer by now
     if (serialize_value(ctx, &ev->context.value) != 0) {
@@ -463,6 +578,23 @@ serialize_value(
         }
         break;
 
+    case WS_VALUE_TYPE_ARRAY:
+        {
+            struct ws_value_array* ary = (struct ws_value_array*) val;
+            size_t len = ws_value_array_len(ary);
+            intmax_t const* elems = ws_value_array_elems(ary);
+
+            stat = yajl_gen_array_open(ctx->yajlgen);
+            size_t i;
+            for (i = 0; (stat == yajl_gen_status_ok) && (i < len); ++i) {
+                stat = yajl_gen_integer(ctx->yajlgen, elems[i]);
+            }
+            if (stat == yajl_gen_status_ok) {
+                stat = yajl_gen_array_close(ctx->yajlgen);
+            }
+        }
+        break;
+
     default:
         {
             stat = yajl_gen_map_open(ctx->yajlgen);
@@ -482,7 +614,7 @@ serialize_value(
                     struct ws_value_object_id* obj_id;
                     obj_id = (struct ws_value_object_id*) val;
                     struct ws_object* object = ws_value_object_id_get(obj_id);
-                    if (serialize_object_to_id_string(ctx, object)) {
+                    if (serialize_object(ctx, object)) {
                         //!< @todo error?
                         return -1;
                     }
@@ -498,8 +630,7 @@ serialize_value(
 
                 //!< @todo check return value ... might return before ready
                 ws_value_set_select((struct ws_value_set*) val, NULL, NULL,
-                        (int (*)(void*, void const*))
-                            serialize_object_to_id_string,
+                        (int (*)(void*, void const*)) serialize_object,
                         ctx);
 
                 stat = yajl_gen_array_close(ctx->yajlgen);
@@ -527,6 +658,57 @@ serialize_value(
     return 0;
 }
 
+static int
+serialize_object(
+    struct serializer_context* ctx,
+    struct ws_object* obj
+) {
+    if (!ctx->expand) {
+        return serialize_object_to_id_string(ctx, obj);
+    }
+
+    yajl_gen_status stat = yajl_gen_map_open(ctx->yajlgen);
+    if ((stat != yajl_gen_status_ok) || gen_key(ctx, EXPANDED_ID) ||
+            serialize_object_to_id_string(ctx, obj) ||
+            gen_key(ctx, EXPANDED_TYPE)) {
+        //!< @todo error?
+        return -1;
+    }
+
+    char const* type = obj->id->typestr;
+    stat = yajl_gen_string(ctx->yajlgen, (unsigned char*) type, strlen(type));
+
+    size_t i;
+    for (i = 0; (stat == yajl_gen_status_ok) && (i < ctx->num_expand_attrs);
+            ++i) {
+        if (gen_key(ctx, ctx->expand_attrs[i])) {
+            //!< @todo error?
+            return -1;
+        }
+
+        // only integral attributes can be read without further conversion
+        struct ws_object_attribute const* attr;
+        intmax_t val;
+        if ((ws_object_type_resolve_attrs(obj->id, ctx->expand_attrs + i, 1,
+                                          &attr) == 0) &&
+                (ws_object_attr_read_ints(obj, &attr, 1, &val) == 0)) {
+            stat = yajl_gen_integer(ctx->yajlgen, val);
+        } else {
+            stat = yajl_gen_null(ctx->yajlgen);
+        }
+    }
+
+    if (stat == yajl_gen_status_ok) {
+        stat = yajl_gen_map_close(ctx->yajlgen);
+    }
+    if (stat != yajl_gen_status_ok) {
+        //!< @todo error?
+        return -1;
+    }
+
+    return 0;
+}
+
 static int
 serialize_object_to_id_string(
     struct serializer_context* ctx,
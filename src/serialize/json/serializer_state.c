@@ -43,6 +43,10 @@ serializer_context_new(void)
     ctx->yajl_buffer        = NULL;
     ctx->yajl_buffer_size   = 0;
 
+    ctx->expand             = false;
+    ctx->expand_attrs       = NULL;
+    ctx->num_expand_attrs   = 0;
+
     ctx->yajlgen = yajl_gen_alloc(NULL);
     if (!ctx->yajlgen) {
         free(ctx);
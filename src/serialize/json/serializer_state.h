@@ -48,6 +48,9 @@
 #ifndef __WS_SERIALIZE_JSON_SERIALIZER_STATE_H__
 #define __WS_SERIALIZE_JSON_SERIALIZER_STATE_H__
 
+#include <stdbool.h>
+#include <stddef.h>
+
 /**
  * State identifier
  */
@@ -70,6 +73,10 @@ struct serializer_context {
 
     unsigned char*  yajl_buffer;
     size_t          yajl_buffer_size;
+
+    bool expand; //!< @public Expand objects while serializing a value?
+    char const* const* expand_attrs; //!< @public Attributes to inline
+    size_t num_expand_attrs; //!< @public Number of attributes to inline
 };
 
 /*
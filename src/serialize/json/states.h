@@ -58,6 +58,17 @@ enum json_backend_state {
     STATE_FLAGS_EXEC, //!< We parsed the flags key "execute"
     STATE_FLAGS_REGISTER, //!< We parsed the flags key "register"
 
+    STATE_BATCH, //!< We parsed the "batch" key
+    STATE_BATCH_ARY, //!< We are parsing the transaction array of a batch
+    STATE_BATCH_ATOMIC, //!< We parsed the "atomic" key
+
+    STATE_INVOKE, //!< We parsed the "invoke" key
+    STATE_INVOKE_ARGS, //!< We parsed the "args" key
+    STATE_INVOKE_ARGS_ARY, //!< We are parsing the argument array
+
+    STATE_EXPAND, //!< We parsed the "expand" key
+    STATE_EXPAND_ARY, //!< We are parsing the attributes to expand objects with
+
     STATE_COMMAND_ARY, //!< We are parsing the command array
     STATE_COMMAND_ARY_NEW_COMMAND, //!< We are parsing a command
     STATE_COMMAND_ARY_COMMAND_NAME, //!< We parsed the command name
@@ -67,6 +78,7 @@ enum json_backend_state {
 
     STATE_COMMAND_ARY_COMMAND_ARG_INDIRECT, //!< We parsed a indirect value
     STATE_COMMAND_ARY_COMMAND_ARG_INDIRECT_STACKPOS, //!< stack position arg
+    STATE_COMMAND_ARY_COMMAND_ARG_OBJECT_ID, //!< object (uuid) arg
 
     STATE_EVENT_VALUE,
     STATE_EVENT_VALUE_OBJ,
@@ -0,0 +1,235 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util/condition.h"
+#include "values/array.h"
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Release a reference on array storage
+ */
+static void
+data_unref(
+    struct ws_value_array_data* data //!< The storage or `NULL`
+);
+
+/**
+ * Make sure the storage of an array is not shared and holds `len` elements
+ *
+ * @return zero on success, else negative error constant from errno.h
+ */
+static int
+make_unique(
+    struct ws_value_array* self, //!< The object
+    size_t len //!< The number of elements required
+);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+void
+ws_value_array_init(
+    struct ws_value_array* self
+) {
+    ws_value_init(&self->value);
+    self->value.type = WS_VALUE_TYPE_ARRAY;
+    self->data = NULL;
+}
+
+void
+ws_value_array_deinit(
+    struct ws_value* self
+) {
+    struct ws_value_array* ary = (struct ws_value_array*) self;
+
+    data_unref(ary->data);
+    ary->data = NULL;
+}
+
+void
+ws_value_array_assign(
+    struct ws_value_array* self,
+    struct ws_value_array const* other
+) {
+    struct ws_value_array_data* data = other->data;
+    if (data == self->data) {
+        return;
+    }
+
+    if (data) {
+        __atomic_add_fetch(&data->refcnt, 1, __ATOMIC_RELAXED);
+    }
+
+    data_unref(self->data);
+    self->data = data;
+}
+
+size_t
+ws_value_array_len(
+    struct ws_value_array const* self
+) {
+    return self->data ? self->data->len : 0;
+}
+
+intmax_t const*
+ws_value_array_elems(
+    struct ws_value_array const* self
+) {
+    return self->data ? self->data->elems : NULL;
+}
+
+intmax_t*
+ws_value_array_elems_mut(
+    struct ws_value_array* self
+) {
+    if (make_unique(self, ws_value_array_len(self)) < 0) {
+        return NULL;
+    }
+
+    return self->data ? self->data->elems : NULL;
+}
+
+int
+ws_value_array_resize(
+    struct ws_value_array* self,
+    size_t len
+) {
+    return make_unique(self, len);
+}
+
+intmax_t
+ws_value_array_get(
+    struct ws_value_array const* self,
+    size_t index
+) {
+    if (index >= ws_value_array_len(self)) {
+        return 0;
+    }
+
+    return self->data->elems[index];
+}
+
+int
+ws_value_array_set(
+    struct ws_value_array* self,
+    size_t index,
+    intmax_t val
+) {
+    if (index >= ws_value_array_len(self)) {
+        return -ERANGE;
+    }
+
+    intmax_t* elems = ws_value_array_elems_mut(self);
+    if (!elems) {
+        return -ENOMEM;
+    }
+
+    elems[index] = val;
+    return 0;
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static void
+data_unref(
+    struct ws_value_array_data* data
+) {
+    if (data && !__atomic_sub_fetch(&data->refcnt, 1, __ATOMIC_ACQ_REL)) {
+        free(data);
+    }
+}
+
+static int
+make_unique(
+    struct ws_value_array* self,
+    size_t len
+) {
+    struct ws_value_array_data* data = self->data;
+    size_t old_len = data ? data->len : 0;
+
+    if (!len) {
+        data_unref(data);
+        self->data = NULL;
+        return 0;
+    }
+
+    // the size of the storage must be representable
+    if (len > (SIZE_MAX - sizeof(*data)) / sizeof(*data->elems)) {
+        return -EOVERFLOW;
+    }
+
+    bool shared = data &&
+                  (__atomic_load_n(&data->refcnt, __ATOMIC_ACQUIRE) > 1);
+
+    if (data && !shared) {
+        if (len != old_len) {
+            data = realloc(data, sizeof(*data) + len * sizeof(*data->elems));
+            if (unlikely(!data)) {
+                return -ENOMEM;
+            }
+        }
+    } else {
+        data = malloc(sizeof(*data) + len * sizeof(*data->elems));
+        if (unlikely(!data)) {
+            return -ENOMEM;
+        }
+        data->refcnt = 1;
+
+        if (shared) {
+            size_t copy = (old_len < len) ? old_len : len;
+            memcpy(data->elems, self->data->elems, copy * sizeof(*data->elems));
+            data_unref(self->data);
+        }
+    }
+
+    if (len > old_len) {
+        memset(data->elems + old_len, 0,
+               (len - old_len) * sizeof(*data->elems));
+    }
+
+    data->len = len;
+    self->data = data;
+    return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup values "Value types"
+ *
+ * @{
+ */
+
+#ifndef __WS_VALUES_ARRAY_H__
+#define __WS_VALUES_ARRAY_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "values/value.h"
+
+/**
+ * Shared storage of ws_value_array objects
+ *
+ * The storage is reference counted. Copies of an array share it until one of
+ * them is modified (copy-on-write).
+ */
+struct ws_value_array_data {
+    size_t refcnt; //!< @private Number of arrays sharing the storage
+    size_t len; //!< @private Number of elements
+    intmax_t elems[]; //!< @private The elements
+};
+
+/**
+ * ws_value_array type definition
+ *
+ * @extends ws_value
+ *
+ * An array is a contiguous sequence of integers.
+ */
+struct ws_value_array {
+    struct ws_value value; //!< @protected Base class.
+
+    struct ws_value_array_data* data; //!< @private Storage, `NULL` if empty
+};
+
+/**
+ * Initialize an empty ws_value_array object
+ *
+ * @memberof ws_value_array
+ */
+void
+ws_value_array_init(
+    struct ws_value_array* self //!< The object
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Deinitialize a ws_value_array object
+ *
+ * @memberof ws_value_array
+ *
+ * @note Dispatched to by ws_value_deinit(), use that one instead
+ */
+void
+ws_value_array_deinit(
+    struct ws_value* self //!< The value to deinitialize
+);
+
+/**
+ * Make an array share the elements of another array
+ *
+ * @memberof ws_value_array
+ */
+void
+ws_value_array_assign(
+    struct ws_value_array* self, //!< The object
+    struct ws_value_array const* other //!< The array to share the elements of
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Get the number of elements of an array
+ *
+ * @memberof ws_value_array
+ *
+ * @return the number of elements
+ */
+size_t
+ws_value_array_len(
+    struct ws_value_array const* self //!< The object
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get read access to the elements of an array
+ *
+ * @memberof ws_value_array
+ *
+ * @warning the pointer is invalidated by any modification of the array
+ *
+ * @return the elements, `NULL` if the array is empty
+ */
+intmax_t const*
+ws_value_array_elems(
+    struct ws_value_array const* self //!< The object
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get write access to the elements of an array
+ *
+ * @memberof ws_value_array
+ *
+ * If the elements are shared with other arrays, they are copied first.
+ *
+ * @warning the pointer is invalidated by any other modification of the array
+ *
+ * @return the elements, `NULL` if the array is empty or on failure
+ */
+intmax_t*
+ws_value_array_elems_mut(
+    struct ws_value_array* self //!< The object
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Resize an array
+ *
+ * @memberof ws_value_array
+ *
+ * New elements are initialized with zero.
+ *
+ * @return zero on success, else negative error constant from errno.h:
+ *          -EOVERFLOW - the size of the elements is not representable
+ *          -ENOMEM - the elements could not be allocated
+ */
+int
+ws_value_array_resize(
+    struct ws_value_array* self, //!< The object
+    size_t len //!< The new number of elements
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get an element of an array
+ *
+ * @memberof ws_value_array
+ *
+ * @return the element or zero, if the index is out of range
+ */
+intmax_t
+ws_value_array_get(
+    struct ws_value_array const* self, //!< The object
+    size_t index //!< Index of the element
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Set an element of an array
+ *
+ * @memberof ws_value_array
+ *
+ * @return zero on success, else negative error constant from errno.h:
+ *          -ERANGE - the index is out of range
+ *          -ENOMEM - the elements could not be copied
+ */
+int
+ws_value_array_set(
+    struct ws_value_array* self, //!< The object
+    size_t index, //!< Index of the element
+    intmax_t val //!< The value to set the element to
+)
+__ws_nonnull__(1)
+;
+
+#endif // __WS_VALUES_ARRAY_H__
+
+/**
+ * @}
+ */
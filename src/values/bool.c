@@ -40,7 +40,6 @@ ws_value_bool_init(
         ws_value_init(&self->value);
 
         self->value.type = WS_VALUE_TYPE_BOOL;
-        self->value.deinit_callback = NULL;
     }
 }
 
@@ -41,7 +41,6 @@ ws_value_int_init(
         ws_value_init(&self->value);
 
         self->value.type = WS_VALUE_TYPE_INT;
-        self->value.deinit_callback = NULL;
     }
 }
 
@@ -36,12 +36,5 @@ ws_value_nil_init(
     if (self) {
         ws_value_init(&self->value);
         self->value.type = WS_VALUE_TYPE_NIL;
-
-        /*
-         * DON'T set the deinit callback, as the NIL type is nothing
-         * special. We don't need a deinit functionality, because it is
-         * just a value type with another name
-         */
-        //self->value.deinit_callback = nil_deinit;
     }
 }
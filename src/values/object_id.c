@@ -30,8 +30,8 @@
 #include "objects/object.h"
 #include "values/object_id.h"
 
-static void
-value_object_id_deinit(
+void
+ws_value_object_id_deinit(
     struct ws_value* self
 ) {
     struct ws_value_object_id* tmp = (struct ws_value_object_id*) self;
@@ -55,7 +55,9 @@ ws_value_object_id_init(
 
     ws_value_init(&self->val);
     self->val.type = WS_VALUE_TYPE_OBJECT_ID;
-    self->val.deinit_callback = value_object_id_deinit;
+
+    // the memory may have held an object id before, e.g. on a reused stack
+    self->obj = NULL;
 }
 
 struct ws_object*
@@ -45,6 +45,18 @@ struct ws_value_object_id {
     struct ws_object* obj; //!< @protected Reference to a ws_object
 };
 
+/**
+ * Deinitialize a ws_value_object_id object
+ *
+ * @memberof ws_value_object_id
+ *
+ * @note Dispatched to by ws_value_deinit(), use that one instead
+ */
+void
+ws_value_object_id_deinit(
+    struct ws_value* self //!< The value to deinitialize
+);
+
 /**
  * Initialize a ws_value_object_id object
  *
@@ -29,8 +29,47 @@
 #include <stdlib.h>
 #include "values/set.h"
 
-static void
-value_set_deinit(
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Create an empty set, which is ordered if `like` is ordered
+ *
+ * @return a new set or `NULL` on failure
+ */
+static struct ws_set*
+new_set_like(
+    struct ws_set const* like //!< The set to take the ordering from
+);
+
+/**
+ * Perform a set operation, storing the result in a value
+ *
+ * If the destination set is shared, the result is stored in a new set rather
+ * than copying the destination just to overwrite its content.
+ *
+ * @return zero on success, else negative error value from errno.h
+ */
+static int
+set_operation(
+    struct ws_value_set* dest, //!< The destination value
+    struct ws_set const* src_a, //!< The first source set
+    struct ws_set const* src_b, //!< The second source set
+    int (*op)(struct ws_set*, struct ws_set const*, struct ws_set const*)
+    //!< The operation to perform
+);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+void
+ws_value_set_deinit(
     struct ws_value* self
 ) {
     struct ws_value_set* s = (struct ws_value_set*) self;
@@ -47,12 +86,11 @@ ws_value_set_init(
     struct ws_value_set* self
 ) {
     self->set = ws_set_new();
-    if (!self) {
+    if (!self->set) {
         return -ENOMEM;
     }
 
     self->value.type = WS_VALUE_TYPE_SET;
-    self->value.deinit_callback = value_set_deinit;
 
     return 0;
 }
@@ -82,12 +120,58 @@ ws_value_set_get(
     return NULL;
 }
 
+void
+ws_value_set_set(
+    struct ws_value_set* self,
+    struct ws_set* set
+) {
+    if (set) {
+        struct ws_set* new_set = getref(set);
+
+        if (new_set) {
+            ws_object_unref(&self->set->obj);
+            self->set = new_set;
+        }
+    }
+}
+
+struct ws_set*
+ws_value_set_get_mut(
+    struct ws_value_set* self
+) {
+    if (!self->set) {
+        return NULL;
+    }
+
+    if (ws_object_is_shared(&self->set->obj)) {
+        struct ws_set* copy = new_set_like(self->set);
+        if (!copy) {
+            return NULL;
+        }
+
+        if (ws_set_union(copy, self->set, self->set) < 0) {
+            ws_object_unref(&copy->obj);
+            return NULL;
+        }
+
+        ws_object_unref(&self->set->obj);
+        self->set = copy;
+    }
+
+    return self->set;
+}
+
 int
 ws_value_set_insert(
     struct ws_value_set* self,
     struct ws_object* obj
 ) {
-    return ws_set_insert(self->set, obj);
+    struct ws_set* set = ws_value_set_get_mut(self);
+    if (!set) {
+        return -ENOMEM;
+    }
+
+    return ws_set_insert(set, obj);
 }
 
 int
@@ -95,7 +179,12 @@ ws_value_set_remove(
     struct ws_value_set* self,
     struct ws_object const* cmp
 ) {
-    return ws_set_remove(self->set, cmp);
+    struct ws_set* set = ws_value_set_get_mut(self);
+    if (!set) {
+        return -ENOMEM;
+    }
+
+    return ws_set_remove(set, cmp);
 }
 
 struct ws_object*
@@ -106,40 +195,42 @@ ws_value_set_get_object(
     return  ws_set_get(self->set, cmp);
 }
 
-/*
 int
 ws_value_set_union(
     struct ws_value_set* dest,
     struct ws_value_set const* src_a,
     struct ws_value_set const* src_b
 ) {
-    return ws_set_union(dest->set, src_a->set, src_b->set);
+    return set_operation(dest, src_a->set, src_b->set, ws_set_union);
 }
-*/
 
-/*
 int
 ws_value_set_intersection(
     struct ws_value_set* dest,
     struct ws_value_set const* src_a,
     struct ws_value_set const* src_b
 ) {
-    return ws_set_intersection(dest->set, src_a->set, src_b->set);
+    return set_operation(dest, src_a->set, src_b->set, ws_set_intersection);
+}
+
+int
+ws_value_set_difference(
+    struct ws_value_set* dest,
+    struct ws_value_set const* src_a,
+    struct ws_value_set const* src_b
+) {
+    return set_operation(dest, src_a->set, src_b->set, ws_set_difference);
 }
-*/
 
-/*
 int
 ws_value_set_xor(
     struct ws_value_set* dest,
     struct ws_value_set const* src_a,
     struct ws_value_set const* src_b
 ) {
-    return ws_set_xor(dest->set, src_a->set, src_b->set);
+    return set_operation(dest, src_a->set, src_b->set, ws_set_xor);
 }
-*/
 
-/*
 bool
 ws_value_set_is_subset(
     struct ws_value_set const* self,
@@ -147,7 +238,6 @@ ws_value_set_is_subset(
 ) {
     return ws_set_is_subset(self->set, other->set);
 }
-*/
 
 bool
 ws_value_set_equal(
@@ -174,3 +264,54 @@ ws_value_set_select(
 ) {
     return ws_set_select(self->set, pred, pred_etc, proc, proc_etc);
 }
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static struct ws_set*
+new_set_like(
+    struct ws_set const* like
+) {
+    struct ws_set* set = ws_set_new();
+    if (!set) {
+        return NULL;
+    }
+
+    if (ws_set_is_ordered(like) && (ws_set_enable_ordering(set) < 0)) {
+        ws_object_unref(&set->obj);
+        return NULL;
+    }
+
+    return set;
+}
+
+static int
+set_operation(
+    struct ws_value_set* dest,
+    struct ws_set const* src_a,
+    struct ws_set const* src_b,
+    int (*op)(struct ws_set*, struct ws_set const*, struct ws_set const*)
+) {
+    if (!ws_object_is_shared(&dest->set->obj)) {
+        return op(dest->set, src_a, src_b);
+    }
+
+    struct ws_set* res = new_set_like(dest->set);
+    if (!res) {
+        return -ENOMEM;
+    }
+
+    int retval = op(res, src_a, src_b);
+    if (retval < 0) {
+        ws_object_unref(&res->obj);
+        return retval;
+    }
+
+    // the sources may be the old set, so we may only drop it now
+    ws_object_unref(&dest->set->obj);
+    dest->set = res;
+    return 0;
+}
@@ -58,6 +58,18 @@ typedef int (*ws_value_set_predf)(void const*, void*);
  */
 typedef int (*ws_value_set_procf)(void*, void const*);
 
+/**
+ * Deinitialize a value_set object
+ *
+ * @memberof ws_value_set
+ *
+ * @note Dispatched to by ws_value_deinit(), use that one instead
+ */
+void
+ws_value_set_deinit(
+    struct ws_value* self //!< The value to deinitialize
+);
+
 /**
  * Initialize a value_set object
  *
@@ -96,6 +108,39 @@ ws_value_set_get(
 __ws_nonnull__(1)
 ;
 
+/**
+ * Set the ws_set object contained in the ws_value_set
+ *
+ * @memberof ws_value_set
+ */
+void
+ws_value_set_set(
+    struct ws_value_set* self, //!< The value_set object
+    struct ws_set* set //!< The set to store in the value
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get the ws_set object stored in the value type for modification
+ *
+ * @memberof ws_value_set
+ *
+ * Values share their ws_set object on copy. If the set is shared, it is
+ * replaced by a private copy, which may be modified without affecting other
+ * values.
+ *
+ * @warning No reference is taken on the returned object
+ *
+ * @return The set stored in ws_value_set object, NULL on failure
+ */
+struct ws_set*
+ws_value_set_get_mut(
+    struct ws_value_set* self
+)
+__ws_nonnull__(1)
+;
+
 /**
  * Insert an object into the set
  *
@@ -174,6 +219,22 @@ ws_value_set_intersection(
 __ws_nonnull__(1, 2, 3)
 ;
 
+/**
+ * Create the difference of two value_sets
+ *
+ * @memberof ws_value_set
+ *
+ * @return zero on success, else negative error value from errno.h
+ */
+int
+ws_value_set_difference(
+    struct ws_value_set* dest, //!< The destination object
+    struct ws_value_set const* src_a, //!< The value_set to subtract from
+    struct ws_value_set const* src_b //!< The value_set to subtract
+)
+__ws_nonnull__(1, 2, 3)
+;
+
 /**
  * Create the symmetric difference between two value_sets
  *
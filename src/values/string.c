@@ -32,18 +32,6 @@
 #include "objects/string.h"
 #include "values/value.h"
 
-/*
- *
- * forward delarations
- *
- */
-static void
-value_string_deinit(
-    struct ws_value* self
-)
-__ws_nonnull__(1)
-;
-
 void
 ws_value_string_init(
     struct ws_value_string* self
@@ -52,7 +40,6 @@ ws_value_string_init(
         ws_value_init(&self->val);
 
         self->val.type = WS_VALUE_TYPE_STRING;
-        self->val.deinit_callback = value_string_deinit;
 
         struct ws_string* str = ws_string_new();
 
@@ -85,6 +72,27 @@ ws_value_string_get(
     return NULL;
 }
 
+struct ws_string*
+ws_value_string_get_mut(
+    struct ws_value_string* self
+) {
+    if (!self || !self->str) {
+        return NULL;
+    }
+
+    if (ws_object_is_shared(&self->str->obj)) {
+        struct ws_string* copy = ws_string_dupl(self->str);
+        if (!copy) {
+            return NULL;
+        }
+
+        ws_object_unref(&self->str->obj);
+        self->str = copy;
+    }
+
+    return self->str;
+}
+
 void
 ws_value_string_set_str(
     struct ws_value_string* self,
@@ -100,13 +108,8 @@ ws_value_string_set_str(
     }
 }
 
-/*
- *
- * static function implementations
- *
- */
-static void
-value_string_deinit(
+void
+ws_value_string_deinit(
     struct ws_value* self
 ) {
     struct ws_value_string* wvs = (struct ws_value_string*) self;
@@ -46,6 +46,18 @@ struct ws_value_string {
     struct ws_string* str; //!< @protected ws_string object
 };
 
+/**
+ * Deinitialize a ws_value_string object
+ *
+ * @memberof ws_value_string
+ *
+ * @note Dispatched to by ws_value_deinit(), use that one instead
+ */
+void
+ws_value_string_deinit(
+    struct ws_value* self //!< The value to deinitialize
+);
+
 /**
  * Initialize a ws_value_string object
  *
@@ -81,6 +93,25 @@ ws_value_string_get(
     struct ws_value_string* self
 );
 
+/**
+ * get the ws_value_string's ws_string object for modification
+ *
+ * @memberof ws_value_string
+ *
+ * Values share their ws_string object on copy. If the string is shared, it is
+ * replaced by a private copy, which may be modified without affecting other
+ * values.
+ *
+ * @warning No reference is taken on the returned object
+ *
+ * @return the ws_string object contained in the ws_value_string object,
+ * NULL on failure
+ */
+struct ws_string*
+ws_value_string_get_mut(
+    struct ws_value_string* self
+);
+
 /**
  * set the ws_string object contained in the ws_value_string
  *
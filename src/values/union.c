@@ -26,6 +26,7 @@
  */
 
 #include <errno.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "values/union.h"
@@ -64,12 +65,10 @@ ws_value_union_init_from_val(
         }
 
     case WS_VALUE_TYPE_STRING:
-        ws_value_string_init(&dest->string);
-        {
-            ws_string_set_from_str(dest->string.str,
-                                    ((struct ws_value_string*)src)->str);
-            return 0;
-        }
+        // the string is shared, it is copied on the first modification
+        dest->string.val.type = WS_VALUE_TYPE_STRING;
+        dest->string.str = ws_value_string_get((struct ws_value_string*) src);
+        return dest->string.str ? 0 : -EINVAL;
 
     case WS_VALUE_TYPE_OBJECT_ID:
         ws_value_object_id_init(&dest->object_id);
@@ -85,9 +84,15 @@ ws_value_union_init_from_val(
         }
 
     case WS_VALUE_TYPE_SET:
+        dest->set.value.type = WS_VALUE_TYPE_SET;
         dest->set.set = ws_value_set_get((struct ws_value_set*) src);
         return 0;
 
+    case WS_VALUE_TYPE_ARRAY:
+        ws_value_array_init(&dest->array);
+        ws_value_array_assign(&dest->array, (struct ws_value_array*) src);
+        return 0;
+
     }
     return -EINVAL;
 }
@@ -128,6 +133,10 @@ ws_value_union_reinit(
 
     case WS_VALUE_TYPE_SET:
         return ws_value_set_init(&self->set);
+
+    case WS_VALUE_TYPE_ARRAY:
+        ws_value_array_init(&self->array);
+        break;
     }
     return 0;
 }
@@ -221,6 +230,31 @@ ws_value_union_tostr(
             //!< @todo implement
             break;
 
+    case WS_VALUE_TYPE_ARRAY:
+            {
+                size_t len = ws_value_array_len(&self->array);
+                intmax_t const* elems = ws_value_array_elems(&self->array);
+                size_t size;
+                size_t i;
+
+                FILE* stream = open_memstream(&res, &size);
+                if (!stream) {
+                    return NULL;
+                }
+
+                fputc('[', stream);
+                for (i = 0; i < len; ++i) {
+                    fprintf(stream, i ? ", %jd" : "%jd", elems[i]);
+                }
+                fputc(']', stream);
+
+                if (fclose(stream) != 0) {
+                    free(res);
+                    return NULL;
+                }
+            }
+            break;
+
     default:
             break;
     }
@@ -35,6 +35,7 @@
 #ifndef __WS_VALUES_UNION_H__
 #define __WS_VALUES_UNION_H__
 
+#include "values/array.h"
 #include "values/bool.h"
 #include "values/int.h"
 #include "values/nil.h"
@@ -54,6 +55,7 @@ union ws_value_union {
     struct ws_value_string      string;         //!< string value
     struct ws_value_object_id   object_id;      //!< object id value
     struct ws_value_set         set;            //!< set value
+    struct ws_value_array       array;          //!< array value
 };
 
 /**
@@ -25,18 +25,46 @@
  * along with waysome. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "values/array.h"
+#include "values/object_id.h"
+#include "values/set.h"
+#include "values/string.h"
 #include "values/value.h"
 #include "values/value_type.h"
 
+#include "util/arithmetical.h"
 #include "util/condition.h"
 
+/*
+ *
+ * Internal constant
+ *
+ */
+
+/**
+ * Deinit functions, indexed by value type
+ *
+ * Types without an entry are trivially destructible.
+ */
+static ws_value_type_deinit_callback const DEINIT_CALLBACKS[] = {
+    [WS_VALUE_TYPE_STRING]      = ws_value_string_deinit,
+    [WS_VALUE_TYPE_OBJECT_ID]   = ws_value_object_id_deinit,
+    [WS_VALUE_TYPE_SET]         = ws_value_set_deinit,
+    [WS_VALUE_TYPE_ARRAY]       = ws_value_array_deinit,
+};
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
 void
 ws_value_init(
     struct ws_value* self
 ) {
     if (self) {
         self->type = WS_VALUE_TYPE_VALUE;
-        self->deinit_callback = ws_value_deinit;
     }
 }
 
@@ -44,11 +72,13 @@ void
 ws_value_deinit(
     struct ws_value* self
 ) {
-    if (self) {
-        if (self->deinit_callback &&
-                likely(self->deinit_callback != ws_value_deinit)) {
-            self->deinit_callback(self);
-        }
+    if (unlikely(!self) || ((size_t) self->type >= ARYLEN(DEINIT_CALLBACKS))) {
+        return;
+    }
+
+    ws_value_type_deinit_callback deinit = DEINIT_CALLBACKS[self->type];
+    if (deinit) {
+        deinit(self);
     }
 }
 
@@ -47,11 +47,20 @@
 
 struct ws_value;
 
+/**
+ * Deinit function type for values
+ */
 typedef void (*ws_value_type_deinit_callback)(struct ws_value*);
 
+/**
+ * Value type definition
+ *
+ * A value is merely a type tag followed by the payload of the derived type.
+ * The deinit function is not stored in the value but looked up by the tag,
+ * which keeps every value, and hence `union ws_value_union`, at 16 bytes.
+ */
 struct ws_value {
-    enum ws_value_type type;
-    ws_value_type_deinit_callback deinit_callback; //!< @private
+    enum ws_value_type type; //!< @protected Type tag
 };
 
 /**
@@ -66,6 +75,9 @@ __ws_nonnull__(1)
 
 /**
  * Deinit a value object
+ *
+ * Dispatches to the deinit function of the value's type. Values of trivially
+ * destructible types, e.g. ints, are left alone.
  */
 void
 ws_value_deinit(
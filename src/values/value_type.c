@@ -30,6 +30,7 @@
 
 #include "util/arithmetical.h"
 #include "util/string.h"
+#include "values/array.h"
 #include "values/bool.h"
 #include "values/int.h"
 #include "values/nil.h"
@@ -47,6 +48,7 @@ const char* WS_VALUE_TYPE_NAMES[] = {
     [WS_VALUE_TYPE_STRING]      = "string",
     [WS_VALUE_TYPE_OBJECT_ID]   = "object",
     [WS_VALUE_TYPE_SET]         = "set",
+    [WS_VALUE_TYPE_ARRAY]       = "array",
 };
 
 
@@ -100,6 +102,11 @@ ws_value_type_instance_from_value_name(
         ws_value_set_init((struct ws_value_set*) v);
         break;
 
+    case WS_VALUE_TYPE_ARRAY:
+        v = calloc(1, sizeof(struct ws_value_array));
+        ws_value_array_init((struct ws_value_array*) v);
+        break;
+
     case WS_VALUE_TYPE_NONE:
     case WS_VALUE_TYPE_VALUE:
     default:
@@ -38,8 +38,1198 @@
  */
 
 #include <check.h>
+#include <errno.h>
+#include <ev.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "tests.h"
 
+#include "action/commands.h"
+#include "action/dispatch.h"
+#include "action/manager.h"
+#include "action/observer.h"
+#include "action/processor.h"
+#include "action/profiler.h"
+#include "action/stack_pool.h"
+#include "action/timer.h"
+#include "action/worker.h"
+#include "command/bytecode.h"
+#include "command/command.h"
+#include "command/statement.h"
+#include "values/array.h"
+#include "values/int.h"
+#include "values/set.h"
+#include "values/string.h"
+#include "objects/message/batch.h"
+#include "objects/message/batch_reply.h"
+#include "objects/message/error_reply.h"
+#include "objects/message/invocation.h"
+#include "objects/message/transaction.h"
+#include "objects/message/value_reply.h"
+#include "objects/string.h"
+#include "util/arithmetical.h"
+#include "util/cleaner.h"
+
+/**
+ * Create a string from a C string
+ */
+static struct ws_string*
+mk_str(
+    char const* str
+) {
+    struct ws_string* retval = ws_string_new();
+    ck_assert(retval);
+    ck_assert(ws_string_set_from_raw(retval, (char*) str) == 0);
+    return retval;
+}
+
+/**
+ * Create an empty transaction with a name
+ */
+static struct ws_transaction*
+mk_transaction(
+    char const* name
+) {
+    struct ws_string* str = mk_str(name);
+    struct ws_transaction* retval;
+    retval = ws_transaction_new(0, str, WS_TRANSACTION_FLAGS_REGISTER, NULL);
+    ck_assert(retval);
+    ws_object_unref((struct ws_object*) str);
+    return retval;
+}
+
+/**
+ * Allocate an int value
+ */
+static struct ws_value*
+mk_int(
+    intmax_t val
+) {
+    struct ws_value_int* v = calloc(1, sizeof(*v));
+    ck_assert(v);
+
+    ws_value_int_init(v);
+    ws_value_int_set(v, val);
+    return &v->value;
+}
+
+/**
+ * Create a transaction executing a single command with two int arguments
+ */
+static struct ws_transaction*
+mk_exec_transaction(
+    size_t id,
+    char const* command,
+    intmax_t lhs,
+    intmax_t rhs
+) {
+    struct ws_transaction* retval;
+    retval = ws_transaction_new(id, NULL, WS_TRANSACTION_FLAGS_EXEC, NULL);
+    ck_assert(retval);
+
+    struct ws_statement st;
+    ck_assert(ws_statement_init(&st, (char*) command) == 0);
+    ck_assert(ws_statement_append_direct(&st, mk_int(lhs)) == 0);
+    ck_assert(ws_statement_append_direct(&st, mk_int(rhs)) == 0);
+    ck_assert(ws_transaction_push_statement(retval, &st) == 0);
+    return retval;
+}
+
+/**
+ * Run statements and get the int value left on top of the stack
+ */
+static intmax_t
+run_statements(
+    struct ws_statement* st,
+    size_t num
+) {
+    struct ws_bytecode* code = ws_bytecode_compile(st, num);
+    ck_assert(code);
+
+    struct ws_processor_stack* stack = ws_processor_stack_pool_get();
+    ck_assert(stack);
+
+    struct ws_processor proc;
+    ck_assert(ws_processor_init(&proc, stack, code) == 0);
+    ck_assert(ws_processor_exec(&proc) == 0);
+
+    struct ws_value* top = ws_processor_stack_value_at(stack, -1, NULL);
+    ck_assert(top);
+    ck_assert(ws_value_get_type(top) == WS_VALUE_TYPE_INT);
+    intmax_t retval = ws_value_int_get((struct ws_value_int*) top);
+
+    ws_processor_deinit(&proc);
+    ws_processor_stack_pool_put(stack);
+    ws_bytecode_free(code);
+
+    size_t i;
+    for (i = 0; i < num; ++i) {
+        ws_statement_deinit(st + i);
+    }
+    return retval;
+}
+
+/**
+ * Run statements, returning the result of the processor
+ *
+ * If `top` is not `NULL`, the int value left on top of the stack is stored
+ * there.
+ */
+static ssize_t
+exec_statements(
+    struct ws_statement* st,
+    size_t num,
+    intmax_t* top
+) {
+    struct ws_bytecode* code = ws_bytecode_compile(st, num);
+    ck_assert(code);
+
+    struct ws_processor_stack* stack = ws_processor_stack_pool_get();
+    ck_assert(stack);
+
+    struct ws_processor proc;
+    ck_assert(ws_processor_init(&proc, stack, code) == 0);
+    ssize_t retval = ws_processor_exec(&proc);
+    ck_assert(!proc.suspended);
+
+    if (top) {
+        struct ws_value* val = ws_processor_stack_value_at(stack, -1, NULL);
+        ck_assert(val);
+        ck_assert(ws_value_get_type(val) == WS_VALUE_TYPE_INT);
+        *top = ws_value_int_get((struct ws_value_int*) val);
+    }
+
+    ws_processor_deinit(&proc);
+    ws_processor_stack_pool_put(stack);
+    ws_bytecode_free(code);
+
+    size_t i;
+    for (i = 0; i < num; ++i) {
+        ws_statement_deinit(st + i);
+    }
+    return retval;
+}
+
+START_TEST (test_dispatch_table) {
+    struct ws_dispatch_table table;
+    ck_assert(ws_dispatch_table_init(&table) == 0);
+
+    struct ws_transaction* foo = mk_transaction("foo");
+    struct ws_transaction* bar = mk_transaction("bar");
+    struct ws_string* foo_name = mk_str("foo");
+    struct ws_string* event = mk_str("event");
+
+    // transactions are found by their name
+    ck_assert(ws_dispatch_table_set(&table, foo_name, WS_DISPATCH_NAMED,
+                                    foo) == 0);
+    ck_assert(ws_dispatch_table_set(&table, foo_name, WS_DISPATCH_NAMED,
+                                    bar) == -EEXIST);
+    struct ws_transaction* found = ws_dispatch_table_get(&table, foo_name);
+    ck_assert(found == foo);
+    ws_object_unref((struct ws_object*) found);
+    ck_assert(!ws_dispatch_table_get(&table, event));
+
+    // registrations take precedence over names
+    ck_assert(ws_dispatch_table_set(&table, event, WS_DISPATCH_REGISTERED,
+                                    bar) == 0);
+    ck_assert(ws_dispatch_table_set(&table, foo_name, WS_DISPATCH_REGISTERED,
+                                    bar) == 0);
+    found = ws_dispatch_table_get(&table, foo_name);
+    ck_assert(found == bar);
+    ws_object_unref((struct ws_object*) found);
+
+    ck_assert(ws_dispatch_table_set(&table, foo_name, WS_DISPATCH_REGISTERED,
+                                    NULL) == 0);
+    found = ws_dispatch_table_get(&table, foo_name);
+    ck_assert(found == foo);
+    ws_object_unref((struct ws_object*) found);
+
+    // clearing the last mapping removes the name
+    ck_assert(ws_dispatch_table_set(&table, event, WS_DISPATCH_REGISTERED,
+                                    NULL) == 0);
+    ck_assert(ws_dispatch_table_set(&table, event, WS_DISPATCH_REGISTERED,
+                                    NULL) == -ENOENT);
+    ck_assert(!ws_dispatch_table_get(&table, event));
+
+    ws_object_unref((struct ws_object*) event);
+    ws_object_unref((struct ws_object*) foo_name);
+    ws_object_unref((struct ws_object*) bar);
+    ws_object_unref((struct ws_object*) foo);
+    ws_dispatch_table_deinit(&table);
+}
+END_TEST
+
+START_TEST (test_dispatch_table_many) {
+    struct ws_dispatch_table table;
+    ck_assert(ws_dispatch_table_init(&table) == 0);
+
+    struct ws_transaction* foo = mk_transaction("foo");
+    char buf[16];
+    int i;
+
+    // enough names to grow the table a few times
+    for (i = 0; i < 200; ++i) {
+        snprintf(buf, sizeof(buf), "event%d", i);
+        struct ws_string* name = mk_str(buf);
+        ck_assert(ws_dispatch_table_set(&table, name, WS_DISPATCH_REGISTERED,
+                                        foo) == 0);
+        ws_object_unref((struct ws_object*) name);
+    }
+
+    // remove every other name
+    for (i = 0; i < 200; i += 2) {
+        snprintf(buf, sizeof(buf), "event%d", i);
+        struct ws_string* name = mk_str(buf);
+        ck_assert(ws_dispatch_table_set(&table, name, WS_DISPATCH_REGISTERED,
+                                        NULL) == 0);
+        ws_object_unref((struct ws_object*) name);
+    }
+
+    for (i = 0; i < 200; ++i) {
+        snprintf(buf, sizeof(buf), "event%d", i);
+        struct ws_string* name = mk_str(buf);
+        struct ws_transaction* found = ws_dispatch_table_get(&table, name);
+        ck_assert((found == foo) == (i % 2));
+        if (found) {
+            ws_object_unref((struct ws_object*) found);
+        }
+        ws_object_unref((struct ws_object*) name);
+    }
+
+    ws_object_unref((struct ws_object*) foo);
+    ws_dispatch_table_deinit(&table);
+}
+END_TEST
+
+START_TEST (test_stack_pool_reuse) {
+    struct ws_processor_stack* stack = ws_processor_stack_pool_get();
+    ck_assert(stack);
+    ck_assert(ws_processor_stack_push(stack, 100) == 0);
+    size_t size = stack->size;
+    ws_processor_stack_pool_put(stack);
+
+    // the same stack is handed out again, empty but with its capacity
+    struct ws_processor_stack* again = ws_processor_stack_pool_get();
+    ck_assert(again == stack);
+    ck_assert(again->top == 0);
+    ck_assert(again->size == size);
+    ws_processor_stack_pool_put(again);
+
+    ws_processor_stack_pool_release();
+}
+END_TEST
+
+START_TEST (test_stack_pool_trim) {
+    struct ws_processor_stack* stack = ws_processor_stack_pool_get();
+    ck_assert(stack);
+    ck_assert(ws_processor_stack_push(stack, 100) == 0);
+    size_t size = stack->size;
+    ws_processor_stack_pool_put(stack);
+
+    // the stack was used since the last trim, so its capacity is kept
+    ws_processor_stack_pool_trim();
+    stack = ws_processor_stack_pool_get();
+    ck_assert(stack->size == size);
+    ws_processor_stack_pool_put(stack);
+
+    // a pop never shrinks the stack
+    stack = ws_processor_stack_pool_get();
+    ck_assert(ws_processor_stack_push(stack, 10) == 0);
+    ck_assert(ws_processor_stack_pop(stack, 10) == 0);
+    ck_assert(stack->size == size);
+    ws_processor_stack_pool_put(stack);
+
+    // an unused stack is released by the second trim
+    ws_processor_stack_pool_trim();
+    ws_processor_stack_pool_trim();
+    stack = ws_processor_stack_pool_get();
+    ck_assert(stack->size < size);
+    ws_processor_stack_pool_put(stack);
+
+    ws_processor_stack_pool_release();
+}
+END_TEST
+
+START_TEST (test_stack_pool_nesting) {
+    struct ws_processor_stack* stacks[8];
+
+    // take more stacks than the pool holds
+    size_t i;
+    for (i = 0; i < 8; ++i) {
+        stacks[i] = ws_processor_stack_pool_get();
+        ck_assert(stacks[i]);
+        ck_assert(ws_processor_stack_push(stacks[i], 3) == 0);
+    }
+
+    // stacks may be returned in any order
+    for (i = 0; i < 8; ++i) {
+        ws_processor_stack_pool_put(stacks[i]);
+    }
+
+    ws_processor_stack_pool_release();
+}
+END_TEST
+
+START_TEST (test_processor_exec) {
+    ck_assert(ws_command_init() == 0);
+    ck_assert(ws_action_commands_init() == 0);
+
+    struct ws_statement st[4];
+    intmax_t top;
+
+    // push 1; jump 1; push 2; add $-1 10
+    ck_assert(ws_statement_init(&st[0], "push") == 0);
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(1)) == 0);
+    ck_assert(ws_statement_init(&st[1], "jump") == 0);
+    ck_assert(ws_statement_append_direct(&st[1], mk_int(1)) == 0);
+    ck_assert(ws_statement_init(&st[2], "push") == 0);
+    ck_assert(ws_statement_append_direct(&st[2], mk_int(2)) == 0);
+    ck_assert(ws_statement_init(&st[3], "add") == 0);
+    ck_assert(ws_statement_append_indirect(&st[3], -1) == 0);
+    ck_assert(ws_statement_append_direct(&st[3], mk_int(10)) == 0);
+    ck_assert(exec_statements(st, 4, &top) == 0);
+    ck_assert(top == 11);
+
+    // push 1; jump 3, leaving the transaction at position 5
+    ck_assert(ws_statement_init(&st[0], "push") == 0);
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(1)) == 0);
+    ck_assert(ws_statement_init(&st[1], "jump") == 0);
+    ck_assert(ws_statement_append_direct(&st[1], mk_int(3)) == 0);
+    ck_assert(exec_statements(st, 2, NULL) == 5);
+
+    // push 2; store 7 $-1; mul $-1 3, the special alters the stack
+    ck_assert(ws_statement_init(&st[0], "push") == 0);
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(2)) == 0);
+    ck_assert(ws_statement_init(&st[1], "store") == 0);
+    ck_assert(ws_statement_append_direct(&st[1], mk_int(7)) == 0);
+    ck_assert(ws_statement_append_indirect(&st[1], -1) == 0);
+    ck_assert(ws_statement_init(&st[2], "mul") == 0);
+    ck_assert(ws_statement_append_indirect(&st[2], -1) == 0);
+    ck_assert(ws_statement_append_direct(&st[2], mk_int(3)) == 0);
+    ck_assert(exec_statements(st, 3, &top) == 0);
+    ck_assert(top == 21);
+
+    // errors of regular commands stop the execution: push 4; div $-1 0
+    ck_assert(ws_statement_init(&st[0], "push") == 0);
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(4)) == 0);
+    ck_assert(ws_statement_init(&st[1], "div") == 0);
+    ck_assert(ws_statement_append_indirect(&st[1], -1) == 0);
+    ck_assert(ws_statement_append_direct(&st[1], mk_int(0)) == 0);
+    ck_assert(ws_statement_init(&st[2], "jump") == 0);
+    ck_assert(ws_statement_append_direct(&st[2], mk_int(3)) == 0);
+    ck_assert(exec_statements(st, 3, NULL) == -EFAULT);
+
+    // ... as do errors of special commands: pop 3
+    ck_assert(ws_statement_init(&st[0], "pop") == 0);
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(3)) == 0);
+    ck_assert(ws_statement_init(&st[1], "jump") == 0);
+    ck_assert(ws_statement_append_direct(&st[1], mk_int(3)) == 0);
+    ck_assert(exec_statements(st, 2, NULL) < 0);
+
+    // ... and stack positions which are out of bounds: add $-2 1
+    ck_assert(ws_statement_init(&st[0], "add") == 0);
+    ck_assert(ws_statement_append_indirect(&st[0], -2) == 0);
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(1)) == 0);
+    ck_assert(exec_statements(st, 1, NULL) == -EINVAL);
+
+    ws_processor_stack_pool_release();
+}
+END_TEST
+
+START_TEST (test_processor_budget) {
+    ck_assert(ws_command_init() == 0);
+    ck_assert(ws_action_commands_init() == 0);
+
+    // jump -1, an endless loop
+    struct ws_value_int* offset = calloc(1, sizeof(*offset));
+    ck_assert(offset);
+    ws_value_int_init(offset);
+    ws_value_int_set(offset, -1);
+
+    struct ws_statement st;
+    ck_assert(ws_statement_init(&st, "jump") == 0);
+    ck_assert(ws_statement_append_direct(&st, &offset->value) == 0);
+
+    struct ws_bytecode* code = ws_bytecode_compile(&st, 1);
+    ck_assert(code);
+
+    struct ws_processor_stack* stack = ws_processor_stack_pool_get();
+    ck_assert(stack);
+
+    struct ws_processor proc;
+    ck_assert(ws_processor_init(&proc, stack, code) == 0);
+
+    // the processor is suspended and may be resumed
+    proc.budget = 1000;
+    ck_assert(ws_processor_exec(&proc) == 0);
+    ck_assert(proc.suspended);
+    ck_assert(ws_processor_exec(&proc) == 0);
+    ck_assert(proc.suspended);
+
+    proc.budget = 0;
+    proc.time_budget = 0.001;
+    ck_assert(ws_processor_exec(&proc) == 0);
+    ck_assert(proc.suspended);
+
+    ws_processor_deinit(&proc);
+    ws_processor_stack_pool_put(stack);
+    ws_processor_stack_pool_release();
+    ws_bytecode_free(code);
+    ws_statement_deinit(&st);
+}
+END_TEST
+
+/**
+ * Get the report of the profiler as a string
+ */
+static char*
+profiler_report(void) {
+    char* buf = NULL;
+    size_t len = 0;
+    FILE* out = open_memstream(&buf, &len);
+    ck_assert(out);
+    ck_assert(ws_profiler_report(out) == 0);
+    fclose(out);
+    return buf;
+}
+
+START_TEST (test_profiler) {
+    ck_assert(ws_command_init() == 0);
+    ck_assert(ws_action_commands_init() == 0);
+
+    // div 4 0, which is not folded since it fails
+    struct ws_value_int* vals[2];
+    size_t i;
+    for (i = 0; i < 2; ++i) {
+        vals[i] = calloc(1, sizeof(*vals[i]));
+        ck_assert(vals[i]);
+        ws_value_int_init(vals[i]);
+    }
+    ws_value_int_set(vals[0], 4);
+    ws_value_int_set(vals[1], 0);
+
+    struct ws_statement st;
+    ck_assert(ws_statement_init(&st, "div") == 0);
+    ck_assert(ws_statement_append_direct(&st, &vals[0]->value) == 0);
+    ck_assert(ws_statement_append_direct(&st, &vals[1]->value) == 0);
+
+    struct ws_bytecode* code = ws_bytecode_compile(&st, 1);
+    ck_assert(code);
+
+    struct ws_processor_stack* stack = ws_processor_stack_pool_get();
+    ck_assert(stack);
+
+    // nothing is recorded while the profiler is disabled
+    ws_profiler_reset();
+    struct ws_processor proc;
+    ck_assert(ws_processor_init(&proc, stack, code) == 0);
+    ck_assert(ws_processor_exec(&proc) < 0);
+    ws_processor_deinit(&proc);
+
+    char* report = profiler_report();
+    ck_assert(!strstr(report, "command div:"));
+    free(report);
+
+    // failing invocations are recorded as well
+    ws_profiler_enable(true);
+    for (i = 0; i < 2; ++i) {
+        ck_assert(ws_processor_init(&proc, stack, code) == 0);
+        ck_assert(ws_processor_exec(&proc) < 0);
+        ws_processor_deinit(&proc);
+    }
+
+    struct ws_string* name = mk_str("foo");
+    ws_profiler_record_transaction(name, 3000);
+    ws_profiler_record_transaction(name, 3000);
+
+    report = profiler_report();
+    ck_assert(strstr(report, "command div: calls=2 "));
+    ck_assert(strstr(report, "transaction foo: runs=2 total_ns=6000 "));
+    ck_assert(strstr(report, " <4:2"));
+    free(report);
+
+    // a reset clears all the counters
+    ws_profiler_reset();
+    report = profiler_report();
+    ck_assert(!strstr(report, "div"));
+    ck_assert(!strstr(report, "foo"));
+    free(report);
+    ws_profiler_enable(false);
+
+    ws_object_unref((struct ws_object*) name);
+    ws_processor_stack_pool_put(stack);
+    ws_processor_stack_pool_release();
+    ws_bytecode_free(code);
+    ws_statement_deinit(&st);
+}
+END_TEST
+
+START_TEST (test_processor_branches) {
+    ck_assert(ws_command_init() == 0);
+    ck_assert(ws_action_commands_init() == 0);
+
+    intmax_t cond;
+    for (cond = 0; cond < 2; ++cond) {
+        struct ws_statement st[3];
+
+        // push cond; jump_unless $-1 1; push 7
+        ck_assert(ws_statement_init(&st[0], "push") == 0);
+        ck_assert(ws_statement_append_direct(&st[0], mk_int(cond)) == 0);
+        ck_assert(ws_statement_init(&st[1], "jump_unless") == 0);
+        ck_assert(ws_statement_append_indirect(&st[1], -1) == 0);
+        ck_assert(ws_statement_append_direct(&st[1], mk_int(1)) == 0);
+        ck_assert(ws_statement_init(&st[2], "push") == 0);
+        ck_assert(ws_statement_append_direct(&st[2], mk_int(7)) == 0);
+
+        ck_assert(run_statements(st, 3) == (cond ? 7 : 0));
+    }
+
+    // the distance of a conditional jump must be known ahead of time
+    struct ws_statement st;
+    ck_assert(ws_statement_init(&st, "jump_if") == 0);
+    ck_assert(ws_statement_append_direct(&st, mk_int(1)) == 0);
+    ck_assert(ws_statement_append_indirect(&st, -1) == 0);
+    ck_assert(!ws_bytecode_compile(&st, 1));
+    ws_statement_deinit(&st);
+
+    ws_processor_stack_pool_release();
+}
+END_TEST
+
+START_TEST (test_processor_foreach) {
+    ck_assert(ws_command_init() == 0);
+    ck_assert(ws_action_commands_init() == 0);
+
+    struct ws_value_array* array = calloc(1, sizeof(*array));
+    ck_assert(array);
+    ws_value_array_init(array);
+    ck_assert(ws_value_array_resize(array, 4) == 0);
+    size_t i;
+    for (i = 0; i < 4; ++i) {
+        ck_assert(ws_value_array_set(array, i, i + 1) == 0);
+    }
+
+    struct ws_statement st[8];
+
+    // push 0; push 0; foreach [1 2 3 4] $-1 4; add $-3 $-1; store $-1 $-4;
+    // pop 2; jump -5; pop 1
+    ck_assert(ws_statement_init(&st[0], "push") == 0);
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(0)) == 0);
+    ck_assert(ws_statement_init(&st[1], "push") == 0);
+    ck_assert(ws_statement_append_direct(&st[1], mk_int(0)) == 0);
+    ck_assert(ws_statement_init(&st[2], "foreach") == 0);
+    ck_assert(ws_statement_append_direct(&st[2], &array->value) == 0);
+    ck_assert(ws_statement_append_indirect(&st[2], -1) == 0);
+    ck_assert(ws_statement_append_direct(&st[2], mk_int(4)) == 0);
+    ck_assert(ws_statement_init(&st[3], "add") == 0);
+    ck_assert(ws_statement_append_indirect(&st[3], -3) == 0);
+    ck_assert(ws_statement_append_indirect(&st[3], -1) == 0);
+    ck_assert(ws_statement_init(&st[4], "store") == 0);
+    ck_assert(ws_statement_append_indirect(&st[4], -1) == 0);
+    ck_assert(ws_statement_append_indirect(&st[4], -4) == 0);
+    ck_assert(ws_statement_init(&st[5], "pop") == 0);
+    ck_assert(ws_statement_append_direct(&st[5], mk_int(2)) == 0);
+    ck_assert(ws_statement_init(&st[6], "jump") == 0);
+    ck_assert(ws_statement_append_direct(&st[6], mk_int(-5)) == 0);
+    ck_assert(ws_statement_init(&st[7], "pop") == 0);
+    ck_assert(ws_statement_append_direct(&st[7], mk_int(1)) == 0);
+
+    ck_assert(run_statements(st, 8) == 10);
+
+    // sets of strings are hashed over the whole table
+    struct ws_value_set* set = ws_value_set_new();
+    ck_assert(set);
+    char buf[16];
+    for (i = 0; i < 100; ++i) {
+        snprintf(buf, sizeof(buf), "elem%zu", i);
+        struct ws_string* str = mk_str(buf);
+        ck_assert(ws_value_set_insert(set, &str->obj) == 0);
+        ws_object_unref(&str->obj);
+    }
+
+    // push 0; push 0; foreach {...} $-1 4; add $-3 1; store $-1 $-4;
+    // pop 2; jump -5; pop 1
+    ck_assert(ws_statement_init(&st[0], "push") == 0);
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(0)) == 0);
+    ck_assert(ws_statement_init(&st[1], "push") == 0);
+    ck_assert(ws_statement_append_direct(&st[1], mk_int(0)) == 0);
+    ck_assert(ws_statement_init(&st[2], "foreach") == 0);
+    ck_assert(ws_statement_append_direct(&st[2], &set->value) == 0);
+    ck_assert(ws_statement_append_indirect(&st[2], -1) == 0);
+    ck_assert(ws_statement_append_direct(&st[2], mk_int(4)) == 0);
+    ck_assert(ws_statement_init(&st[3], "add") == 0);
+    ck_assert(ws_statement_append_indirect(&st[3], -3) == 0);
+    ck_assert(ws_statement_append_direct(&st[3], mk_int(1)) == 0);
+    ck_assert(ws_statement_init(&st[4], "store") == 0);
+    ck_assert(ws_statement_append_indirect(&st[4], -1) == 0);
+    ck_assert(ws_statement_append_indirect(&st[4], -4) == 0);
+    ck_assert(ws_statement_init(&st[5], "pop") == 0);
+    ck_assert(ws_statement_append_direct(&st[5], mk_int(2)) == 0);
+    ck_assert(ws_statement_init(&st[6], "jump") == 0);
+    ck_assert(ws_statement_append_direct(&st[6], mk_int(-5)) == 0);
+    ck_assert(ws_statement_init(&st[7], "pop") == 0);
+    ck_assert(ws_statement_append_direct(&st[7], mk_int(1)) == 0);
+
+    // every element is visited exactly once
+    ck_assert(run_statements(st, 8) == 100);
+    ws_processor_stack_pool_release();
+}
+END_TEST
+
+START_TEST (test_timers) {
+    struct ws_string* tick = mk_str("tick");
+    struct ws_string* tock = mk_str("tock");
+
+    ck_assert(ws_action_timer_add(tick, 1, 0) == 0);
+    ck_assert(ws_action_timer_add(tock, 0.5, 0.5) == 0);
+    ck_assert(ws_action_timer_add(tock, -1, 0) == -EINVAL);
+
+    // timers with the same name are replaced
+    ck_assert(ws_action_timer_add(tick, 2, 2) == 0);
+    ck_assert(ws_action_timer_remove(tick) == 0);
+    ck_assert(ws_action_timer_remove(tick) == -ENOENT);
+
+    ws_action_timer_deinit();
+    ck_assert(ws_action_timer_remove(tock) == -ENOENT);
+
+    ws_object_unref((struct ws_object*) tick);
+    ws_object_unref((struct ws_object*) tock);
+}
+END_TEST
+
+START_TEST (test_observers) {
+    ws_cleaner_init();
+
+    struct ws_string* moved = mk_str("moved");
+    struct ws_string* other = mk_str("other");
+    struct ws_object* obj = ws_object_new_raw();
+    ck_assert(obj);
+
+    ck_assert(ws_action_observer_init() == 0);
+
+    // either an object or a type must be observed
+    ck_assert(ws_action_observer_add(moved, NULL, NULL, "x") == -EINVAL);
+    ck_assert(ws_action_observer_add(moved, obj, "ws_object", "x") ==
+              -EINVAL);
+
+    ck_assert(ws_action_observer_add(moved, obj, NULL, "x") == 0);
+    ck_assert(ws_action_observer_add(moved, NULL, "ws_object", "y") == 0);
+
+    // changes are queued until the next loop iteration
+    ws_action_observer_notify(obj, "x");
+    ws_action_observer_notify(obj, "x");
+    ws_action_observer_notify(obj, "y");
+    ws_action_observer_notify((struct ws_object*) other, "x");
+
+    ck_assert(ws_action_observer_remove(moved) == 0);
+    ck_assert(ws_action_observer_remove(moved) == -ENOENT);
+    ck_assert(ws_action_observer_remove(other) == -ENOENT);
+
+    // pending changes are dropped
+    ws_action_observer_deinit();
+
+    ws_object_unref(obj);
+    ws_object_unref((struct ws_object*) moved);
+    ws_object_unref((struct ws_object*) other);
+    ws_cleaner_run();
+}
+END_TEST
+
+START_TEST (test_batch) {
+    ck_assert(ws_command_init() == 0);
+    ck_assert(ws_action_commands_init() == 0);
+
+    int atomic;
+    for (atomic = 0; atomic < 2; ++atomic) {
+        struct ws_batch* batch = ws_batch_new(42);
+        ck_assert(batch);
+        ws_batch_set_atomic(batch, atomic);
+
+        // the second transaction fails
+        struct ws_transaction* t[3] = {
+            mk_exec_transaction(1, "add", 1, 2),
+            mk_exec_transaction(2, "div", 4, 0),
+            mk_exec_transaction(3, "sub", 5, 1),
+        };
+        size_t i;
+        for (i = 0; i < 3; ++i) {
+            ck_assert(ws_batch_append(batch, t[i]) == 0);
+            ws_object_unref((struct ws_object*) t[i]);
+        }
+
+        struct ws_reply* reply = ws_action_manager_process(&batch->m);
+        ck_assert(reply);
+        ck_assert(reply->m.obj.id == &WS_OBJECT_TYPE_ID_BATCH_REPLY);
+        ck_assert(ws_message_get_id(&reply->m) == 42);
+
+        struct ws_batch_reply* br = (struct ws_batch_reply*) reply;
+        ck_assert(ws_batch_reply_len(br) == 3);
+
+        struct ws_reply* r = ws_batch_reply_get(br, 0);
+        ck_assert(r->m.obj.id == &WS_OBJECT_TYPE_ID_VALUE_REPLY);
+        ck_assert(ws_message_get_id(&r->m) == 1);
+        struct ws_value* v;
+        v = ws_value_reply_get_value((struct ws_value_reply*) r);
+        ck_assert(ws_value_int_get((struct ws_value_int*) v) == 3);
+
+        r = ws_batch_reply_get(br, 1);
+        ck_assert(r->m.obj.id == &WS_OBJECT_TYPE_ID_ERROR_REPLY);
+        ck_assert(ws_message_get_id(&r->m) == 2);
+
+        // an atomic batch stops at the first error
+        r = ws_batch_reply_get(br, 2);
+        ck_assert(ws_message_get_id(&r->m) == 3);
+        if (atomic) {
+            ck_assert(r->m.obj.id == &WS_OBJECT_TYPE_ID_ERROR_REPLY);
+            struct ws_error_reply* e = (struct ws_error_reply*) r;
+            ck_assert(ws_error_reply_get_code(e) == ECANCELED);
+        } else {
+            ck_assert(r->m.obj.id == &WS_OBJECT_TYPE_ID_VALUE_REPLY);
+            v = ws_value_reply_get_value((struct ws_value_reply*) r);
+            ck_assert(ws_value_int_get((struct ws_value_int*) v) == 4);
+        }
+
+        ws_object_unref((struct ws_object*) reply);
+        ws_object_unref((struct ws_object*) batch);
+    }
+
+    ws_processor_stack_pool_release();
+}
+END_TEST
+
+START_TEST (test_invocation) {
+    ws_cleaner_init();
+    ck_assert(ws_command_init() == 0);
+
+    struct ws_string* name = mk_str("addargs");
+    ck_assert(ws_action_manager_init((struct ws_object*) name) == 0);
+
+    // register a transaction adding its first two arguments
+    struct ws_transaction* t = ws_transaction_new(1, name,
+                                                  WS_TRANSACTION_FLAGS_REGISTER,
+                                                  NULL);
+    ck_assert(t);
+    struct ws_statement st;
+    ck_assert(ws_statement_init(&st, "add") == 0);
+    ck_assert(ws_statement_append_indirect(&st, 2) == 0);
+    ck_assert(ws_statement_append_indirect(&st, 3) == 0);
+    ck_assert(ws_transaction_push_statement(t, &st) == 0);
+    ck_assert(!ws_action_manager_process(&t->m));
+
+    struct ws_invocation* inv = ws_invocation_new(9, name);
+    ck_assert(inv);
+    struct ws_value* arg = mk_int(3);
+    ck_assert(ws_invocation_append_arg(inv, arg) == 0);
+    ws_value_deinit(arg);
+    free(arg);
+    arg = mk_int(4);
+    ck_assert(ws_invocation_append_arg(inv, arg) == 0);
+    ws_value_deinit(arg);
+    free(arg);
+
+    // the reply carries the id of the invocation
+    struct ws_reply* reply = ws_action_manager_process(&inv->m);
+    ck_assert(reply);
+    ck_assert(reply->m.obj.id == &WS_OBJECT_TYPE_ID_VALUE_REPLY);
+    ck_assert(ws_message_get_id(&reply->m) == 9);
+    struct ws_value* v;
+    v = ws_value_reply_get_value((struct ws_value_reply*) reply);
+    ck_assert(ws_value_int_get((struct ws_value_int*) v) == 7);
+    ws_object_unref((struct ws_object*) reply);
+    ws_object_unref((struct ws_object*) inv);
+
+    // unknown transactions are reported
+    struct ws_string* other = mk_str("nonexistent");
+    inv = ws_invocation_new(10, other);
+    ck_assert(inv);
+    reply = ws_action_manager_process(&inv->m);
+    ck_assert(reply);
+    ck_assert(reply->m.obj.id == &WS_OBJECT_TYPE_ID_ERROR_REPLY);
+    ck_assert(ws_message_get_id(&reply->m) == 10);
+    ck_assert(ws_error_reply_get_code((struct ws_error_reply*) reply) ==
+              ENOENT);
+    ws_object_unref((struct ws_object*) reply);
+    ws_object_unref((struct ws_object*) inv);
+
+    ws_object_unref((struct ws_object*) other);
+    ws_object_unref((struct ws_object*) t);
+    ws_object_unref((struct ws_object*) name);
+    ws_cleaner_run();
+}
+END_TEST
+
+/**
+ * Replies collected by `collect_reply()`, in the order they were passed
+ */
+struct collected_replies {
+    struct ws_reply* replies[8]; //!< replies collected
+    size_t num; //!< number of replies collected
+};
+
+/**
+ * Reply callback collecting the replies in a `struct collected_replies`
+ */
+static void
+collect_reply(
+    struct ws_reply* reply,
+    void* data
+) {
+    struct collected_replies* collected = (struct collected_replies*) data;
+    ck_assert(collected->num < ARYLEN(collected->replies));
+    collected->replies[collected->num++] = reply;
+}
+
+/**
+ * Create a transaction executing statements
+ *
+ * The transaction takes over the statements.
+ */
+static struct ws_transaction*
+mk_statements_transaction(
+    size_t id,
+    struct ws_statement* st,
+    size_t num
+) {
+    struct ws_transaction* retval;
+    retval = ws_transaction_new(id, NULL, WS_TRANSACTION_FLAGS_EXEC, NULL);
+    ck_assert(retval);
+
+    size_t i;
+    for (i = 0; i < num; ++i) {
+        ck_assert(ws_transaction_push_statement(retval, st + i) == 0);
+    }
+    return retval;
+}
+
+/**
+ * Create a transaction which is not pure, counting down from `count`
+ */
+static struct ws_transaction*
+mk_countdown_transaction(
+    size_t id,
+    struct ws_string* name,
+    enum ws_transaction_flags flags,
+    intmax_t count
+) {
+    struct ws_transaction* retval = ws_transaction_new(id, name, flags, NULL);
+    ck_assert(retval);
+
+    // hastypename $0 "ws_string"; push count; sub $-1 1; store $-1 $-2;
+    // pop 1; jump_unless $-1 1; jump -5
+    struct ws_statement st[7];
+    ck_assert(ws_statement_init(&st[0], "hastypename") == 0);
+    ck_assert(ws_statement_append_indirect(&st[0], 0) == 0);
+    struct ws_value_string* type = ws_value_string_new();
+    ck_assert(type);
+    struct ws_string* typename = mk_str("ws_string");
+    ws_value_string_set_str(type, typename);
+    ws_object_unref((struct ws_object*) typename);
+    ck_assert(ws_statement_append_direct(&st[0], &type->val) == 0);
+    ck_assert(ws_statement_init(&st[1], "push") == 0);
+    ck_assert(ws_statement_append_direct(&st[1], mk_int(count)) == 0);
+    ck_assert(ws_statement_init(&st[2], "sub") == 0);
+    ck_assert(ws_statement_append_indirect(&st[2], -1) == 0);
+    ck_assert(ws_statement_append_direct(&st[2], mk_int(1)) == 0);
+    ck_assert(ws_statement_init(&st[3], "store") == 0);
+    ck_assert(ws_statement_append_indirect(&st[3], -1) == 0);
+    ck_assert(ws_statement_append_indirect(&st[3], -2) == 0);
+    ck_assert(ws_statement_init(&st[4], "pop") == 0);
+    ck_assert(ws_statement_append_direct(&st[4], mk_int(1)) == 0);
+    ck_assert(ws_statement_init(&st[5], "jump_unless") == 0);
+    ck_assert(ws_statement_append_indirect(&st[5], -1) == 0);
+    ck_assert(ws_statement_append_direct(&st[5], mk_int(1)) == 0);
+    ck_assert(ws_statement_init(&st[6], "jump") == 0);
+    ck_assert(ws_statement_append_direct(&st[6], mk_int(-5)) == 0);
+
+    size_t i;
+    for (i = 0; i < ARYLEN(st); ++i) {
+        ck_assert(ws_transaction_push_statement(retval, st + i) == 0);
+    }
+    return retval;
+}
+
+/**
+ * Get the int value transported by a value reply
+ */
+static intmax_t
+reply_int(
+    struct ws_reply* reply
+) {
+    ck_assert(reply);
+    ck_assert(reply->m.obj.id == &WS_OBJECT_TYPE_ID_VALUE_REPLY);
+    struct ws_value* v;
+    v = ws_value_reply_get_value((struct ws_value_reply*) reply);
+    ck_assert(v);
+    ck_assert(ws_value_get_type(v) == WS_VALUE_TYPE_INT);
+    return ws_value_int_get((struct ws_value_int*) v);
+}
+
+START_TEST (test_submit) {
+    ws_cleaner_init();
+    ck_assert(ws_command_init() == 0);
+
+    struct ws_string* context = mk_str("context");
+    ck_assert(ws_action_manager_init((struct ws_object*) context) == 0);
+
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    ck_assert(loop);
+
+    struct collected_replies collected = { .num = 0 };
+    struct ws_transaction* t[7];
+    struct ws_statement st[6];
+    size_t i;
+
+    // push 100000; sub $-1 1; store $-1 $-2; pop 1; jump_unless $-1 1;
+    // jump -5, counting down way beyond the budget of a single run
+    ck_assert(ws_statement_init(&st[0], "push") == 0);
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(100000)) == 0);
+    ck_assert(ws_statement_init(&st[1], "sub") == 0);
+    ck_assert(ws_statement_append_indirect(&st[1], -1) == 0);
+    ck_assert(ws_statement_append_direct(&st[1], mk_int(1)) == 0);
+    ck_assert(ws_statement_init(&st[2], "store") == 0);
+    ck_assert(ws_statement_append_indirect(&st[2], -1) == 0);
+    ck_assert(ws_statement_append_indirect(&st[2], -2) == 0);
+    ck_assert(ws_statement_init(&st[3], "pop") == 0);
+    ck_assert(ws_statement_append_direct(&st[3], mk_int(1)) == 0);
+    ck_assert(ws_statement_init(&st[4], "jump_unless") == 0);
+    ck_assert(ws_statement_append_indirect(&st[4], -1) == 0);
+    ck_assert(ws_statement_append_direct(&st[4], mk_int(1)) == 0);
+    ck_assert(ws_statement_init(&st[5], "jump") == 0);
+    ck_assert(ws_statement_append_direct(&st[5], mk_int(-5)) == 0);
+    t[0] = mk_statements_transaction(1, st, 6);
+
+    // a pure run is performed by the worker pool
+    ck_assert(ws_action_manager_submit(&t[0]->m, collect_reply,
+                                       &collected) == 1);
+
+    // a run which is not pure is performed right away:
+    // hastypename $0 "ws_string"
+    ck_assert(ws_statement_init(&st[0], "hastypename") == 0);
+    ck_assert(ws_statement_append_indirect(&st[0], 0) == 0);
+    struct ws_value_string* type = ws_value_string_new();
+    ck_assert(type);
+    struct ws_string* typename = mk_str("ws_string");
+    ws_value_string_set_str(type, typename);
+    ws_object_unref((struct ws_object*) typename);
+    ck_assert(ws_statement_append_direct(&st[0], &type->val) == 0);
+    t[1] = mk_statements_transaction(2, st, 1);
+
+    ck_assert(ws_action_manager_submit(&t[1]->m, collect_reply,
+                                       &collected) == 0);
+    ck_assert(collected.num == 1);
+
+    // the reply of the pure run is passed on the main loop
+    while (collected.num < 2) {
+        ev_loop(loop, EVLOOP_ONESHOT);
+    }
+    ck_assert(ws_message_get_id(&collected.replies[0]->m) == 2);
+    ck_assert(collected.replies[0]->m.obj.id == &WS_OBJECT_TYPE_ID_VALUE_REPLY);
+    ck_assert(ws_message_get_id(&collected.replies[1]->m) == 1);
+    ck_assert(reply_int(collected.replies[1]) == 0);
+
+    // endless runs, at least one per worker, don't starve the other runs
+    for (i = 2; i < 6; ++i) {
+        ck_assert(ws_statement_init(&st[0], "jump") == 0);
+        ck_assert(ws_statement_append_direct(&st[0], mk_int(-1)) == 0);
+        t[i] = mk_statements_transaction(i + 1, st, 1);
+        ck_assert(ws_action_manager_submit(&t[i]->m, collect_reply,
+                                           &collected) == 1);
+    }
+
+    // push 1; add $-1 2
+    ck_assert(ws_statement_init(&st[0], "push") == 0);
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(1)) == 0);
+    ck_assert(ws_statement_init(&st[1], "add") == 0);
+    ck_assert(ws_statement_append_indirect(&st[1], -1) == 0);
+    ck_assert(ws_statement_append_direct(&st[1], mk_int(2)) == 0);
+    t[6] = mk_statements_transaction(7, st, 2);
+    ck_assert(ws_action_manager_submit(&t[6]->m, collect_reply,
+                                       &collected) == 1);
+
+    while (collected.num < 3) {
+        ev_loop(loop, EVLOOP_ONESHOT);
+    }
+    ck_assert(ws_message_get_id(&collected.replies[2]->m) == 7);
+    ck_assert(reply_int(collected.replies[2]) == 3);
+
+    // the endless runs are aborted when the pool is shut down
+    ws_action_worker_deinit();
+    ck_assert(collected.num == 7);
+    for (i = 3; i < 7; ++i) {
+        ck_assert(!collected.replies[i]);
+    }
+
+    for (i = 0; i < 3; ++i) {
+        ws_object_unref((struct ws_object*) collected.replies[i]);
+    }
+    for (i = 0; i < 7; ++i) {
+        ws_object_unref((struct ws_object*) t[i]);
+    }
+    ws_object_unref((struct ws_object*) context);
+    ws_cleaner_run();
+}
+END_TEST
+
+START_TEST (test_submit_register_exec) {
+    ws_cleaner_init();
+    ck_assert(ws_command_init() == 0);
+
+    struct ws_string* context = mk_str("context");
+    ck_assert(ws_action_manager_init((struct ws_object*) context) == 0);
+
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    ck_assert(loop);
+
+    struct collected_replies collected = { .num = 0 };
+
+    // the transaction is registered right away, but run in the background
+    struct ws_string* name = mk_str("countdown");
+    struct ws_transaction* t[2];
+    t[0] = mk_countdown_transaction(1, name, WS_TRANSACTION_FLAGS_REGISTER |
+                                    WS_TRANSACTION_FLAGS_EXEC, 100000);
+    ck_assert(ws_action_manager_submit(&t[0]->m, collect_reply,
+                                       &collected) == 1);
+    ck_assert(collected.num == 0);
+    ck_assert(ws_action_manager_register(context, name) == 0);
+
+    while (collected.num < 1) {
+        ev_loop(loop, EVLOOP_ONESHOT);
+    }
+    ck_assert(ws_message_get_id(&collected.replies[0]->m) == 1);
+    ck_assert(reply_int(collected.replies[0]) == 0);
+
+    // code which doesn't compile is not run: jump -5
+    struct ws_statement st;
+    ck_assert(ws_statement_init(&st, "jump") == 0);
+    ck_assert(ws_statement_append_direct(&st, mk_int(-5)) == 0);
+    t[1] = mk_statements_transaction(2, &st, 1);
+    ck_assert(ws_action_manager_submit(&t[1]->m, collect_reply,
+                                       &collected) == 0);
+    ck_assert(collected.num == 2);
+    ck_assert(collected.replies[1]->m.obj.id == &WS_OBJECT_TYPE_ID_ERROR_REPLY);
+    ck_assert(ws_error_reply_get_code((struct ws_error_reply*)
+                                      collected.replies[1]) == EINVAL);
+
+    size_t i;
+    for (i = 0; i < 2; ++i) {
+        ws_object_unref((struct ws_object*) collected.replies[i]);
+        ws_object_unref((struct ws_object*) t[i]);
+    }
+    ws_object_unref((struct ws_object*) name);
+    ws_object_unref((struct ws_object*) context);
+    ws_cleaner_run();
+}
+END_TEST
+
+START_TEST (test_submit_invocation) {
+    ws_cleaner_init();
+    ck_assert(ws_command_init() == 0);
+
+    struct ws_string* context = mk_str("context");
+    ck_assert(ws_action_manager_init((struct ws_object*) context) == 0);
+
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    ck_assert(loop);
+
+    struct collected_replies collected = { .num = 0 };
+
+    struct ws_string* name = mk_str("countdown");
+    struct ws_transaction* t;
+    t = mk_countdown_transaction(1, name, WS_TRANSACTION_FLAGS_REGISTER,
+                                 100000);
+    ck_assert(!ws_action_manager_process(&t->m));
+
+    // the run keeps the invocation alive
+    struct ws_invocation* inv = ws_invocation_new(9, name);
+    ck_assert(inv);
+    ck_assert(ws_action_manager_submit(&inv->m, collect_reply,
+                                       &collected) == 1);
+    ws_object_unref((struct ws_object*) inv);
+    ck_assert(collected.num == 0);
+
+    while (collected.num < 1) {
+        ev_loop(loop, EVLOOP_ONESHOT);
+    }
+    ck_assert(ws_message_get_id(&collected.replies[0]->m) == 9);
+    ck_assert(reply_int(collected.replies[0]) == 0);
+
+    // unknown transactions are reported right away
+    struct ws_string* other = mk_str("nonexistent");
+    inv = ws_invocation_new(10, other);
+    ck_assert(inv);
+    ck_assert(ws_action_manager_submit(&inv->m, collect_reply,
+                                       &collected) == 0);
+    ck_assert(collected.num == 2);
+    ck_assert(collected.replies[1]->m.obj.id == &WS_OBJECT_TYPE_ID_ERROR_REPLY);
+    ck_assert(ws_message_get_id(&collected.replies[1]->m) == 10);
+    ck_assert(ws_error_reply_get_code((struct ws_error_reply*)
+                                      collected.replies[1]) == ENOENT);
+    ws_object_unref((struct ws_object*) inv);
+
+    size_t i;
+    for (i = 0; i < 2; ++i) {
+        ws_object_unref((struct ws_object*) collected.replies[i]);
+    }
+    ws_object_unref((struct ws_object*) other);
+    ws_object_unref((struct ws_object*) t);
+    ws_object_unref((struct ws_object*) name);
+    ws_object_unref((struct ws_object*) context);
+    ws_cleaner_run();
+}
+END_TEST
+
+START_TEST (test_submit_batch) {
+    ws_cleaner_init();
+    ck_assert(ws_command_init() == 0);
+
+    struct ws_string* context = mk_str("context");
+    ck_assert(ws_action_manager_init((struct ws_object*) context) == 0);
+
+    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
+    ck_assert(loop);
+
+    struct collected_replies collected = { .num = 0 };
+
+    // the second transaction waits for the first one to complete
+    struct ws_batch* batch = ws_batch_new(42);
+    ck_assert(batch);
+    struct ws_transaction* t[2] = {
+        mk_countdown_transaction(1, NULL, WS_TRANSACTION_FLAGS_EXEC, 100000),
+        mk_exec_transaction(2, "add", 1, 2),
+    };
+    size_t i;
+    for (i = 0; i < 2; ++i) {
+        ck_assert(ws_batch_append(batch, t[i]) == 0);
+        ws_object_unref((struct ws_object*) t[i]);
+    }
+
+    ck_assert(ws_action_manager_submit(&batch->m, collect_reply,
+                                       &collected) == 1);
+    ck_assert(collected.num == 0);
+
+    while (collected.num < 1) {
+        ev_loop(loop, EVLOOP_ONESHOT);
+    }
+    struct ws_reply* reply = collected.replies[0];
+    ck_assert(reply);
+    ck_assert(reply->m.obj.id == &WS_OBJECT_TYPE_ID_BATCH_REPLY);
+    ck_assert(ws_message_get_id(&reply->m) == 42);
+
+    struct ws_batch_reply* br = (struct ws_batch_reply*) reply;
+    ck_assert(ws_batch_reply_len(br) == 2);
+    ck_assert(ws_message_get_id(&ws_batch_reply_get(br, 0)->m) == 1);
+    ck_assert(reply_int(ws_batch_reply_get(br, 0)) == 0);
+    ck_assert(ws_message_get_id(&ws_batch_reply_get(br, 1)->m) == 2);
+    ck_assert(reply_int(ws_batch_reply_get(br, 1)) == 3);
+
+    ws_object_unref((struct ws_object*) reply);
+    ws_object_unref((struct ws_object*) batch);
+    ws_object_unref((struct ws_object*) context);
+    ws_cleaner_run();
+}
+END_TEST
+
 static Suite*
 actionmanager_suite(void)
 {
@@ -49,7 +1239,24 @@ actionmanager_suite(void)
     suite_add_tcase(s, tc);
     // tcase_add_checked_fixture(tc, setup, cleanup); // Not used yet
 
-    //tcase_add_tests(tc, ...);
+    tcase_add_test(tc, test_batch);
+    tcase_add_test(tc, test_dispatch_table);
+    tcase_add_test(tc, test_dispatch_table_many);
+    tcase_add_test(tc, test_invocation);
+    tcase_add_test(tc, test_submit);
+    tcase_add_test(tc, test_submit_register_exec);
+    tcase_add_test(tc, test_submit_invocation);
+    tcase_add_test(tc, test_submit_batch);
+    tcase_add_test(tc, test_processor_exec);
+    tcase_add_test(tc, test_processor_budget);
+    tcase_add_test(tc, test_processor_branches);
+    tcase_add_test(tc, test_processor_foreach);
+    tcase_add_test(tc, test_profiler);
+    tcase_add_test(tc, test_stack_pool_reuse);
+    tcase_add_test(tc, test_stack_pool_trim);
+    tcase_add_test(tc, test_stack_pool_nesting);
+    tcase_add_test(tc, test_timers);
+    tcase_add_test(tc, test_observers);
 
     return s;
 }
@@ -38,8 +38,530 @@
  */
 
 #include <check.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include "tests.h"
 
+#include "command/bytecode.h"
+#include "command/command.h"
+#include "command/statement.h"
+#include "objects/object.h"
+#include "objects/string.h"
+#include "values/array.h"
+#include "values/int.h"
+#include "values/object_id.h"
+#include "values/string.h"
+#include "values/union.h"
+#include "values/value_type.h"
+
+/**
+ * Object with an attribute for testing bulk attribute reads
+ */
+struct attr_object {
+    struct ws_object obj; //!< object
+    int32_t val; //!< the attribute
+};
+
+/**
+ * Attributes of the attribute test object
+ */
+static struct ws_object_attribute const ATTR_OBJECT_ATTRS[] = {
+    {
+        .name = "val",
+        .offset_in_struct = offsetof(struct attr_object, val),
+        .type = WS_OBJ_ATTR_TYPE_INT32,
+    },
+    {
+        .name = NULL,
+        .offset_in_struct = 0,
+        .type = 0,
+    },
+};
+
+/**
+ * Type of the attribute test object
+ */
+static ws_object_type_id ATTR_OBJECT_ID = {
+    .supertype  = &WS_OBJECT_TYPE_ID_OBJECT,
+    .typestr    = "attr_object",
+    .attribute_table = ATTR_OBJECT_ATTRS,
+};
+
+/**
+ * Allocate an int value
+ */
+static struct ws_value*
+mk_int(
+    intmax_t val
+) {
+    struct ws_value_int* v = calloc(1, sizeof(*v));
+    ck_assert(v);
+
+    ws_value_int_init(v);
+    ws_value_int_set(v, val);
+    return &v->value;
+}
+
+/**
+ * Get the int pushed by a constant instruction
+ */
+static intmax_t
+const_int(
+    struct ws_bytecode_insn const* insn
+) {
+    ck_assert(insn->op == WS_BYTECODE_OP_CONST);
+    ck_assert(ws_value_get_type(insn->arg.value) == WS_VALUE_TYPE_INT);
+    return ws_value_int_get((struct ws_value_int*) insn->arg.value);
+}
+
+/**
+ * Set an argument to an int value
+ */
+static void
+set_int(
+    union ws_value_union* arg,
+    intmax_t val
+) {
+    ck_assert(ws_value_union_reinit(arg, WS_VALUE_TYPE_INT) == 0);
+    ws_value_int_set(&arg->int_, val);
+}
+
+/**
+ * Set an argument to an array value
+ */
+static void
+set_array(
+    union ws_value_union* arg,
+    intmax_t const* elems,
+    size_t len
+) {
+    ck_assert(ws_value_union_reinit(arg, WS_VALUE_TYPE_ARRAY) == 0);
+    ck_assert(ws_value_array_resize(&arg->array, len) == 0);
+    if (len) {
+        memcpy(ws_value_array_elems_mut(&arg->array), elems,
+               len * sizeof(*elems));
+    }
+}
+
+/**
+ * Check whether an argument is an array holding the expected elements
+ */
+static void
+check_array(
+    union ws_value_union* arg,
+    intmax_t const* elems,
+    size_t len
+) {
+    ck_assert(ws_value_get_type(&arg->value) == WS_VALUE_TYPE_ARRAY);
+    ck_assert(ws_value_array_len(&arg->array) == len);
+
+    size_t i;
+    for (i = 0; i < len; ++i) {
+        ck_assert(ws_value_array_get(&arg->array, i) == elems[i]);
+    }
+}
+
+/**
+ * Deinitialize arguments, leaving "none" values
+ */
+static void
+clear_args(
+    union ws_value_union* args,
+    size_t num
+) {
+    size_t i;
+    for (i = 0; i < num; ++i) {
+        ws_value_deinit(&args[i].value);
+    }
+    memset(args, 0, num * sizeof(*args));
+}
+
+/**
+ * Run a regular command by name
+ *
+ * @return the result of the command
+ */
+static int
+run_cmd(
+    char const* name,
+    union ws_value_union* args
+) {
+    struct ws_command const* cmd = ws_command_get(name);
+    ck_assert(cmd);
+    ck_assert(cmd->command_type == regular);
+    return cmd->func.regular(args);
+}
+
+START_TEST (test_array_create) {
+    union ws_value_union args[4];
+    memset(args, 0, sizeof(args));
+
+    set_int(args, 1);
+    set_int(args + 1, -2);
+    set_int(args + 2, 3);
+    ck_assert(run_cmd("array", args) == 0);
+    check_array(args, (intmax_t[]) {1, -2, 3}, 3);
+    clear_args(args, 4);
+
+    // no arguments result in an empty array
+    ck_assert(run_cmd("array", args) == 0);
+    check_array(args, NULL, 0);
+    clear_args(args, 4);
+
+    // arrays only hold ints
+    set_int(args, 1);
+    ck_assert(ws_value_union_reinit(args + 1, WS_VALUE_TYPE_NIL) == 0);
+    ck_assert(run_cmd("array", args) == -EINVAL);
+    clear_args(args, 4);
+}
+END_TEST
+
+START_TEST (test_array_at_length) {
+    intmax_t const elems[] = {4, 5, 6};
+    union ws_value_union args[4];
+    memset(args, 0, sizeof(args));
+
+    set_array(args, elems, 3);
+    set_int(args + 1, 2);
+    ck_assert(run_cmd("at", args) == 0);
+    ck_assert(ws_value_get_type(&args->value) == WS_VALUE_TYPE_INT);
+    ck_assert(ws_value_int_get(&args->int_) == 6);
+    clear_args(args, 4);
+
+    // indices out of the bounds
+    set_array(args, elems, 3);
+    set_int(args + 1, 3);
+    ck_assert(run_cmd("at", args) == -ERANGE);
+    set_int(args + 1, -1);
+    ck_assert(run_cmd("at", args) == -ERANGE);
+    clear_args(args, 4);
+
+    set_array(args, NULL, 0);
+    set_int(args + 1, 0);
+    ck_assert(run_cmd("at", args) == -ERANGE);
+    clear_args(args, 4);
+
+    set_array(args, elems, 3);
+    set_int(args + 1, 0);
+    set_int(args + 2, 0);
+    ck_assert(run_cmd("at", args) == -E2BIG);
+    clear_args(args, 4);
+
+    set_int(args, 0);
+    set_int(args + 1, 0);
+    ck_assert(run_cmd("at", args) == -EINVAL);
+    clear_args(args, 4);
+
+    set_array(args, elems, 3);
+    ck_assert(run_cmd("length", args) == 0);
+    ck_assert(ws_value_get_type(&args->value) == WS_VALUE_TYPE_INT);
+    ck_assert(ws_value_int_get(&args->int_) == 3);
+    clear_args(args, 4);
+
+    set_array(args, NULL, 0);
+    ck_assert(run_cmd("length", args) == 0);
+    ck_assert(ws_value_int_get(&args->int_) == 0);
+    clear_args(args, 4);
+
+    set_array(args, elems, 3);
+    set_int(args + 1, 0);
+    ck_assert(run_cmd("length", args) == -E2BIG);
+    clear_args(args, 4);
+
+    set_int(args, 3);
+    ck_assert(run_cmd("length", args) == -EINVAL);
+    clear_args(args, 4);
+}
+END_TEST
+
+START_TEST (test_array_range) {
+    union ws_value_union args[4];
+    memset(args, 0, sizeof(args));
+
+    set_int(args, 3);
+    ck_assert(run_cmd("range", args) == 0);
+    check_array(args, (intmax_t[]) {0, 1, 2}, 3);
+    clear_args(args, 4);
+
+    set_int(args, -1);
+    set_int(args + 1, 2);
+    ck_assert(run_cmd("range", args) == 0);
+    check_array(args, (intmax_t[]) {-1, 0, 1}, 3);
+    clear_args(args, 4);
+
+    // empty ranges
+    set_int(args, 5);
+    set_int(args + 1, 2);
+    ck_assert(run_cmd("range", args) == 0);
+    check_array(args, NULL, 0);
+    clear_args(args, 4);
+
+    set_int(args, -3);
+    ck_assert(run_cmd("range", args) == 0);
+    check_array(args, NULL, 0);
+    clear_args(args, 4);
+
+    // arguments
+    ck_assert(run_cmd("range", args) == -EINVAL);
+    set_int(args, 1);
+    set_int(args + 1, 2);
+    set_int(args + 2, 3);
+    ck_assert(run_cmd("range", args) == -E2BIG);
+    clear_args(args, 4);
+
+    // ranges which would need too much memory
+    set_int(args, 0);
+    set_int(args + 1, INTMAX_C(1) << 61);
+    ck_assert(run_cmd("range", args) == -E2BIG);
+    clear_args(args, 4);
+
+    set_int(args, INTMAX_MIN);
+    set_int(args + 1, INTMAX_MAX);
+    ck_assert(run_cmd("range", args) == -E2BIG);
+    clear_args(args, 4);
+}
+END_TEST
+
+START_TEST (test_array_arithmetic) {
+    union ws_value_union args[5];
+    memset(args, 0, sizeof(args));
+
+    set_array(args, (intmax_t[]) {1, 2}, 2);
+    set_array(args + 1, (intmax_t[]) {3, 4}, 2);
+    set_int(args + 2, 1);
+    ck_assert(run_cmd("add", args) == 0);
+    check_array(args, (intmax_t[]) {5, 7}, 2);
+    clear_args(args, 5);
+
+    // ints are applied to each element, also as the first argument
+    set_int(args, 10);
+    set_array(args + 1, (intmax_t[]) {1, 2}, 2);
+    ck_assert(run_cmd("sub", args) == 0);
+    check_array(args, (intmax_t[]) {9, 8}, 2);
+    clear_args(args, 5);
+
+    set_array(args, (intmax_t[]) {2, 3}, 2);
+    set_int(args + 1, 2);
+    set_array(args + 2, (intmax_t[]) {-1, 0}, 2);
+    ck_assert(run_cmd("mul", args) == 0);
+    check_array(args, (intmax_t[]) {-4, 0}, 2);
+    clear_args(args, 5);
+
+    set_array(args, (intmax_t[]) {7, -9}, 2);
+    set_int(args + 1, 2);
+    ck_assert(run_cmd("div", args) == 0);
+    check_array(args, (intmax_t[]) {3, -4}, 2);
+    clear_args(args, 5);
+
+    set_array(args, NULL, 0);
+    set_int(args + 1, 2);
+    ck_assert(run_cmd("add", args) == 0);
+    check_array(args, NULL, 0);
+    clear_args(args, 5);
+
+    // arrays of different lengths
+    set_array(args, (intmax_t[]) {1, 2}, 2);
+    set_array(args + 1, (intmax_t[]) {1}, 1);
+    ck_assert(run_cmd("add", args) == -EINVAL);
+    clear_args(args, 5);
+
+    // division errors
+    set_array(args, (intmax_t[]) {1, 2}, 2);
+    set_array(args + 1, (intmax_t[]) {1, 0}, 2);
+    ck_assert(run_cmd("div", args) == -EFAULT);
+    set_int(args + 1, 0);
+    ck_assert(run_cmd("div", args) == -EFAULT);
+    clear_args(args, 5);
+
+    set_array(args, (intmax_t[]) {1, INTMAX_MIN}, 2);
+    set_int(args + 1, -1);
+    ck_assert(run_cmd("div", args) == -ERANGE);
+    clear_args(args, 5);
+
+    set_array(args, (intmax_t[]) {1, 2}, 2);
+    set_int(args + 1, 1);
+    set_int(args + 2, 1);
+    ck_assert(run_cmd("div", args) == -E2BIG);
+    clear_args(args, 5);
+}
+END_TEST
+
+START_TEST (test_array_div_single) {
+    // exactly sized, so reads past the terminator would be detected
+    union ws_value_union* args = calloc(2, sizeof(*args));
+    ck_assert(args);
+
+    set_array(args, (intmax_t[]) {1, 2}, 2);
+    ck_assert(run_cmd("div", args) == -EINVAL);
+    clear_args(args, 2);
+
+    ck_assert(run_cmd("div", args + 1) == -EINVAL);
+
+    free(args);
+}
+END_TEST
+
+START_TEST (test_read_attrs) {
+    struct attr_object* obj = calloc(1, sizeof(*obj));
+    ck_assert(obj);
+    ck_assert(ws_object_init(&obj->obj));
+    ws_object_set_type(&obj->obj, &ATTR_OBJECT_ID);
+    obj->obj.settings |= WS_OBJECT_HEAPALLOCED;
+    obj->val = -7;
+
+    struct ws_string* name = ws_string_new();
+    ck_assert(name);
+    ck_assert(ws_string_set_from_raw(name, "val") == 0);
+
+    // more attributes than would comfortably fit on the stack
+    static size_t const num = 1000;
+    union ws_value_union* args = calloc(num + 2, sizeof(*args));
+    ck_assert(args);
+    ck_assert(ws_value_union_reinit(args, WS_VALUE_TYPE_OBJECT_ID) == 0);
+    ws_value_object_id_set(&args->object_id, &obj->obj);
+    size_t i;
+    for (i = 1; i <= num; ++i) {
+        ck_assert(ws_value_union_reinit(args + i, WS_VALUE_TYPE_STRING) == 0);
+        ws_value_string_set_str(&args[i].string, name);
+    }
+
+    ck_assert(run_cmd("read_attrs", args) == 0);
+    ck_assert(ws_value_get_type(&args->value) == WS_VALUE_TYPE_ARRAY);
+    ck_assert(ws_value_array_len(&args->array) == num + 1);
+
+    // the uuid is stored bit for bit, even if it exceeds INTMAX_MAX
+    intmax_t uuid = ws_value_array_get(&args->array, 0);
+    ck_assert((uintmax_t) uuid == ws_object_uuid(&obj->obj));
+    for (i = 1; i <= num; ++i) {
+        ck_assert(ws_value_array_get(&args->array, i) == -7);
+    }
+    clear_args(args, num + 2);
+
+    // unknown attributes make the command fail
+    ck_assert(ws_string_set_from_raw(name, "nope") == 0);
+    ck_assert(ws_value_union_reinit(args, WS_VALUE_TYPE_OBJECT_ID) == 0);
+    ws_value_object_id_set(&args->object_id, &obj->obj);
+    ck_assert(ws_value_union_reinit(args + 1, WS_VALUE_TYPE_STRING) == 0);
+    ws_value_string_set_str(&args[1].string, name);
+    ck_assert(run_cmd("read_attrs", args) < 0);
+    clear_args(args, num + 2);
+
+    free(args);
+    ws_object_unref(&name->obj);
+    ws_object_unref(&obj->obj);
+}
+END_TEST
+
+START_TEST (test_bytecode_fold) {
+    struct ws_statement st[2];
+
+    // add 1 2; mul $-1 5
+    ck_assert(ws_statement_init(&st[0], "add") == 0);
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(1)) == 0);
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(2)) == 0);
+    ck_assert(ws_statement_init(&st[1], "mul") == 0);
+    ck_assert(ws_statement_append_indirect(&st[1], -1) == 0);
+    ck_assert(ws_statement_append_direct(&st[1], mk_int(5)) == 0);
+
+    struct ws_bytecode* code = ws_bytecode_compile(st, 2);
+    ck_assert(code);
+    ck_assert(code->num == 2);
+    ck_assert(const_int(code->code) == 3);
+    ck_assert(const_int(code->code + 1) == 15);
+    ck_assert(code->code[2].op == WS_BYTECODE_OP_END);
+    ck_assert(code->stack_size == 2);
+    ck_assert(code->pure);
+
+    ws_bytecode_free(code);
+    ws_statement_deinit(&st[0]);
+    ws_statement_deinit(&st[1]);
+}
+END_TEST
+
+START_TEST (test_bytecode_no_fold_on_error) {
+    struct ws_statement st;
+
+    // div 4 0
+    ck_assert(ws_statement_init(&st, "div") == 0);
+    ck_assert(ws_statement_append_direct(&st, mk_int(4)) == 0);
+    ck_assert(ws_statement_append_direct(&st, mk_int(0)) == 0);
+
+    struct ws_bytecode* code = ws_bytecode_compile(&st, 1);
+    ck_assert(code);
+    ck_assert(code->num == 1);
+    ck_assert(code->code[0].op == WS_BYTECODE_OP_REGULAR);
+
+    ws_bytecode_free(code);
+    ws_statement_deinit(&st);
+}
+END_TEST
+
+START_TEST (test_bytecode_dead_code) {
+    // the processor's jump command is not available here
+    struct ws_command jump = {
+        .name = "jump",
+        .command_type = special,
+    };
+    struct ws_statement st[3];
+
+    // jump 1; add 1 1; sub 3 1
+    st[0].command = &jump;
+    st[0].args.num = 0;
+    st[0].args.vals = NULL;
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(1)) == 0);
+    ck_assert(ws_statement_init(&st[1], "add") == 0);
+    ck_assert(ws_statement_append_direct(&st[1], mk_int(1)) == 0);
+    ck_assert(ws_statement_append_direct(&st[1], mk_int(1)) == 0);
+    ck_assert(ws_statement_init(&st[2], "sub") == 0);
+    ck_assert(ws_statement_append_direct(&st[2], mk_int(3)) == 0);
+    ck_assert(ws_statement_append_direct(&st[2], mk_int(1)) == 0);
+
+    struct ws_bytecode* code = ws_bytecode_compile(st, 3);
+    ck_assert(code);
+    ck_assert(code->num == 2);
+    ck_assert(code->code[0].op == WS_BYTECODE_OP_JUMP);
+    ck_assert(code->code[0].arg.target == 1);
+    ck_assert(const_int(code->code + 1) == 2);
+    ck_assert(code->stmt_map[1] == 1);
+    ck_assert(code->stmt_map[2] == 1);
+    ck_assert(code->stmt_map[3] == 2);
+    ck_assert(code->stack_size == 1);
+
+    ws_bytecode_free(code);
+    size_t i;
+    for (i = 0; i < 3; ++i) {
+        ws_statement_deinit(&st[i]);
+    }
+}
+END_TEST
+
+START_TEST (test_bytecode_invalid_jump) {
+    struct ws_command jump = {
+        .name = "jump",
+        .command_type = special,
+    };
+    struct ws_statement st[2];
+
+    // add 1 1; jump -3
+    ck_assert(ws_statement_init(&st[0], "add") == 0);
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(1)) == 0);
+    ck_assert(ws_statement_append_direct(&st[0], mk_int(1)) == 0);
+    st[1].command = &jump;
+    st[1].args.num = 0;
+    st[1].args.vals = NULL;
+    ck_assert(ws_statement_append_direct(&st[1], mk_int(-3)) == 0);
+
+    // the jump would lead before the first statement
+    ck_assert(!ws_bytecode_compile(st, 2));
+
+    ws_statement_deinit(&st[0]);
+    ws_statement_deinit(&st[1]);
+}
+END_TEST
+
 static Suite*
 commandprocessor_suite(void)
 {
@@ -49,7 +571,16 @@ commandprocessor_suite(void)
     suite_add_tcase(s, tc);
     // tcase_add_checked_fixture(tc, setup, cleanup); // Not used yet
 
-    //tcase_add_tests(tc, ...);
+    tcase_add_test(tc, test_array_create);
+    tcase_add_test(tc, test_array_at_length);
+    tcase_add_test(tc, test_array_range);
+    tcase_add_test(tc, test_array_arithmetic);
+    tcase_add_test(tc, test_array_div_single);
+    tcase_add_test(tc, test_read_attrs);
+    tcase_add_test(tc, test_bytecode_fold);
+    tcase_add_test(tc, test_bytecode_no_fold_on_error);
+    tcase_add_test(tc, test_bytecode_dead_code);
+    tcase_add_test(tc, test_bytecode_invalid_jump);
 
     return s;
 }
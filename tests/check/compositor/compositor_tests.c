@@ -37,9 +37,137 @@
  * @{
  */
 
+#define _GNU_SOURCE
+
 #include <check.h>
+#include <stdlib.h>
 #include "tests.h"
 
+// the snapshot is tested from the inside, without a socket and main loop
+#include "compositor/snapshot.c"
+
+/**
+ * Hash a monitor by its id
+ */
+static size_t
+test_monitor_hash(
+    struct ws_object* obj
+) {
+    return ((struct ws_monitor*) obj)->id;
+}
+
+/**
+ * Monitor type without any device behind it
+ */
+static ws_object_type_id TEST_MONITOR_ID = {
+    .supertype  = &WS_OBJECT_TYPE_ID_OBJECT,
+    .typestr    = "test_monitor",
+    .hash_callback = test_monitor_hash,
+};
+
+/**
+ * Create a monitor without any device behind it
+ */
+static struct ws_monitor*
+mk_monitor(
+    int id,
+    bool connected,
+    struct ws_monitor_mode* mode
+) {
+    struct ws_monitor* mon = calloc(1, sizeof(*mon));
+    ck_assert(mon);
+    ck_assert(ws_object_init(&mon->obj));
+    ws_object_set_type(&mon->obj, &TEST_MONITOR_ID);
+    mon->obj.settings |= WS_OBJECT_HEAPALLOCED;
+
+    mon->id = id;
+    mon->connected = connected;
+    mon->current_mode = mode;
+    mon->phys_width = 520;
+    mon->phys_height = 290;
+    return mon;
+}
+
+START_TEST (test_snapshot) {
+    ck_assert(create_shared_memory() == 0);
+    struct ws_snapshot const* shared = snapshot_ctx.shared;
+    ck_assert(shared->magic == WS_SNAPSHOT_MAGIC);
+    ck_assert(shared->version == WS_SNAPSHOT_VERSION);
+
+    ck_assert(ws_set_init(&ws_comp_ctx.monitors) == 0);
+    ws_comp_ctx.keyboard = NULL;
+    ws_comp_ctx.cursor = NULL;
+
+    // the empty state matches the initial contents
+    struct ws_snapshot_state state;
+    write_snapshot();
+    uint32_t seq = ws_snapshot_read(shared, &state);
+    ck_assert(seq == 0);
+    ck_assert(state.num_monitors == 0);
+    ck_assert(state.keyboard_focus.uuid == 0);
+
+    struct ws_monitor_mode mode;
+    memset(&mode, 0, sizeof(mode));
+    mode.mode.hdisplay = 1920;
+    mode.mode.vdisplay = 1080;
+    mode.mode.vrefresh = 60;
+
+    // only connected monitors are published
+    struct ws_monitor* mon = mk_monitor(3, true, &mode);
+    struct ws_monitor* off = mk_monitor(4, false, &mode);
+    ck_assert(ws_set_insert(&ws_comp_ctx.monitors, &mon->obj) == 0);
+    ck_assert(ws_set_insert(&ws_comp_ctx.monitors, &off->obj) == 0);
+    ws_object_unref(&mon->obj);
+    ws_object_unref(&off->obj);
+
+    struct ws_surface* surface = calloc(1, sizeof(*surface));
+    ck_assert(surface);
+    ck_assert(ws_object_init(&surface->wl_obj.obj));
+    surface->wl_obj.obj.settings |= WS_OBJECT_HEAPALLOCED;
+    surface->x = 10;
+    surface->y = -20;
+    surface->width = 640;
+    surface->height = 480;
+
+    struct ws_keyboard keyboard;
+    memset(&keyboard, 0, sizeof(keyboard));
+    keyboard.active_surface = surface;
+    ws_comp_ctx.keyboard = &keyboard;
+
+    write_snapshot();
+    ck_assert(ws_snapshot_read(shared, &state) == seq + 2);
+
+    ck_assert(state.keyboard_focus.uuid ==
+              ws_object_uuid(&surface->wl_obj.obj));
+    ck_assert(state.keyboard_focus.x == 10);
+    ck_assert(state.keyboard_focus.y == -20);
+    ck_assert(state.keyboard_focus.width == 640);
+    ck_assert(state.keyboard_focus.height == 480);
+    ck_assert(state.pointer_focus.uuid == 0);
+
+    ck_assert(state.num_monitors == 1);
+    ck_assert(state.monitors[0].id == 3);
+    ck_assert(state.monitors[0].width == 1920);
+    ck_assert(state.monitors[0].height == 1080);
+    ck_assert(state.monitors[0].refresh == 60);
+    ck_assert(state.monitors[0].phys_width == 520);
+    ck_assert(state.monitors[0].phys_height == 290);
+
+    // writing the same state again doesn't bump the sequence number
+    write_snapshot();
+    ck_assert(ws_snapshot_read(shared, &state) == seq + 2);
+
+    ws_comp_ctx.keyboard = NULL;
+    ws_object_deinit((struct ws_object*) &ws_comp_ctx.monitors);
+    ws_object_unref(&surface->wl_obj.obj);
+
+    munmap(snapshot_ctx.shared, sizeof(*snapshot_ctx.shared));
+    close(snapshot_ctx.fd);
+    snapshot_ctx.shared = NULL;
+    snapshot_ctx.fd = -1;
+}
+END_TEST
+
 static Suite*
 compositor_suite(void)
 {
@@ -49,7 +177,7 @@ compositor_suite(void)
     suite_add_tcase(s, tc);
     // tcase_add_checked_fixture(tc, setup, cleanup); // Not used yet
 
-    //tcase_add_tests(tc, ...);
+    tcase_add_test(tc, test_snapshot);
 
     return s;
 }
@@ -25,6 +25,7 @@
  * along with waysome. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <errno.h>
 #include <check.h>
 #include <stdlib.h>
 
@@ -93,7 +94,7 @@ static struct ws_test_object* ws_test_object_new(void)
     if (t) {
         ws_object_init(&t->obj);
 
-        t->obj.id = &WS_OBJECT_TYPE_ID_TESTOBJ;
+        ws_object_set_type(&t->obj, &WS_OBJECT_TYPE_ID_TESTOBJ);
         t->obj.settings |= WS_OBJECT_HEAPALLOCED;
 
         t->int_attribute        = TEST_INT;
@@ -173,3 +174,40 @@ START_TEST (test_object_attribute_read) {
     ws_object_unref(&to->obj);
 }
 END_TEST
+
+START_TEST (test_object_attribute_read_ints) {
+    struct ws_test_object* to = ws_test_object_new();
+    if (!to) { // If we fail to alloc, fail here
+        ck_assert(0 != 0);
+    }
+
+    char const* idents[] = { "char", "int" };
+    struct ws_object_attribute const* attrs[2];
+    intmax_t vals[2] = { 0, 0 };
+    int r = 0;
+
+    r = ws_object_type_resolve_attrs(&WS_OBJECT_TYPE_ID_TESTOBJ, idents, 2,
+                                     attrs);
+    ck_assert(r == 0);
+
+    r = ws_object_attr_read_ints(&to->obj, attrs, 2, vals);
+    ck_assert(r == 0);
+    ck_assert(vals[0] == TEST_CHR);
+    ck_assert(vals[1] == TEST_INT);
+
+    // non-integral attributes can't be read in bulk
+    idents[1] = "string";
+    r = ws_object_type_resolve_attrs(&WS_OBJECT_TYPE_ID_TESTOBJ, idents, 2,
+                                     attrs);
+    ck_assert(r == 0);
+    r = ws_object_attr_read_ints(&to->obj, attrs, 2, vals);
+    ck_assert(r == -EINVAL);
+
+    idents[1] = "nonexistent";
+    r = ws_object_type_resolve_attrs(&WS_OBJECT_TYPE_ID_TESTOBJ, idents, 2,
+                                     attrs);
+    ck_assert(r == -ECANCELED);
+
+    ws_object_unref(&to->obj);
+}
+END_TEST
@@ -44,7 +44,10 @@
 #include "tests.h"
 #include "objects/ws_object/attribute_test.c"
 
+#include "objects/deferred.h"
 #include "objects/object.h"
+#include "objects/registry.h"
+#include "objects/stats.h"
 
 START_TEST (test_object_init) {
     struct ws_object o;
@@ -183,6 +186,161 @@ START_TEST (test_object_uuid) {
 }
 END_TEST
 
+START_TEST (test_object_uuid_unique) {
+    static const size_t num = 1000;
+    struct ws_object* objs[num];
+    uintmax_t ids[num];
+
+    for (size_t i = 0; i < num; ++i) {
+        objs[i] = ws_object_new(sizeof(struct ws_object));
+        ck_assert(objs[i]);
+        ids[i] = ws_object_uuid(objs[i]);
+        ck_assert(ids[i] != 0);
+
+        for (size_t j = 0; j < i; ++j) {
+            ck_assert(ids[i] != ids[j]);
+        }
+    }
+
+    for (size_t i = 0; i < num; ++i) {
+        ws_object_unref(objs[i]);
+    }
+}
+END_TEST
+
+START_TEST (test_object_registry) {
+    struct ws_object* o = ws_object_new(sizeof(*o));
+    ck_assert(o);
+
+    uintmax_t id = ws_object_uuid(o);
+
+    struct ws_object* found = ws_object_registry_get(id);
+    ck_assert(found == o);
+    ws_object_unref(found);
+
+    ck_assert(ws_object_registry_get(id + 1) == NULL);
+    ck_assert(ws_object_registry_get(0) == NULL);
+
+    ws_object_unref(o);
+
+    // the object is gone, so the uuid must not resolve any more
+    ck_assert(ws_object_registry_get(id) == NULL);
+}
+END_TEST
+
+START_TEST (test_object_registry_many) {
+    static const size_t num = 1000;
+    struct ws_object* objs[num];
+    uintmax_t ids[num];
+
+    for (size_t i = 0; i < num; ++i) {
+        objs[i] = ws_object_new(sizeof(struct ws_object));
+        ck_assert(objs[i]);
+        ids[i] = ws_object_uuid(objs[i]);
+    }
+
+    // remove every second object
+    for (size_t i = 0; i < num; i += 2) {
+        ws_object_unref(objs[i]);
+    }
+
+    for (size_t i = 0; i < num; ++i) {
+        struct ws_object* found = ws_object_registry_get(ids[i]);
+        if (i % 2) {
+            ck_assert(found == objs[i]);
+            ws_object_unref(found);
+        } else {
+            ck_assert(found == NULL);
+        }
+    }
+
+    for (size_t i = 1; i < num; i += 2) {
+        ws_object_unref(objs[i]);
+    }
+}
+END_TEST
+
+/**
+ * Type for testing the per-type counters
+ */
+static ws_object_type_id WS_OBJECT_TYPE_ID_STATS_TEST = {
+    .supertype  = &WS_OBJECT_TYPE_ID_OBJECT,
+    .typestr    = "ws_stats_test",
+};
+
+/**
+ * Get the counters of a type
+ *
+ * @return true if the type was found, else false
+ */
+static bool
+get_type_stats(
+    ws_object_type_id* type,
+    struct ws_object_type_stats* dest
+) {
+    size_t num = ws_object_stats_snapshot(NULL, 0);
+    struct ws_object_type_stats stats[num + 1];
+    num = ws_object_stats_snapshot(stats, num);
+
+    for (size_t i = 0; i < num; ++i) {
+        if (stats[i].type == type) {
+            *dest = stats[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+START_TEST (test_object_stats) {
+    struct ws_object_type_stats before;
+    struct ws_object_type_stats stats;
+    ck_assert(get_type_stats(&WS_OBJECT_TYPE_ID_OBJECT, &before));
+
+    struct ws_object o;
+    memset(&o, 0, sizeof(o));
+    ck_assert(ws_object_init(&o));
+    ws_object_set_type(&o, &WS_OBJECT_TYPE_ID_STATS_TEST);
+
+    // the object was allocated as both types, but is live as the new one
+    ck_assert(get_type_stats(&WS_OBJECT_TYPE_ID_OBJECT, &stats));
+    ck_assert(stats.allocs == before.allocs + 1);
+    ck_assert(stats.live == before.live);
+    ck_assert(get_type_stats(&WS_OBJECT_TYPE_ID_STATS_TEST, &stats));
+    ck_assert(stats.allocs == 1);
+    ck_assert(stats.live == 1);
+    ck_assert(stats.deinits == 0);
+
+    ws_object_deinit(&o);
+
+    ck_assert(get_type_stats(&WS_OBJECT_TYPE_ID_STATS_TEST, &stats));
+    ck_assert(stats.allocs == 1);
+    ck_assert(stats.live == 0);
+    ck_assert(stats.deinits == 1);
+
+    // the counters of the base type are not touched by the deinitialization
+    ck_assert(get_type_stats(&WS_OBJECT_TYPE_ID_OBJECT, &stats));
+    ck_assert(stats.allocs == before.allocs + 1);
+    ck_assert(stats.deinits == before.deinits);
+}
+END_TEST
+
+START_TEST (test_object_deferred) {
+    ck_assert(0 == ws_object_deferred_init());
+
+    struct ws_object* o = ws_object_new(sizeof(*o));
+    ck_assert(o);
+    uintmax_t id = ws_object_uuid(o);
+
+    ws_object_unref(o);
+
+    // the object is queued, but may not be resolved any more
+    ck_assert(ws_object_registry_get(id) == NULL);
+
+    ck_assert(1 == ws_object_deferred_run(-1));
+    ck_assert(0 == ws_object_deferred_run(-1));
+}
+END_TEST
+
 static Suite*
 objects_suite(void)
 {
@@ -208,9 +366,15 @@ objects_suite(void)
     tcase_add_test(tc, test_object_lock_try_write);
     tcase_add_test(tc, test_object_cmp);
     tcase_add_test(tc, test_object_uuid);
+    tcase_add_test(tc, test_object_uuid_unique);
+    tcase_add_test(tc, test_object_registry);
+    tcase_add_test(tc, test_object_registry_many);
+    tcase_add_test(tc, test_object_stats);
+    tcase_add_test(tc, test_object_deferred);
 
     tcase_add_test(tca, test_object_attribute_type);
     tcase_add_test(tca, test_object_attribute_read);
+    tcase_add_test(tca, test_object_attribute_read_ints);
 
     return s;
 }
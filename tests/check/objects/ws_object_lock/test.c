@@ -0,0 +1,261 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup tests "Testing"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup tests_objects "Testing: Object locking"
+ *
+ * @{
+ */
+
+#include <check.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "tests.h"
+#include "objects/object.h"
+#include "objects/string.h"
+
+/**
+ * Number of threads to start per direction
+ */
+#define NUM_THREADS (4)
+
+/**
+ * Number of iterations per thread
+ */
+#define NUM_ITERATIONS (10000)
+
+/*
+ *
+ * setup/teardown helpers
+ *
+ */
+
+static struct ws_string* str_a = NULL;
+static struct ws_string* str_b = NULL;
+
+void
+setup(void) {
+    str_a = ws_string_new();
+    str_b = ws_string_new();
+    ws_string_set_from_raw(str_a, "contended");
+    ws_string_set_from_raw(str_b, "contended");
+}
+
+void
+teardown(void) {
+    ws_object_unref(&str_a->obj);
+    ws_object_unref(&str_b->obj);
+    str_a = NULL;
+    str_b = NULL;
+}
+
+/*
+ *
+ * thread functions
+ *
+ */
+
+/**
+ * Pair of strings, in the order a thread operates on them
+ */
+struct string_pair {
+    struct ws_string* first;
+    struct ws_string* second;
+};
+
+static void*
+cmp_thread(
+    void* arg
+) {
+    struct string_pair* pair = (struct string_pair*) arg;
+
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        if (ws_string_cmp(pair->first, pair->second) != 0) {
+            return (void*) 1;
+        }
+        if (ws_object_cmp(&pair->first->obj, &pair->second->obj) != 0) {
+            return (void*) 1;
+        }
+    }
+
+    return NULL;
+}
+
+static void*
+set_thread(
+    void* arg
+) {
+    struct string_pair* pair = (struct string_pair*) arg;
+
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+        if (!ws_string_set_from_str(pair->first, pair->second)) {
+            return (void*) 1;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Run threads operating on the strings in both orders concurrently
+ *
+ * @return number of threads which reported an error
+ */
+static int
+run_threads(
+    void* (*fn)(void*)
+) {
+    struct string_pair ab = { .first = str_a, .second = str_b };
+    struct string_pair ba = { .first = str_b, .second = str_a };
+    pthread_t threads[2 * NUM_THREADS];
+    int failed = 0;
+
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        ck_assert(0 == pthread_create(&threads[2 * i], NULL, fn, &ab));
+        ck_assert(0 == pthread_create(&threads[2 * i + 1], NULL, fn, &ba));
+    }
+
+    for (int i = 0; i < 2 * NUM_THREADS; ++i) {
+        void* res;
+        ck_assert(0 == pthread_join(threads[i], &res));
+        failed += !!res;
+    }
+
+    return failed;
+}
+
+/*
+ *
+ * Test cases
+ *
+ */
+
+START_TEST (test_object_lock_pair) {
+    ck_assert(ws_object_lock_pair(&str_a->obj, true, &str_b->obj, false));
+
+    // the second object is only read-locked
+    ck_assert(0 == ws_object_lock_try_read(&str_b->obj));
+    ck_assert(ws_object_unlock(&str_b->obj));
+
+    ck_assert(ws_object_unlock_pair(&str_a->obj, true, &str_b->obj, false));
+
+    // both locks are released
+    ck_assert(0 == ws_object_lock_try_write(&str_a->obj));
+    ck_assert(ws_object_unlock(&str_a->obj));
+    ck_assert(0 == ws_object_lock_try_write(&str_b->obj));
+    ck_assert(ws_object_unlock(&str_b->obj));
+}
+END_TEST
+
+START_TEST (test_object_lock_pair_same) {
+    // locking the same object twice must not deadlock
+    ck_assert(ws_object_lock_pair(&str_a->obj, true, &str_a->obj, false));
+    ck_assert(0 != ws_object_lock_try_read(&str_a->obj));
+    ck_assert(ws_object_unlock_pair(&str_a->obj, true, &str_a->obj, false));
+
+    ck_assert(0 == ws_object_lock_try_write(&str_a->obj));
+    ck_assert(ws_object_unlock(&str_a->obj));
+
+    ck_assert(0 == ws_string_cmp(str_a, str_a));
+    ck_assert(ws_string_set_from_str(str_a, str_a));
+    ck_assert(ws_string_cat(str_a, str_a) == str_a);
+    ck_assert(ws_string_len(str_a) == 2 * ws_string_len(str_b));
+}
+END_TEST
+
+START_TEST (test_object_lock_pair_const) {
+    ws_object_set_settings(&str_b->obj,
+                           ws_object_get_settings(&str_b->obj) | WS_OBJ_CONST);
+
+    // constant objects are not read-locked
+    ck_assert(ws_object_lock_pair(&str_a->obj, false, &str_b->obj, false));
+    ck_assert(0 == ws_object_lock_try_write(&str_b->obj));
+    ck_assert(ws_object_unlock(&str_b->obj));
+    ck_assert(ws_object_unlock_pair(&str_a->obj, false, &str_b->obj, false));
+}
+END_TEST
+
+START_TEST (test_object_lock_contention_cmp) {
+    ck_assert(0 == run_threads(cmp_thread));
+}
+END_TEST
+
+START_TEST (test_object_lock_contention_set) {
+    ck_assert(0 == run_threads(set_thread));
+    ck_assert(0 == ws_string_cmp(str_a, str_b));
+}
+END_TEST
+
+/*
+ *
+ * main()
+ *
+ */
+
+static Suite*
+object_lock_suite(void)
+{
+    Suite* s    = suite_create("Object locking");
+    TCase* tc   = tcase_create("main case");
+    TCase* tcs  = tcase_create("Stress case");
+
+    suite_add_tcase(s, tc);
+    suite_add_tcase(s, tcs);
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_checked_fixture(tcs, setup, teardown);
+
+    // a deadlock shows up as a timeout
+    tcase_set_timeout(tcs, 30);
+
+    tcase_add_test(tc, test_object_lock_pair);
+    tcase_add_test(tc, test_object_lock_pair_same);
+    tcase_add_test(tc, test_object_lock_pair_const);
+
+    tcase_add_test(tcs, test_object_lock_contention_cmp);
+    tcase_add_test(tcs, test_object_lock_contention_set);
+
+    return s;
+}
+
+WS_TESTS_CHECK_MAIN(object_lock_suite);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
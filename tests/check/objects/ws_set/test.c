@@ -38,11 +38,15 @@
  */
 
 #include <check.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "tests.h"
 #include "objects/object.h"
 #include "objects/set.h"
+#include "objects/string.h"
 #include "util/arithmetical.h"
 
 /*
@@ -73,6 +77,34 @@ ws_object_type_id TEST_ID = {
     .cmp_callback = compare_set_test_objs,
 };
 
+/*
+ * Type whose elements are distinct by hash, but all compare equal
+ */
+
+static size_t
+hash_tie_obj(
+    struct ws_object* self
+) {
+    return (uintptr_t) self;
+}
+
+static int
+compare_tie_objs(
+    struct ws_object const* o1,
+    struct ws_object const* o2
+) {
+    return 0;
+}
+
+ws_object_type_id TIE_ID = {
+    .supertype  = &WS_OBJECT_TYPE_ID_OBJECT,
+    .typestr    = "ws_set_tie_obj",
+
+    .deinit_callback = NULL,
+    .hash_callback = hash_tie_obj,
+    .cmp_callback = compare_tie_objs,
+};
+
 struct ws_set_test_obj*
 new_test_obj(void)
 {
@@ -80,7 +112,7 @@ new_test_obj(void)
 
     if (o) {
         ws_object_init(&o->obj);
-        o->obj.id = &TEST_ID;
+        ws_object_set_type(&o->obj, &TEST_ID);
     }
 
     return o;
@@ -118,6 +150,34 @@ processor(
     return 0;
 }
 
+/**
+ * Processor checking whether the elements are processed in ascending order
+ */
+static int
+ascending_processor(
+    void* etc,
+    void const* obj
+) {
+    struct ws_object const** last = etc;
+
+    // elements of the test type are ordered by address
+    ck_assert((uintptr_t) *last < (uintptr_t) obj);
+    *last = obj;
+    return 0;
+}
+
+/**
+ * Processor counting the elements
+ */
+static int
+counting_processor(
+    void* etc,
+    void const* obj
+) {
+    ++*(size_t*) etc;
+    return 0;
+}
+
 /*
  *
  * Setup/Teardown functions
@@ -272,87 +332,152 @@ START_TEST (test_set_insert_get_remove) {
 }
 END_TEST
 
+START_TEST (test_set_many) {
+    // strings provide a real hash, so the table has to grow and rehash
+    static struct ws_string* strs[1000];
+    char buf[16];
+    int i;
+
+    for (i = 0; i < 1000; ++i) {
+        strs[i] = ws_string_new();
+        ck_assert(strs[i] != NULL);
+        snprintf(buf, sizeof(buf), "str%d", i);
+        ck_assert(0 == ws_string_set_from_raw(strs[i], buf));
+        ck_assert(0 == ws_set_insert(set, &strs[i]->obj));
+    }
+    ck_assert(1000 == ws_set_cardinality(set));
+
+    // inserting an equal element is a no-op
+    ck_assert(0 == ws_set_insert(set, &strs[0]->obj));
+    ck_assert(1000 == ws_set_cardinality(set));
+
+    for (i = 0; i < 1000; i += 2) {
+        ck_assert(0 == ws_set_remove(set, &strs[i]->obj));
+    }
+    ck_assert(500 == ws_set_cardinality(set));
+    ck_assert(-ENOENT == ws_set_remove(set, &strs[0]->obj));
+
+    for (i = 0; i < 1000; ++i) {
+        struct ws_object* o = ws_set_get(set, &strs[i]->obj);
+        ck_assert(o == ((i % 2) ? &strs[i]->obj : NULL));
+        ws_object_unref(o);
+        ws_object_unref(&strs[i]->obj);
+    }
+}
+END_TEST
+
 /*
  *
  * Tests: Set operations
  *
  */
 
-//START_TEST (test_set_union) {
-//    ck_assert(0 == ws_set_union(set, set_a, set_b));
-//
-//    int i;
-//
-//    for (i = N_TEST_OBJS - 1; i; --i) {
-//        ck_assert(TEST_OBJS[i] == ws_set_get(set, TEST_OBJS[i]));
-//    }
-//}
-//END_TEST
-
-//START_TEST (test_set_intersection) {
-//    ck_assert(0 == ws_set_intersection(set, set_a, set_b));
-//    // No intersection by now, as the sets `set_a` and `set_b` do not contain
-//    // equal elements
-//
-//    int i;
-//
-//    for (i = N_TEST_OBJS - 1; i; --i) {
-//        ck_assert(NULL == ws_set_get(set, TEST_OBJS[i]));
-//    }
-//
-//    // Insert the same object into both sets here.
-//    // No assertions here, as some of the objects are already in the sets
-//    for (i = N_TEST_OBJS / 2; i; --i) {
-//        ws_set_insert(set_a, TEST_OBJS[i]);
-//        ws_set_insert(set_b, TEST_OBJS[i]);
-//    }
-//
-//    // Now we create a _real_ intersection, where something actually happens
-//    ck_assert(0 == ws_set_intersection(set, set_a, set_b));
-//
-//    for (i = N_TEST_OBJS / 2; i; --i) {
-//        ck_assert(TEST_OBJS[i] == ws_set_get(set, TEST_OBJS[i]));
-//    }
-//}
-//END_TEST
-
-//START_TEST (test_set_xor) {
-//    ck_assert(0 == ws_set_xor(set, set_a, set_b));
-//
-//    int i;
-//
-//    for (i = N_TEST_OBJS - 1; i; --i) {
-//        ck_assert(NULL == ws_set_get(set, TEST_OBJS[i]));
-//    }
-//
-//    ws_set_insert(set_a, TEST_OBJS[0]);
-//    ws_set_insert(set_b, TEST_OBJS[0]);
-//
-//    ck_assert(0 == ws_set_xor(set, set_a, set_b));
-//
-//    for (i = N_TEST_OBJS - 1; i; --i) {
-//        if (i == 0) {
-//            ck_assert(TEST_OBJS[i] == ws_set_get(set, TEST_OBJS[i]));
-//        } else {
-//            ck_assert(NULL == ws_set_get(set, TEST_OBJS[i]));
-//        }
-//    }
-//}
-//END_TEST
-
-//START_TEST (test_set_subset) {
-//    // "set" is empty
-//    ck_assert(0 == ws_set_is_subset(set, set_a));
-//    ck_assert(0 == ws_set_is_subset(set, set_b));
-//
-//    ck_assert(1 == ws_set_is_subset(set_a, set));
-//    ck_assert(1 == ws_set_is_subset(set_b, set));
-//
-//    // set_a and set_b are different
-//    ck_assert(0 == ws_set_is_subset(set_a, set_b));
-//    ck_assert(0 == ws_set_is_subset(set_b, set_a));
-//}
-//END_TEST
+START_TEST (test_set_union) {
+    ck_assert(0 == ws_set_union(set, set_a, set_b));
+
+    int i;
+
+    for (i = N_TEST_OBJS - 1; i; --i) {
+        ck_assert(TEST_OBJS[i] == ws_set_get(set, TEST_OBJS[i]));
+    }
+
+    // union in place
+    ck_assert(0 == ws_set_union(set_a, set_a, set_b));
+    ck_assert(1 == ws_set_equal(set, set_a));
+}
+END_TEST
+
+START_TEST (test_set_intersection) {
+    ck_assert(0 == ws_set_intersection(set, set_a, set_b));
+    // No intersection by now, as the sets `set_a` and `set_b` do not contain
+    // equal elements
+
+    int i;
+
+    for (i = N_TEST_OBJS - 1; i; --i) {
+        ck_assert(NULL == ws_set_get(set, TEST_OBJS[i]));
+    }
+
+    // Insert the same object into both sets here.
+    // No assertions here, as some of the objects are already in the sets
+    for (i = N_TEST_OBJS / 2; i; --i) {
+        ws_set_insert(set_a, TEST_OBJS[i]);
+        ws_set_insert(set_b, TEST_OBJS[i]);
+    }
+
+    // Now we create a _real_ intersection, where something actually happens
+    ck_assert(0 == ws_set_intersection(set, set_a, set_b));
+
+    for (i = N_TEST_OBJS - 1; i; --i) {
+        if (i <= N_TEST_OBJS / 2) {
+            ck_assert(TEST_OBJS[i] == ws_set_get(set, TEST_OBJS[i]));
+        } else {
+            ck_assert(NULL == ws_set_get(set, TEST_OBJS[i]));
+        }
+    }
+    ck_assert(N_TEST_OBJS / 2 == ws_set_cardinality(set));
+}
+END_TEST
+
+START_TEST (test_set_difference) {
+    // the sets are disjoint
+    ck_assert(0 == ws_set_difference(set, set_a, set_b));
+    ck_assert(1 == ws_set_equal(set, set_a));
+
+    ck_assert(0 == ws_set_insert(set_b, TEST_OBJS[1]));
+
+    // difference in place
+    ck_assert(0 == ws_set_difference(set_a, set_a, set_b));
+    ck_assert(NULL == ws_set_get(set_a, TEST_OBJS[1]));
+    ck_assert(N_TEST_OBJS / 2 - 1 == ws_set_cardinality(set_a));
+
+    ck_assert(0 == ws_set_difference(set, set_b, set_b));
+    ck_assert(0 == ws_set_cardinality(set));
+}
+END_TEST
+
+START_TEST (test_set_xor) {
+    ck_assert(0 == ws_set_xor(set, set_a, set_b));
+
+    int i;
+
+    // the sets are disjoint
+    for (i = N_TEST_OBJS - 1; i; --i) {
+        ck_assert(TEST_OBJS[i] == ws_set_get(set, TEST_OBJS[i]));
+    }
+
+    ws_set_insert(set_a, TEST_OBJS[2]);
+    ws_set_insert(set_b, TEST_OBJS[1]);
+
+    ck_assert(0 == ws_set_xor(set, set_a, set_b));
+
+    for (i = N_TEST_OBJS - 1; i; --i) {
+        if (i <= 2) {
+            ck_assert(NULL == ws_set_get(set, TEST_OBJS[i]));
+        } else {
+            ck_assert(TEST_OBJS[i] == ws_set_get(set, TEST_OBJS[i]));
+        }
+    }
+}
+END_TEST
+
+START_TEST (test_set_subset) {
+    // "set" is empty
+    ck_assert(0 == ws_set_is_subset(set, set_a));
+    ck_assert(0 == ws_set_is_subset(set, set_b));
+
+    ck_assert(1 == ws_set_is_subset(set_a, set));
+    ck_assert(1 == ws_set_is_subset(set_b, set));
+
+    // set_a and set_b are different
+    ck_assert(0 == ws_set_is_subset(set_a, set_b));
+    ck_assert(0 == ws_set_is_subset(set_b, set_a));
+
+    ck_assert(0 == ws_set_union(set, set_a, set_b));
+    ck_assert(1 == ws_set_is_subset(set, set_a));
+    ck_assert(1 == ws_set_is_subset(set, set_b));
+}
+END_TEST
 
 START_TEST (test_set_cardinality) {
     ck_assert(0 == ws_set_cardinality(set));
@@ -360,9 +485,9 @@ START_TEST (test_set_cardinality) {
     ck_assert(N_TEST_OBJS / 2 == ws_set_cardinality(set_a));
     ck_assert(N_TEST_OBJS / 2 == ws_set_cardinality(set_b));
 
-//    ck_assert(0 == ws_set_union(set, set_a, set_b));
-//
-//    ck_assert(15 == ws_set_cardinality(set));
+    ck_assert(0 == ws_set_union(set, set_a, set_b));
+
+    ck_assert(N_TEST_OBJS - 1 == ws_set_cardinality(set));
 }
 END_TEST
 
@@ -375,6 +500,141 @@ START_TEST (test_set_select) {
 }
 END_TEST
 
+START_TEST (test_set_select_next) {
+    struct ws_object* obj;
+    size_t cursor = 0;
+    size_t count = 0;
+
+    while ((obj = ws_set_select_next(set_a, &cursor))) {
+        // every element is visited exactly once
+        ck_assert(0 == ws_set_insert(set, obj));
+        ck_assert(++count == ws_set_cardinality(set));
+        ws_object_unref(obj);
+    }
+    ck_assert(1 == ws_set_equal(set, set_a));
+
+    // the cursor stays at the end
+    ck_assert(NULL == ws_set_select_next(set_a, &cursor));
+}
+END_TEST
+
+START_TEST (test_set_ordered) {
+    struct ws_object const* last = NULL;
+    struct ws_object* lowest = NULL;
+    struct ws_object* greatest = NULL;
+    size_t count = 0;
+    int i;
+
+    ck_assert(-ENOTSUP == ws_set_select_range(set_a, NULL, NULL, NULL, NULL,
+                                              counting_processor, &count));
+
+    // enable the index on a populated set
+    ck_assert(0 == ws_set_enable_ordering(set_a));
+    ck_assert(ws_set_is_ordered(set_a));
+    ck_assert(0 == ws_set_select(set_a, NULL, NULL, ascending_processor,
+                                 &last));
+
+    // `set_a` contains the objects with odd indices
+    for (i = 1; i < N_TEST_OBJS; i += 2) {
+        if (!lowest || ((uintptr_t) TEST_OBJS[i] < (uintptr_t) lowest)) {
+            lowest = TEST_OBJS[i];
+        }
+        if (!greatest || ((uintptr_t) TEST_OBJS[i] > (uintptr_t) greatest)) {
+            greatest = TEST_OBJS[i];
+        }
+    }
+    ck_assert(lowest == ws_set_select_lowest(set_a));
+    ck_assert(greatest == ws_set_select_greatest(set_a));
+
+    // the index is maintained by set operations
+    ck_assert(0 == ws_set_union(set_a, set_a, set_b));
+    ck_assert(ws_set_is_ordered(set_a));
+    last = NULL;
+    ck_assert(0 == ws_set_select(set_a, NULL, NULL, ascending_processor,
+                                 &last));
+    ck_assert(last == ws_set_select_greatest(set_a));
+
+    // ... and on removal
+    ck_assert(0 == ws_set_remove(set_a, ws_set_select_lowest(set_a)));
+    ck_assert(0 == ws_set_remove(set_a, ws_set_select_greatest(set_a)));
+    ck_assert(0 == ws_set_select(set_a, NULL, NULL, counting_processor,
+                                 &count));
+    ck_assert(N_TEST_OBJS - 3 == count);
+
+    // the range includes both bounds
+    lowest = ws_set_select_lowest(set_a);
+    greatest = ws_set_select_greatest(set_a);
+    count = 0;
+    ck_assert(0 == ws_set_select_range(set_a, lowest, greatest, NULL, NULL,
+                                       counting_processor, &count));
+    ck_assert(N_TEST_OBJS - 3 == count);
+
+    ck_assert(0 == ws_set_remove(set_a, lowest));
+    count = 0;
+    ck_assert(0 == ws_set_select_range(set_a, lowest, greatest, NULL, NULL,
+                                       counting_processor, &count));
+    ck_assert(N_TEST_OBJS - 4 == count);
+
+    count = 0;
+    ck_assert(0 == ws_set_select_range(set_a, greatest, NULL, NULL, NULL,
+                                       counting_processor, &count));
+    ck_assert(1 == count);
+
+    ws_set_disable_ordering(set_a);
+    ck_assert(!ws_set_is_ordered(set_a));
+    ck_assert(N_TEST_OBJS - 4 == ws_set_cardinality(set_a));
+}
+END_TEST
+
+/**
+ * Processor checking that an element is not processed
+ */
+static int
+absent_processor(
+    void* etc,
+    void const* obj
+) {
+    ck_assert(obj != etc);
+    return 0;
+}
+
+START_TEST (test_set_ordered_ties) {
+    struct ws_object* objs[8];
+    size_t count;
+    size_t i;
+
+    ck_assert(0 == ws_set_enable_ordering(set));
+    for (i = 0; i < 8; ++i) {
+        objs[i] = ws_object_new(sizeof(struct ws_object));
+        ck_assert(objs[i]);
+        ws_object_set_type(objs[i], &TIE_ID);
+        ck_assert(0 == ws_set_insert(set, objs[i]));
+    }
+    ck_assert(8 == ws_set_cardinality(set));
+
+    // remove elements which are not the first of their run of equal keys
+    for (i = 1; i < 8; i += 2) {
+        ck_assert(0 == ws_set_remove(set, objs[i]));
+        ck_assert(0 == ws_set_select(set, NULL, NULL, absent_processor,
+                                     objs[i]));
+    }
+
+    count = 0;
+    ck_assert(0 == ws_set_select(set, NULL, NULL, counting_processor,
+                                 &count));
+    ck_assert(4 == count);
+
+    for (i = 0; i < 8; i += 2) {
+        ck_assert(0 == ws_set_remove(set, objs[i]));
+    }
+    ck_assert(NULL == ws_set_select_lowest(set));
+
+    for (i = 0; i < 8; ++i) {
+        ws_object_unref(objs[i]);
+    }
+}
+END_TEST
+
 /*
  *
  * Suite
@@ -394,23 +654,28 @@ set_suite(void)
 
     tcase_add_test(tc, test_set_init);
     tcase_add_test(tc, test_set_init_deinit);
+    tcase_add_test(tc, test_set_ordered_ties);
 
     suite_add_tcase(s, tce);
     tcase_add_checked_fixture(tce, test_set_setup_objs, test_set_teardown_objs);
     tcase_add_test(tce, test_set_insert);
     tcase_add_test(tce, test_set_insert_remove);
     tcase_add_test(tce, test_set_insert_get_remove);
+    tcase_add_test(tce, test_set_many);
 
     suite_add_tcase(s, tcso);
     tcase_add_checked_fixture(tcso,
                               test_set_setup_sets,
                               test_set_teardown_sets);
-//    tcase_add_test(tcso, test_set_union);
-//    tcase_add_test(tcso, test_set_intersection);
-//    tcase_add_test(tcso, test_set_xor);
-//    tcase_add_test(tcso, test_set_subset);
+    tcase_add_test(tcso, test_set_union);
+    tcase_add_test(tcso, test_set_intersection);
+    tcase_add_test(tcso, test_set_difference);
+    tcase_add_test(tcso, test_set_xor);
+    tcase_add_test(tcso, test_set_subset);
     tcase_add_test(tcso, test_set_cardinality);
     tcase_add_test(tcso, test_set_select);
+    tcase_add_test(tcso, test_set_select_next);
+    tcase_add_test(tcso, test_set_ordered);
 
     return s;
 }
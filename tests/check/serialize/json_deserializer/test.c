@@ -44,17 +44,22 @@
  */
 
 #include <check.h>
+#include <inttypes.h>
+#include <stdio.h>
 #include "tests.h"
 
 #include "serialize/deserializer.h"
 #include "serialize/json/deserializer.h"
 #include "serialize/json/keys.h"
+#include "objects/message/batch.h"
 #include "objects/message/event.h"
+#include "objects/message/invocation.h"
 #include "objects/message/message.h"
 #include "objects/message/transaction.h"
 #include "command/statement.h"
 #include "util/string.h"
 #include "values/int.h"
+#include "values/object_id.h"
 #include "values/string.h"
 
 /*
@@ -354,6 +359,28 @@ START_TEST (test_json_deserializer_flags) {
 }
 END_TEST
 
+START_TEST (test_json_deserializer_expand) {
+    char const* buf =   "{ \"" TYPE "\": \"" TYPE_TRANSACTION "\","
+                        " \"" UID "\": 1337, "
+                        " \"" EXPAND "\": [ \"width\", \"height\" ]"
+                        "}";
+
+    ssize_t s = ws_deserialize(d, &messagebuf, buf, strlen(buf));
+
+    ck_assert((unsigned long) s == strlen(buf));
+    ck_assert(messagebuf != NULL);
+
+    struct ws_transaction* t = (struct ws_transaction*) messagebuf; // cast
+
+    char const* const* attrs;
+    size_t num;
+    ck_assert(ws_transaction_expansion(t, &attrs, &num));
+    ck_assert(num == 2);
+    ck_assert(ws_streq(attrs[0], "width"));
+    ck_assert(ws_streq(attrs[1], "height"));
+}
+END_TEST
+
 START_TEST (test_json_deserializer_events) {
     char const* buf = "{ \"" EVENT_NAME "\": \"testname\" }";
 
@@ -624,6 +651,148 @@ START_TEST (test_json_deserializer_multiple_transactions_flags) {
 }
 END_TEST
 
+START_TEST (test_json_deserializer_object_arg) {
+    struct ws_string* str = ws_string_new();
+    ck_assert(str);
+    uintmax_t id = ws_object_uuid((struct ws_object*) str);
+
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "{ \"" TYPE "\": \"" TYPE_TRANSACTION "\","
+             " \"" UID "\": 1337, "
+             " \"" COMMANDS "\": ["
+                "{ \"cat\": [ { \"" OBJECT_ID "\": \"%" PRIxMAX "\" },"
+                             " { \"" OBJECT_ID "\": \"%" PRIxMAX "\" } ] }"
+             "] }", id, id + 1);
+
+    ssize_t s = ws_deserialize(d, &messagebuf, buf, strlen(buf));
+
+    ck_assert((unsigned long) s == strlen(buf));
+    ck_assert(messagebuf != NULL);
+    ck_assert(messagebuf->obj.id == &WS_OBJECT_TYPE_ID_TRANSACTION);
+
+    struct ws_transaction* t = (struct ws_transaction*) messagebuf;
+    ck_assert(t->cmds != NULL);
+    ck_assert(t->cmds->num == 1);
+    ck_assert(t->cmds->statements[0].args.num == 2);
+
+    struct ws_value* val = t->cmds->statements[0].args.vals[0].arg.val;
+    ck_assert(val->type == WS_VALUE_TYPE_OBJECT_ID);
+    struct ws_object* obj;
+    obj = ws_value_object_id_get((struct ws_value_object_id*) val);
+    ck_assert(obj == (struct ws_object*) str);
+    ws_object_unref(obj);
+
+    // there is no object with this uuid
+    val = t->cmds->statements[0].args.vals[1].arg.val;
+    ck_assert(val->type == WS_VALUE_TYPE_NIL);
+
+    ws_object_unref((struct ws_object*) str);
+}
+END_TEST
+
+START_TEST (test_json_deserializer_batch) {
+    char const* buf =
+    "{" \
+        "\"UID\": 7," \
+        "\"ATOMIC\": true," \
+        "\"BATCH\": [" \
+        "    {" \
+        "        \"UID\": 1," \
+        "        \"FLAGS\": { \"REGISTER\": \"foo\" }," \
+        "        \"CMDS\": [ { \"add\": [ 1, 2 ] } ]" \
+        "    }," \
+        "    {" \
+        "        \"UID\": 2," \
+        "        \"FLAGS\": { \"EXEC\": true }," \
+        "        \"CMDS\": [ { \"sub\": [ 3, 2 ] } ]" \
+        "    }" \
+        "]" \
+    "}";
+
+    ssize_t s = ws_deserialize(d, &messagebuf, buf, strlen(buf));
+
+    ck_assert((unsigned long) s == strlen(buf));
+    ck_assert(messagebuf != NULL);
+    ck_assert(messagebuf->obj.id == &WS_OBJECT_TYPE_ID_BATCH);
+    ck_assert(messagebuf->id == 7);
+
+    struct ws_batch* batch = (struct ws_batch*) messagebuf;
+    ck_assert(ws_batch_is_atomic(batch));
+    ck_assert(ws_batch_len(batch) == 2);
+
+    struct ws_transaction* t = ws_batch_get(batch, 0);
+    ck_assert(t->m.id == 1);
+    ck_assert(ws_transaction_flags(t) == WS_TRANSACTION_FLAGS_REGISTER);
+    ck_assert(t->name != NULL);
+    ck_assert(t->cmds != NULL);
+    ck_assert(t->cmds->num == 1);
+
+    t = ws_batch_get(batch, 1);
+    ck_assert(t->m.id == 2);
+    ck_assert(ws_transaction_flags(t) == WS_TRANSACTION_FLAGS_EXEC);
+    ck_assert(t->name == NULL);
+    ck_assert(t->cmds != NULL);
+    ck_assert(t->cmds->num == 1);
+
+    ck_assert(ws_batch_get(batch, 2) == NULL);
+}
+END_TEST
+
+START_TEST (test_json_deserializer_batch_nested) {
+    char const* buf =
+    "{" \
+        "\"BATCH\": [" \
+        "    { \"BATCH\": [ { \"CMDS\": [] } ] }" \
+        "]" \
+    "}";
+
+    ws_deserialize(d, &messagebuf, buf, strlen(buf));
+
+    // batches may not be nested
+    ck_assert(messagebuf == NULL);
+}
+END_TEST
+
+START_TEST (test_json_deserializer_invocation) {
+    char const* buf =   "{ \"" UID "\": 3, "
+                        " \"" ARGS "\": [ 1, \"foo\", true, null ],"
+                        " \"" INVOKE "\": \"bar\" }";
+
+    ssize_t s = ws_deserialize(d, &messagebuf, buf, strlen(buf));
+
+    ck_assert((unsigned long) s == strlen(buf));
+    ck_assert(messagebuf != NULL);
+    ck_assert(messagebuf->obj.id == &WS_OBJECT_TYPE_ID_INVOCATION);
+    ck_assert(messagebuf->id == 3);
+
+    struct ws_invocation* inv = (struct ws_invocation*) messagebuf;
+    struct ws_string* name = ws_invocation_name(inv);
+    ck_assert(name != NULL);
+    ck_assert(ws_streq(ws_string_raw(name), "bar"));
+    ws_object_unref((struct ws_object*) name);
+
+    ck_assert(ws_invocation_nargs(inv) == 4);
+    union ws_value_union const* args = ws_invocation_args(inv);
+    ck_assert(args[0].value.type == WS_VALUE_TYPE_INT);
+    ck_assert(args[0].int_.i == 1);
+    ck_assert(args[1].value.type == WS_VALUE_TYPE_STRING);
+    ck_assert(args[2].value.type == WS_VALUE_TYPE_BOOL);
+    ck_assert(args[3].value.type == WS_VALUE_TYPE_NIL);
+}
+END_TEST
+
+START_TEST (test_json_deserializer_invocation_with_cmds) {
+    char const* buf =   "{ \"" INVOKE "\": \"bar\","
+                        " \"" COMMANDS "\": [] }";
+
+    ws_deserialize(d, &messagebuf, buf, strlen(buf));
+
+    // an invocation does not carry commands
+    ck_assert(messagebuf == NULL);
+}
+END_TEST
+
 /*
  *
  * main()
@@ -655,12 +824,18 @@ json_deserializer_suite(void)
     tcase_add_test(tcx, test_json_deserializer_transaction_one_command);
     tcase_add_test(tcx, test_json_deserializer_transaction_commands);
     tcase_add_test(tcx, test_json_deserializer_flags);
+    tcase_add_test(tcx, test_json_deserializer_expand);
     tcase_add_test(tcx, test_json_deserializer_events);
     tcase_add_test(tcx, test_json_deserializer_events_with_type);
     tcase_add_test(tcx, test_json_deserializer_events_with_everything);
     tcase_add_test(tcx, test_json_deserializer_multiple_transactions);
     tcase_add_test(tcx, test_json_deserializer_multiple_transactions_three);
     tcase_add_test(tcx, test_json_deserializer_multiple_transactions_flags);
+    tcase_add_test(tcx, test_json_deserializer_object_arg);
+    tcase_add_test(tcx, test_json_deserializer_batch);
+    tcase_add_test(tcx, test_json_deserializer_batch_nested);
+    tcase_add_test(tcx, test_json_deserializer_invocation);
+    tcase_add_test(tcx, test_json_deserializer_invocation_with_cmds);
 
     return s;
 }
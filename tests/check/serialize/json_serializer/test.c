@@ -51,6 +51,8 @@
 #include "serialize/serializer.h"
 #include "serialize/json/serializer.h"
 #include "serialize/json/keys.h"
+#include "objects/message/batch.h"
+#include "objects/message/batch_reply.h"
 #include "objects/message/error_reply.h"
 #include "objects/message/message.h"
 #include "objects/message/event.h"
@@ -60,6 +62,7 @@
 
 #include "util/string.h"
 
+#include "values/array.h"
 #include "values/int.h"
 #include "values/string.h"
 
@@ -353,6 +356,101 @@ START_TEST (test_json_serializer_value_reply_int) {
 }
 END_TEST
 
+START_TEST (test_json_serializer_value_reply_array) {
+    size_t t_id = 42;
+
+    struct ws_value_array* v = calloc(1, sizeof(*v));
+    ck_assert(v);
+
+    ws_value_array_init(v);
+    ck_assert(ws_value_array_resize(v, 3) == 0);
+    ck_assert(ws_value_array_set(v, 0, 1) == 0);
+    ck_assert(ws_value_array_set(v, 2, -3) == 0);
+
+    struct ws_value_reply* vr = mk_value_reply("testtrans",
+                                               (struct ws_value*) v,
+                                               t_id);
+
+    ssize_t s; // Number of written bytes
+    size_t nbuf = 1000; // 1000 bytes are enough, hopefully
+    char* buf   = calloc(1, sizeof(*buf) * nbuf);
+    ck_assert(buf);
+
+    s = ws_serialize(ser, buf, nbuf, (struct ws_message*) vr);
+
+    ck_assert(s != 0);
+
+    { // test the result
+        char exp[1024];
+        memset(exp, 0, 1024);
+        const char* pref = "{\"value\":[1,0,-3],\""TRANSACTION_ID"\":";
+        const char* suff = "}";
+        snprintf(exp, 1024, "%s%zi%s", pref, t_id, suff);
+        ck_assert(ws_streq(exp, buf));
+
+        // we can now check the returned value
+        ck_assert(s == (ssize_t) strlen(exp));
+    }
+
+    ws_object_unref((struct ws_object*) vr);
+    free(buf);
+}
+END_TEST
+
+START_TEST (test_json_serializer_value_reply_expanded) {
+    size_t t_id = 7;
+
+    struct ws_object* obj = ws_object_new_raw();
+    ck_assert(obj);
+
+    struct ws_value_object_id* v = calloc(1, sizeof(*v));
+    ck_assert(v);
+    ws_value_object_id_init(v);
+    ws_value_object_id_set(v, obj);
+
+    struct ws_string* tname = ws_string_new();
+    ck_assert(tname);
+    ws_string_set_from_raw(tname, "testtrans");
+
+    // objects of the reply are expanded with an attribute they don't have
+    struct ws_transaction* t = ws_transaction_new(t_id, tname, 0, NULL);
+    ck_assert(t);
+    ck_assert(ws_transaction_expand(t, "width") == 0);
+
+    struct ws_value_reply* vr = ws_value_reply_new(t, (struct ws_value*) v);
+    ck_assert(vr);
+
+    ssize_t s; // Number of written bytes
+    size_t nbuf = 1000; // 1000 bytes are enough, hopefully
+    char* buf   = calloc(1, sizeof(*buf) * nbuf);
+    ck_assert(buf);
+
+    s = ws_serialize(ser, buf, nbuf, (struct ws_message*) vr);
+
+    ck_assert(s != 0);
+
+    { // test the result
+        char exp[1024];
+        memset(exp, 0, 1024);
+        const char* pref = "{\"value\":{\"object\":{\""EXPANDED_ID"\":\"";
+        const char* suff = "\",\""EXPANDED_TYPE"\":\"ws_object\","
+                           "\"width\":null}},\""TRANSACTION_ID"\":";
+        uintmax_t id = ws_object_uuid(obj);
+        snprintf(exp, 1024, "%s%"PRIxMAX"%s%zi}", pref, id, suff, t_id);
+        ck_assert(ws_streq(exp, buf));
+
+        // we can now check the returned value
+        ck_assert(s == (ssize_t) strlen(exp));
+    }
+
+    ws_object_unref((struct ws_object*) vr);
+    ws_object_unref((struct ws_object*) t);
+    ws_object_unref((struct ws_object*) tname);
+    ws_object_unref(obj);
+    free(buf);
+}
+END_TEST
+
 START_TEST (test_json_serializer_error_reply) {
     size_t t_id = 132;
     unsigned int code = 12345;
@@ -399,6 +497,45 @@ START_TEST (test_json_serializer_error_reply) {
 }
 END_TEST
 
+START_TEST (test_json_serializer_batch_reply) {
+    struct ws_batch* batch = ws_batch_new(5);
+    ck_assert(batch);
+
+    struct ws_batch_reply* br = ws_batch_reply_new(batch);
+    ck_assert(br);
+
+    struct ws_value_reply* vr = mk_value_reply("testtrans", NULL, 13);
+    ck_assert(ws_batch_reply_append(br, (struct ws_reply*) vr) == 0);
+
+    struct ws_transaction* t = ws_transaction_new(14, NULL, 0, NULL);
+    ck_assert(t);
+    struct ws_error_reply* er = ws_error_reply_new(t, 1, "a", "b");
+    ck_assert(er);
+    ck_assert(ws_batch_reply_append(br, (struct ws_reply*) er) == 0);
+
+    size_t nbuf = 1000; // 1000 bytes are enough, hopefully
+    char* buf   = calloc(1, sizeof(*buf) * nbuf);
+    ck_assert(buf);
+
+    ssize_t s = ws_serialize(ser, buf, nbuf, (struct ws_message*) br);
+
+    { // test the result
+        const char* exp = "{\""REPLIES"\":["
+                            "{\"value\":null,\""TRANSACTION_ID"\":13},"
+                            "{\""ERROR_CODE"\":1,\""ERROR_DESC"\":\"a\","
+                            "\""ERROR_CAUSE"\":\"b\"}"
+                          "],\""TRANSACTION_ID"\":5}";
+        ck_assert(ws_streq(exp, buf));
+        ck_assert(s == (ssize_t) strlen(exp));
+    }
+
+    ws_object_unref((struct ws_object*) br);
+    ws_object_unref((struct ws_object*) t);
+    ws_object_unref((struct ws_object*) batch);
+    free(buf);
+}
+END_TEST
+
 /*
  *
  * main()
@@ -425,7 +562,10 @@ json_deserializer_suite(void)
 
     tcase_add_test(tcx, test_json_serializer_value_reply);
     tcase_add_test(tcx, test_json_serializer_value_reply_int);
+    tcase_add_test(tcx, test_json_serializer_value_reply_array);
+    tcase_add_test(tcx, test_json_serializer_value_reply_expanded);
     tcase_add_test(tcx, test_json_serializer_error_reply);
+    tcase_add_test(tcx, test_json_serializer_batch_reply);
 
     return s;
 }
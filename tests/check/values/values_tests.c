@@ -40,6 +40,76 @@
 #include <check.h>
 #include "tests.h"
 
+#include "objects/set.h"
+#include "objects/string.h"
+#include "values/set.h"
+#include "values/string.h"
+#include "values/union.h"
+
+START_TEST (test_value_string_copy_on_write) {
+    struct ws_value_string orig;
+    ws_value_string_init(&orig);
+    ck_assert(orig.str);
+    ck_assert(ws_string_set_from_raw(orig.str, "foo") == 0);
+
+    union ws_value_union copy;
+    ws_value_init(&copy.value);
+    ck_assert(ws_value_union_init_from_val(&copy, &orig.val) == 0);
+
+    // the copy shares the string until it is modified
+    ck_assert(copy.string.str == orig.str);
+
+    struct ws_string* str = ws_value_string_get_mut(&copy.string);
+    ck_assert(str);
+    ck_assert(str != orig.str);
+    ck_assert(ws_string_cmp(str, orig.str) == 0);
+
+    // a private string is not copied again
+    ck_assert(ws_value_string_get_mut(&copy.string) == str);
+
+    ck_assert(ws_string_cat(str, orig.str) == str);
+    ck_assert(ws_string_len(str) == 6);
+    ck_assert(ws_string_len(orig.str) == 3);
+
+    ws_value_deinit(&copy.value);
+    ws_value_deinit(&orig.val);
+}
+END_TEST
+
+START_TEST (test_value_set_copy_on_write) {
+    struct ws_value_set orig;
+    ck_assert(ws_value_set_init(&orig) == 0);
+
+    struct ws_string* elem = ws_string_new();
+    ck_assert(elem);
+    ck_assert(ws_string_set_from_raw(elem, "foo") == 0);
+
+    union ws_value_union copy;
+    ws_value_init(&copy.value);
+    ck_assert(ws_value_union_init_from_val(&copy, &orig.value) == 0);
+    ck_assert(copy.set.set == orig.set);
+
+    // inserting into the copy must not alter the original
+    ck_assert(ws_value_set_insert(&copy.set, &elem->obj) == 0);
+    ck_assert(copy.set.set != orig.set);
+    ck_assert(ws_value_set_cardinality(&copy.set) == 1);
+    ck_assert(ws_value_set_cardinality(&orig) == 0);
+
+    // set operations on a shared value must not alter the other values
+    union ws_value_union other;
+    ws_value_init(&other.value);
+    ck_assert(ws_value_union_init_from_val(&other, &copy.value) == 0);
+    ck_assert(ws_value_set_difference(&other.set, &copy.set, &copy.set) == 0);
+    ck_assert(ws_value_set_cardinality(&other.set) == 0);
+    ck_assert(ws_value_set_cardinality(&copy.set) == 1);
+
+    ws_value_deinit(&other.value);
+    ws_value_deinit(&copy.value);
+    ws_value_deinit(&orig.value);
+    ws_object_unref(&elem->obj);
+}
+END_TEST
+
 static Suite*
 values_suite(void)
 {
@@ -49,7 +119,8 @@ values_suite(void)
     suite_add_tcase(s, tc);
     // tcase_add_checked_fixture(tc, setup, cleanup); // Not used yet
 
-    //tcase_add_tests(tc, ...);
+    tcase_add_test(tc, test_value_string_copy_on_write);
+    tcase_add_test(tc, test_value_set_copy_on_write);
 
     return s;
 }